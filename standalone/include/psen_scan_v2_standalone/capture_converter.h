@@ -0,0 +1,109 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_CAPTURE_CONVERTER_H
+#define PSEN_SCAN_V2_STANDALONE_CAPTURE_CONVERTER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/util/thread_pool.h"
+
+namespace psen_scan_v2_standalone
+{
+/**
+ * @brief LaserScan with the receive time of its last datagram.
+ */
+struct CapturedScan
+{
+  //! @brief Time since the epoch of the system clock.
+  std::chrono::nanoseconds timestamp{ 0 };
+  LaserScan scan;
+};
+
+/**
+ * @brief Counters of a conversion.
+ */
+struct CaptureConversionStatistics
+{
+  uint64_t datagrams{ 0 };
+  uint64_t scans{ 0 };
+  //! Datagrams which could not be deserialized, e.g. because they are no monitoring frames.
+  uint64_t decode_errors{ 0 };
+  //! Scan rounds which were incomplete, had too many frames or could not be converted.
+  uint64_t dropped_rounds{ 0 };
+  //! Frames of a scan round which was already complete.
+  uint64_t outdated_frames{ 0 };
+};
+
+/**
+ * @brief Converts recorded datagrams of the data connection into LaserScans, using all cores.
+ *
+ * The datagrams are split into chunks at the boundaries of the scan rounds, i.e. where the scan counter exceeds all
+ * before. Incomplete rounds at the chunk boundaries are counted as dropped like in a single run over all datagrams,
+ * so the result does not depend on the number of threads.
+ * The chunks are processed in parallel like the driver processes received datagrams:
+ * monitoring_frame::deserialize(), the scan buffer (unless fragmented scans are enabled) and LaserScanConverter.
+ * Unlike the ReplayScanner, the conversion continues after datagrams which cannot be deserialized, so that long
+ * captures with occasional foreign or damaged datagrams can be evaluated.
+ *
+ * @see communication_layer::readRecording()
+ */
+class CaptureConverter
+{
+public:
+  using ScanHandler = std::function<void(const CapturedScan&)>;
+
+  /**
+   * @param fragmented_scans If true, each monitoring frame is converted into a LaserScan of its own, like the driver
+   * does with ScannerConfigurationBuilder::enableFragmentedScans().
+   * @param number_of_threads Number of threads converting the chunks.
+   * @throws std::invalid_argument if the number of threads is 0.
+   */
+  CaptureConverter(const bool& fragmented_scans = false,
+                   const std::size_t& number_of_threads = util::ThreadPool::defaultNumberOfThreads());
+
+public:
+  /**
+   * @brief Converts the datagrams and passes the scans in the order of the datagrams to the handler.
+   *
+   * The handler is called by the calling thread while later chunks are still being converted, so the scans
+   * of long captures do not have to be kept in memory.
+   */
+  CaptureConversionStatistics convert(const std::vector<communication_layer::RecordedDatagram>& datagrams,
+                                      const ScanHandler& handler) const;
+  std::vector<CapturedScan> convert(const std::vector<communication_layer::RecordedDatagram>& datagrams) const;
+
+  /**
+   * @returns the indices of the first datagram of each chunk, starting with 0.
+   *
+   * The datagrams are divided into about the given number of chunks. A chunk starts with the first datagram of a
+   * scan round, so each round is converted as a whole. Outdated frames of an earlier round never start a chunk.
+   */
+  static std::vector<std::size_t> findChunks(const std::vector<communication_layer::RecordedDatagram>& datagrams,
+                                             const std::size_t& number_of_chunks);
+
+private:
+  const bool fragmented_scans_;
+  const std::size_t number_of_threads_;
+};
+
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_CAPTURE_CONVERTER_H
@@ -0,0 +1,195 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_DATAGRAM_LOG_H
+#define PSEN_SCAN_V2_STANDALONE_DATAGRAM_LOG_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/raw_scanner_data.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace communication_layer
+{
+/**
+ * @brief Datagram received at the given time.
+ */
+struct RecordedDatagram
+{
+  //! @brief Receive time since the epoch of the system clock.
+  std::chrono::nanoseconds timestamp{ 0 };
+  data_conversion_layer::RawData data;
+};
+
+//! @brief Exception thrown if a recording cannot be read.
+class DatagramLogError : public std::runtime_error
+{
+public:
+  DatagramLogError(const std::string& msg);
+};
+
+//! @brief Size of the file header written by encodeDatagramLogHeader() or encodePcapHeader().
+static constexpr std::size_t MAX_FILE_HEADER_SIZE{ 24 };
+//! @brief Size of the record header written by encodeDatagramLogRecordHeader() or encodePcapRecordHeader().
+static constexpr std::size_t MAX_RECORD_HEADER_SIZE{ 44 };
+
+/**
+ * @brief Addresses of the IPv4 and UDP headers written to pcap files. Unknown addresses can be left 0.
+ */
+struct UdpEndpoints
+{
+  uint32_t source_ip{ 0 };
+  uint16_t source_port{ 0 };
+  uint32_t destination_ip{ 0 };
+  uint16_t destination_port{ 0 };
+};
+
+/**
+ * @brief Writes the header of a raw datagram log to the buffer, which has to hold MAX_FILE_HEADER_SIZE bytes.
+ *
+ * @returns the number of bytes written.
+ * @see writeDatagramLogHeader()
+ */
+std::size_t encodeDatagramLogHeader(char* buffer);
+/**
+ * @brief Writes the header of a record of a raw datagram log to the buffer, which has to hold MAX_RECORD_HEADER_SIZE
+ * bytes. The payload of the datagram has to follow directly.
+ *
+ * @returns the number of bytes written.
+ */
+std::size_t encodeDatagramLogRecordHeader(char* buffer,
+                                          const std::chrono::nanoseconds& timestamp,
+                                          const std::size_t& length);
+
+/**
+ * @brief Writes the header of a pcap file with nanosecond timestamps and raw IPv4 packets to the buffer, which has to
+ * hold MAX_FILE_HEADER_SIZE bytes.
+ *
+ * @returns the number of bytes written.
+ */
+std::size_t encodePcapHeader(char* buffer);
+/**
+ * @brief Writes the header of a pcap record, including an IPv4 and a UDP header, to the buffer, which has to hold
+ * MAX_RECORD_HEADER_SIZE bytes. The payload of the datagram has to follow directly.
+ *
+ * @returns the number of bytes written.
+ */
+std::size_t encodePcapRecordHeader(char* buffer,
+                                   const std::chrono::nanoseconds& timestamp,
+                                   const std::size_t& length,
+                                   const UdpEndpoints& endpoints);
+
+//! @brief Size of the header of a flight recording, after which the ring of records starts.
+static constexpr std::size_t FLIGHT_RECORDING_HEADER_SIZE{ 64 };
+//! @brief Size of the header of a record of a flight recording.
+static constexpr std::size_t FLIGHT_RECORD_HEADER_SIZE{ 16 };
+//! @brief The records of a flight recording start at multiples of this alignment.
+static constexpr std::size_t FLIGHT_RECORD_ALIGNMENT{ 8 };
+//! @brief Offsets of the fields in the header of a flight recording.
+static constexpr std::size_t FLIGHT_RECORDING_CAPACITY_OFFSET{ 16 };
+static constexpr std::size_t FLIGHT_RECORDING_TAIL_OFFSET{ 24 };
+static constexpr std::size_t FLIGHT_RECORDING_HEAD_OFFSET{ 32 };
+
+/**
+ * @brief Writes the header of a flight recording with the given capacity of the ring to the buffer, which has to
+ * hold FLIGHT_RECORDING_HEADER_SIZE bytes. The ring is empty.
+ *
+ * @returns the number of bytes written.
+ * @see readFlightRecording()
+ */
+std::size_t encodeFlightRecordingHeader(char* buffer, const uint64_t& capacity);
+/**
+ * @brief Writes the header of a record of a flight recording to the buffer, which has to hold
+ * FLIGHT_RECORD_HEADER_SIZE bytes.
+ *
+ * @returns the number of bytes written.
+ */
+std::size_t encodeFlightRecordHeader(char* buffer,
+                                     const std::chrono::nanoseconds& timestamp,
+                                     const std::size_t& length);
+
+/**
+ * @brief Writes the header of a raw datagram log.
+ *
+ * A raw datagram log consists of the magic "PSENDGRM", the format version as uint32 and one record per datagram:
+ * the receive time in nanoseconds since the epoch as uint64, the length as uint32 and the payload. All integers are
+ * little endian.
+ */
+void writeDatagramLogHeader(std::ostream& os);
+//! @brief Appends one record to a raw datagram log, see writeDatagramLogHeader().
+void writeDatagramLogRecord(std::ostream& os,
+                            const std::chrono::nanoseconds& timestamp,
+                            const char* data,
+                            const std::size_t& length);
+
+/**
+ * @brief Reads all datagrams of a raw datagram log.
+ *
+ * @throws DatagramLogError if the header or the length of a record is invalid. A truncated last record, e.g. of a
+ * recording which was not closed properly, is ignored.
+ */
+std::vector<RecordedDatagram> readDatagramLog(std::istream& is);
+
+/**
+ * @brief Reads the payload of all UDP datagrams of a pcap file, e.g. captured by tcpdump or Wireshark.
+ *
+ * Supports the link types Ethernet (also with VLAN tags), raw IP and Linux cooked capture (v1 and v2) with IPv4.
+ * Fragmented IP packets are reassembled, which is needed for monitoring frames larger than the MTU.
+ * Packets which are not UDP over IPv4 are skipped.
+ *
+ * @param udp_port If set, only datagrams sent from or to this port are read.
+ * @throws DatagramLogError if the file is no pcap file or uses an unsupported link type.
+ */
+std::vector<RecordedDatagram> readPcap(std::istream& is, const boost::optional<unsigned short>& udp_port = boost::none);
+
+/**
+ * @brief Reads the datagrams of a flight recording, from the oldest to the newest.
+ *
+ * A flight recording consists of a header of FLIGHT_RECORDING_HEADER_SIZE bytes and a ring of the given capacity.
+ * The header contains the magic "PSENFLRC", the format version as uint32, the capacity of the ring and the positions
+ * of the oldest record (tail) and after the newest record (head) as uint64. The positions count the bytes written
+ * since the creation, their remainder of the division by the capacity is the offset in the ring. Each record
+ * consists of the receive time in nanoseconds since the epoch as uint64, the length as uint32, 4 reserved bytes
+ * and the payload, padded to FLIGHT_RECORD_ALIGNMENT. A record may wrap around the end of the ring. All integers
+ * are little endian.
+ *
+ * @throws DatagramLogError if the header or a record is invalid.
+ * @see FlightRecorder
+ */
+std::vector<RecordedDatagram> readFlightRecording(std::istream& is);
+
+/**
+ * @brief Reads a pcap file, a raw datagram log or a flight recording, depending on its content.
+ *
+ * @param udp_port If set, only datagrams sent from or to this port are read from a pcap file. Has no effect on raw
+ * datagram logs and flight recordings, since they only contain the datagrams of one socket.
+ * @throws DatagramLogError if the file cannot be opened or has an unknown format.
+ */
+std::vector<RecordedDatagram> readRecording(const std::string& filename,
+                                            const boost::optional<unsigned short>& udp_port = boost::none);
+
+}  // namespace communication_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_DATAGRAM_LOG_H
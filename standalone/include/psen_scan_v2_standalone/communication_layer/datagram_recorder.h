@@ -0,0 +1,123 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_DATAGRAM_RECORDER_H
+#define PSEN_SCAN_V2_STANDALONE_DATAGRAM_RECORDER_H
+
+#ifdef __linux__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/communication_layer/udp_client.h"
+#include "psen_scan_v2_standalone/configuration/default_parameters.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+#include "psen_scan_v2_standalone/util/spsc_ring.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace communication_layer
+{
+/**
+ * @brief Records the datagrams received by a UdpClientImpl into a raw datagram log or a pcap file.
+ *
+ * The receive path only copies the datagram into a reused slot of a lock-free queue. A background thread
+ * batches the records and writes them to the file, bypassing the page cache (O_DIRECT) where the file system supports
+ * it. Therefore, the receive path never blocks on the disk. If the writer cannot keep up, datagrams are dropped and
+ * counted instead.
+ *
+ * The file is complete once the recorder is destroyed. Recordings can be played back with a ReplayScanner.
+ *
+ * @see UdpClientImpl::addDatagramTap()
+ * @see readRecording()
+ */
+class DatagramRecorder : public IDatagramTap
+{
+public:
+  //! @brief Default number of datagrams which can be queued, about 5 s of monitoring frames.
+  static constexpr std::size_t DEFAULT_QUEUE_CAPACITY{ 1024 };
+
+  /**
+   * @param filename File to write. A pcap file is written if the name ends with ".pcap", else a raw datagram log.
+   * @param endpoints Addresses written to the packet headers of a pcap file.
+   * @param queue_capacity Number of datagrams which can be queued for the writer thread.
+   * @param thread_settings Name, priority and cpu affinity of the writer thread.
+   *
+   * @throws std::runtime_error if the file cannot be opened.
+   */
+  DatagramRecorder(const std::string& filename,
+                   const UdpEndpoints& endpoints = UdpEndpoints(),
+                   const std::size_t& queue_capacity = DEFAULT_QUEUE_CAPACITY,
+                   const util::ThreadSettings& thread_settings = { configuration::RECORDER_THREAD_NAME });
+  //! @brief Writes all queued datagrams and closes the file.
+  ~DatagramRecorder() override;
+
+public:
+  //! @brief Queues the datagram for the writer thread. Never blocks. Must only be called by one thread.
+  void tap(const std::chrono::nanoseconds& receive_time, const char* data, const std::size_t& length) override;
+
+  //! @returns the number of datagrams passed to the writer thread. Can be called from any thread.
+  uint64_t numberOfRecordedDatagrams() const;
+  //! @returns the number of datagrams dropped because the queue was full or writing failed.
+  uint64_t numberOfDroppedDatagrams() const;
+
+private:
+  void writeLoop();
+  //! @brief Appends the oldest queued datagram to the batch.
+  void encode(const RecordedDatagram& datagram);
+  /**
+   * @brief Writes the batch to the file.
+   *
+   * @param all If false and the file is opened with O_DIRECT, only complete blocks are written and the rest is kept.
+   */
+  void writeBatch(const bool& all);
+
+private:
+  struct AlignedDeleter
+  {
+    void operator()(char* buffer) const;
+  };
+
+private:
+  const std::string filename_;
+  const bool pcap_;
+  const UdpEndpoints endpoints_;
+
+  int fd_{ -1 };
+  bool direct_io_{ false };
+  bool write_failed_{ false };
+
+  util::SpscRing<RecordedDatagram> queue_;
+  std::unique_ptr<char, AlignedDeleter> batch_;
+  std::size_t batch_size_{ 0 };
+
+  std::atomic<uint64_t> recorded_datagrams_{ 0 };
+  std::atomic<uint64_t> dropped_datagrams_{ 0 };
+
+  std::atomic_bool terminated_{ false };
+  std::thread writer_thread_;
+};
+
+}  // namespace communication_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // __linux__
+
+#endif  // PSEN_SCAN_V2_STANDALONE_DATAGRAM_RECORDER_H
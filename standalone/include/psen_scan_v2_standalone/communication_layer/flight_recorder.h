@@ -0,0 +1,158 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_FLIGHT_RECORDER_H
+#define PSEN_SCAN_V2_STANDALONE_FLIGHT_RECORDER_H
+
+#ifdef __linux__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/communication_layer/udp_client.h"
+#include "psen_scan_v2_standalone/configuration/default_parameters.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace communication_layer
+{
+/**
+ * @brief Keeps the most recent datagrams received by a UdpClientImpl in a memory-mapped file of fixed size.
+ *
+ * The file is a ring (see readFlightRecording()) which always contains the latest datagrams and is never written
+ * to disk by the recorder itself. Since the mapping is shared, the datagrams are kept in the page cache, so they
+ * survive a crash of the process and can be read afterwards like any other recording, e.g. by the
+ * psen_scan_v2_standalone_replay tool. While the process runs, a snapshot can be taken on demand or on a signal.
+ *
+ * The receive path only copies the datagram into the mapping and advances two positions in the header. The pages of
+ * the ring are touched on construction, so no page faults occur while recording.
+ *
+ * @see UdpClientImpl::addDatagramTap()
+ */
+class FlightRecorder : public IDatagramTap
+{
+public:
+  /**
+   * @param filename File to map. It is created or truncated.
+   * @param capacity Size of the ring in bytes. Rounded up to a multiple of FLIGHT_RECORD_ALIGNMENT.
+   *
+   * @throws std::runtime_error if the file cannot be created or mapped.
+   */
+  FlightRecorder(const std::string& filename, const std::size_t& capacity);
+  //! @brief Unmaps the file, which keeps the recorded datagrams.
+  ~FlightRecorder() override;
+
+  /**
+   * @returns the capacity of a ring holding the datagrams of the given duration.
+   *
+   * @param datagrams_per_second Maximal rate of the datagrams.
+   * @param bytes_per_second Maximal rate of the payload of the datagrams.
+   */
+  static std::size_t capacityFor(const std::chrono::seconds& duration,
+                                 const double& datagrams_per_second,
+                                 const double& bytes_per_second);
+
+public:
+  /**
+   * @brief Appends the datagram to the ring, overwriting the oldest ones. Never blocks.
+   *
+   * Must only be called by one thread. Datagrams larger than the ring are dropped.
+   */
+  void tap(const std::chrono::nanoseconds& receive_time, const char* data, const std::size_t& length) override;
+
+  /**
+   * @returns the datagrams in the ring, from the oldest to the newest.
+   *
+   * Does not lock the receive path. Can be called from any thread.
+   */
+  std::vector<RecordedDatagram> snapshot() const;
+  /**
+   * @brief Writes the datagrams in the ring to a raw datagram log.
+   *
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  void writeSnapshot(const std::string& filename) const;
+  /**
+   * @brief Writes a snapshot each time the process receives the given signal, e.g. SIGUSR1.
+   *
+   * The snapshots are written to "<snapshot_prefix>_<milliseconds since the epoch>.log" by a thread of the
+   * recorder, not by the signal handler. Can only be called once.
+   *
+   * @throws std::logic_error if the snapshots are already enabled.
+   */
+  void snapshotOnSignal(const int& signal_number,
+                        const std::string& snapshot_prefix,
+                        const util::ThreadSettings& thread_settings = { configuration::FLIGHT_RECORDER_THREAD_NAME });
+
+  //! @returns the capacity of the ring in bytes.
+  std::size_t capacity() const;
+  //! @returns the number of datagrams written to the ring. Can be called from any thread.
+  uint64_t numberOfRecordedDatagrams() const;
+  //! @returns the number of datagrams dropped because they are larger than the ring.
+  uint64_t numberOfDroppedDatagrams() const;
+
+private:
+  void copyToRing(const uint64_t& position, const char* data, const std::size_t& length);
+  void copyFromRing(const uint64_t& position, const std::size_t& length, char* destination) const;
+  //! @returns the size of the record at the given position, including its header and padding.
+  std::size_t recordSizeAt(const uint64_t& position) const;
+  void waitForSignal(const std::string& snapshot_prefix);
+
+private:
+  const std::string filename_;
+  const std::size_t capacity_;
+
+  int fd_{ -1 };
+  std::size_t mapping_size_{ 0 };
+  char* mapping_{ nullptr };
+  char* ring_{ nullptr };
+  //! @brief Positions in the header of the file. Only modified by the thread calling tap().
+  std::atomic<uint64_t>* tail_{ nullptr };
+  std::atomic<uint64_t>* head_{ nullptr };
+
+  std::atomic<uint64_t> recorded_datagrams_{ 0 };
+  std::atomic<uint64_t> dropped_datagrams_{ 0 };
+
+  //! @brief Only set if snapshots are taken on a signal.
+  std::unique_ptr<boost::asio::io_service> signal_service_;
+  std::unique_ptr<boost::asio::signal_set> signals_;
+  std::thread signal_thread_;
+};
+
+/**
+ * @brief Deserializes the monitoring frames of a recording, e.g. of a flight recorder.
+ *
+ * Datagrams which are no valid monitoring frames are skipped. To get LaserScans, play the recording back with a
+ * ReplayScanner instead.
+ */
+std::vector<data_conversion_layer::monitoring_frame::Message>
+decodeMonitoringFrames(const std::vector<RecordedDatagram>& datagrams);
+
+}  // namespace communication_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // __linux__
+
+#endif  // PSEN_SCAN_V2_STANDALONE_FLIGHT_RECORDER_H
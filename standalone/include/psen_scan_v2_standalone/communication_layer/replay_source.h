@@ -0,0 +1,112 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_REPLAY_SOURCE_H
+#define PSEN_SCAN_V2_STANDALONE_REPLAY_SOURCE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/communication_layer/udp_client.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace communication_layer
+{
+/**
+ * @brief Drop-in replacement of the UdpClientImpl, which plays back recorded datagrams instead of receiving them.
+ *
+ * The datagrams are passed to the data handler by a thread of their own, like the io_service thread of the
+ * UdpClientImpl calls it for received datagrams. Like a socket, the source only delivers datagrams while it is
+ * receiving, i.e. between startAsyncReceiving() and stopReceiving(). The playback itself is started with play().
+ * Written data are discarded, so a source without datagrams can stand in for the control client.
+ *
+ * @see readRecording()
+ */
+class ReplaySource : public IUdpClient
+{
+public:
+  //! @brief Speed at which the datagrams are passed on without waiting between them.
+  static constexpr double AS_FAST_AS_POSSIBLE{ 0. };
+
+  /**
+   * @param data_handler Handler called with each datagram.
+   * @param datagrams Datagrams to play back in the given order.
+   * @param speed Multiple of the recorded speed, e.g. 1 for real time or AS_FAST_AS_POSSIBLE.
+   * @param thread_settings Name, priority and cpu affinity of the playback thread.
+   *
+   * @throws std::invalid_argument if the speed is negative.
+   */
+  ReplaySource(const NewDataHandler& data_handler,
+               std::vector<RecordedDatagram> datagrams,
+               const double& speed = 1.,
+               const util::ThreadSettings& thread_settings = util::ThreadSettings());
+  //! @brief Stops the playback and waits for the playback thread.
+  ~ReplaySource() override;
+
+public:
+  void startAsyncReceiving(const ReceiveMode& modi = ReceiveMode::continuous) override;
+  //! @brief Discards the data.
+  void write(const data_conversion_layer::RawData& data) override;
+  void stopReceiving() override;
+  //! @returns the loopback address, since there is no socket.
+  boost::asio::ip::address_v4 getHostIp() override;
+  uint64_t numberOfReceivedDatagrams() const override;
+  uint64_t numberOfReceivedBytes() const override;
+  //! @returns 0, since there is no kernel which could drop datagrams.
+  uint64_t numberOfDroppedDatagrams() const override;
+
+  /**
+   * @brief Starts the playback.
+   *
+   * The timing of the datagrams is reproduced relative to the call of this function. Datagrams played back while
+   * the source is not receiving are dropped.
+   *
+   * @returns a future which becomes ready once all datagrams have been played back.
+   */
+  std::future<void> play();
+
+private:
+  void playBack();
+
+private:
+  const NewDataHandler data_handler_;
+  const std::vector<RecordedDatagram> datagrams_;
+  const double speed_;
+  const util::ThreadSettings thread_settings_;
+
+  std::atomic_bool receiving_{ false };
+  std::atomic_bool receive_single_datagram_{ false };
+  bool terminated_{ false };
+  std::mutex terminated_mutex_;
+  std::condition_variable terminated_cv_;
+
+  std::atomic<uint64_t> received_datagrams_{ 0 };
+  std::atomic<uint64_t> received_bytes_{ 0 };
+
+  std::promise<void> finished_;
+  std::thread playback_thread_;
+};
+
+}  // namespace communication_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_REPLAY_SOURCE_H
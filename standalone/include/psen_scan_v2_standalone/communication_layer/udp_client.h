@@ -15,7 +15,10 @@
 #ifndef PSEN_SCAN_V2_STANDALONE_UDP_CLIENT_H
 #define PSEN_SCAN_V2_STANDALONE_UDP_CLIENT_H
 
+#include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -23,9 +26,16 @@
 #include <string>
 #include <thread>
 #include <future>
+#include <vector>
 
 #ifdef __linux__
 #include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/sock_diag.h>
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
 #endif
 
 #ifdef _WIN32
@@ -36,7 +46,12 @@
 #include <boost/bind.hpp>
 
 #include "psen_scan_v2_standalone/data_conversion_layer/raw_scanner_data.h"
+#include "psen_scan_v2_standalone/util/allocation_tags.h"
 #include "psen_scan_v2_standalone/util/logging.h"
+#include "psen_scan_v2_standalone/util/probes.h"
+#include "psen_scan_v2_standalone/util/tracing.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+#include "psen_scan_v2_standalone/util/spsc_ring.h"
 
 namespace psen_scan_v2_standalone
 {
@@ -60,6 +75,111 @@ enum class ReceiveMode
   continuous
 };
 
+/**
+ * @returns the size of a receive buffer for datagrams of at most the given size.
+ *
+ * The buffer is a multiple of the cache line size and holds at least one byte more than the largest datagram, so a
+ * datagram which fills the whole buffer was truncated.
+ */
+inline std::size_t receiveBufferSize(const std::size_t& max_datagram_size)
+{
+  return (max_datagram_size + util::CACHE_LINE_SIZE) / util::CACHE_LINE_SIZE * util::CACHE_LINE_SIZE;
+}
+
+#ifdef __linux__
+//! @returns the number of datagrams dropped by the kernel for the given socket, or 0 if it does not report them.
+inline uint64_t socketDrops(const int& socket)
+{
+#ifdef SO_MEMINFO
+  uint32_t meminfo[SK_MEMINFO_VARS]{};
+  socklen_t size{ sizeof(meminfo) };
+  if (getsockopt(socket, SOL_SOCKET, SO_MEMINFO, meminfo, &size) == 0 && size > SK_MEMINFO_DROPS * sizeof(uint32_t))
+  {
+    return meminfo[SK_MEMINFO_DROPS];
+  }
+#endif
+  return 0;
+}
+
+/**
+ * @returns the kernel receive time of the datagram last received by the given socket as time since the epoch, or the
+ * current time if the kernel does not report it.
+ */
+inline std::chrono::nanoseconds socketReceiveTimestamp(const int& socket)
+{
+#ifdef SIOCGSTAMPNS
+  timespec receive_time{};
+  if (ioctl(socket, SIOCGSTAMPNS, &receive_time) == 0)
+  {
+    return std::chrono::seconds(receive_time.tv_sec) + std::chrono::nanoseconds(receive_time.tv_nsec);
+  }
+#endif
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch());
+}
+
+//! @brief Attaches the classic BPF program to the given socket. Errors are logged.
+inline bool setSocketFilter(const int& socket, std::vector<sock_filter>& program)
+{
+  sock_fprog filter{};
+  filter.len = static_cast<unsigned short>(program.size());
+  filter.filter = program.data();
+  if (setsockopt(socket, SOL_SOCKET, SO_ATTACH_FILTER, &filter, sizeof(filter)) != 0)
+  {
+    PSENSCAN_WARN("UdpClient", "Could not attach the socket filter: {}", std::strerror(errno));
+    return false;
+  }
+  return true;
+}
+#endif
+
+/**
+ * @brief Interface of the UDP clients used by the protocol_layer::ScannerProtocolDef.
+ *
+ * Implemented by UdpClientImpl for the communication with the scanner and by ReplaySource for the playback of
+ * recorded datagrams.
+ */
+class IUdpClient
+{
+public:
+  virtual ~IUdpClient() = default;
+
+public:
+  //! @brief Starts calling the data handler for new messages, see UdpClientImpl::startAsyncReceiving().
+  virtual void startAsyncReceiving(const ReceiveMode& modi = ReceiveMode::continuous) = 0;
+  //! @brief Asynchronously sends the specified data to the other endpoint.
+  virtual void write(const data_conversion_layer::RawData& data) = 0;
+  //! @brief Stops calling the data handler, see UdpClientImpl::stopReceiving().
+  virtual void stopReceiving() = 0;
+  //! @brief Returns local ip address of current socket connection.
+  virtual boost::asio::ip::address_v4 getHostIp() = 0;
+  //! @returns the number of datagrams received since the creation of the client. Can be called from any thread.
+  virtual uint64_t numberOfReceivedDatagrams() const = 0;
+  //! @returns the number of bytes received since the creation of the client. Can be called from any thread.
+  virtual uint64_t numberOfReceivedBytes() const = 0;
+  //! @returns the number of datagrams dropped before they reached the client. Can be called from any thread.
+  virtual uint64_t numberOfDroppedDatagrams() const = 0;
+};
+
+/**
+ * @brief Receives a copy of every datagram received by a UdpClientImpl, e.g. to record it.
+ *
+ * The tap is called by the io_service thread before the data handler, so it must not block.
+ *
+ * @see DatagramRecorder
+ */
+class IDatagramTap
+{
+public:
+  virtual ~IDatagramTap() = default;
+
+  /**
+   * @param receive_time Time since the epoch of the system clock at which the kernel received the datagram.
+   * @param data Payload of the datagram. Only valid during the call.
+   * @param length Length of the payload.
+   */
+  virtual void tap(const std::chrono::nanoseconds& receive_time, const char* data, const std::size_t& length) = 0;
+};
+
 /**
  * @brief Helper for asynchronously sending and receiving data via UDP.
  *
@@ -70,7 +190,7 @@ enum class ReceiveMode
  *
  * The ScannerV2 constructs two UDP clients, which are then used by the scanner_protocol::ScannerProtocolDef.
  */
-class UdpClientImpl
+class UdpClientImpl : public IUdpClient
 {
 public:
   /**
@@ -103,17 +223,46 @@ public:
    * @param host_port Port from which data are sent and received.
    * @param endpoint_ip IP address of the endpoint from which data are received and sent too.
    * @param endpoint_port Port on which the other endpoint is sending and receiving data.
+   * @param thread_settings Name, priority and cpu affinity of the io_service thread.
+   * @param max_datagram_size Size of the largest expected datagram, which determines the size of the receive buffer
+   * (see receiveBufferSize()). Larger datagrams are truncated and reported to the error handler.
    */
   UdpClientImpl(const NewDataHandler& data_handler,
                 const ErrorHandler& error_handler,
                 const unsigned short& host_port,
                 const unsigned int& endpoint_ip,
-                const unsigned short& endpoint_port);
+                const unsigned short& endpoint_port,
+                const util::ThreadSettings& thread_settings = util::ThreadSettings(),
+                const std::size_t& max_datagram_size = data_conversion_layer::MAX_UDP_PAKET_SIZE);
+
+  /**
+   * @brief Opens an UDP connection which is served by the specified io_service instead of an own io_service thread.
+   *
+   * This allows many clients to share a small number of threads.
+   *
+   * @note The io_service has to be run by exactly one thread and has to outlive the client. The client must not be
+   * closed from within the io_service thread.
+   *
+   * @param io_service io_service handling all socket operations and calling the handlers.
+   * @param data_handler Handler called whenever new data are received.
+   * @param error_handler Handler called whenever something wents wrong while receiving data.
+   * @param host_port Port from which data are sent and received.
+   * @param endpoint_ip IP address of the endpoint from which data are received and sent too.
+   * @param endpoint_port Port on which the other endpoint is sending and receiving data.
+   * @param max_datagram_size Size of the largest expected datagram, see the other constructor.
+   */
+  UdpClientImpl(boost::asio::io_service& io_service,
+                const NewDataHandler& data_handler,
+                const ErrorHandler& error_handler,
+                const unsigned short& host_port,
+                const unsigned int& endpoint_ip,
+                const unsigned short& endpoint_port,
+                const std::size_t& max_datagram_size = data_conversion_layer::MAX_UDP_PAKET_SIZE);
 
   /**
    * @brief Closes the UDP connection and stops all pending asynchronous operation.
    */
-  ~UdpClientImpl();
+  ~UdpClientImpl() override;
 
 public:
   /**
@@ -124,51 +273,158 @@ public:
    *
    * @param modi Specifies if the function continuously listens to new messages or or not.
    */
-  void startAsyncReceiving(const ReceiveMode& modi = ReceiveMode::continuous);
+  void startAsyncReceiving(const ReceiveMode& modi = ReceiveMode::continuous) override;
 
   /**
    * @brief Asynchronously sends the specified data to the other endpoint.
    *
    * @param data Data which have to be send to the other endpoint.
    */
-  void write(const data_conversion_layer::RawData& data);
+  void write(const data_conversion_layer::RawData& data) override;
 
   /**
    * @brief Closes the UDP connection and stops all pending asynchronous operation.
    */
   void close();
 
+  /**
+   * @brief Stops calling the data handler and the error handler without waiting for the io_service thread.
+   *
+   * In contrast to close(), this function can be called while holding a lock which the data handler acquires.
+   * The connection is closed on destruction.
+   *
+   * @note This is check-then-act: the receive handler checks the flag before it calls the data handler or the
+   * error handler. A handler which already passed the check delivers one more datagram (or error) after this
+   * function returned, typically as soon as the caller releases the lock mentioned above.
+   */
+  void stopReceiving() override;
+
   /**
    * @brief Returns local ip address of current socket connection.
    */
-  boost::asio::ip::address_v4 getHostIp();
+  boost::asio::ip::address_v4 getHostIp() override;
+
+  uint64_t numberOfReceivedDatagrams() const override;
+  uint64_t numberOfReceivedBytes() const override;
+  /**
+   * @returns the number of datagrams dropped by the kernel, i.e. rejected by the socket filter or dropped because the
+   * receive buffer of the socket was full. Always 0 if the kernel does not report them.
+   */
+  uint64_t numberOfDroppedDatagrams() const override;
+
+#ifdef __linux__
+  /**
+   * @brief Attaches a classic BPF program to the socket, so that the kernel drops unwanted datagrams before they wake
+   * up the io_service thread.
+   *
+   * @returns false if the program could not be attached. The client keeps receiving all datagrams in that case.
+   * @see data_conversion_layer::monitoring_frame::createSocketFilter()
+   */
+  bool attachSocketFilter(std::vector<sock_filter> program);
+#endif
+
+  /**
+   * @brief Passes every received datagram together with its kernel receive timestamp to the specified tap.
+   *
+   * Enables the timestamping of the socket, so the timestamps are not affected by the scheduling of the io_service
+   * thread. Multiple taps are called in the order they were added.
+   *
+   * @note Must not be called while receiving.
+   */
+  void addDatagramTap(std::shared_ptr<IDatagramTap> tap);
 
 private:
+  UdpClientImpl(std::unique_ptr<boost::asio::io_service> own_io_service,
+                boost::asio::io_service* shared_io_service,
+                const NewDataHandler& data_handler,
+                const ErrorHandler& error_handler,
+                const unsigned short& host_port,
+                const unsigned int& endpoint_ip,
+                const unsigned short& endpoint_port,
+                const std::size_t& max_datagram_size);
+
+  void closeSocketOnSharedIoService();
+
   void asyncReceive(const ReceiveMode& modi);
 
   void sendCompleteHandler(const boost::system::error_code& error, std::size_t bytes_transferred);
 
+  //! @returns the time at which the kernel received the last datagram, if available, else the current time.
+  std::chrono::nanoseconds receiveTimestamp();
+
 private:
-  boost::asio::io_service io_service_;
+  //! @brief Only set if the client runs its own io_service thread.
+  std::unique_ptr<boost::asio::io_service> own_io_service_;
+  boost::asio::io_service& io_service_;
   // Prevent the run() method of the io_service from returning when there is no more work.
-  boost::asio::io_service::work work_{ io_service_ };
+  std::unique_ptr<boost::asio::io_service::work> work_;
   std::thread io_service_thread_;
 
+  std::atomic_bool closing_{ false };
+
+  std::atomic<uint64_t> received_datagrams_{ 0 };
+  std::atomic<uint64_t> received_bytes_{ 0 };
+
   data_conversion_layer::RawData received_data_;
 
   NewDataHandler data_handler_;
   ErrorHandler error_handler_;
+  //! @brief Only filled if the received datagrams are tapped.
+  std::vector<std::shared_ptr<IDatagramTap>> taps_;
 
   boost::asio::ip::udp::socket socket_;
   boost::asio::ip::udp::endpoint endpoint_;
+#ifdef __linux__
+  //! @brief Native handle of the socket, which can be queried from any thread without accessing the socket object.
+  int socket_handle_{ -1 };
+#endif
 };
 
 inline communication_layer::UdpClientImpl::UdpClientImpl(const NewDataHandler& data_handler,
                                                          const ErrorHandler& error_handler,
                                                          const unsigned short& host_port,
                                                          const unsigned int& endpoint_ip,
-                                                         const unsigned short& endpoint_port)
-  : data_handler_(data_handler)
+                                                         const unsigned short& endpoint_port,
+                                                         const util::ThreadSettings& thread_settings,
+                                                         const std::size_t& max_datagram_size)
+  : UdpClientImpl(std::unique_ptr<boost::asio::io_service>(new boost::asio::io_service()),
+                  nullptr,
+                  data_handler,
+                  error_handler,
+                  host_port,
+                  endpoint_ip,
+                  endpoint_port,
+                  max_datagram_size)
+{
+  work_.reset(new boost::asio::io_service::work(io_service_));
+  assert(!io_service_thread_.joinable() && "io_service_thread_ is joinable!");
+  io_service_thread_ = std::thread([this]() { io_service_.run(); });
+  util::applyThreadSettings(io_service_thread_, thread_settings);
+}
+
+inline communication_layer::UdpClientImpl::UdpClientImpl(boost::asio::io_service& io_service,
+                                                         const NewDataHandler& data_handler,
+                                                         const ErrorHandler& error_handler,
+                                                         const unsigned short& host_port,
+                                                         const unsigned int& endpoint_ip,
+                                                         const unsigned short& endpoint_port,
+                                                         const std::size_t& max_datagram_size)
+  : UdpClientImpl(
+        nullptr, &io_service, data_handler, error_handler, host_port, endpoint_ip, endpoint_port, max_datagram_size)
+{
+}
+
+inline communication_layer::UdpClientImpl::UdpClientImpl(std::unique_ptr<boost::asio::io_service> own_io_service,
+                                                         boost::asio::io_service* shared_io_service,
+                                                         const NewDataHandler& data_handler,
+                                                         const ErrorHandler& error_handler,
+                                                         const unsigned short& host_port,
+                                                         const unsigned int& endpoint_ip,
+                                                         const unsigned short& endpoint_port,
+                                                         const std::size_t& max_datagram_size)
+  : own_io_service_(std::move(own_io_service))
+  , io_service_(own_io_service_ ? *own_io_service_ : *shared_io_service)
+  , data_handler_(data_handler)
   , error_handler_(error_handler)
   , socket_(io_service_, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), host_port))
   , endpoint_(boost::asio::ip::address_v4(endpoint_ip), endpoint_port)
@@ -183,10 +439,13 @@ inline communication_layer::UdpClientImpl::UdpClientImpl(const NewDataHandler& d
     throw std::invalid_argument("Error handler is invalid");
   }
 
-  received_data_.resize(psen_scan_v2_standalone::data_conversion_layer::MAX_UDP_PAKET_SIZE);
+  received_data_.resize(receiveBufferSize(max_datagram_size));
   try
   {
     socket_.connect(endpoint_);
+#ifdef __linux__
+    socket_handle_ = socket_.native_handle();
+#endif
   }
   // LCOV_EXCL_START
   // No coverage check because testing the socket is not the objective here.
@@ -195,13 +454,17 @@ inline communication_layer::UdpClientImpl::UdpClientImpl(const NewDataHandler& d
     throw OpenConnectionFailure(ex.what());
   }
   // LCOV_EXCL_STOP
-
-  assert(!io_service_thread_.joinable() && "io_service_thread_ is joinable!");
-  io_service_thread_ = std::thread([this]() { io_service_.run(); });
 }
 
 inline void UdpClientImpl::close()
 {
+  closing_ = true;
+  if (!own_io_service_)
+  {
+    closeSocketOnSharedIoService();
+    return;
+  }
+
   io_service_.stop();
   if (io_service_thread_.joinable())
   {
@@ -225,6 +488,34 @@ inline void UdpClientImpl::close()
   // LCOV_EXCL_STOP
 }
 
+inline void UdpClientImpl::stopReceiving()
+{
+  closing_ = true;
+}
+
+inline void UdpClientImpl::closeSocketOnSharedIoService()
+{
+  // The shared io_service cannot be stopped. Instead, the socket is closed on the io_service thread and it is
+  // waited until the handlers of all aborted operations have been called, so that none of them refers to this
+  // client after its destruction.
+  boost::system::error_code error_code;
+  std::promise<void> handlers_done_barrier;
+  const auto handlers_done_future{ handlers_done_barrier.get_future() };
+  io_service_.post([this, &error_code, &handlers_done_barrier]() {
+    socket_.close(error_code);
+    // The handlers of the aborted operations are already queued. Therefore, the following task is executed last.
+    io_service_.post([&handlers_done_barrier]() { handlers_done_barrier.set_value(); });
+  });
+  handlers_done_future.wait();
+
+  // LCOV_EXCL_START
+  if (error_code)
+  {
+    throw CloseConnectionFailure(error_code.message());
+  }
+  // LCOV_EXCL_STOP
+}
+
 inline boost::asio::ip::address_v4 UdpClientImpl::getHostIp()
 {
   return socket_.local_endpoint().address().to_v4();
@@ -287,12 +578,37 @@ inline void UdpClientImpl::asyncReceive(const ReceiveMode& modi)
 {
   socket_.async_receive(boost::asio::buffer(received_data_, received_data_.size()),
                         [this, modi](const boost::system::error_code& error_code, const std::size_t& bytes_received) {
+                          const util::AllocationTagScope allocation_tag(util::AllocationTag::udp);
+                          if (closing_)
+                          {
+                            return;
+                          }
                           if (error_code || bytes_received == 0)
                           {
                             error_handler_(error_code.message());
                           }
+                          else if (bytes_received >= received_data_.size())
+                          {
+                            PSENSCAN_WARN_THROTTLE(1 /* sec */,
+                                                   "UdpClient",
+                                                   "Dropped a datagram exceeding the receive buffer of {} bytes.",
+                                                   received_data_.size());
+                            error_handler_("Datagram truncated");
+                          }
                           else
                           {
+                            PSENSCAN_TRACE_SPAN("receive");
+                            PSENSCAN_PROBE2(frame_received, bytes_received, endpoint_.port());
+                            received_datagrams_.fetch_add(1, std::memory_order_relaxed);
+                            received_bytes_.fetch_add(bytes_received, std::memory_order_relaxed);
+                            if (!taps_.empty())
+                            {
+                              const auto receive_time{ receiveTimestamp() };
+                              for (const auto& tap : taps_)
+                              {
+                                tap->tap(receive_time, received_data_.data(), bytes_received);
+                              }
+                            }
                             data_handler_(received_data_, bytes_received);
                           }
                           if (modi == ReceiveMode::continuous)
@@ -302,6 +618,53 @@ inline void UdpClientImpl::asyncReceive(const ReceiveMode& modi)
                         });
 }
 
+inline uint64_t UdpClientImpl::numberOfReceivedDatagrams() const
+{
+  return received_datagrams_.load(std::memory_order_relaxed);
+}
+
+inline uint64_t UdpClientImpl::numberOfReceivedBytes() const
+{
+  return received_bytes_.load(std::memory_order_relaxed);
+}
+
+inline uint64_t UdpClientImpl::numberOfDroppedDatagrams() const
+{
+#ifdef __linux__
+  return socketDrops(socket_handle_);
+#else
+  return 0;
+#endif
+}
+
+#ifdef __linux__
+inline bool UdpClientImpl::attachSocketFilter(std::vector<sock_filter> program)
+{
+  return setSocketFilter(socket_.native_handle(), program);
+}
+#endif
+
+inline void UdpClientImpl::addDatagramTap(std::shared_ptr<IDatagramTap> tap)
+{
+#if defined(__linux__) && defined(SO_TIMESTAMPNS)
+  const int enable{ 1 };
+  if (setsockopt(socket_.native_handle(), SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) != 0)
+  {
+    PSENSCAN_WARN("UdpClient", "Could not enable the receive timestamps of the socket: {}", std::strerror(errno));
+  }
+#endif
+  taps_.push_back(std::move(tap));
+}
+
+inline std::chrono::nanoseconds UdpClientImpl::receiveTimestamp()
+{
+#ifdef __linux__
+  return socketReceiveTimestamp(socket_.native_handle());
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch());
+#endif
+}
+
 inline UdpClientImpl::OpenConnectionFailure::OpenConnectionFailure(const std::string& msg) : std::runtime_error(msg)
 {
 }
@@ -0,0 +1,198 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_URING_UDP_CLIENT_H
+#define PSEN_SCAN_V2_STANDALONE_URING_UDP_CLIENT_H
+
+#ifdef PSENSCAN_ENABLE_IO_URING
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <linux/filter.h>
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+
+#include "psen_scan_v2_standalone/communication_layer/udp_client.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/raw_scanner_data.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace communication_layer
+{
+/**
+ * @brief Alternative to the UdpClientImpl, which receives the datagrams via io_uring instead of Boost.Asio.
+ *
+ * A single multishot receive stays armed while receiving. The kernel picks a buffer of a pool (provided buffer ring)
+ * for each datagram and writes the datagram directly into it, so that no system call is needed per datagram. A
+ * thread of its own waits for the completions, calls the data handler with the buffer and returns the buffer to the
+ * pool afterwards. The socket is registered with the ring, which saves the lookup of the file per datagram.
+ *
+ * The data handler is called with the same contract as by the UdpClientImpl. Requires Linux 6.0 or newer.
+ *
+ * @note Only built if the driver is compiled with ENABLE_IO_URING.
+ * @see ScannerConfigurationBuilder::enableIoUring()
+ */
+class UringUdpClient : public IUdpClient
+{
+public:
+  //! @brief Default number of datagrams which the kernel can write before the io thread handles them.
+  static constexpr std::size_t DEFAULT_NUMBER_OF_BUFFERS{ 16 };
+
+  /**
+   * @param data_handler Handler called whenever new data are received.
+   * @param error_handler Handler called whenever something wents wrong while receiving data.
+   * @param host_port Port from which data are sent and received.
+   * @param endpoint_ip IP address of the endpoint from which data are received and sent too.
+   * @param endpoint_port Port on which the other endpoint is sending and receiving data.
+   * @param thread_settings Name, priority and cpu affinity of the io thread.
+   * @param number_of_buffers Size of the pool of receive buffers. It is rounded up to the next power of two.
+   * @param max_datagram_size Size of the largest expected datagram, which determines the size of each buffer of the
+   * pool (see receiveBufferSize()). Larger datagrams are truncated and reported to the error handler.
+   *
+   * @throws UdpClientImpl::OpenConnectionFailure if the socket or the ring cannot be set up, e.g. because the kernel
+   * is too old.
+   */
+  UringUdpClient(const NewDataHandler& data_handler,
+                 const ErrorHandler& error_handler,
+                 const unsigned short& host_port,
+                 const unsigned int& endpoint_ip,
+                 const unsigned short& endpoint_port,
+                 const util::ThreadSettings& thread_settings = util::ThreadSettings(),
+                 const std::size_t& number_of_buffers = DEFAULT_NUMBER_OF_BUFFERS,
+                 const std::size_t& max_datagram_size = data_conversion_layer::MAX_UDP_PAKET_SIZE);
+  //! @brief Stops the io thread and closes the socket and the ring.
+  ~UringUdpClient() override;
+
+public:
+  void startAsyncReceiving(const ReceiveMode& modi = ReceiveMode::continuous) override;
+  //! @brief Sends the data without blocking. Errors are logged.
+  void write(const data_conversion_layer::RawData& data) override;
+  void stopReceiving() override;
+  boost::asio::ip::address_v4 getHostIp() override;
+  uint64_t numberOfReceivedDatagrams() const override;
+  uint64_t numberOfReceivedBytes() const override;
+  //! @see UdpClientImpl::numberOfDroppedDatagrams()
+  uint64_t numberOfDroppedDatagrams() const override;
+
+  //! @see UdpClientImpl::attachSocketFilter()
+  bool attachSocketFilter(std::vector<sock_filter> program);
+  /**
+   * @brief Passes every received datagram together with its kernel receive timestamp to the specified tap, see
+   * UdpClientImpl::addDatagramTap().
+   *
+   * Enables the timestamping of the socket. While receiving continuously the datagrams are received by a multishot
+   * recvmsg then, which delivers the timestamp of each datagram as control message. The datagram is moved to the
+   * front of its buffer afterwards, so that the data handler is called as without taps.
+   *
+   * @note Must not be called while receiving.
+   */
+  void addDatagramTap(std::shared_ptr<IDatagramTap> tap);
+
+private:
+  //! @brief Memory of the submission and completion queues shared with the kernel.
+  struct Rings
+  {
+    void* sq_ring{ nullptr };
+    std::size_t sq_ring_size{ 0 };
+    void* cq_ring{ nullptr };
+    std::size_t cq_ring_size{ 0 };
+    io_uring_sqe* sqes{ nullptr };
+    std::size_t sqes_size{ 0 };
+
+    unsigned* sq_tail{ nullptr };
+    unsigned* sq_mask{ nullptr };
+    unsigned* sq_array{ nullptr };
+    unsigned* cq_head{ nullptr };
+    unsigned* cq_tail{ nullptr };
+    unsigned* cq_mask{ nullptr };
+    io_uring_cqe* cqes{ nullptr };
+  };
+
+  void setUpRing();
+  void setUpBufferRing(const std::size_t& number_of_buffers, const std::size_t& buffer_size);
+  void closeAll();
+
+  //! @brief Queues the submission, which is prepared by the given function, and submits it to the kernel.
+  template <typename Preparation>
+  void submit(const Preparation& prepare);
+  //! @brief Arms the receive of the given mode, if it is not armed yet. Requires the submission mutex.
+  void armReceive(const ReceiveMode& modi);
+  //! @brief Makes the buffer available to the kernel again. Only called by the io thread.
+  void recycleBuffer(const uint16_t& buffer_id);
+  //! @returns the number of bytes of a buffer, which the kernel may write to.
+  std::size_t receiveLength(const uint16_t& buffer_id) const;
+  /**
+   * @brief Moves the datagram, which a multishot recvmsg wrote behind its header and control messages, to the front
+   * of the buffer.
+   *
+   * @param receive_time Set to the kernel receive timestamp of the datagram, or the current time if it is missing.
+   * @returns the length of the datagram, which is at least the payload capacity if the datagram was truncated.
+   */
+  std::size_t unpackMessage(const uint16_t& buffer_id, std::chrono::nanoseconds& receive_time);
+
+  void completionLoop();
+  //! @returns false if the io thread has to terminate.
+  bool handleCompletion(const io_uring_cqe& cqe);
+
+private:
+  NewDataHandler data_handler_;
+  ErrorHandler error_handler_;
+  std::vector<std::shared_ptr<IDatagramTap>> taps_;
+  //! @brief Set if the datagrams are tapped, which requires their kernel receive timestamps.
+  bool receive_timestamps_{ false };
+  //! @brief Template of the multishot recvmsg, only its lengths of the name and the control messages are used.
+  msghdr receive_message_{};
+
+  int socket_{ -1 };
+  int ring_fd_{ -1 };
+  Rings rings_;
+
+  //! @brief Receive buffers, whose data the kernel writes to. Indexed by the buffer id.
+  std::vector<data_conversion_layer::RawData> buffers_;
+  //! @brief Room for the datagram in each buffer, a datagram filling it was truncated (see receiveBufferSize()).
+  std::size_t payload_capacity_{ 0 };
+  //! @brief Ring of the buffers available to the kernel, shared with the kernel.
+  io_uring_buf* buffer_ring_{ nullptr };
+  std::size_t buffer_ring_size_{ 0 };
+  uint16_t buffer_ring_mask_{ 0 };
+  uint16_t buffer_ring_tail_{ 0 };
+
+  //! @brief Serializes the submissions, which happen from the calling threads and the io thread.
+  std::mutex submission_mutex_;
+  bool receive_armed_{ false };
+  //! @brief user_data of the armed receive, which tells a recv and a recvmsg apart.
+  uint64_t receive_user_data_{ 0 };
+  ReceiveMode receive_mode_{ ReceiveMode::continuous };
+
+  std::atomic_bool closing_{ false };
+  std::atomic<uint64_t> received_datagrams_{ 0 };
+  std::atomic<uint64_t> received_bytes_{ 0 };
+
+  std::thread io_thread_;
+};
+
+}  // namespace communication_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSENSCAN_ENABLE_IO_URING
+
+#endif  // PSEN_SCAN_V2_STANDALONE_URING_UDP_CLIENT_H
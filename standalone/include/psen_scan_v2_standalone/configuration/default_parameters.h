@@ -16,6 +16,9 @@
 #ifndef PSEN_SCAN_V2_STANDALONE_DEFAULT_PARAMETERS_H
 #define PSEN_SCAN_V2_STANDALONE_DEFAULT_PARAMETERS_H
 
+#include <chrono>
+#include <string>
+
 #include "psen_scan_v2_standalone/data_conversion_layer/angle_conversions.h"
 
 namespace psen_scan_v2_standalone
@@ -36,6 +39,21 @@ static constexpr bool DIAGNOSTICS{ false };
 
 static constexpr int16_t SCAN_ANGLE_RESOLUTION{ 1 };
 
+static const std::string IO_THREAD_NAME{ "psen_io" };
+static const std::string WATCHDOG_THREAD_NAME{ "psen_watchdog" };
+static const std::string DISPATCHER_THREAD_NAME{ "psen_dispatch" };
+static const std::string RECORDER_THREAD_NAME{ "psen_record" };
+static const std::string FLIGHT_RECORDER_THREAD_NAME{ "psen_flight" };
+static const std::string CAPTURE_CONVERTER_THREAD_NAME{ "psen_convert" };
+static const std::string RELAY_THREAD_NAME{ "psen_relay" };
+static const std::string RELAY_RECEIVER_THREAD_NAME{ "psen_relay_rx" };
+static constexpr bool MEMORY_LOCKING{ false };
+static constexpr bool PIPELINED_PROCESSING{ false };
+static constexpr bool PERF_COUNTERS{ false };
+static constexpr bool FAST_START{ false };
+static constexpr bool IO_URING{ false };
+static constexpr std::chrono::seconds FLIGHT_RECORDER_DURATION{ 30 };
+
 //! @brief Start angle of measurement.
 static constexpr double DEFAULT_ANGLE_START(-data_conversion_layer::degreeToRadian(137.5));
 //! @brief  End angle of measurement.
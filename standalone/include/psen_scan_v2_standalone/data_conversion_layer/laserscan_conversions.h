@@ -94,6 +94,7 @@ LaserScanConverter::toLaserScan(const std::vector<data_conversion_layer::monitor
   LaserScan scan(frames[0].resolution(), min_angle, max_angle);
   scan.setMeasurements(measurements);
   scan.setIntensities(intensities);
+  scan.setScanCounter(frames[0].scanCounter());
 
   return scan;
 }
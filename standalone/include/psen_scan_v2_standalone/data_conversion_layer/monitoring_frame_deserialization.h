@@ -15,6 +15,7 @@
 #ifndef PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_DESERIALIZATION_H
 #define PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_DESERIALIZATION_H
 
+#include <cstddef>
 #include <ostream>
 
 #include "psen_scan_v2_standalone/data_conversion_layer/raw_scanner_data.h"
@@ -50,6 +51,28 @@ static constexpr uint32_t GUI_MONITORING_TRANSACTION{ 0x05 };
 static constexpr uint16_t NUMBER_OF_BYTES_SCAN_COUNTER{ 4 };
 static constexpr uint16_t NUMBER_OF_BYTES_SINGLE_MEASUREMENT{ 2 };
 static constexpr uint16_t NUMBER_OF_BYTES_SINGLE_INTENSITY{ 2 };
+static constexpr std::size_t NUMBER_OF_BYTES_FIXED_FIELDS{ 21 };
+static constexpr std::size_t NUMBER_OF_BYTES_ADDITIONAL_FIELD_HEADER{ 3 };
+//! @brief The id of the end of frame field is followed by three unused bytes.
+static constexpr std::size_t NUMBER_OF_BYTES_END_OF_FRAME{ 4 };
+
+/**
+ * @returns the size of a monitoring frame containing the given number of measurements, i.e. the size of the largest
+ * frame if it is the number of measurements of a whole scan round.
+ *
+ * @param intensities True if the frame contains an intensity per measurement.
+ * @param diagnostics True if the frame contains the diagnostic data.
+ */
+inline std::size_t maxSize(const std::size_t& number_of_measurements, const bool& intensities, const bool& diagnostics)
+{
+  return NUMBER_OF_BYTES_FIXED_FIELDS + NUMBER_OF_BYTES_ADDITIONAL_FIELD_HEADER + NUMBER_OF_BYTES_SCAN_COUNTER +
+         (diagnostics ? NUMBER_OF_BYTES_ADDITIONAL_FIELD_HEADER + diagnostic::RAW_CHUNK_LENGTH_IN_BYTES : 0u) +
+         NUMBER_OF_BYTES_ADDITIONAL_FIELD_HEADER + number_of_measurements * NUMBER_OF_BYTES_SINGLE_MEASUREMENT +
+         (intensities ? NUMBER_OF_BYTES_ADDITIONAL_FIELD_HEADER +
+                            number_of_measurements * NUMBER_OF_BYTES_SINGLE_INTENSITY :
+                        0u) +
+         NUMBER_OF_BYTES_END_OF_FRAME;
+}
 
 /**
  * @brief The information included in every single monitoring frame.
@@ -0,0 +1,78 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_FILTER_H
+#define PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_FILTER_H
+
+#ifdef __linux__
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <linux/filter.h>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace data_conversion_layer
+{
+namespace monitoring_frame
+{
+//! @brief A socket filter sees the UDP header in front of the payload.
+static constexpr uint32_t SOCKET_FILTER_UDP_HEADER_SIZE{ 8 };
+
+//! @returns the value of a little endian uint32 as loaded by a (big endian) BPF instruction.
+inline constexpr uint32_t toBpfByteOrder(const uint32_t& value)
+{
+  return ((value & 0xFFu) << 24) | ((value & 0xFF00u) << 8) | ((value >> 8) & 0xFF00u) | (value >> 24);
+}
+
+/**
+ * @brief Creates a classic BPF program which accepts only datagrams starting with the fixed fields of a monitoring
+ * frame, i.e. with OP_CODE_MONITORING_FRAME, ONLINE_WORKING_MODE and GUI_MONITORING_TRANSACTION.
+ *
+ * Attached to the data socket, all other datagrams (including ones which are too short) are dropped by the kernel
+ * instead of waking up the io_service thread.
+ *
+ * @see communication_layer::UdpClientImpl::attachSocketFilter()
+ */
+inline std::vector<sock_filter> createSocketFilter()
+{
+  static constexpr uint32_t OP_CODE_OFFSET{ SOCKET_FILTER_UDP_HEADER_SIZE + sizeof(FixedFields::DeviceStatus) };
+  static constexpr uint32_t WORKING_MODE_OFFSET{ OP_CODE_OFFSET + sizeof(FixedFields::OpCode) };
+  static constexpr uint32_t TRANSACTION_TYPE_OFFSET{ WORKING_MODE_OFFSET + sizeof(FixedFields::WorkingMode) };
+  static constexpr uint32_t ACCEPT{ std::numeric_limits<uint32_t>::max() };
+  static constexpr uint32_t DROP{ 0 };
+
+  // Each comparison jumps to the last instruction (DROP) on a mismatch. Loads beyond the end of the datagram drop it.
+  return { BPF_STMT(BPF_LD | BPF_W | BPF_ABS, OP_CODE_OFFSET),
+           BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, toBpfByteOrder(OP_CODE_MONITORING_FRAME), 0, 5),
+           BPF_STMT(BPF_LD | BPF_W | BPF_ABS, WORKING_MODE_OFFSET),
+           BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, toBpfByteOrder(ONLINE_WORKING_MODE), 0, 3),
+           BPF_STMT(BPF_LD | BPF_W | BPF_ABS, TRANSACTION_TYPE_OFFSET),
+           BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, toBpfByteOrder(GUI_MONITORING_TRANSACTION), 0, 1),
+           BPF_STMT(BPF_RET | BPF_K, ACCEPT),
+           BPF_STMT(BPF_RET | BPF_K, DROP) };
+}
+
+}  // namespace monitoring_frame
+}  // namespace data_conversion_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // __linux__
+
+#endif  // PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_FILTER_H
@@ -12,8 +12,8 @@
 //
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
-#ifndef PSEN_SCAN_V2_MONITORING_FRAME_SERIALIZATION_H
-#define PSEN_SCAN_V2_MONITORING_FRAME_SERIALIZATION_H
+#ifndef PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_SERIALIZATION_H
+#define PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_SERIALIZATION_H
 
 #include "psen_scan_v2_standalone/data_conversion_layer/diagnostics.h"
 #include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
@@ -26,6 +26,11 @@ namespace data_conversion_layer
 {
 namespace monitoring_frame
 {
+/**
+ * @brief Serializes a monitoring frame the way the scanner sends it.
+ *
+ * Inverse of deserialize(). Used by the simulator (see simulation::ScannerSimulator) and the tests.
+ */
 RawData serialize(const data_conversion_layer::monitoring_frame::Message& frame);
 namespace diagnostic
 {
@@ -36,4 +41,4 @@ void write(std::ostringstream& os, const data_conversion_layer::monitoring_frame
 }  // namespace data_conversion_layer
 }  // namespace psen_scan_v2_standalone
 
-#endif  // PSEN_SCAN_V2_MONITORING_FRAME_SERIALIZATION_H
+#endif  // PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_SERIALIZATION_H
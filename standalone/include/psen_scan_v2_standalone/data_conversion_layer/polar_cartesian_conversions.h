@@ -0,0 +1,119 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_POLAR_CARTESIAN_CONVERSIONS_H
+#define PSEN_SCAN_V2_STANDALONE_POLAR_CARTESIAN_CONVERSIONS_H
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace psen_scan_v2_standalone
+{
+namespace data_conversion_layer
+{
+/**
+ * @brief Computes the cosines and sines of the angles first_angle + i * increment for i in [0, number_of_angles).
+ *
+ * The results only depend on the geometry of a scan, so they can be computed once and reused for all scans with the
+ * same geometry.
+ */
+inline void computeCosinesAndSines(const double& first_angle,
+                                   const double& increment,
+                                   const std::size_t& number_of_angles,
+                                   std::vector<double>& cosines,
+                                   std::vector<double>& sines)
+{
+  cosines.resize(number_of_angles);
+  sines.resize(number_of_angles);
+  for (std::size_t i = 0; i < number_of_angles; ++i)
+  {
+    const double angle{ first_angle + static_cast<double>(i) * increment };
+    cosines[i] = std::cos(angle);
+    sines[i] = std::sin(angle);
+  }
+}
+
+/**
+ * @brief Converts the polar coordinates (ranges[i], angle[i]) to cartesian coordinates and moves them by the offset.
+ *
+ * The angles are passed as precomputed cosines and sines (see computeCosinesAndSines()). The loops work on plain
+ * arrays without branches, so that the compiler can vectorize them.
+ */
+inline void polarToCartesian(const std::vector<double>& ranges,
+                             const std::vector<double>& cosines,
+                             const std::vector<double>& sines,
+                             const double& offset_x,
+                             const double& offset_y,
+                             std::vector<double>& x,
+                             std::vector<double>& y)
+{
+  if (cosines.size() < ranges.size() || sines.size() < ranges.size())
+  {
+    throw std::invalid_argument("Number of cosines and sines does not fit to the number of ranges");
+  }
+
+  const std::size_t size{ ranges.size() };
+  x.resize(size);
+  y.resize(size);
+  const double* const r_data{ ranges.data() };
+  const double* const cos_data{ cosines.data() };
+  const double* const sin_data{ sines.data() };
+  double* const x_data{ x.data() };
+  double* const y_data{ y.data() };
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    x_data[i] = offset_x + r_data[i] * cos_data[i];
+  }
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    y_data[i] = offset_y + r_data[i] * sin_data[i];
+  }
+}
+
+/**
+ * @brief Converts cartesian coordinates to polar coordinates. The angles are in the range [-pi, pi].
+ */
+inline void cartesianToPolar(const std::vector<double>& x,
+                             const std::vector<double>& y,
+                             std::vector<double>& angles,
+                             std::vector<double>& ranges)
+{
+  if (x.size() != y.size())
+  {
+    throw std::invalid_argument("Number of x and y coordinates differs");
+  }
+
+  const std::size_t size{ x.size() };
+  angles.resize(size);
+  ranges.resize(size);
+  const double* const x_data{ x.data() };
+  const double* const y_data{ y.data() };
+  double* const r_data{ ranges.data() };
+  double* const angle_data{ angles.data() };
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    r_data[i] = std::sqrt(x_data[i] * x_data[i] + y_data[i] * y_data[i]);
+  }
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    angle_data[i] = std::atan2(y_data[i], x_data[i]);
+  }
+}
+
+}  // namespace data_conversion_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_POLAR_CARTESIAN_CONVERSIONS_H
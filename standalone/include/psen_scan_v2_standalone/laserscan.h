@@ -33,6 +33,7 @@ namespace psen_scan_v2_standalone
  * - Normalized intensities of the signals.
  * - Resolution of the scan in radians.
  * - Min and Max angle in radians.
+ * - Scan counter of the scan round.
  *
  * The measures use the target frame defined as \<prefix\>_scan.
  * @see https://github.com/PilzDE/psen_scan_v2_standalone/blob/main/README.md#tf-frames
@@ -60,6 +61,9 @@ public:
   const IntensityData& getIntensities() const;
   void setIntensities(const IntensityData&);
 
+  uint32_t getScanCounter() const;
+  void setScanCounter(const uint32_t& scan_counter);
+
   bool operator==(const LaserScan& scan) const;
 
 private:
@@ -73,6 +77,8 @@ private:
   const util::TenthOfDegree min_scan_angle_;
   //! Highest angle the scanner is scanning (in radian).
   const util::TenthOfDegree max_scan_angle_;
+  //! Number of the scan round in which the measurements were taken.
+  uint32_t scan_counter_{ 0 };
 };
 
 }  // namespace psen_scan_v2_standalone
@@ -0,0 +1,72 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_LATENCY_HISTOGRAMS_H
+#define PSEN_SCAN_V2_STANDALONE_LATENCY_HISTOGRAMS_H
+
+#include "psen_scan_v2_standalone/util/latency_histogram.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace protocol_layer
+{
+/**
+ * @brief Snapshot of the latencies of the stages between the receiving of a monitoring frame and the laser scan
+ * callback.
+ */
+struct LatencyStatistics
+{
+  //! Deserialization of the received datagram into a monitoring frame.
+  util::LatencySnapshot deserialization;
+  //! Adding the monitoring frame to the scan buffer.
+  util::LatencySnapshot scan_buffer;
+  //! Conversion of the monitoring frame(s) into the laser scan.
+  util::LatencySnapshot conversion;
+  //! Call of the laser scan callback, i.e. entry till exit (or posting if a callback executor is configured).
+  util::LatencySnapshot callback;
+  //! Receiving of the (last) monitoring frame of the laser scan till the entry into the laser scan callback.
+  util::LatencySnapshot receive_to_callback;
+};
+
+/**
+ * @brief Histograms recording the latencies of the processing stages of one scanner.
+ *
+ * @see LatencyStatistics
+ */
+struct LatencyHistograms
+{
+  util::LatencyHistogram deserialization;
+  util::LatencyHistogram scan_buffer;
+  util::LatencyHistogram conversion;
+  util::LatencyHistogram callback;
+  util::LatencyHistogram receive_to_callback;
+
+  LatencyStatistics snapshot() const;
+};
+
+inline LatencyStatistics LatencyHistograms::snapshot() const
+{
+  LatencyStatistics statistics;
+  statistics.deserialization = deserialization.snapshot();
+  statistics.scan_buffer = scan_buffer.snapshot();
+  statistics.conversion = conversion.snapshot();
+  statistics.callback = callback.snapshot();
+  statistics.receive_to_callback = receive_to_callback.snapshot();
+  return statistics;
+}
+
+}  // namespace protocol_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_LATENCY_HISTOGRAMS_H
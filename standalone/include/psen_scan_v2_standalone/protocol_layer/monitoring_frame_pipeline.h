@@ -0,0 +1,239 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_PIPELINE_H
+#define PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_PIPELINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/raw_scanner_data.h"
+#include "psen_scan_v2_standalone/util/allocation_tags.h"
+#include "psen_scan_v2_standalone/util/latency_histogram.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+#include "psen_scan_v2_standalone/util/perf_counters.h"
+#include "psen_scan_v2_standalone/util/pipeline_stage.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+#include "psen_scan_v2_standalone/util/tracing.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace protocol_layer
+{
+//! @brief Number of elements each stage of the pipeline can buffer (about 10 scan rounds).
+static constexpr std::size_t PIPELINE_QUEUE_CAPACITY{ 64 };
+
+/**
+ * @brief Metrics of the stages of the MonitoringFramePipeline.
+ */
+struct PipelineStatistics
+{
+  //! Received datagrams waiting for the deserialization.
+  util::StageStatistics decode;
+  //! Deserialized monitoring frames waiting for the scan assembly.
+  util::StageStatistics assembly;
+  //! Datagrams which could not be deserialized by the decode stage.
+  uint64_t decode_errors{ 0 };
+};
+
+/**
+ * @brief Processes received monitoring frames in two stages apart from the thread receiving the datagrams.
+ *
+ * - The receiving thread only copies the datagram into the queue of the decode stage (see push()).
+ * - The decode stage deserializes the datagram and passes the monitoring frame to the assembly stage.
+ * - The assembly stage calls the frame handler, which assembles the scan and informs the user.
+ *
+ * Datagrams which cannot be deserialized are passed to the assembly stage as well, which calls the error handler with
+ * the exception of the deserialization. This way they are handled in order with the monitoring frames. If one of the
+ * handlers throws, the assembly stage stops (see util::PipelineStage).
+ *
+ * The queues are lock-free single-producer single-consumer rings, so the receiving thread never waits for the
+ * processing of the data. If a stage cannot keep up, the data are dropped and counted in the statistics.
+ *
+ * @see util::PipelineStage
+ */
+class MonitoringFramePipeline
+{
+public:
+  using FrameHandler = std::function<void(const data_conversion_layer::monitoring_frame::Message&,
+                                          const util::LatencyClock::time_point& receive_time)>;
+  using DecodingErrorHandler = std::function<void(const std::exception_ptr& exception)>;
+
+public:
+  /**
+   * @param frame_handler Called in the thread of the assembly stage for each monitoring frame.
+   * @param decoding_error_handler Called in the thread of the assembly stage for each datagram which could not be
+   * deserialized.
+   * @param thread_settings Settings of the stage threads. The suffixes "_dec" and "_asm" are appended to the name.
+   * @param deserialization_histogram Records the duration of the deserialization. Must outlive the pipeline.
+   * @param deserialization_perf_counters Records the hardware counters of the deserialization. Must outlive the
+   * pipeline.
+   */
+  MonitoringFramePipeline(const FrameHandler& frame_handler,
+                          const DecodingErrorHandler& decoding_error_handler,
+                          const util::ThreadSettings& thread_settings,
+                          util::LatencyHistogram& deserialization_histogram,
+                          util::PerfCounters& deserialization_perf_counters);
+
+public:
+  //! @brief Copies the datagram into the pipeline. Has to be called by the receiving thread only.
+  void push(const data_conversion_layer::RawData& data,
+            const std::size_t& num_bytes,
+            const util::LatencyClock::time_point& receive_time);
+
+  //! @brief Stops both stages. Data still in the pipeline are not processed anymore.
+  void stop();
+
+  PipelineStatistics statistics() const;
+
+private:
+  struct ReceivedDatagram
+  {
+    data_conversion_layer::RawData data;
+    util::LatencyClock::time_point receive_time;
+  };
+
+  struct ReceivedFrame
+  {
+    data_conversion_layer::monitoring_frame::Message frame;
+    util::LatencyClock::time_point receive_time;
+    //! Set instead of the frame if the deserialization failed.
+    std::exception_ptr decoding_error;
+  };
+
+private:
+  void decode(ReceivedDatagram& datagram);
+  void assemble(const ReceivedFrame& received);
+
+private:
+  const FrameHandler frame_handler_;
+  const DecodingErrorHandler decoding_error_handler_;
+  util::LatencyHistogram& deserialization_histogram_;
+  util::PerfCounters& deserialization_perf_counters_;
+  std::atomic<uint64_t> decode_errors_{ 0 };
+  // The assembly stage is fed by the decode stage and, therefore, has to be created first and destroyed last.
+  util::PipelineStage<ReceivedFrame> assembly_stage_;
+  util::PipelineStage<ReceivedDatagram> decode_stage_;
+};
+
+inline MonitoringFramePipeline::MonitoringFramePipeline(const FrameHandler& frame_handler,
+                                                        const DecodingErrorHandler& decoding_error_handler,
+                                                        const util::ThreadSettings& thread_settings,
+                                                        util::LatencyHistogram& deserialization_histogram,
+                                                        util::PerfCounters& deserialization_perf_counters)
+  : frame_handler_(frame_handler)
+  , decoding_error_handler_(decoding_error_handler)
+  , deserialization_histogram_(deserialization_histogram)
+  , deserialization_perf_counters_(deserialization_perf_counters)
+  , assembly_stage_(PIPELINE_QUEUE_CAPACITY,
+                    [this](const ReceivedFrame& received) { assemble(received); },
+                    thread_settings.withNameSuffix("_asm"))
+  , decode_stage_(PIPELINE_QUEUE_CAPACITY,
+                  [this](ReceivedDatagram& datagram) { decode(datagram); },
+                  thread_settings.withNameSuffix("_dec"))
+{
+  if (!frame_handler_)
+  {
+    throw std::invalid_argument("Frame handler must not be null");
+  }
+  if (!decoding_error_handler_)
+  {
+    throw std::invalid_argument("Decoding error handler must not be null");
+  }
+}
+
+inline void MonitoringFramePipeline::push(const data_conversion_layer::RawData& data,
+                                          const std::size_t& num_bytes,
+                                          const util::LatencyClock::time_point& receive_time)
+{
+  // assign() reuses the capacity of the slot, i.e. no memory is allocated once all slots have been used.
+  if (!decode_stage_.tryPush([&](ReceivedDatagram& slot) {
+        slot.data.assign(data.cbegin(), data.cbegin() + num_bytes);
+        slot.receive_time = receive_time;
+      }))
+  {
+    PSENSCAN_WARN_THROTTLE(1 /* sec */, "MonitoringFramePipeline", "Decode stage overloaded. Dropping datagrams.");
+  }
+}
+
+inline void MonitoringFramePipeline::decode(ReceivedDatagram& datagram)
+{
+  try
+  {
+    const auto deserialization_start{ util::LatencyClock::now() };
+    data_conversion_layer::monitoring_frame::Message frame{ [this, &datagram]() {
+      PSENSCAN_TRACE_SPAN("deserialize");
+      const util::AllocationTagScope allocation_tag(util::AllocationTag::decode);
+      const util::PerfCounterScope perf_counter_scope(deserialization_perf_counters_);
+      return data_conversion_layer::monitoring_frame::deserialize(datagram.data, datagram.data.size());
+    }() };
+    deserialization_histogram_.record(deserialization_start, util::LatencyClock::now());
+    if (!assembly_stage_.tryPush([&](ReceivedFrame& slot) {
+          slot.frame = std::move(frame);
+          slot.receive_time = datagram.receive_time;
+          slot.decoding_error = nullptr;
+        }))
+    {
+      PSENSCAN_WARN_THROTTLE(
+          1 /* sec */, "MonitoringFramePipeline", "Assembly stage overloaded. Dropping monitoring frames.");
+    }
+  }
+  catch (const std::exception&)
+  {
+    // The error is handled by the assembly stage, like the deserialization errors without pipeline.
+    decode_errors_.fetch_add(1, std::memory_order_relaxed);
+    if (!assembly_stage_.tryPush([&](ReceivedFrame& slot) {
+          slot.receive_time = datagram.receive_time;
+          slot.decoding_error = std::current_exception();
+        }))
+    {
+      PSENSCAN_WARN_THROTTLE(
+          1 /* sec */, "MonitoringFramePipeline", "Assembly stage overloaded. Dropping monitoring frames.");
+    }
+  }
+}
+
+inline void MonitoringFramePipeline::assemble(const ReceivedFrame& received)
+{
+  if (received.decoding_error)
+  {
+    decoding_error_handler_(received.decoding_error);
+    return;
+  }
+  frame_handler_(received.frame, received.receive_time);
+}
+
+inline void MonitoringFramePipeline::stop()
+{
+  decode_stage_.stop();
+  assembly_stage_.stop();
+}
+
+inline PipelineStatistics MonitoringFramePipeline::statistics() const
+{
+  return PipelineStatistics{ decode_stage_.statistics(),
+                             assembly_stage_.statistics(),
+                             decode_errors_.load(std::memory_order_relaxed) };
+}
+
+}  // namespace protocol_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_MONITORING_FRAME_PIPELINE_H
@@ -0,0 +1,62 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_PROTOCOL_STATISTICS_H
+#define PSEN_SCAN_V2_STANDALONE_PROTOCOL_STATISTICS_H
+
+#include <cstdint>
+
+namespace psen_scan_v2_standalone
+{
+namespace protocol_layer
+{
+/**
+ * @brief Snapshot of the health counters of the scanner protocol.
+ *
+ * All counters are monotonically increasing since the creation of the scanner, so that the rate of e.g. lost scans
+ * can be computed from two snapshots.
+ */
+struct ProtocolStatistics
+{
+  //! Datagrams received by the data client (including the ones which are dropped later on).
+  uint64_t datagrams_received{ 0 };
+  //! Bytes received by the data client.
+  uint64_t bytes_received{ 0 };
+  //! Datagrams dropped by the kernel, i.e. foreign datagrams rejected by the socket filter of the data client and
+  //! datagrams dropped because the receive buffer of the socket was full, which may include monitoring frames.
+  uint64_t datagrams_dropped{ 0 };
+  //! Monitoring frames handled by the state machine.
+  uint64_t frames_received{ 0 };
+  //! Monitoring frames which arrived while the scanner was not waiting for them (e.g. during the stop).
+  uint64_t unexpected_frames{ 0 };
+  //! Laser scans passed to the laser scan callback.
+  uint64_t scans_completed{ 0 };
+  //! Missing scan counters between consecutive monitoring frames, i.e. scan rounds which were lost completely.
+  uint64_t scan_counter_gaps{ 0 };
+  //! Monitoring frames with a scan counter of an earlier scan round.
+  uint64_t outdated_frames{ 0 };
+  //! Scan rounds which were dropped because the next round started before they were complete.
+  uint64_t dropped_rounds{ 0 };
+  //! Scan rounds with more monitoring frames than expected.
+  uint64_t oversaturated_rounds{ 0 };
+  //! Datagrams which could not be deserialized.
+  uint64_t decode_errors{ 0 };
+  //! Timeouts while waiting for monitoring frames.
+  uint64_t monitoring_frame_timeouts{ 0 };
+};
+
+}  // namespace protocol_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_PROTOCOL_STATISTICS_H
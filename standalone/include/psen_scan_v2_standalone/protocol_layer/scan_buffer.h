@@ -16,10 +16,13 @@
 #ifndef PSEN_SCAN_V2_STANDALONE_SCAN_ROUND_H
 #define PSEN_SCAN_V2_STANDALONE_SCAN_ROUND_H
 
+#include <atomic>
+#include <cstdint>
 #include <exception>
 
 #include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
 #include "psen_scan_v2_standalone/util/logging.h"
+#include "psen_scan_v2_standalone/util/probes.h"
 
 namespace psen_scan_v2_standalone
 {
@@ -75,11 +78,14 @@ public:
  * Discovers if there are to many monitoring frames in a scan round.
  * Informs when a scan round ended incomplete.
  * Discovers and omits old messages.
+ *
+ * The first scan round usually is incomplete, because the receiving starts in the middle of a round. It is dropped
+ * silently, unless keep_incomplete_first_round is set. Then it can be taken once the next round started.
  */
 class ScanBuffer
 {
 public:
-  ScanBuffer(const uint32_t& num_expected_msgs);
+  ScanBuffer(const uint32_t& num_expected_msgs, const bool& keep_incomplete_first_round = false);
   /**
    * @brief Adds the message to the current scan round.
    *
@@ -99,6 +105,21 @@ public:
   std::vector<data_conversion_layer::monitoring_frame::Message> getMsgs();
   bool isRoundComplete();
 
+  //! @returns true if the incomplete first round was kept and has not been taken, yet.
+  bool hasIncompleteFirstRound() const;
+  /**
+   * @returns the frames of the incomplete first round and removes them from the buffer, or an empty vector
+   * if there are none.
+   */
+  std::vector<data_conversion_layer::monitoring_frame::Message> takeIncompleteFirstRound();
+
+  //! @returns the number of ignored frames from earlier rounds. Can be called from any thread.
+  uint64_t numberOfOutdatedFrames() const;
+  //! @returns the number of incomplete rounds which were dropped. Can be called from any thread.
+  uint64_t numberOfDroppedRounds() const;
+  //! @returns the number of rounds with too many frames. Can be called from any thread.
+  uint64_t numberOfOversaturatedRounds() const;
+
 private:
   void startNewRound(const data_conversion_layer::monitoring_frame::Message& msg);
 
@@ -106,9 +127,16 @@ private:
   std::vector<data_conversion_layer::monitoring_frame::Message> current_round_{};
   const uint32_t& num_expected_msgs_;
   bool first_scan_round_ = true;
+  const bool keep_incomplete_first_round_;
+  std::vector<data_conversion_layer::monitoring_frame::Message> incomplete_first_round_{};
+
+  std::atomic<uint64_t> outdated_frames_{ 0 };
+  std::atomic<uint64_t> dropped_rounds_{ 0 };
+  std::atomic<uint64_t> oversaturated_rounds_{ 0 };
 };
 
-inline ScanBuffer::ScanBuffer(const uint32_t& num_expected_msgs) : num_expected_msgs_(num_expected_msgs)
+inline ScanBuffer::ScanBuffer(const uint32_t& num_expected_msgs, const bool& keep_incomplete_first_round)
+  : num_expected_msgs_(num_expected_msgs), keep_incomplete_first_round_(keep_incomplete_first_round)
 {
 }
 
@@ -127,6 +155,33 @@ inline bool ScanBuffer::isRoundComplete()
   return current_round_.size() == num_expected_msgs_;
 }
 
+inline bool ScanBuffer::hasIncompleteFirstRound() const
+{
+  return !incomplete_first_round_.empty();
+}
+
+inline std::vector<data_conversion_layer::monitoring_frame::Message> ScanBuffer::takeIncompleteFirstRound()
+{
+  std::vector<data_conversion_layer::monitoring_frame::Message> round;
+  round.swap(incomplete_first_round_);
+  return round;
+}
+
+inline uint64_t ScanBuffer::numberOfOutdatedFrames() const
+{
+  return outdated_frames_.load(std::memory_order_relaxed);
+}
+
+inline uint64_t ScanBuffer::numberOfDroppedRounds() const
+{
+  return dropped_rounds_.load(std::memory_order_relaxed);
+}
+
+inline uint64_t ScanBuffer::numberOfOversaturatedRounds() const
+{
+  return oversaturated_rounds_.load(std::memory_order_relaxed);
+}
+
 inline void ScanBuffer::add(const data_conversion_layer::monitoring_frame::Message& msg)
 {
   if (current_round_.empty() || msg.scanCounter() == current_round_[0].scanCounter())
@@ -134,8 +189,14 @@ inline void ScanBuffer::add(const data_conversion_layer::monitoring_frame::Messa
     current_round_.push_back(msg);
     if (current_round_.size() > num_expected_msgs_)
     {
+      oversaturated_rounds_.fetch_add(1, std::memory_order_relaxed);
+      PSENSCAN_PROBE2(round_dropped, msg.scanCounter(), "oversaturated");
       throw ScanRoundOversaturatedError();
     }
+    if (current_round_.size() == num_expected_msgs_)
+    {
+      PSENSCAN_PROBE2(round_completed, msg.scanCounter(), current_round_.size());
+    }
   }
   else if (msg.scanCounter() > current_round_[0].scanCounter())
   {
@@ -143,6 +204,8 @@ inline void ScanBuffer::add(const data_conversion_layer::monitoring_frame::Messa
   }
   else
   {
+    outdated_frames_.fetch_add(1, std::memory_order_relaxed);
+    PSENSCAN_PROBE2(round_dropped, msg.scanCounter(), "outdated_frame");
     throw OutdatedMessageError();
   }
 }
@@ -150,10 +213,17 @@ inline void ScanBuffer::add(const data_conversion_layer::monitoring_frame::Messa
 inline void ScanBuffer::startNewRound(const data_conversion_layer::monitoring_frame::Message& msg)
 {
   bool old_round_undersaturated = current_round_.size() < num_expected_msgs_;
+  const uint32_t old_scan_counter{ current_round_[0].scanCounter() };
+  if (old_round_undersaturated && first_scan_round_ && keep_incomplete_first_round_)
+  {
+    incomplete_first_round_ = current_round_;
+  }
   reset();
   current_round_.push_back(msg);
   if (old_round_undersaturated && !first_scan_round_)
   {
+    dropped_rounds_.fetch_add(1, std::memory_order_relaxed);
+    PSENSCAN_PROBE2(round_dropped, old_scan_counter, "incomplete");
     throw ScanRoundEndedEarlyError();
   }
   first_scan_round_ = false;
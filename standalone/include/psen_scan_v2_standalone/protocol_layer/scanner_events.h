@@ -15,7 +15,11 @@
 #ifndef PSEN_SCAN_V2_STANDALONE_EVENTS_H
 #define PSEN_SCAN_V2_STANDALONE_EVENTS_H
 
+#include <exception>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
 #include "psen_scan_v2_standalone/data_conversion_layer/raw_scanner_data.h"
+#include "psen_scan_v2_standalone/util/latency_histogram.h"
 
 namespace psen_scan_v2_standalone
 {
@@ -48,14 +52,18 @@ class StartTimeout
 class RawReplyReceived
 {
 public:
-  RawReplyReceived(const data_conversion_layer::RawData& data, const std::size_t& num_bytes)
-    : data_(data), num_bytes_(num_bytes)
+  RawReplyReceived(const data_conversion_layer::RawData& data,
+                   const std::size_t& num_bytes,
+                   const util::LatencyClock::time_point& receive_time)
+    : data_(data), num_bytes_(num_bytes), receive_time_(receive_time)
   {
   }
 
 public:
   const data_conversion_layer::RawData data_;
   const std::size_t num_bytes_;
+  //! Point in time at which the datagram was received.
+  const util::LatencyClock::time_point receive_time_;
 };
 
 //! @brief Triggered whenever the receiving of a reply message failes.
@@ -67,14 +75,48 @@ class ReplyReceiveError
 class RawMonitoringFrameReceived
 {
 public:
-  RawMonitoringFrameReceived(const data_conversion_layer::RawData& data, const std::size_t& num_bytes)
-    : data_(data), num_bytes_(num_bytes)
+  RawMonitoringFrameReceived(const data_conversion_layer::RawData& data,
+                             const std::size_t& num_bytes,
+                             const util::LatencyClock::time_point& receive_time)
+    : data_(data), num_bytes_(num_bytes), receive_time_(receive_time)
   {
   }
 
 public:
   const data_conversion_layer::RawData data_;
   const std::size_t num_bytes_;
+  //! Point in time at which the datagram was received.
+  const util::LatencyClock::time_point receive_time_;
+};
+
+//! @brief Monitoring frame which was already deserialized apart from the state machine (pipelined processing).
+class MonitoringFrameReceived
+{
+public:
+  MonitoringFrameReceived(const data_conversion_layer::monitoring_frame::Message& frame,
+                          const util::LatencyClock::time_point& receive_time)
+    : frame_(frame), receive_time_(receive_time)
+  {
+  }
+
+public:
+  //! The event is only valid during the processing by the state machine, therefore, the frame is not copied.
+  const data_conversion_layer::monitoring_frame::Message& frame_;
+  //! Point in time at which the datagram containing the frame was received.
+  const util::LatencyClock::time_point receive_time_;
+};
+
+//! @brief Datagram which could not be deserialized apart from the state machine (pipelined processing).
+class MonitoringFrameDecodingFailed
+{
+public:
+  explicit MonitoringFrameDecodingFailed(const std::exception_ptr& exception) : exception_(exception)
+  {
+  }
+
+public:
+  //! The exception thrown by the deserialization.
+  const std::exception_ptr exception_;
 };
 
 //! @brief Timeout while waiting for MonitoringFrame.
@@ -15,6 +15,8 @@
 #ifndef PSEN_SCAN_V2_STANDALONE_SCANNER_PROTOCOL_DEF_H
 #define PSEN_SCAN_V2_STANDALONE_SCANNER_PROTOCOL_DEF_H
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <memory>
@@ -29,6 +31,7 @@
 #include <boost/msm/front/state_machine_def.hpp>
 
 #include <boost/msm/back/tools.hpp>
+#include <boost/optional.hpp>
 #include <boost/msm/back/metafunctions.hpp>
 
 #include "psen_scan_v2_standalone/protocol_layer/scanner_events.h"
@@ -48,7 +51,13 @@
 #include "psen_scan_v2_standalone/data_conversion_layer/scanner_reply_serialization_deserialization.h"
 #include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
 #include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+#include "psen_scan_v2_standalone/protocol_layer/latency_histograms.h"
+#include "psen_scan_v2_standalone/protocol_layer/protocol_statistics.h"
 #include "psen_scan_v2_standalone/protocol_layer/scan_buffer.h"
+#include "psen_scan_v2_standalone/protocol_layer/stage_perf_counters.h"
+#include "psen_scan_v2_standalone/util/allocation_tags.h"
+#include "psen_scan_v2_standalone/util/probes.h"
+#include "psen_scan_v2_standalone/util/tracing.h"
 #include "psen_scan_v2_standalone/util/watchdog.h"
 
 namespace psen_scan_v2_standalone
@@ -77,6 +86,8 @@ namespace e = psen_scan_v2_standalone::protocol_layer::scanner_events;
 // clang-format on
 
 static constexpr std::chrono::milliseconds WATCHDOG_TIMEOUT{ 1000 };
+//! @brief First timeout of the start reply in fast start mode, it is doubled with each retry up to WATCHDOG_TIMEOUT.
+static constexpr std::chrono::milliseconds FAST_START_REPLY_TIMEOUT{ 50 };
 static constexpr uint32_t DEFAULT_NUM_MSG_PER_ROUND{ 6 };
 
 using ScannerStartedCB = std::function<void()>;
@@ -97,7 +108,7 @@ public:
   virtual ~IWatchdogFactory() = default;
 
 public:
-  virtual std::unique_ptr<util::Watchdog> create(const util::Watchdog::Timeout& timeout,
+  virtual std::unique_ptr<util::Watchdog> create(const util::Watchdog::Schedule& schedule,
                                                  const std::string& event_type) = 0;
 };
 
@@ -108,17 +119,21 @@ public:
 struct StateMachineArgs
 {
   StateMachineArgs(const ScannerConfiguration& scanner_config,
-                   std::unique_ptr<communication_layer::UdpClientImpl> control_client,
-                   std::unique_ptr<communication_layer::UdpClientImpl> data_client,
+                   std::unique_ptr<communication_layer::IUdpClient> control_client,
+                   std::unique_ptr<communication_layer::IUdpClient> data_client,
                    const ScannerStartedCB& started_cb,
                    const ScannerStoppedCB& stopped_cb,
                    const InformUserAboutLaserScanCB& laser_scan_cb,
-                   std::unique_ptr<IWatchdogFactory> watchdog_factory)
+                   std::unique_ptr<IWatchdogFactory> watchdog_factory,
+                   LatencyHistograms& latency_histograms,
+                   StagePerfCounters& perf_counters)
     : config_(scanner_config)
     , scanner_started_cb(started_cb)
     , scanner_stopped_cb(stopped_cb)
     , inform_user_about_laser_scan_cb(laser_scan_cb)
     , watchdog_factory_(std::move(watchdog_factory))
+    , latency_histograms_(latency_histograms)
+    , perf_counters_(perf_counters)
     , control_client_(std::move(control_client))
     , data_client_(std::move(data_client))
   {
@@ -134,11 +149,16 @@ struct StateMachineArgs
   // Factories
   std::unique_ptr<IWatchdogFactory> watchdog_factory_{};
 
+  //! @brief Owned by the scanner, so that the statistics can be read without locking the state machine.
+  LatencyHistograms& latency_histograms_;
+  //! @brief Owned by the scanner, so that the statistics can be read without locking the state machine.
+  StagePerfCounters& perf_counters_;
+
   // UDP clients
   // Note: The clients must be declared last, to ensure that they are desroyed first.
   // If they are not declared last, segmentation default might occur!
-  std::unique_ptr<communication_layer::UdpClientImpl> control_client_{};
-  std::unique_ptr<communication_layer::UdpClientImpl> data_client_{};
+  std::unique_ptr<communication_layer::IUdpClient> control_client_{};
+  std::unique_ptr<communication_layer::IUdpClient> data_client_{};
 };
 
 // front-end: define the FSM structure
@@ -178,8 +198,18 @@ public:  // Action methods
   template <class T>
   void sendStopRequest(const T& event);
   void handleMonitoringFrame(const scanner_events::RawMonitoringFrameReceived& event);
+  void handleDeserializedMonitoringFrame(const scanner_events::MonitoringFrameReceived& event);
+  void handleMonitoringFrameDecodingFailure(const scanner_events::MonitoringFrameDecodingFailed& event);
   void handleMonitoringFrameTimeout(const scanner_events::MonitoringFrameTimeout& event);
 
+public:
+  /**
+   * @returns a snapshot of the health counters.
+   *
+   * @note Only reads atomic counters, i.e. it may be called from any thread without synchronization.
+   */
+  ProtocolStatistics protocolStatistics() const;
+
 public:  // Guards
   bool isStartReply(scanner_events::RawReplyReceived const& reply_event);
   bool isStopReply(scanner_events::RawReplyReceived const& reply_event);
@@ -194,6 +224,11 @@ public:  // Replaces the default exception/no-transition responses
   template <class FSM>
   void no_transition(const scanner_events::RawMonitoringFrameReceived&, FSM&, int state);
 
+  template <class FSM>
+  void no_transition(const scanner_events::MonitoringFrameReceived&, FSM&, int state);
+  template <class FSM>
+  void no_transition(const scanner_events::MonitoringFrameDecodingFailed&, FSM&, int state);
+
 public:  // Definition of state machine via table
   typedef Idle initial_state;
   typedef ScannerProtocolDef m;
@@ -210,6 +245,8 @@ public:  // Definition of state machine via table
       g_row  < WaitForStartReply,         e::RawReplyReceived,          WaitForMonitoringFrame,                                   &m::isStartReply            >,
       a_irow < WaitForStartReply,         e::StartTimeout,                                          &m::handleStartRequestTimeout                             >,
       a_irow < WaitForMonitoringFrame,    e::RawMonitoringFrameReceived,                            &m::handleMonitoringFrame                                 >,
+      a_irow < WaitForMonitoringFrame,    e::MonitoringFrameReceived,                               &m::handleDeserializedMonitoringFrame                     >,
+      a_irow < WaitForMonitoringFrame,    e::MonitoringFrameDecodingFailed,                         &m::handleMonitoringFrameDecodingFailure                  >,
       a_irow < WaitForMonitoringFrame,    e::MonitoringFrameTimeout,                                &m::handleMonitoringFrameTimeout                          >,
       a_row  < WaitForStartReply,         e::StopRequest,               WaitForStopReply,           &m::sendStopRequest                                       >,
       a_row  < WaitForMonitoringFrame,    e::StopRequest,               WaitForStopReply,           &m::sendStopRequest                                       >,
@@ -233,8 +270,12 @@ private:
   // LCOV_EXCL_STOP
   void checkForInternalErrors(const data_conversion_layer::scanner_reply::Message& msg);
 
+  void processMonitoringFrame(const data_conversion_layer::monitoring_frame::Message& frame,
+                              const util::LatencyClock::time_point& receive_time);
   void checkForDiagnosticErrors(const data_conversion_layer::monitoring_frame::Message& frame);
+  void countScanCounterGaps(const data_conversion_layer::monitoring_frame::Message& frame);
   void informUserAboutTheScanData(const data_conversion_layer::monitoring_frame::Message& frame);
+  util::Watchdog::Schedule startReplyTimeouts() const;
   void sendMessageWithMeasurements(const std::vector<data_conversion_layer::monitoring_frame::Message>& frames);
   bool framesContainMeasurements(const std::vector<data_conversion_layer::monitoring_frame::Message>& frames);
 
@@ -244,7 +285,17 @@ private:
   std::unique_ptr<util::Watchdog> start_reply_watchdog_{};
 
   std::unique_ptr<util::Watchdog> monitoring_frame_watchdog_{};
-  ScanBuffer scan_buffer_{ DEFAULT_NUM_MSG_PER_ROUND };
+  ScanBuffer scan_buffer_;
+  //! @brief Receive time of the monitoring frame currently processed.
+  util::LatencyClock::time_point receive_time_{};
+  boost::optional<uint32_t> last_scan_counter_{};
+
+  std::atomic<uint64_t> frames_received_{ 0 };
+  std::atomic<uint64_t> unexpected_frames_{ 0 };
+  std::atomic<uint64_t> scans_completed_{ 0 };
+  std::atomic<uint64_t> scan_counter_gaps_{ 0 };
+  std::atomic<uint64_t> decode_errors_{ 0 };
+  std::atomic<uint64_t> monitoring_frame_timeouts_{ 0 };
 };
 
 // Pick a back-end
@@ -18,7 +18,10 @@ namespace psen_scan_v2_standalone
 {
 namespace protocol_layer
 {
-inline ScannerProtocolDef::ScannerProtocolDef(StateMachineArgs* const args) : args_(args)
+inline ScannerProtocolDef::ScannerProtocolDef(StateMachineArgs* const args)
+  : args_(args)
+  , scan_buffer_(DEFAULT_NUM_MSG_PER_ROUND,
+                 args_->config_.fastStartEnabled() && !args_->config_.fragmentedScansEnabled())
 {
 }
 
@@ -62,7 +65,7 @@ void ScannerProtocolDef::WaitForStartReply::on_entry(Event const&, FSM& fsm)
 {
   PSENSCAN_DEBUG("StateMachine", fmt::format("Entering state: {}", "WaitForStartReply"));
   // Start watchdog...
-  fsm.start_reply_watchdog_ = fsm.args_->watchdog_factory_->create(WATCHDOG_TIMEOUT, "StartReplyTimeout");
+  fsm.start_reply_watchdog_ = fsm.args_->watchdog_factory_->create(fsm.startReplyTimeouts(), "StartReplyTimeout");
 }
 
 template <class Event, class FSM>
@@ -78,8 +81,10 @@ void ScannerProtocolDef::WaitForMonitoringFrame::on_entry(Event const&, FSM& fsm
 {
   PSENSCAN_DEBUG("StateMachine", fmt::format("Entering state: {}", "WaitForMonitoringFrame"));
   fsm.scan_buffer_.reset();
+  fsm.last_scan_counter_ = boost::none;
   // Start watchdog...
-  fsm.monitoring_frame_watchdog_ = fsm.args_->watchdog_factory_->create(WATCHDOG_TIMEOUT, "MonitoringFrameTimeout");
+  fsm.monitoring_frame_watchdog_ =
+      fsm.args_->watchdog_factory_->create({ WATCHDOG_TIMEOUT }, "MonitoringFrameTimeout");
   fsm.args_->scanner_started_cb();
 }
 
@@ -118,9 +123,25 @@ inline void ScannerProtocolDef::sendStartRequest(const T& event)
       data_conversion_layer::start_request::serialize(data_conversion_layer::start_request::Message(args_->config_)));
 }
 
+inline util::Watchdog::Schedule ScannerProtocolDef::startReplyTimeouts() const
+{
+  if (!args_->config_.fastStartEnabled())
+  {
+    return { WATCHDOG_TIMEOUT };
+  }
+  util::Watchdog::Schedule schedule;
+  for (auto timeout = FAST_START_REPLY_TIMEOUT; timeout < WATCHDOG_TIMEOUT; timeout *= 2)
+  {
+    schedule.push_back(timeout);
+  }
+  schedule.push_back(WATCHDOG_TIMEOUT);
+  return schedule;
+}
+
 inline void ScannerProtocolDef::handleStartRequestTimeout(const scanner_events::StartTimeout& event)
 {
   PSENSCAN_DEBUG("StateMachine", "Action: handleStartRequestTimeout");
+  PSENSCAN_PROBE1(watchdog_timeout, "StartReplyTimeout");
   PSENSCAN_ERROR("StateMachine",
                  "Timeout while waiting for the scanner to start! Retrying... "
                  "(Please check the ethernet connection or contact PILZ support if the error persists.)");
@@ -131,7 +152,8 @@ template <class T>
 inline void ScannerProtocolDef::sendStopRequest(const T& event)
 {
   PSENSCAN_DEBUG("StateMachine", "Action: sendStopRequest");
-  args_->data_client_->close();
+  // Closing the data client would wait for the data handler, which might be blocked by the caller of the event.
+  args_->data_client_->stopReceiving();
   args_->control_client_->write(data_conversion_layer::stop_request::serialize());
 }
 
@@ -142,19 +164,86 @@ inline void ScannerProtocolDef::handleMonitoringFrame(const scanner_events::RawM
 
   try
   {
-    const data_conversion_layer::monitoring_frame::Message frame{ data_conversion_layer::monitoring_frame::deserialize(
-        event.data_, event.num_bytes_) };
+    const auto deserialization_start{ util::LatencyClock::now() };
+    const data_conversion_layer::monitoring_frame::Message frame{ [this, &event]() {
+      PSENSCAN_TRACE_SPAN("deserialize");
+      const util::AllocationTagScope allocation_tag(util::AllocationTag::decode);
+      const util::PerfCounterScope perf_counter_scope(args_->perf_counters_.deserialization);
+      return data_conversion_layer::monitoring_frame::deserialize(event.data_, event.num_bytes_);
+    }() };
+    args_->latency_histograms_.deserialization.record(deserialization_start, util::LatencyClock::now());
+    processMonitoringFrame(frame, event.receive_time_);
+  }
+  // LCOV_EXCL_START
+  catch (const data_conversion_layer::monitoring_frame::DecodingFailure&)
+  {
+    // Only counted, the error handling is left to exception_caught().
+    decode_errors_.fetch_add(1, std::memory_order_relaxed);
+    throw;
+  }
+  // LCOV_EXCL_STOP
+}
+
+inline void
+ScannerProtocolDef::handleDeserializedMonitoringFrame(const scanner_events::MonitoringFrameReceived& event)
+{
+  PSENSCAN_DEBUG("StateMachine", "Action: handleDeserializedMonitoringFrame");
+  monitoring_frame_watchdog_->reset();
+  processMonitoringFrame(event.frame_, event.receive_time_);
+}
+
+inline void
+ScannerProtocolDef::handleMonitoringFrameDecodingFailure(const scanner_events::MonitoringFrameDecodingFailed& event)
+{
+  PSENSCAN_DEBUG("StateMachine", "Action: handleMonitoringFrameDecodingFailure");
+  monitoring_frame_watchdog_->reset();
+
+  // Same handling as a failing deserialization in handleMonitoringFrame().
+  try
+  {
+    std::rethrow_exception(event.exception_);
+  }
+  catch (const data_conversion_layer::monitoring_frame::DecodingFailure&)
+  {
+    decode_errors_.fetch_add(1, std::memory_order_relaxed);
+    throw;
+  }
+}
+
+inline void ScannerProtocolDef::processMonitoringFrame(const data_conversion_layer::monitoring_frame::Message& frame,
+                                                       const util::LatencyClock::time_point& receive_time)
+{
+  receive_time_ = receive_time;
+  frames_received_.fetch_add(1, std::memory_order_relaxed);
+  try
+  {
     checkForDiagnosticErrors(frame);
+    countScanCounterGaps(frame);
     informUserAboutTheScanData(frame);
   }
   // LCOV_EXCL_START
   catch (const data_conversion_layer::monitoring_frame::ScanCounterMissing& e)
   {
+    decode_errors_.fetch_add(1, std::memory_order_relaxed);
     PSENSCAN_ERROR("StateMachine", e.what());
   }
   // LCOV_EXCL_STOP
 }
 
+inline void ScannerProtocolDef::countScanCounterGaps(const data_conversion_layer::monitoring_frame::Message& frame)
+{
+  const uint32_t scan_counter{ frame.scanCounter() };
+  // Outdated frames are counted by the scan buffer.
+  if (last_scan_counter_ && scan_counter > *last_scan_counter_ + 1)
+  {
+    scan_counter_gaps_.fetch_add(scan_counter - *last_scan_counter_ - 1, std::memory_order_relaxed);
+  }
+  if (!last_scan_counter_ || scan_counter > *last_scan_counter_)
+  {
+    last_scan_counter_ = scan_counter;
+  }
+}
+
 inline void ScannerProtocolDef::checkForDiagnosticErrors(const data_conversion_layer::monitoring_frame::Message& frame)
 {
   if (!frame.diagnosticMessages().empty())
@@ -167,9 +256,17 @@ inline void ScannerProtocolDef::checkForDiagnosticErrors(const data_conversion_l
 inline void
 ScannerProtocolDef::informUserAboutTheScanData(const data_conversion_layer::monitoring_frame::Message& frame)
 {
+  const util::AllocationTagScope allocation_tag(util::AllocationTag::buffer);
   try
   {
+    const auto scan_buffer_start{ util::LatencyClock::now() };
     scan_buffer_.add(frame);
+    args_->latency_histograms_.scan_buffer.record(scan_buffer_start, util::LatencyClock::now());
+    if (scan_buffer_.hasIncompleteFirstRound())
+    {
+      PSENSCAN_DEBUG("StateMachine", "Fast start: Passing on the incomplete first scan round.");
+      sendMessageWithMeasurements(scan_buffer_.takeIncompleteFirstRound());
+    }
     if (!args_->config_.fragmentedScansEnabled() && scan_buffer_.isRoundComplete())
     {
       sendMessageWithMeasurements(scan_buffer_.getMsgs());
@@ -192,7 +289,23 @@ inline void ScannerProtocolDef::sendMessageWithMeasurements(
   {
     try
     {
-      args_->inform_user_about_laser_scan_cb(data_conversion_layer::LaserScanConverter::toLaserScan(frames));
+      const auto conversion_start{ util::LatencyClock::now() };
+      const LaserScan scan{ [this, &frames]() {
+        const util::AllocationTagScope allocation_tag(util::AllocationTag::conversion);
+        const util::PerfCounterScope perf_counter_scope(args_->perf_counters_.conversion);
+        return data_conversion_layer::LaserScanConverter::toLaserScan(frames);
+      }() };
+      const auto callback_entry{ util::LatencyClock::now() };
+      args_->latency_histograms_.conversion.record(conversion_start, callback_entry);
+      args_->latency_histograms_.receive_to_callback.record(receive_time_, callback_entry);
+      {
+        PSENSCAN_TRACE_SPAN("laser_scan_callback");
+        const util::AllocationTagScope allocation_tag(util::AllocationTag::callback);
+        args_->inform_user_about_laser_scan_cb(scan);
+      }
+      scans_completed_.fetch_add(1, std::memory_order_relaxed);
+      PSENSCAN_PROBE2(scan_delivered, scan.getScanCounter(), scan.getMeasurements().size());
+      args_->latency_histograms_.callback.record(callback_entry, util::LatencyClock::now());
     }
     // LCOV_EXCL_START
     catch (const data_conversion_layer::ScannerProtocolViolationError& ex)
@@ -217,12 +330,32 @@ inline bool ScannerProtocolDef::framesContainMeasurements(
 inline void ScannerProtocolDef::handleMonitoringFrameTimeout(const scanner_events::MonitoringFrameTimeout& event)
 {
   PSENSCAN_DEBUG("StateMachine", "Action: handleMonitoringFrameTimeout");
+  monitoring_frame_timeouts_.fetch_add(1, std::memory_order_relaxed);
+  PSENSCAN_PROBE1(watchdog_timeout, "MonitoringFrameTimeout");
 
   PSENSCAN_WARN("StateMachine",
                 "Timeout while waiting for MonitoringFrame message."
                 " (Please check the ethernet connection or contact PILZ support if the error persists.)");
 }
 
+inline ProtocolStatistics ScannerProtocolDef::protocolStatistics() const
+{
+  ProtocolStatistics statistics;
+  statistics.datagrams_received = args_->data_client_->numberOfReceivedDatagrams();
+  statistics.bytes_received = args_->data_client_->numberOfReceivedBytes();
+  statistics.datagrams_dropped = args_->data_client_->numberOfDroppedDatagrams();
+  statistics.frames_received = frames_received_.load(std::memory_order_relaxed);
+  statistics.unexpected_frames = unexpected_frames_.load(std::memory_order_relaxed);
+  statistics.scans_completed = scans_completed_.load(std::memory_order_relaxed);
+  statistics.scan_counter_gaps = scan_counter_gaps_.load(std::memory_order_relaxed);
+  statistics.outdated_frames = scan_buffer_.numberOfOutdatedFrames();
+  statistics.dropped_rounds = scan_buffer_.numberOfDroppedRounds();
+  statistics.oversaturated_rounds = scan_buffer_.numberOfOversaturatedRounds();
+  statistics.decode_errors = decode_errors_.load(std::memory_order_relaxed);
+  statistics.monitoring_frame_timeouts = monitoring_frame_timeouts_.load(std::memory_order_relaxed);
+  return statistics;
+}
+
 //+++++++++++++++++++++++++++++++++ Guards ++++++++++++++++++++++++++++++++++++
 
 // LCOV_EXCL_START
@@ -313,8 +446,24 @@ void ScannerProtocolDef::no_transition(Event const& event, FSM&, int state)
 template <class FSM>
 void ScannerProtocolDef::no_transition(const scanner_events::RawMonitoringFrameReceived&, FSM&, int state)
 {
+  unexpected_frames_.fetch_add(1, std::memory_order_relaxed);
   PSENSCAN_WARN("StateMachine", "Received monitoring frame despite not waiting for it");
 }
 
+template <class FSM>
+void ScannerProtocolDef::no_transition(const scanner_events::MonitoringFrameReceived&, FSM&, int state)
+{
+  // Frames still in the pipeline are expected to arrive shortly after the stop request.
+  unexpected_frames_.fetch_add(1, std::memory_order_relaxed);
+  PSENSCAN_DEBUG("StateMachine", "Dropped monitoring frame despite not waiting for it");
+}
+
+template <class FSM>
+void ScannerProtocolDef::no_transition(const scanner_events::MonitoringFrameDecodingFailed&, FSM&, int state)
+{
+  unexpected_frames_.fetch_add(1, std::memory_order_relaxed);
+  PSENSCAN_DEBUG("StateMachine", "Dropped invalid monitoring frame despite not waiting for it");
+}
+
 }  // namespace protocol_layer
 }  // namespace psen_scan_v2_standalone
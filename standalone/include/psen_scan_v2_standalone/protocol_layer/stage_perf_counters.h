@@ -0,0 +1,67 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_STAGE_PERF_COUNTERS_H
+#define PSEN_SCAN_V2_STANDALONE_STAGE_PERF_COUNTERS_H
+
+#include "psen_scan_v2_standalone/util/perf_counters.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace protocol_layer
+{
+/**
+ * @brief Snapshot of the hardware performance counters of the cpu intensive processing stages.
+ *
+ * All values are zero if the performance counters are disabled.
+ */
+struct PerfCounterStatistics
+{
+  //! Deserialization of the received datagram into a monitoring frame.
+  util::PerfCounterSnapshot deserialization;
+  //! Conversion of the monitoring frame(s) into the laser scan.
+  util::PerfCounterSnapshot conversion;
+};
+
+/**
+ * @brief Hardware performance counters of the processing stages of one scanner.
+ *
+ * @see PerfCounterStatistics
+ */
+struct StagePerfCounters
+{
+  explicit StagePerfCounters(const bool& enabled = false);
+
+  util::PerfCounters deserialization;
+  util::PerfCounters conversion;
+
+  PerfCounterStatistics snapshot() const;
+};
+
+inline StagePerfCounters::StagePerfCounters(const bool& enabled) : deserialization(enabled), conversion(enabled)
+{
+}
+
+inline PerfCounterStatistics StagePerfCounters::snapshot() const
+{
+  PerfCounterStatistics statistics;
+  statistics.deserialization = deserialization.snapshot();
+  statistics.conversion = conversion.snapshot();
+  return statistics;
+}
+
+}  // namespace protocol_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_STAGE_PERF_COUNTERS_H
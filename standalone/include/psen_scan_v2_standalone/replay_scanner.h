@@ -0,0 +1,134 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_REPLAY_SCANNER_H
+#define PSEN_SCAN_V2_STANDALONE_REPLAY_SCANNER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "psen_scan_v2_standalone/scanner_configuration.h"
+#include "psen_scan_v2_standalone/scanner_interface.h"
+#include "psen_scan_v2_standalone/scanner_statistics.h"
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/communication_layer/replay_source.h"
+#include "psen_scan_v2_standalone/protocol_layer/latency_histograms.h"
+#include "psen_scan_v2_standalone/protocol_layer/scanner_state_machine.h"
+#include "psen_scan_v2_standalone/protocol_layer/stage_perf_counters.h"
+
+#include "psen_scan_v2_standalone/util/watchdog.h"
+
+namespace psen_scan_v2_standalone
+{
+/**
+ * @brief Feeds recorded monitoring frames through the protocol implementation of the ScannerV2.
+ *
+ * The data client of the state machine is replaced by a communication_layer::ReplaySource, so the recorded
+ * datagrams are processed exactly like received ones (deserialization, scan buffer, conversion to LaserScan).
+ * There is no control connection: The start and stop replies of the scanner are injected into the state machine.
+ * No sockets are opened, so recordings can be evaluated on any machine, e.g. to reproduce a problem of the field or
+ * to measure the throughput of the processing (see communication_layer::ReplaySource::AS_FAST_AS_POSSIBLE).
+ *
+ * The scan range, resolution and fragmentation of the configuration have to match the recording. Like the driver,
+ * the processing stops at the first datagram which cannot be deserialized.
+ *
+ * @see communication_layer::readRecording()
+ */
+class ReplayScanner
+{
+public:
+  /**
+   * @param scanner_config Configuration of the scanner which was recorded. The ip addresses are not used.
+   * @param laser_scan_cb Callback called with each laser scan, by the playback thread.
+   * @param datagrams Recorded datagrams of the data connection.
+   * @param speed Multiple of the recorded speed, see communication_layer::ReplaySource.
+   */
+  ReplayScanner(const ScannerConfiguration& scanner_config,
+                const IScanner::LaserScanCallback& laser_scan_cb,
+                std::vector<communication_layer::RecordedDatagram> datagrams,
+                const double& speed = 1.);
+  ~ReplayScanner();
+
+public:
+  /**
+   * @brief Starts the protocol, plays back all datagrams and stops the protocol again.
+   *
+   * Blocks until all datagrams have been processed. Can only be called once.
+   */
+  void run();
+
+  //! @see ScannerV2::getStatistics()
+  ScannerStatistics getStatistics() const;
+
+private:
+  protocol_layer::StateMachineArgs* createStateMachineArgs(std::vector<communication_layer::RecordedDatagram> datagrams,
+                                           const double& speed);
+
+  template <class T>
+  void triggerEventWithParam(const T& event);
+  template <class T>
+  void triggerEvent();
+  void injectReply(const data_conversion_layer::scanner_reply::Message::Type& type);
+
+private:
+  /**
+   * @brief Watchdog factory of the replay.
+   *
+   * The start reply is injected by the replay, so only the monitoring frame timeouts are handled.
+   */
+  class WatchdogFactory : public protocol_layer::IWatchdogFactory
+  {
+  public:
+    WatchdogFactory(ReplayScanner* scanner);
+    std::unique_ptr<util::Watchdog> create(const util::Watchdog::Schedule& schedule,
+                                           const std::string& event_type) override;
+
+  private:
+    ReplayScanner* scanner_;
+  };
+
+private:
+  const ScannerConfiguration config_;
+  const IScanner::LaserScanCallback laser_scan_cb_;
+
+  //! @brief Protects the state machine against the playback thread and the watchdog thread.
+  std::mutex member_mutex_;
+
+  protocol_layer::LatencyHistograms latency_histograms_;
+  protocol_layer::StagePerfCounters perf_counters_;
+
+  //! @brief Owned by the state machine.
+  communication_layer::ReplaySource* data_source_{ nullptr };
+  std::unique_ptr<protocol_layer::ScannerStateMachine> sm_;
+  bool has_run_{ false };
+};
+
+template <class T>
+void ReplayScanner::triggerEventWithParam(const T& event)
+{
+  const std::lock_guard<std::mutex> lock(member_mutex_);
+  sm_->process_event(event);
+}
+
+template <class T>
+void ReplayScanner::triggerEvent()
+{
+  triggerEventWithParam<T>(T());
+}
+
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_REPLAY_SCANNER_H
@@ -0,0 +1,162 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_SCAN_CODEC_H
+#define PSEN_SCAN_V2_STANDALONE_SCAN_CODEC_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "psen_scan_v2_standalone/laserscan.h"
+
+namespace psen_scan_v2_standalone
+{
+/**
+ * @brief Exception thrown if a frame cannot be decoded.
+ */
+class ScanCodecError : public std::runtime_error
+{
+public:
+  ScanCodecError(const std::string& msg);
+};
+
+/**
+ * @brief Options of the ScanEncoder.
+ */
+struct ScanCodecOptions
+{
+  //! @brief Every n-th frame is a key frame, which can be decoded without the previous frames. 1 disables deltas.
+  std::size_t key_frame_interval{ 33 };
+  //! @brief Packs the values in blocks of 128 with the bit width of their maximum instead of varints.
+  bool bit_packing{ false };
+  /**
+   * @brief If false, the values are written as plain uint16 and every frame is a key frame.
+   *
+   * Uncompressed frames are about twice as large as varint encoded key frames, but they are cheaper to encode and can
+   * be parsed without the ScanDecoder.
+   */
+  bool compression{ true };
+  //! @brief Uses the SSE2 implementation on x86-64. Both implementations produce the same frames.
+  bool simd{ true };
+};
+
+/**
+ * @brief Compresses consecutive LaserScans, e.g. for storing or forwarding them.
+ *
+ * The measurements (rounded to millimeters) and intensities are encoded as differences to the previous scan if it
+ * has the same angles and number of values, else as differences to the previous value of the same scan (key frame).
+ * The differences are zigzag encoded, such that small negative differences result in small numbers, and written as
+ * varints or, with bit packing, in blocks of 128 values with the bit width needed by the block.
+ *
+ * Each frame starts with a header of 28 bytes: format version (uint8), flags (uint8), 2 reserved bytes, sequence
+ * number (uint32), scan counter (uint32), resolution, min and max scan angle (int16), 2 reserved bytes, number of
+ * measurements and intensities (uint32). All integers are little endian. The sequence number allows the ScanDecoder
+ * to detect lost frames.
+ *
+ * Without compression, the values are written as uint16 instead and each frame is a key frame.
+ *
+ * The encoder is stateful: the frames have to be decoded in the order in which they were encoded.
+ *
+ * @see ScanDecoder
+ */
+class ScanEncoder
+{
+public:
+  ScanEncoder(const ScanCodecOptions& options = ScanCodecOptions());
+
+public:
+  /**
+   * @brief Replaces the content of the given frame with the encoded scan.
+   *
+   * Measurements which cannot be represented (e.g. infinity) are encoded as the maximal value of uint16.
+   */
+  void encode(const LaserScan& scan, std::vector<char>& frame);
+  std::vector<char> encode(const LaserScan& scan);
+  //! @brief The next frame becomes a key frame, e.g. after a receiver has joined.
+  void forceKeyFrame();
+
+private:
+  uint8_t flags(const bool& key_frame) const;
+  void encodeValues(const std::vector<uint16_t>& values,
+                    const std::vector<uint16_t>& previous_values,
+                    const bool& key_frame,
+                    std::vector<char>& frame);
+
+private:
+  const ScanCodecOptions options_;
+  uint32_t sequence_number_{ 0 };
+  std::size_t frames_since_key_frame_{ 0 };
+  bool force_key_frame_{ true };
+  //! @brief Resolution, min and max scan angle of the previous scan.
+  std::array<int16_t, 3> previous_angles_{};
+  std::vector<uint16_t> measurements_;
+  std::vector<uint16_t> intensities_;
+  std::vector<uint16_t> previous_measurements_;
+  std::vector<uint16_t> previous_intensities_;
+  std::vector<uint32_t> zigzag_;
+};
+
+/**
+ * @brief Decodes the frames of a ScanEncoder.
+ *
+ * @see ScanEncoder
+ */
+class ScanDecoder
+{
+public:
+  ScanDecoder(const bool& simd = true);
+
+public:
+  /**
+   * @brief Decodes the next frame.
+   *
+   * After an error, e.g. because a frame was lost, only key frames are decoded till the next key frame arrives.
+   *
+   * @throws ScanCodecError if the frame is invalid or is a delta to a frame which was not decoded.
+   */
+  LaserScan decode(const char* data, const std::size_t& size);
+  LaserScan decode(const std::vector<char>& frame);
+  //! @returns the number of frames which could not be decoded.
+  std::size_t numberOfErrors() const;
+
+private:
+  LaserScan decodeFrame(const char* data, const std::size_t& size);
+  const char* copyValues(const char* begin,
+                         const char* end,
+                         const std::size_t& number_of_values,
+                         std::vector<uint16_t>& values);
+  const char* decodeValues(const char* begin,
+                           const char* end,
+                           const std::size_t& number_of_values,
+                           const bool& key_frame,
+                           const bool& bit_packing,
+                           std::vector<uint16_t>& values);
+
+private:
+  const bool simd_;
+  bool has_previous_frame_{ false };
+  uint32_t previous_sequence_number_{ 0 };
+  std::vector<uint16_t> measurements_;
+  std::vector<uint16_t> intensities_;
+  std::vector<uint32_t> zigzag_;
+  std::size_t errors_{ 0 };
+};
+
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_SCAN_CODEC_H
@@ -0,0 +1,202 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_SCAN_MERGER_H
+#define PSEN_SCAN_V2_STANDALONE_SCAN_MERGER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "psen_scan_v2_standalone/configuration/default_parameters.h"
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scanner_interface.h"
+
+namespace psen_scan_v2_standalone
+{
+/**
+ * @brief Pose of the mounting frame of a scanner in the common target frame (e.g. the base frame of the robot).
+ */
+struct MountingPose
+{
+  //! Position in meters.
+  double x{ 0. };
+  double y{ 0. };
+  //! Rotation around the z-axis in radian.
+  double yaw{ 0. };
+};
+
+/**
+ * @brief Describes where a scanner, whose scans are merged, is located.
+ */
+struct ScanMergerInput
+{
+  MountingPose mounting_pose{};
+  //! Offset (in radian) subtracted from the angles of the LaserScan to get the angles in the mounting frame.
+  //! It has the same meaning as the x_axis_rotation of the ROS driver.
+  double x_axis_rotation{ configuration::DEFAULT_X_AXIS_ROTATION };
+};
+
+/**
+ * @brief Points of multiple scans in the common target frame, sorted by ascending angle.
+ *
+ * The data are stored as one vector per attribute, i.e. the i-th point consists of angles[i], ranges[i], ...
+ */
+struct CompositeScan
+{
+  //! Angles in radian in the range [-pi, pi].
+  std::vector<double> angles;
+  //! Distances to the origin of the target frame in meters.
+  std::vector<double> ranges;
+  //! Intensities of the measurements. Measurements without intensity have the value NaN.
+  std::vector<double> intensities;
+  //! Cartesian coordinates in meters.
+  std::vector<double> x;
+  std::vector<double> y;
+  //! Index of the input the point originates from.
+  std::vector<std::size_t> sources;
+  //! Scan counter of the merged scan of each input.
+  std::vector<uint32_t> scan_counters;
+
+  std::size_t size() const;
+  void clear();
+};
+
+/**
+ * @brief Merges the scans of multiple scanners into a single composite scan.
+ *
+ * The measurements of each scan are transformed into the common target frame, based on the mounting pose and the
+ * x_axis_rotation of the scanner. The transformed points of each scan are sorted by angle, so that the scans can be
+ * merged with a k-way merge.
+ *
+ * The merger waits for one scan of each input. Scans which are older than the synchronization window compared to the
+ * newest scan are dropped, as well as scans whose scan counter is not newer than the last merged scan of the input.
+ * This way the composite scan always contains scans of the same scan rounds, even if the data of a scanner are lost.
+ * Scan counters are compared with wrap-around. A scan counter which is more than MAX_SCAN_COUNTER_DELAY rounds older
+ * than the last merged scan is considered as restart of the scanner, which resets the state of the input.
+ *
+ * Only complete scans can be merged, i.e. the scanners have to be configured without fragmented scans.
+ *
+ * Usage with multiple scanners:
+ * @code
+ * ScanMerger merger({ front_input, back_input }, std::chrono::milliseconds(15), composite_scan_callback);
+ * ScannerV2 front_scanner(front_config, merger.laserScanCallback(0));
+ * ScannerV2 back_scanner(back_config, merger.laserScanCallback(1));
+ * @endcode
+ */
+class ScanMerger
+{
+public:
+  using Clock = std::chrono::steady_clock;
+  using CompositeScanCallback = std::function<void(const CompositeScan&)>;
+
+  //! Maximal number of scan rounds a scan can be older than the last merged scan of its input and still be
+  //! considered as late scan (e.g. reordered by the network). Older scans indicate a restart of the scanner.
+  static constexpr uint32_t MAX_SCAN_COUNTER_DELAY{ 10 };
+
+public:
+  /**
+   * @param inputs Location of the scanners whose scans are merged. The index of an input is used in addScan().
+   * @param sync_window Maximal time between the arrival of the first and the last scan of a composite scan.
+   * @param composite_scan_callback Called with each composite scan, in the thread which added the last scan. The
+   * callback must not add scans itself.
+   */
+  ScanMerger(const std::vector<ScanMergerInput>& inputs,
+             const std::chrono::milliseconds& sync_window,
+             const CompositeScanCallback& composite_scan_callback);
+
+public:
+  /**
+   * @brief Adds the scan of the specified input. If there is a scan of each input, they are merged.
+   *
+   * This function is thread-safe, i.e. it can be called directly from the callbacks of multiple scanners.
+   *
+   * @throws std::invalid_argument if the scan is a fragment, i.e. another part of the pending or last merged scan round
+   * of the input.
+   */
+  void addScan(const std::size_t& input_index,
+               const LaserScan& scan,
+               const Clock::time_point& arrival_time = Clock::now());
+
+  //! @returns a callback for a scanner, which adds the scans of the scanner to the specified input.
+  IScanner::LaserScanCallback laserScanCallback(const std::size_t& input_index);
+
+  /**
+   * @brief Merges one scan per input without any synchronization.
+   *
+   * @note Not thread-safe. Must not be used concurrently with addScan().
+   */
+  void merge(const std::vector<LaserScan>& scans, CompositeScan& composite_scan);
+
+  std::size_t numberOfInputs() const;
+  //! @returns the number of scans which were dropped during the synchronization.
+  std::size_t numberOfDroppedScans() const;
+
+private:
+  struct InputState
+  {
+    explicit InputState(const ScanMergerInput& scan_merger_input);
+
+    const ScanMergerInput input;
+
+    // Cosines and sines of the measurement angles in the target frame, computed for the geometry of the last scan.
+    int16_t min_angle{ 0 };
+    int16_t resolution{ 0 };
+    std::vector<double> cosines;
+    std::vector<double> sines;
+
+    // Transformed points of the current scan and their indices in the order of ascending angles.
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> angles;
+    std::vector<double> ranges;
+    std::vector<std::size_t> order;
+
+    boost::optional<LaserScan> pending_scan;
+    Clock::time_point arrival_time;
+    boost::optional<uint32_t> last_merged_scan_counter;
+  };
+
+  struct MergeCursor
+  {
+    double angle;
+    std::size_t input_index;
+    std::size_t position;
+  };
+
+private:
+  void mergeScans(const std::vector<const LaserScan*>& scans, CompositeScan& composite_scan);
+  void transform(InputState& state, const LaserScan& scan);
+  void sortByAngle(InputState& state);
+  bool allScansPending() const;
+
+private:
+  std::vector<InputState> inputs_;
+  const std::chrono::milliseconds sync_window_;
+  const CompositeScanCallback composite_scan_callback_;
+
+  mutable std::mutex mutex_;
+  std::size_t number_of_dropped_scans_{ 0 };
+  std::vector<MergeCursor> heap_;
+  CompositeScan composite_scan_;
+};
+
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_SCAN_MERGER_H
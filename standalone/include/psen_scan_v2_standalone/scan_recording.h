@@ -0,0 +1,215 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_SCAN_RECORDING_H
+#define PSEN_SCAN_V2_STANDALONE_SCAN_RECORDING_H
+
+#ifdef __linux__
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scanner_interface.h"
+#include "psen_scan_v2_standalone/util/tenth_of_degree.h"
+
+namespace psen_scan_v2_standalone
+{
+/**
+ * @brief Exception thrown if a scan recording cannot be written or read.
+ */
+class ScanRecordingError : public std::runtime_error
+{
+public:
+  ScanRecordingError(const std::string& msg);
+};
+
+/**
+ * @brief Entry of the index of a scan recording.
+ */
+struct ScanIndexEntry
+{
+  //! @brief Time since the epoch of the system clock in nanoseconds.
+  uint64_t timestamp;
+  //! @brief Offset of the scan in the file.
+  uint64_t offset;
+  uint32_t scan_counter;
+  uint32_t reserved;
+};
+
+/**
+ * @brief Read-only view of a scan in a memory-mapped scan recording. Only valid as long as the reader exists.
+ */
+class ScanView
+{
+public:
+  explicit ScanView(const char* record);
+
+public:
+  std::chrono::nanoseconds timestamp() const;
+  uint32_t scanCounter() const;
+  util::TenthOfDegree scanResolution() const;
+  util::TenthOfDegree minScanAngle() const;
+  util::TenthOfDegree maxScanAngle() const;
+
+  //! @returns the number of measurements.
+  std::size_t size() const;
+  //! @returns the measurements in millimeters, as sent by the scanner.
+  const uint16_t* ranges() const;
+  //! @returns the number of intensities, which is 0 if the scan has none.
+  std::size_t numberOfIntensities() const;
+  //! @returns the intensities, as sent by the scanner.
+  const uint16_t* intensities() const;
+
+  //! @returns a copy of the scan.
+  LaserScan toLaserScan() const;
+
+private:
+  const char* record_;
+};
+
+/**
+ * @brief Writes LaserScans to a compact, seekable scan recording.
+ *
+ * A scan recording consists of a header of 64 bytes, the scans and an index. The header contains the magic
+ * "PSENSCNR", the format version as uint32, the number of scans and the offset of the index as uint64. Each scan is
+ * stored as a header of 32 bytes (timestamp, scan counter, size of the record, resolution, min and max scan angle,
+ * number of measurements and intensities) followed by the measurements in millimeters and the intensities as
+ * uint16, padded to 8 bytes. The index contains one ScanIndexEntry per scan. All integers are little endian.
+ *
+ * The header and the index are written on close(). A recording which was not closed (e.g. after a crash) can still
+ * be read, the reader rebuilds the index in that case.
+ *
+ * Usage with a scanner:
+ * @code
+ * ScanRecordingWriter writer("session.scans");
+ * ScannerV2 scanner(config, writer.laserScanCallback());
+ * @endcode
+ *
+ * @see ScanRecordingReader
+ */
+class ScanRecordingWriter
+{
+public:
+  //! @throws ScanRecordingError if the file cannot be opened.
+  ScanRecordingWriter(const std::string& filename);
+  //! @brief Closes the recording. Errors are logged.
+  ~ScanRecordingWriter();
+
+public:
+  /**
+   * @brief Appends the scan with the given time. Thread-safe.
+   *
+   * Measurements are rounded to millimeters. Measurements which cannot be represented (e.g. infinity) are stored as
+   * the maximal value.
+   *
+   * @throws ScanRecordingError if the recording is closed or cannot be written.
+   */
+  void write(const LaserScan& scan,
+             const std::chrono::nanoseconds& timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::system_clock::now().time_since_epoch()));
+  //! @returns a callback for a scanner, which writes each scan with its time of arrival.
+  IScanner::LaserScanCallback laserScanCallback();
+  //! @returns the number of written scans.
+  std::size_t numberOfScans() const;
+  //! @brief Writes the buffered scans to the file, e.g. to read a recording while it is written.
+  void flush();
+
+  /**
+   * @brief Writes the index and the header. Further scans cannot be written.
+   *
+   * @throws ScanRecordingError if the recording cannot be written.
+   */
+  void close();
+
+private:
+  void writeHeader(const uint64_t& index_offset);
+
+private:
+  const std::string filename_;
+  std::ofstream file_;
+  std::vector<char> write_buffer_;
+  std::vector<uint16_t> values_;
+  std::vector<ScanIndexEntry> index_;
+  uint64_t offset_{ 0 };
+  bool closed_{ false };
+  mutable std::mutex mutex_;
+};
+
+/**
+ * @brief Reads a scan recording via a read-only memory mapping, without copying the scans.
+ *
+ * The scans can be accessed by their position or found by their time or scan counter in O(log n).
+ *
+ * @see ScanRecordingWriter
+ */
+class ScanRecordingReader
+{
+public:
+  //! @throws ScanRecordingError if the file cannot be mapped or is no valid scan recording.
+  ScanRecordingReader(const std::string& filename);
+  ~ScanRecordingReader();
+
+  ScanRecordingReader(const ScanRecordingReader&) = delete;
+  ScanRecordingReader& operator=(const ScanRecordingReader&) = delete;
+
+public:
+  std::size_t size() const;
+  //! @returns the scan at the given position, the oldest scan has the position 0.
+  ScanView operator[](const std::size_t& position) const;
+  //! @throws std::out_of_range if there is no scan at the given position.
+  ScanView at(const std::size_t& position) const;
+
+  /**
+   * @returns the position of the first scan not older than the given time, or size() if there is none.
+   *
+   * Expects the scans to be written in the order of their time, like the scans of a scanner.
+   */
+  std::size_t findByTime(const std::chrono::nanoseconds& timestamp) const;
+  /**
+   * @returns the position of the first scan whose scan counter is not smaller than the given one, or size() if
+   * there is none.
+   *
+   * Expects the scans to be written in the order of their scan counter, like the scans of a scanner.
+   */
+  std::size_t findByScanCounter(const uint32_t& scan_counter) const;
+
+  //! @returns false if the recording was not closed by the writer and the index had to be rebuilt.
+  bool isComplete() const;
+
+private:
+  const ScanIndexEntry& entry(const std::size_t& position) const;
+  void rebuildIndex();
+
+private:
+  int fd_{ -1 };
+  std::size_t mapping_size_{ 0 };
+  const char* mapping_{ nullptr };
+  //! @brief Points into the mapping if the recording is complete, else to the rebuilt index.
+  const ScanIndexEntry* index_{ nullptr };
+  std::size_t size_{ 0 };
+  std::vector<ScanIndexEntry> rebuilt_index_;
+};
+
+}  // namespace psen_scan_v2_standalone
+
+#endif  // __linux__
+
+#endif  // PSEN_SCAN_V2_STANDALONE_SCAN_RECORDING_H
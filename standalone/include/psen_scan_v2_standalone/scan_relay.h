@@ -0,0 +1,203 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_SCAN_RELAY_H
+#define PSEN_SCAN_V2_STANDALONE_SCAN_RELAY_H
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "psen_scan_v2_standalone/configuration/default_parameters.h"
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scan_codec.h"
+#include "psen_scan_v2_standalone/scanner_interface.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+#include "psen_scan_v2_standalone/util/spsc_ring.h"
+
+namespace psen_scan_v2_standalone
+{
+/**
+ * @brief Exception thrown if the socket of a ScanRelay or ScanRelayReceiver cannot be set up.
+ */
+class ScanRelayError : public std::runtime_error
+{
+public:
+  ScanRelayError(const std::string& msg);
+};
+
+/**
+ * @brief Unicast or multicast address to which a ScanRelay sends the scans.
+ */
+struct ScanRelayDestination
+{
+  std::string ip;
+  unsigned short port;
+};
+
+/**
+ * @brief Options of the ScanRelay.
+ */
+struct ScanRelayOptions
+{
+  //! @brief Key frames every 10 scans (about 0.3 s), so that receivers recover quickly from lost datagrams.
+  ScanCodecOptions codec{ 10 };
+  //! @brief Number of encoded scans which can be queued for the sender thread.
+  std::size_t queue_capacity{ 64 };
+  //! @brief Time to live of multicast datagrams. 1 keeps them in the local network.
+  int multicast_ttl{ 1 };
+  //! @brief Address of the interface to send multicast datagrams from, e.g. "127.0.0.1". Empty for the default.
+  std::string multicast_interface{};
+  util::ThreadSettings thread_settings{ configuration::RELAY_THREAD_NAME };
+};
+
+/**
+ * @brief Forwards LaserScans to other hosts or processes via UDP, e.g. to several consumers at once via multicast.
+ *
+ * Each scan is sent as one datagram containing a frame of the ScanEncoder, i.e. a header with a sequence number
+ * followed by the measurements in millimeters and the intensities as uint16 values, which are delta encoded unless
+ * the compression is disabled (see ScanCodecOptions). The frames can be received with a ScanRelayReceiver.
+ *
+ * send() only encodes the scan into a reused slot of a lock-free queue, so it never blocks on the network. A
+ * dedicated thread sends all queued frames to all destinations with one sendmmsg() call. If the queue is full or a
+ * datagram cannot be sent, the scan is dropped and counted and the next frame is a key frame, so that the receivers
+ * can continue decoding.
+ *
+ * Usage with a scanner:
+ * @code
+ * ScanRelay relay({ { "239.255.0.1", 55200 } });
+ * ScannerV2 scanner(config, relay.laserScanCallback());
+ * @endcode
+ *
+ * @see ScanRelayReceiver
+ */
+class ScanRelay
+{
+public:
+  /**
+   * @throws std::invalid_argument if there are no destinations or an address is invalid.
+   * @throws ScanRelayError if the socket cannot be set up.
+   */
+  ScanRelay(const std::vector<ScanRelayDestination>& destinations,
+            const ScanRelayOptions& options = ScanRelayOptions());
+  //! @brief Sends all queued scans and closes the socket.
+  ~ScanRelay();
+
+public:
+  //! @brief Queues the scan for the sender thread. Never blocks. Must only be called by one thread at a time.
+  void send(const LaserScan& scan);
+  //! @returns a callback for a scanner, which sends each scan.
+  IScanner::LaserScanCallback laserScanCallback();
+  //! @returns the number of datagrams sent, i.e. the number of sent scans times the number of destinations.
+  uint64_t numberOfSentDatagrams() const;
+  //! @returns the number of datagrams dropped because the queue was full or sending failed.
+  uint64_t numberOfDroppedDatagrams() const;
+
+private:
+  void sendLoop();
+  //! @brief Sends the given number of frames of the batch to all destinations.
+  void sendBatch(const std::size_t& number_of_frames);
+
+private:
+  const ScanRelayOptions options_;
+  std::vector<sockaddr_in> destinations_;
+  int fd_{ -1 };
+  ScanEncoder encoder_;
+  util::SpscRing<std::vector<char>> queue_;
+  //! @brief Frames taken from the queue by the sender thread. They are swapped with the slots to keep the buffers.
+  std::vector<std::vector<char>> batch_;
+  std::vector<iovec> iovecs_;
+  std::vector<mmsghdr> messages_;
+  //! @brief Set by the sender thread if a datagram was dropped, the next frame is a key frame then.
+  std::atomic_bool key_frame_requested_{ false };
+  std::atomic<uint64_t> sent_datagrams_{ 0 };
+  std::atomic<uint64_t> dropped_datagrams_{ 0 };
+  std::atomic_bool terminated_{ false };
+  std::thread sender_thread_;
+};
+
+/**
+ * @brief Receives the scans sent by one or more ScanRelays.
+ *
+ * The datagrams are received in batches with recvmmsg() by a thread of its own, which decodes them and calls the
+ * handler. The frames of each sender are decoded separately. After a lost datagram, the frames of the sender are
+ * dropped till its next key frame.
+ *
+ * @see ScanRelay
+ */
+class ScanRelayReceiver
+{
+public:
+  using ScanHandler = std::function<void(const LaserScan&)>;
+
+  /**
+   * @param port UDP port to receive on, from all interfaces.
+   * @param handler Handler called with each decoded scan by the receiver thread.
+   * @param multicast_group If not empty, the multicast group to join, e.g. "239.255.0.1".
+   * @param multicast_interface Address of the interface to join the group on. Empty for the default.
+   * @param thread_settings Name, priority and cpu affinity of the receiver thread.
+   *
+   * @throws std::invalid_argument if an address is invalid.
+   * @throws ScanRelayError if the socket cannot be set up.
+   */
+  ScanRelayReceiver(const unsigned short& port,
+                    const ScanHandler& handler,
+                    const std::string& multicast_group = "",
+                    const std::string& multicast_interface = "",
+                    const util::ThreadSettings& thread_settings = { configuration::RELAY_RECEIVER_THREAD_NAME });
+  //! @brief Stops the receiver thread and closes the socket.
+  ~ScanRelayReceiver();
+
+public:
+  //! @returns the number of decoded scans.
+  uint64_t numberOfReceivedScans() const;
+  //! @returns the number of datagrams which could not be decoded, e.g. because a previous datagram was lost.
+  uint64_t numberOfDecodeErrors() const;
+
+private:
+  void receiveLoop();
+  void decode(const uint64_t& sender, const char* data, const std::size_t& size);
+
+private:
+  const ScanHandler handler_;
+  int fd_{ -1 };
+  std::vector<char> buffer_;
+  std::vector<sockaddr_in> senders_;
+  std::vector<iovec> iovecs_;
+  std::vector<mmsghdr> messages_;
+  //! @brief Decoders per address and port of the sender.
+  std::map<uint64_t, ScanDecoder> decoders_;
+  std::atomic<uint64_t> received_scans_{ 0 };
+  std::atomic<uint64_t> decode_errors_{ 0 };
+  std::atomic_bool terminated_{ false };
+  std::thread receiver_thread_;
+};
+
+}  // namespace psen_scan_v2_standalone
+
+#endif  // __linux__
+
+#endif  // PSEN_SCAN_V2_STANDALONE_SCAN_RELAY_H
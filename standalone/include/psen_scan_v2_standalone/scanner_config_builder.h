@@ -16,6 +16,7 @@
 #ifndef PSEN_SCAN_V2_STANDALONE_SCANNER_CONFIG_BUILDER_H
 #define PSEN_SCAN_V2_STANDALONE_SCANNER_CONFIG_BUILDER_H
 
+#include <chrono>
 #include <cmath>
 #include <stdexcept>
 #include <string>
@@ -23,7 +24,9 @@
 #include "psen_scan_v2_standalone/scanner_configuration.h"
 #include "psen_scan_v2_standalone/scan_range.h"
 #include "psen_scan_v2_standalone/data_conversion_layer/angle_conversions.h"
+#include "psen_scan_v2_standalone/util/executor.h"
 #include "psen_scan_v2_standalone/util/ip_conversion.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
 
 namespace psen_scan_v2_standalone
 {
@@ -48,6 +51,107 @@ public:
   ScannerConfigurationBuilder& enableDiagnostics(const bool&);
   ScannerConfigurationBuilder& enableIntensities(const bool&);
   ScannerConfigurationBuilder& enableFragmentedScans(const bool&);
+  /**
+   * @brief Sets name, real-time priority and cpu affinity of all threads with the specified role.
+   *
+   * The settings are applied when the threads are created. The io role covers the data and the control client,
+   * the thread of the control client gets the suffix "_ctrl" appended to its name.
+   */
+  ScannerConfigurationBuilder& threadSettings(const util::ThreadRole&, const util::ThreadSettings&);
+  /**
+   * @brief Locks all current and future pages of the process into RAM via mlockall() when the scanner is started.
+   *
+   * The kernel maps the pages of later allocations right away then, so the buffers do not cause page faults on the
+   * hot path.
+   */
+  ScannerConfigurationBuilder& enableMemoryLocking(const bool&);
+  /**
+   * @brief Deserializes and assembles the monitoring frames in two separate threads with the role "dispatcher".
+   *
+   * The io thread of the data client then only copies the received datagrams into a queue.
+   * Has no effect if the scanner shares its threads with other scanners (see ScannerManager).
+   */
+  ScannerConfigurationBuilder& enablePipelinedProcessing(const bool&);
+  /**
+   * @brief Records the hardware performance counters (cycles, instructions, cache and branch misses) of the
+   * deserialization and the conversion into laser scans.
+   *
+   * Costs two system calls per stage and monitoring frame. If the counters are not permitted or not supported the
+   * executions are only counted as unavailable.
+   *
+   * @see ScannerV2::getStatistics()
+   */
+  ScannerConfigurationBuilder& enablePerfCounters(const bool&);
+  /**
+   * @brief Shortens the time until the first laser scan, e.g. after the scanners were power-cycled.
+   *
+   * The start request is repeated after 50 ms and then with doubling timeouts up to the regular timeout of 1 s,
+   * instead of only once per second. Duplicate start replies caused by the repetitions are ignored with a warning.
+   * Additionally, the incomplete first scan round, which starts in the middle of the scan range, is passed to the
+   * user as soon as the next round starts instead of being dropped. Has no effect on fragmented scans, since they
+   * are passed on immediately anyway.
+   */
+  ScannerConfigurationBuilder& enableFastStart(const bool&);
+  /**
+   * @brief Receives the monitoring frames via io_uring instead of Boost.Asio.
+   *
+   * The kernel writes the datagrams directly into a pool of receive buffers with a single multishot receive, so no
+   * system call is needed per monitoring frame. Requires Linux 6.0 and a driver built with ENABLE_IO_URING. Otherwise,
+   * and if the scanner shares its threads with other scanners (see ScannerManager), Boost.Asio is used with a warning.
+   *
+   * @see communication_layer::UringUdpClient
+   */
+  ScannerConfigurationBuilder& enableIoUring(const bool&);
+  /**
+   * @brief Runs the laser scan callback via the specified executor, e.g. a thread pool or a ROS callback queue.
+   *
+   * Each call posts one task holding a copy of the laser scan. The tasks of a scanner are serialized (see
+   * util::serialExecutor()), i.e. the callback of a scanner is never run concurrently and receives the scans in the
+   * order of their arrival, even if the executor is multi-threaded. The tasks may still run after the scanner has been
+   * destroyed, they do not access the scanner. By default (or if an empty executor is passed) the callback is called
+   * inline by the thread processing the monitoring frames, which gives the minimal latency.
+   *
+   * @see util::ioServiceExecutor()
+   */
+  ScannerConfigurationBuilder& callbackExecutor(const util::Executor&);
+  /**
+   * @brief Enables the util::Tracer when the scanner is created and writes the recorded spans as Chrome trace JSON to
+   * the specified file when the scanner is destroyed.
+   *
+   * The tracer is shared by all scanners of the process, so the file contains the spans of all of them. The spans
+   * are dropped when the last tracing scanner is destroyed.
+   */
+  ScannerConfigurationBuilder& traceFile(const std::string&);
+  /**
+   * @brief Records all datagrams of the data connection with their kernel receive timestamps to the specified file.
+   *
+   * A pcap file is written if the name ends with ".pcap", else a raw datagram log. The file is written by a
+   * background thread and is complete once the scanner is destroyed. Recordings can be played back with the
+   * ReplayScanner.
+   *
+   * @note Only supported on Linux. On other platforms the option is ignored with a warning.
+   *
+   * @see communication_layer::DatagramRecorder
+   */
+  ScannerConfigurationBuilder& recordDatagrams(const std::string&);
+  /**
+   * @brief Keeps the monitoring frames of the given duration in a memory-mapped ring in the specified file.
+   *
+   * Unlike recordDatagrams(), nothing is written to disk by the driver, but the file always contains the latest
+   * monitoring frames, even after a crash of the process. It can be played back with the ReplayScanner.
+   *
+   * @note Only supported on Linux. On other platforms the option is ignored with a warning.
+   *
+   * @see communication_layer::FlightRecorder
+   * @see ScannerV2::writeFlightRecorderSnapshot()
+   */
+  ScannerConfigurationBuilder& flightRecorder(const std::string&,
+                                              const std::chrono::seconds& = configuration::FLIGHT_RECORDER_DURATION);
+  /**
+   * @brief Writes a snapshot of the flight recorder each time the process receives the specified signal, e.g.
+   * SIGUSR1. The snapshots are written next to the file of the flight recorder.
+   */
+  ScannerConfigurationBuilder& snapshotFlightRecorderOnSignal(const int&);
 
 private:
   static uint16_t convertPort(const int& port);
@@ -143,6 +247,87 @@ inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::enableFragmente
   config_.fragmented_scans_ = enable;
   return *this;
 }
+
+inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::threadSettings(const util::ThreadRole& role,
+                                                                                const util::ThreadSettings& settings)
+{
+  if (settings.name.size() > util::MAX_THREAD_NAME_LENGTH)
+  {
+    throw std::invalid_argument("Thread names must not be longer than " +
+                                std::to_string(util::MAX_THREAD_NAME_LENGTH) + " characters.");
+  }
+  if (settings.fifo_priority &&
+      (*settings.fifo_priority < util::MIN_FIFO_PRIORITY || *settings.fifo_priority > util::MAX_FIFO_PRIORITY))
+  {
+    throw std::invalid_argument("Real-time priority has to be between " + std::to_string(util::MIN_FIFO_PRIORITY) +
+                                " and " + std::to_string(util::MAX_FIFO_PRIORITY) + ".");
+  }
+  config_.thread_settings_.at(static_cast<std::size_t>(role)) = settings;
+  return *this;
+}
+
+inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::enableMemoryLocking(const bool& enable = true)
+{
+  config_.memory_locking_ = enable;
+  return *this;
+}
+
+inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::enablePipelinedProcessing(const bool& enable = true)
+{
+  config_.pipelined_processing_ = enable;
+  return *this;
+}
+
+inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::enablePerfCounters(const bool& enable = true)
+{
+  config_.perf_counters_ = enable;
+  return *this;
+}
+
+inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::enableFastStart(const bool& enable = true)
+{
+  config_.fast_start_ = enable;
+  return *this;
+}
+
+inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::enableIoUring(const bool& enable = true)
+{
+  config_.io_uring_ = enable;
+  return *this;
+}
+
+inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::callbackExecutor(const util::Executor& executor)
+{
+  config_.callback_executor_ = executor;
+  return *this;
+}
+
+inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::traceFile(const std::string& file_name)
+{
+  config_.trace_file_ = file_name;
+  return *this;
+}
+
+inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::recordDatagrams(const std::string& file_name)
+{
+  config_.datagram_recording_file_ = file_name;
+  return *this;
+}
+
+inline ScannerConfigurationBuilder& ScannerConfigurationBuilder::flightRecorder(const std::string& file_name,
+                                                                               const std::chrono::seconds& duration)
+{
+  config_.flight_recorder_file_ = file_name;
+  config_.flight_recorder_duration_ = duration;
+  return *this;
+}
+
+inline ScannerConfigurationBuilder&
+ScannerConfigurationBuilder::snapshotFlightRecorderOnSignal(const int& signal_number)
+{
+  config_.flight_recorder_snapshot_signal_ = signal_number;
+  return *this;
+}
 }  // namespace psen_scan_v2_standalone
 
 #endif  // PSEN_SCAN_V2_STANDALONE_SCANNER_CONFIG_BUILDER_H
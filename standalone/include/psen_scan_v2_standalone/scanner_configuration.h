@@ -15,10 +15,16 @@
 #ifndef PSEN_SCAN_V2_STANDALONE_SCANNER_CONFIGURATION_H
 #define PSEN_SCAN_V2_STANDALONE_SCANNER_CONFIGURATION_H
 
+#include <array>
+#include <chrono>
+#include <string>
+
 #include <boost/optional.hpp>
 
 #include "psen_scan_v2_standalone/configuration/default_parameters.h"
+#include "psen_scan_v2_standalone/util/executor.h"
 #include "psen_scan_v2_standalone/util/logging.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
 #include "psen_scan_v2_standalone/scan_range.h"
 
 namespace psen_scan_v2_standalone
@@ -53,6 +59,25 @@ public:
 
   bool fragmentedScansEnabled() const;
 
+  const util::ThreadSettings& threadSettings(const util::ThreadRole& role) const;
+  bool memoryLockingEnabled() const;
+  bool pipelinedProcessingEnabled() const;
+  bool perfCountersEnabled() const;
+  bool fastStartEnabled() const;
+  bool ioUringEnabled() const;
+  //! @returns the executor running the laser scan callback. An empty executor means the callback is called inline.
+  const util::Executor& callbackExecutor() const;
+  //! @returns the file to which the trace of the hot path is written on destruction of the scanner, if any.
+  const boost::optional<std::string>& traceFile() const;
+  //! @returns the file to which the received monitoring frames are recorded, if any.
+  const boost::optional<std::string>& datagramRecordingFile() const;
+  //! @returns the file of the flight recorder keeping the latest monitoring frames, if any.
+  const boost::optional<std::string>& flightRecorderFile() const;
+  //! @returns the duration of the monitoring frames kept by the flight recorder.
+  const std::chrono::seconds& flightRecorderDuration() const;
+  //! @returns the signal on which the flight recorder writes a snapshot, if any.
+  const boost::optional<int>& flightRecorderSnapshotSignal() const;
+
   void setHostIp(const uint32_t& host_ip);
 
 private:
@@ -76,6 +101,23 @@ private:
   bool diagnostics_enabled_{ configuration::DIAGNOSTICS };
   bool intensities_enabled_{ configuration::INTENSITIES };
   bool fragmented_scans_{ configuration::FRAGMENTED_SCANS };
+
+  std::array<util::ThreadSettings, util::NUMBER_OF_THREAD_ROLES> thread_settings_{
+    { { configuration::IO_THREAD_NAME },
+      { configuration::WATCHDOG_THREAD_NAME },
+      { configuration::DISPATCHER_THREAD_NAME } }
+  };
+  bool memory_locking_{ configuration::MEMORY_LOCKING };
+  bool pipelined_processing_{ configuration::PIPELINED_PROCESSING };
+  bool perf_counters_{ configuration::PERF_COUNTERS };
+  bool fast_start_{ configuration::FAST_START };
+  bool io_uring_{ configuration::IO_URING };
+  util::Executor callback_executor_{};
+  boost::optional<std::string> trace_file_{};
+  boost::optional<std::string> datagram_recording_file_{};
+  boost::optional<std::string> flight_recorder_file_{};
+  std::chrono::seconds flight_recorder_duration_{ configuration::FLIGHT_RECORDER_DURATION };
+  boost::optional<int> flight_recorder_snapshot_signal_{};
 };
 
 inline bool ScannerConfiguration::isComplete() const
@@ -90,6 +132,16 @@ inline bool ScannerConfiguration::isValid() const
     PSENSCAN_ERROR("ScannerConfiguration", "Requires a resolution of min: 0.2 degree when intensities are enabled");
     return false;
   }
+  if (flight_recorder_file_ && flight_recorder_duration_ <= std::chrono::seconds(0))
+  {
+    PSENSCAN_ERROR("ScannerConfiguration", "Requires a positive duration of the flight recorder");
+    return false;
+  }
+  if (flight_recorder_snapshot_signal_ && !flight_recorder_file_)
+  {
+    PSENSCAN_ERROR("ScannerConfiguration", "Requires a flight recorder to write snapshots on a signal");
+    return false;
+  }
   return true;
 }
 
@@ -148,6 +200,66 @@ inline bool ScannerConfiguration::fragmentedScansEnabled() const
   return fragmented_scans_;
 }
 
+inline const util::ThreadSettings& ScannerConfiguration::threadSettings(const util::ThreadRole& role) const
+{
+  return thread_settings_.at(static_cast<std::size_t>(role));
+}
+
+inline bool ScannerConfiguration::memoryLockingEnabled() const
+{
+  return memory_locking_;
+}
+
+inline bool ScannerConfiguration::pipelinedProcessingEnabled() const
+{
+  return pipelined_processing_;
+}
+
+inline bool ScannerConfiguration::perfCountersEnabled() const
+{
+  return perf_counters_;
+}
+
+inline bool ScannerConfiguration::fastStartEnabled() const
+{
+  return fast_start_;
+}
+
+inline bool ScannerConfiguration::ioUringEnabled() const
+{
+  return io_uring_;
+}
+
+inline const util::Executor& ScannerConfiguration::callbackExecutor() const
+{
+  return callback_executor_;
+}
+
+inline const boost::optional<std::string>& ScannerConfiguration::traceFile() const
+{
+  return trace_file_;
+}
+
+inline const boost::optional<std::string>& ScannerConfiguration::datagramRecordingFile() const
+{
+  return datagram_recording_file_;
+}
+
+inline const boost::optional<std::string>& ScannerConfiguration::flightRecorderFile() const
+{
+  return flight_recorder_file_;
+}
+
+inline const std::chrono::seconds& ScannerConfiguration::flightRecorderDuration() const
+{
+  return flight_recorder_duration_;
+}
+
+inline const boost::optional<int>& ScannerConfiguration::flightRecorderSnapshotSignal() const
+{
+  return flight_recorder_snapshot_signal_;
+}
+
 inline void ScannerConfiguration::setHostIp(const uint32_t& host_ip)
 {
   host_ip_ = host_ip;
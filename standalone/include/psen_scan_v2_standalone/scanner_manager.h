@@ -0,0 +1,95 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_SCANNER_MANAGER_H
+#define PSEN_SCAN_V2_STANDALONE_SCANNER_MANAGER_H
+
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "psen_scan_v2_standalone/configuration/default_parameters.h"
+#include "psen_scan_v2_standalone/scanner_configuration.h"
+#include "psen_scan_v2_standalone/scanner_interface.h"
+#include "psen_scan_v2_standalone/scanner_v2.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+#include "psen_scan_v2_standalone/util/thread_pool.h"
+
+namespace psen_scan_v2_standalone
+{
+/**
+ * @brief Owns multiple scanners which share a fixed number of threads.
+ *
+ * Instead of two io_service threads per ScannerV2, all UDP clients are served by one io thread, which only receives
+ * the data. The processing of the data (deserialization, scan assembly and the user callbacks) happens on a
+ * work-stealing thread pool, i.e. the data of any scanner are processed by whichever worker is free. The data of
+ * one scanner are always processed in the order of arrival.
+ *
+ * The number of threads therefore scales with the number of cores instead of the number of scanners.
+ *
+ * @note The watchdogs of the scanners still use their own threads.
+ *
+ * @see ScannerV2
+ * @see util::ThreadPool
+ */
+class ScannerManager
+{
+public:
+  /**
+   * @param num_worker_threads Number of threads processing the scanner data.
+   * @param io_thread_settings Settings of the thread receiving the data of all scanners.
+   * @param worker_thread_settings Settings of the worker threads. The index of the worker is appended to the name.
+   */
+  explicit ScannerManager(
+      const std::size_t& num_worker_threads = util::ThreadPool::defaultNumberOfThreads(),
+      const util::ThreadSettings& io_thread_settings = util::ThreadSettings{ configuration::IO_THREAD_NAME },
+      const util::ThreadSettings& worker_thread_settings = util::ThreadSettings{ configuration::DISPATCHER_THREAD_NAME });
+  ~ScannerManager();
+
+public:
+  /**
+   * @brief Creates a new scanner. Each scanner needs its own host ports.
+   *
+   * @returns the new scanner. It is valid as long as the manager exists.
+   */
+  IScanner& addScanner(const ScannerConfiguration& scanner_config, const IScanner::LaserScanCallback& laser_scan_cb);
+
+  //! @brief Starts all scanners. @returns one future per scanner, in the order in which the scanners were added.
+  std::vector<std::future<void>> startAll();
+  //! @brief Stops all scanners. @returns one future per scanner, in the order in which the scanners were added.
+  std::vector<std::future<void>> stopAll();
+
+  IScanner& scanner(const std::size_t& index);
+  std::size_t numberOfScanners() const;
+  std::size_t numberOfWorkerThreads() const;
+
+private:
+  boost::asio::io_service io_service_;
+  // Prevent the run() method of the io_service from returning when there is no more work.
+  boost::asio::io_service::work work_{ io_service_ };
+  std::thread io_thread_;
+
+  util::ThreadPool worker_pool_;
+
+  // Note: The scanners must be declared last to ensure that they are destroyed before the threads they depend on.
+  std::vector<std::unique_ptr<ScannerV2>> scanners_;
+};
+
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_SCANNER_MANAGER_H
@@ -0,0 +1,44 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_SCANNER_STATISTICS_H
+#define PSEN_SCAN_V2_STANDALONE_SCANNER_STATISTICS_H
+
+#include "psen_scan_v2_standalone/protocol_layer/latency_histograms.h"
+#include "psen_scan_v2_standalone/protocol_layer/monitoring_frame_pipeline.h"
+#include "psen_scan_v2_standalone/protocol_layer/protocol_statistics.h"
+#include "psen_scan_v2_standalone/protocol_layer/stage_perf_counters.h"
+
+namespace psen_scan_v2_standalone
+{
+/**
+ * @brief Snapshot of the runtime statistics of a scanner.
+ *
+ * @see ScannerV2::getStatistics()
+ */
+struct ScannerStatistics
+{
+  //! Health counters of the protocol. Cheap enough to be polled at a high rate (e.g. for alerting on packet loss).
+  protocol_layer::ProtocolStatistics protocol;
+  //! Latencies of the processing stages since the creation of the scanner.
+  protocol_layer::LatencyStatistics latencies;
+  //! Hardware performance counters of the cpu intensive stages. All values are zero unless enabled.
+  protocol_layer::PerfCounterStatistics perf_counters;
+  //! Queues of the pipelined processing. All values are zero if the pipelined processing is disabled.
+  protocol_layer::PipelineStatistics pipeline;
+};
+
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_SCANNER_STATISTICS_H
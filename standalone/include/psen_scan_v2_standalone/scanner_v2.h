@@ -19,13 +19,23 @@
 #include <mutex>
 #include <future>
 #include <functional>
+#include <string>
 
 #include <boost/optional.hpp>
 
+#ifdef __linux__
+#include "psen_scan_v2_standalone/communication_layer/flight_recorder.h"
+#endif
 #include "psen_scan_v2_standalone/scanner_interface.h"
+#include "psen_scan_v2_standalone/scanner_statistics.h"
+#include "psen_scan_v2_standalone/protocol_layer/latency_histograms.h"
+#include "psen_scan_v2_standalone/protocol_layer/monitoring_frame_pipeline.h"
 #include "psen_scan_v2_standalone/protocol_layer/scanner_events.h"
 #include "psen_scan_v2_standalone/protocol_layer/scanner_state_machine.h"
+#include "psen_scan_v2_standalone/protocol_layer/stage_perf_counters.h"
 
+#include "psen_scan_v2_standalone/util/executor.h"
+#include "psen_scan_v2_standalone/util/tracing.h"
 #include "psen_scan_v2_standalone/util/watchdog.h"
 
 /**
@@ -61,17 +71,92 @@ class ScannerV2 : public IScanner
 {
 public:
   ScannerV2(const ScannerConfiguration& scanner_config, const LaserScanCallback& laser_scan_cb);
+
+  /**
+   * @brief Creates a scanner which shares the threads for receiving and processing data with other scanners.
+   *
+   * The UDP clients are served by the specified io_service, which does nothing but receiving the data. All incoming
+   * data are processed via the specified executor. The processing is serialized per scanner, therefore, no
+   * additional synchronization is needed by the executor.
+   *
+   * @param io_service io_service which has to be run by exactly one thread and has to outlive the scanner.
+   * @param executor Executor (usually a thread pool) which has to outlive the scanner.
+   *
+   * @see ScannerManager
+   */
+  ScannerV2(const ScannerConfiguration& scanner_config,
+            const LaserScanCallback& laser_scan_cb,
+            boost::asio::io_service& io_service,
+            const util::Executor& executor);
   ~ScannerV2();
 
 public:
   std::future<void> start() override;
   std::future<void> stop() override;
 
+  /**
+   * @returns the protocol counters, the latencies of the processing stages and the state of the pipeline queues.
+   *
+   * The latencies are recorded for every monitoring frame with a few relaxed atomic operations. Taking the snapshot
+   * does not lock the scanner, so it can be called periodically from any thread.
+   *
+   * @see ScannerConfigurationBuilder::enablePipelinedProcessing()
+   */
+  ScannerStatistics getStatistics() const;
+
+  /**
+   * @returns only the protocol counters (frames, rounds, drops, errors). This reads a dozen atomic counters and no
+   * histograms. The datagrams dropped by the kernel are queried from the socket with a getsockopt() system call, so
+   * each call costs about as much as a system call. It can be called from any thread.
+   */
+  protocol_layer::ProtocolStatistics getProtocolStatistics() const;
+
+  /**
+   * @brief Writes the monitoring frames kept by the flight recorder to a raw datagram log.
+   *
+   * Does not lock the receive path, so it can be called at any time, e.g. after an emergency stop.
+   *
+   * @throws std::logic_error if no flight recorder is configured or the platform is not Linux.
+   * @throws std::runtime_error if the file cannot be written.
+   * @see ScannerConfigurationBuilder::flightRecorder()
+   */
+  void writeFlightRecorderSnapshot(const std::string& filename) const;
+
 private:
   // Raw pointer used here because "msm::back::state_machine" cannot properly pass
   // a "std::unique_ptr" to "msm::front::state_machine_def".
   StateMachineArgs* createStateMachineArgs();
 
+  std::unique_ptr<communication_layer::UdpClientImpl>
+  createUdpClient(const communication_layer::NewDataHandler& data_handler,
+                  const communication_layer::ErrorHandler& error_handler,
+                  const unsigned short& host_port,
+                  const unsigned short& endpoint_port,
+                  const util::ThreadSettings& thread_settings,
+                  const std::size_t& max_datagram_size);
+
+  //! @returns the UDP client of the monitoring frames, receiving them via io_uring if configured and possible.
+  std::unique_ptr<communication_layer::IUdpClient> createDataClient();
+  //! @brief Attaches the socket filter and the taps recording the datagrams and feeding the flight recorder.
+  template <typename Client>
+  void setUpDataClient(Client& data_client);
+  std::unique_ptr<protocol_layer::MonitoringFramePipeline> createPipeline();
+  communication_layer::NewDataHandler createMonitoringFrameHandler();
+  //! @returns the laser scan callback of the user, wrapped so that it is run by the configured callback executor.
+  LaserScanCallback createLaserScanCallback() const;
+  //! @brief Enables the tracer if a trace file is configured.
+  void enableTracing() const;
+  //! @brief Writes the trace to the configured trace file, if any, and disables the tracer for this scanner.
+  void writeTrace() const;
+
+  //! @brief Runs the task directly or, if the scanner shares its threads, on the strand of the scanner.
+  void dispatch(const std::function<void()>& task);
+
+  template <class T>
+  void triggerRawDataEvent(const data_conversion_layer::RawData& data,
+                           const std::size_t& num_bytes,
+                           const util::LatencyClock::time_point& receive_time);
+
   template <class T>
   void triggerEventWithParam(const T& event);
 
@@ -95,7 +180,7 @@ private:
   {
   public:
     WatchdogFactory(ScannerV2* scanner);
-    std::unique_ptr<util::Watchdog> create(const util::Watchdog::Timeout& timeout,
+    std::unique_ptr<util::Watchdog> create(const util::Watchdog::Schedule& schedule,
                                            const std::string& event_type) override;
 
   private:
@@ -114,15 +199,52 @@ private:
   //! - user-main-thread
   //! - io_service thread of UDPClient
   //! - watchdog threads
+  //! - worker threads of the executor (if the scanner shares its threads)
+  //! - assembly thread of the pipeline (if the pipelined processing is enabled)
   std::mutex member_mutex_;
 
+  //! @brief Written by the threads processing the data and read lock-free by getStatistics().
+  protocol_layer::LatencyHistograms latency_histograms_;
+  //! @brief Written by the threads processing the data and read lock-free by getStatistics().
+  protocol_layer::StagePerfCounters perf_counters_;
+
+  //! @brief Only set if the scanner shares its threads with other scanners.
+  boost::asio::io_service* shared_io_service_{ nullptr };
+  //! @brief Only set if the scanner shares its threads with other scanners.
+  std::unique_ptr<util::Strand> strand_;
+  //! @brief Only set if the pipelined processing is enabled. Must outlive the data client feeding it.
+  std::unique_ptr<protocol_layer::MonitoringFramePipeline> pipeline_;
+#ifdef __linux__
+  //! @brief Only set if the flight recorder is configured. Shared with the data client, which fills it.
+  std::shared_ptr<communication_layer::FlightRecorder> flight_recorder_;
+#endif
+
   std::unique_ptr<ScannerStateMachine> sm_;
 };
 
+template <class T>
+void ScannerV2::triggerRawDataEvent(const data_conversion_layer::RawData& data,
+                                    const std::size_t& num_bytes,
+                                    const util::LatencyClock::time_point& receive_time)
+{
+  if (!strand_)
+  {
+    triggerEventWithParam(T(data, num_bytes, receive_time));
+    return;
+  }
+  // The receive buffer is reused by the UDP client as soon as this function returns.
+  const auto data_copy{ std::make_shared<const data_conversion_layer::RawData>(data.cbegin(),
+                                                                              data.cbegin() + num_bytes) };
+  strand_->post([this, data_copy, receive_time]() {
+    triggerEventWithParam(T(*data_copy, data_copy->size(), receive_time));
+  });
+}
+
 template <class T>
 void ScannerV2::triggerEventWithParam(const T& event)
 {
   const std::lock_guard<std::mutex> lock(member_mutex_);
+  PSENSCAN_TRACE_SPAN("process_event");
   sm_->process_event(event);
 }
 
@@ -0,0 +1,198 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_SCANNER_SIMULATOR_H
+#define PSEN_SCAN_V2_STANDALONE_SCANNER_SIMULATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/optional.hpp>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/raw_scanner_data.h"
+#include "psen_scan_v2_standalone/scan_range.h"
+#include "psen_scan_v2_standalone/util/tenth_of_degree.h"
+
+namespace psen_scan_v2_standalone
+{
+/**
+ * @brief Contains the simulation of the scanner device, which allows to run the driver without hardware.
+ */
+namespace simulation
+{
+//! Number of monitoring frames the scanner sends per scan round, independent of the scan range.
+static constexpr std::size_t FRAMES_PER_SCAN_ROUND{ 6 };
+//! Scan rate of the real scanner.
+static constexpr double DEFAULT_SCAN_RATE_HZ{ 33. };
+
+/**
+ * @brief Settings of a start request which determine the monitoring frames sent by the scanner.
+ */
+struct StartRequestSettings
+{
+  std::string host_ip;
+  unsigned short host_data_port{ 0 };
+  ScanRange scan_range{ ScanRange::createInvalidScanRange() };
+  util::TenthOfDegree resolution{ 0 };
+  bool intensities_enabled{ false };
+  bool diagnostics_enabled{ false };
+};
+
+//! @brief Exception thrown if a received control message cannot be parsed.
+class ControlMessageFailure : public std::runtime_error
+{
+public:
+  ControlMessageFailure(const std::string& msg);
+};
+
+/**
+ * @brief Parses a serialized start request.
+ *
+ * @see data_conversion_layer::start_request::serialize()
+ * @throws ControlMessageFailure if the data is no valid start request.
+ */
+StartRequestSettings parseStartRequest(const data_conversion_layer::RawData& data);
+
+//! @brief Position of one monitoring frame within a scan round.
+struct FrameLayout
+{
+  util::TenthOfDegree from_theta;
+  std::size_t number_of_measurements;
+};
+
+/**
+ * @returns the monitoring frames the scanner sends for each scan round of the specified scan range and resolution.
+ *
+ * Like the scanner, the maximal scan range is split into FRAMES_PER_SCAN_ROUND equal sectors and each frame contains
+ * the measurements of the requested scan range within its sector. Frames of sectors outside of the scan range are
+ * sent without measurements.
+ */
+std::vector<FrameLayout> computeFrameLayout(const ScanRange& scan_range, const util::TenthOfDegree& resolution);
+
+/**
+ * @brief Behavior of the simulated scanner which differs from a real scanner on a perfect network.
+ */
+struct SimulationParameters
+{
+  //! Scan rounds per second.
+  double scan_rate_hz{ DEFAULT_SCAN_RATE_HZ };
+  //! Each frame is delayed by a random duration between zero and the jitter.
+  std::chrono::microseconds jitter{ 0 };
+  //! Probability of a frame not being sent.
+  double loss_probability{ 0. };
+  //! Probability of a frame being sent after its successor.
+  double reorder_probability{ 0. };
+  //! Report a diagnostic error in each frame if the diagnostics are enabled by the start request.
+  bool diagnostic_errors{ false };
+  //! Seed of the random generator for jitter, loss and reordering.
+  unsigned int seed{ 0 };
+};
+
+/**
+ * @brief Counters of a ScannerSimulator.
+ */
+struct SimulatorStatistics
+{
+  uint64_t start_requests{ 0 };
+  uint64_t stop_requests{ 0 };
+  uint64_t scan_rounds{ 0 };
+  uint64_t sent_frames{ 0 };
+  //! Frames dropped according to SimulationParameters::loss_probability.
+  uint64_t lost_frames{ 0 };
+  //! Frames swapped with their successor according to SimulationParameters::reorder_probability.
+  uint64_t reordered_frames{ 0 };
+};
+
+/**
+ * @brief Simulates one scanner on the network.
+ *
+ * The simulator listens for start and stop requests on the control port and replies like the scanner does. After
+ * a start request it streams monitoring frames from its data port to the host data port specified by the start
+ * request until it receives a stop request. The frames follow the scan range, resolution, intensities and
+ * diagnostics of the start request and are sent with the configured rate, jitter, loss and reordering.
+ *
+ * Multiple simulators can run in one process, e.g. on consecutive ports of the loopback interface.
+ */
+class ScannerSimulator
+{
+public:
+  /**
+   * @brief Binds the control and the data port and starts listening for control messages.
+   *
+   * @throws boost::system::system_error if a port cannot be bound.
+   */
+  ScannerSimulator(const std::string& ip,
+                   const unsigned short& control_port,
+                   const unsigned short& data_port,
+                   const SimulationParameters& parameters = SimulationParameters());
+  ~ScannerSimulator();
+
+  ScannerSimulator(const ScannerSimulator&) = delete;
+  ScannerSimulator& operator=(const ScannerSimulator&) = delete;
+
+public:
+  SimulatorStatistics statistics() const;
+
+private:
+  void asyncReceiveControlMessage();
+  void handleControlMessage(const data_conversion_layer::RawData& data);
+  void sendReply(const uint32_t& op_code);
+  void streamMonitoringFrames();
+  std::vector<data_conversion_layer::monitoring_frame::Message>
+  createScanRound(const StartRequestSettings& settings, const uint32_t& scan_counter) const;
+  void sendFrame(const data_conversion_layer::monitoring_frame::Message& frame,
+                 const boost::asio::ip::udp::endpoint& receiver);
+
+private:
+  const SimulationParameters parameters_;
+
+  boost::asio::io_service io_service_;
+  boost::asio::ip::udp::socket control_socket_;
+  boost::asio::ip::udp::socket data_socket_;
+  data_conversion_layer::RawData control_buffer_;
+  boost::asio::ip::udp::endpoint control_sender_;
+
+  std::mutex settings_mutex_;
+  std::condition_variable settings_changed_;
+  boost::optional<StartRequestSettings> settings_;
+  bool terminate_{ false };
+
+  std::mt19937 random_generator_;
+
+  std::atomic<uint64_t> start_requests_{ 0 };
+  std::atomic<uint64_t> stop_requests_{ 0 };
+  std::atomic<uint64_t> scan_rounds_{ 0 };
+  std::atomic<uint64_t> sent_frames_{ 0 };
+  std::atomic<uint64_t> lost_frames_{ 0 };
+  std::atomic<uint64_t> reordered_frames_{ 0 };
+
+  std::thread io_service_thread_;
+  std::thread streaming_thread_;
+};
+
+}  // namespace simulation
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_SCANNER_SIMULATOR_H
@@ -0,0 +1,106 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_ALLOCATION_TAGS_H
+#define PSEN_SCAN_V2_STANDALONE_ALLOCATION_TAGS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+/**
+ * @brief Subsystems of the hot path to which the heap allocations of a thread are attributed.
+ */
+enum class AllocationTag : uint8_t
+{
+  //! @brief Allocations outside of the tagged subsystems.
+  other = 0,
+  //! @brief Receiving of datagrams and dispatching of the protocol events.
+  udp = 1,
+  //! @brief Deserialization of monitoring frames.
+  decode = 2,
+  //! @brief Assembly of the scan rounds in the scan buffer.
+  buffer = 3,
+  //! @brief Conversion of monitoring frames to a LaserScan.
+  conversion = 4,
+  //! @brief Laser scan callback of the user, including its dispatching to an executor.
+  callback = 5
+};
+
+//! @brief Number of elements in AllocationTag.
+static constexpr std::size_t NUMBER_OF_ALLOCATION_TAGS{ 6 };
+
+inline const char* allocationTagName(const AllocationTag& tag)
+{
+  switch (tag)
+  {
+    case AllocationTag::udp:
+      return "udp";
+    case AllocationTag::decode:
+      return "decode";
+    case AllocationTag::buffer:
+      return "buffer";
+    case AllocationTag::conversion:
+      return "conversion";
+    case AllocationTag::callback:
+      return "callback";
+    default:
+      return "other";
+  }
+}
+
+/**
+ * @returns the tag of the calling thread.
+ *
+ * Meant to be read by a replacement of the global operator new, so it neither allocates nor throws.
+ */
+inline AllocationTag& currentAllocationTag() noexcept
+{
+  static thread_local AllocationTag tag{ AllocationTag::other };
+  return tag;
+}
+
+/**
+ * @brief Attributes the allocations of the calling thread to a subsystem during the lifetime of the object.
+ *
+ * Scopes nest, the destructor restores the previous tag. The driver only sets the tags, which costs a thread local
+ * store. They are evaluated by a replaced global operator new, see test/benchmarks/benchmark_memory.cpp.
+ */
+class AllocationTagScope
+{
+public:
+  explicit AllocationTagScope(const AllocationTag& tag) noexcept : previous_(currentAllocationTag())
+  {
+    currentAllocationTag() = tag;
+  }
+
+  ~AllocationTagScope()
+  {
+    currentAllocationTag() = previous_;
+  }
+
+  AllocationTagScope(const AllocationTagScope&) = delete;
+  AllocationTagScope& operator=(const AllocationTagScope&) = delete;
+
+private:
+  const AllocationTag previous_;
+};
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_ALLOCATION_TAGS_H
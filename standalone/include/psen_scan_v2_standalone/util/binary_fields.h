@@ -0,0 +1,65 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef PSEN_SCAN_V2_STANDALONE_BINARY_FIELDS_H
+#define PSEN_SCAN_V2_STANDALONE_BINARY_FIELDS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+/**
+ * @brief Writes the value in native byte order to the buffer at the offset. The buffer does not need to be aligned.
+ */
+template <typename T>
+inline void writeField(char* buffer, const std::size_t& offset, const T& value)
+{
+  std::memcpy(buffer + offset, &value, sizeof(T));
+}
+
+/**
+ * @returns the value read in native byte order from the buffer at the offset. The buffer does not need to be aligned.
+ */
+template <typename T>
+inline T readField(const char* buffer, const std::size_t& offset)
+{
+  T value;
+  std::memcpy(&value, buffer + offset, sizeof(T));
+  return value;
+}
+
+/**
+ * @returns the rounded value, limited to the range of uint16_t. NaN is mapped to the maximal value.
+ */
+inline uint16_t toUint16(const double& value)
+{
+  // The negated comparison maps NaN to the maximal value, too.
+  if (!(value < std::numeric_limits<uint16_t>::max()))
+  {
+    return std::numeric_limits<uint16_t>::max();
+  }
+  return value > 0. ? static_cast<uint16_t>(std::round(value)) : 0;
+}
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_BINARY_FIELDS_H
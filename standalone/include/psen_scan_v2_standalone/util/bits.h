@@ -0,0 +1,59 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef PSEN_SCAN_V2_STANDALONE_BITS_H
+#define PSEN_SCAN_V2_STANDALONE_BITS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+/**
+ * @returns the index of the most significant set bit of the value, e.g. 0 for 1 and 63 for 2^63.
+ *
+ * Uses the bit scan instruction of the compiler if available and a shift loop otherwise.
+ *
+ * @note The value must not be 0.
+ */
+inline std::size_t mostSignificantBit(const uint64_t& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<std::size_t>(63 - __builtin_clzll(value));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index{ 0 };
+  _BitScanReverse64(&index, value);
+  return static_cast<std::size_t>(index);
+#else
+  std::size_t index{ 0 };
+  uint64_t remaining{ value };
+  while (remaining >>= 1)
+  {
+    ++index;
+  }
+  return index;
+#endif
+}
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_BITS_H
@@ -0,0 +1,225 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_EXECUTOR_H
+#define PSEN_SCAN_V2_STANDALONE_EXECUTOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include <boost/asio/io_service.hpp>
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+/**
+ * @brief Function executing the passed task, e.g. by posting it to a thread pool or by calling it directly.
+ */
+using Executor = std::function<void(std::function<void()>)>;
+
+/**
+ * @returns an executor which directly calls the task in the calling thread.
+ */
+inline Executor inlineExecutor()
+{
+  return [](std::function<void()> task) { task(); };
+}
+
+/**
+ * @returns an executor which posts the task to the specified io_service, i.e. the task is run by one of the threads
+ * calling io_service.run().
+ *
+ * @note The io_service must outlive the executor.
+ */
+inline Executor ioServiceExecutor(boost::asio::io_service& io_service)
+{
+  return [&io_service](std::function<void()> task) { io_service.post(std::move(task)); };
+}
+
+/**
+ * @brief Executes the posted tasks one after another in the order of posting, while the tasks themselves are run by
+ * an underlying (possibly multi-threaded) executor.
+ *
+ * At most one task of a strand is running at any time. To be fair to other strands sharing the same executor, the
+ * strand hands back control to the executor after MAX_TASKS_PER_RUN tasks.
+ */
+class Strand
+{
+public:
+  static constexpr std::size_t MAX_TASKS_PER_RUN{ 16 };
+
+public:
+  explicit Strand(const Executor& executor);
+  ~Strand();
+
+public:
+  //! @brief Queues the task. Tasks posted after shutdown() are dropped.
+  void post(std::function<void()> task);
+
+  /**
+   * @brief Drops all queued tasks and waits until the currently running task (if any) is finished.
+   *
+   * @note Must not be called from within a task of the strand.
+   */
+  void shutdown();
+
+private:
+  void run();
+
+private:
+  Executor executor_;
+
+  std::mutex mutex_;
+  std::condition_variable scheduled_cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool scheduled_{ false };
+  bool shut_down_{ false };
+};
+
+inline Strand::Strand(const Executor& executor) : executor_(executor)
+{
+  if (!executor_)
+  {
+    throw std::invalid_argument("Executor is invalid");
+  }
+}
+
+inline Strand::~Strand()
+{
+  shutdown();
+}
+
+inline void Strand::post(std::function<void()> task)
+{
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (shut_down_)
+    {
+      return;
+    }
+    tasks_.push_back(std::move(task));
+    if (scheduled_)
+    {
+      return;
+    }
+    scheduled_ = true;
+  }
+  executor_([this]() { run(); });
+}
+
+inline void Strand::run()
+{
+  for (std::size_t i = 0; i < MAX_TASKS_PER_RUN; ++i)
+  {
+    std::function<void()> task;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      if (tasks_.empty() || shut_down_)
+      {
+        scheduled_ = false;
+        scheduled_cv_.notify_all();
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+  // Give other strands the chance to run before continuing.
+  executor_([this]() { run(); });
+}
+
+inline void Strand::shutdown()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  shut_down_ = true;
+  tasks_.clear();
+  scheduled_cv_.wait(lock, [this]() { return !scheduled_; });
+}
+
+namespace detail
+{
+//! @brief State shared by an executor created via serialExecutor() and its pending runs.
+struct SerialExecutorState
+{
+  explicit SerialExecutorState(const Executor& executor) : executor_(executor)
+  {
+  }
+
+  Executor executor_;
+  std::mutex mutex_;
+  std::deque<std::function<void()>> tasks_;
+  bool scheduled_{ false };
+};
+
+inline void runSerialTasks(const std::shared_ptr<SerialExecutorState>& state)
+{
+  for (std::size_t i = 0; i < Strand::MAX_TASKS_PER_RUN; ++i)
+  {
+    std::function<void()> task;
+    {
+      const std::lock_guard<std::mutex> lock(state->mutex_);
+      if (state->tasks_.empty())
+      {
+        state->scheduled_ = false;
+        return;
+      }
+      task = std::move(state->tasks_.front());
+      state->tasks_.pop_front();
+    }
+    task();
+  }
+  // Give other tasks of the underlying executor the chance to run before continuing.
+  state->executor_([state]() { runSerialTasks(state); });
+}
+}  // namespace detail
+
+/**
+ * @returns an executor which runs the tasks one after another in the order of posting via the specified executor,
+ * like a Strand.
+ *
+ * In contrast to a Strand, the pending tasks keep the queue alive. Therefore, the returned executor can be destroyed
+ * while tasks are pending; they are run nevertheless.
+ */
+inline Executor serialExecutor(const Executor& executor)
+{
+  if (!executor)
+  {
+    throw std::invalid_argument("Executor is invalid");
+  }
+  const auto state{ std::make_shared<detail::SerialExecutorState>(executor) };
+  return [state](std::function<void()> task) {
+    {
+      const std::lock_guard<std::mutex> lock(state->mutex_);
+      state->tasks_.push_back(std::move(task));
+      if (state->scheduled_)
+      {
+        return;
+      }
+      state->scheduled_ = true;
+    }
+    state->executor_([state]() { detail::runSerialTasks(state); });
+  };
+}
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_EXECUTOR_H
@@ -0,0 +1,166 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_LATENCY_HISTOGRAM_H
+#define PSEN_SCAN_V2_STANDALONE_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "psen_scan_v2_standalone/util/bits.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+//! @brief Clock used to timestamp the processing stages of the driver.
+using LatencyClock = std::chrono::steady_clock;
+
+/**
+ * @brief Summary of the latencies recorded by a LatencyHistogram.
+ *
+ * The percentiles are reported as the highest value of the bucket they fall into, i.e. they are overestimated by
+ * less than 1 / LatencyHistogram::SUB_BUCKET_COUNT (about 3%). The maximum is exact.
+ */
+struct LatencySnapshot
+{
+  uint64_t count{ 0 };
+  std::chrono::nanoseconds p50{ 0 };
+  std::chrono::nanoseconds p99{ 0 };
+  std::chrono::nanoseconds p999{ 0 };
+  std::chrono::nanoseconds max{ 0 };
+};
+
+/**
+ * @brief Lock-free histogram of latencies with log-linear buckets (similar to an HDR histogram).
+ *
+ * Each power of two is divided into SUB_BUCKET_COUNT linear buckets, so that the relative resolution is constant
+ * over the whole range from 1ns up to MAX_TRACKABLE_VALUE. Larger values are counted in the last bucket.
+ *
+ * Recording only needs a few relaxed atomic operations and never allocates, so it can be called from the real-time
+ * threads of the driver. Any number of threads may record and take snapshots concurrently.
+ */
+class LatencyHistogram
+{
+public:
+  static constexpr std::size_t SUB_BUCKET_BITS{ 5 };
+  static constexpr std::size_t SUB_BUCKET_COUNT{ std::size_t{ 1 } << SUB_BUCKET_BITS };
+  //! Values up to 2^36ns (about 68s) are resolved, larger values are clamped.
+  static constexpr std::size_t MAX_VALUE_BITS{ 36 };
+  static constexpr std::size_t BUCKET_COUNT{ (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT };
+  //! Largest latency in nanoseconds which is resolved by the buckets.
+  static constexpr uint64_t MAX_TRACKABLE_VALUE{ (uint64_t{ 1 } << MAX_VALUE_BITS) - 1 };
+
+public:
+  void record(const std::chrono::nanoseconds& latency);
+  //! @brief Records the time passed between start and end.
+  void record(const LatencyClock::time_point& start, const LatencyClock::time_point& end);
+
+  LatencySnapshot snapshot() const;
+
+private:
+  static std::size_t bucketIndex(const uint64_t& value);
+  //! @returns the highest value which is counted in the bucket with the specified index.
+  static uint64_t highestValueOfBucket(const std::size_t& index);
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+  std::atomic<uint64_t> max_{ 0 };
+};
+
+inline void LatencyHistogram::record(const std::chrono::nanoseconds& latency)
+{
+  const uint64_t value{ static_cast<uint64_t>(std::max<int64_t>(0, latency.count())) };
+  buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t max{ max_.load(std::memory_order_relaxed) };
+  while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+  {
+  }
+}
+
+inline void LatencyHistogram::record(const LatencyClock::time_point& start, const LatencyClock::time_point& end)
+{
+  record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start));
+}
+
+inline std::size_t LatencyHistogram::bucketIndex(const uint64_t& value)
+{
+  if (value < SUB_BUCKET_COUNT)
+  {
+    return static_cast<std::size_t>(value);
+  }
+  const uint64_t clamped_value{ value < MAX_TRACKABLE_VALUE ? value : MAX_TRACKABLE_VALUE };
+  const std::size_t most_significant_bit{ mostSignificantBit(clamped_value) };
+  const std::size_t shift{ most_significant_bit - SUB_BUCKET_BITS };
+  return (shift + 1) * SUB_BUCKET_COUNT + static_cast<std::size_t>((clamped_value >> shift) - SUB_BUCKET_COUNT);
+}
+
+inline uint64_t LatencyHistogram::highestValueOfBucket(const std::size_t& index)
+{
+  if (index < SUB_BUCKET_COUNT)
+  {
+    return index;
+  }
+  const std::size_t shift{ index / SUB_BUCKET_COUNT - 1 };
+  const uint64_t lowest_value{ static_cast<uint64_t>(index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT) << shift };
+  return lowest_value + (uint64_t{ 1 } << shift) - 1;
+}
+
+inline LatencySnapshot LatencyHistogram::snapshot() const
+{
+  std::array<uint64_t, BUCKET_COUNT> counts;
+  uint64_t total{ 0 };
+  for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+  {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  LatencySnapshot snapshot;
+  snapshot.count = total;
+  snapshot.max = std::chrono::nanoseconds(max_.load(std::memory_order_relaxed));
+  if (total == 0)
+  {
+    return snapshot;
+  }
+
+  const auto percentile = [&](const double& fraction) {
+    const uint64_t rank{ std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * total))) };
+    uint64_t cumulative_count{ 0 };
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+      cumulative_count += counts[i];
+      if (cumulative_count >= rank)
+      {
+        return std::min(std::chrono::nanoseconds(highestValueOfBucket(i)), snapshot.max);
+      }
+    }
+    return snapshot.max;  // LCOV_EXCL_LINE
+  };
+  snapshot.p50 = percentile(0.5);
+  snapshot.p99 = percentile(0.99);
+  snapshot.p999 = percentile(0.999);
+  return snapshot;
+}
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_LATENCY_HISTOGRAM_H
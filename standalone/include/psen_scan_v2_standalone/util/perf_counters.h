@@ -0,0 +1,309 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_PERF_COUNTERS_H
+#define PSEN_SCAN_V2_STANDALONE_PERF_COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "psen_scan_v2_standalone/util/logging.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+//! @brief Values of the hardware performance counters of the calling thread.
+struct PerfCounterValues
+{
+  uint64_t cycles{ 0 };
+  uint64_t instructions{ 0 };
+  uint64_t cache_misses{ 0 };
+  uint64_t branch_misses{ 0 };
+};
+
+/**
+ * @brief Summary of the hardware performance counters recorded by PerfCounters.
+ *
+ * The counters are the sums over all samples. A low number of instructions per cycle together with many cache
+ * misses points to a memory bound stage, a high number of instructions to a compute bound stage.
+ */
+struct PerfCounterSnapshot
+{
+  //! Number of measured executions of the stage.
+  uint64_t samples{ 0 };
+  //! Number of executions which could not be measured, because the performance counters are not available.
+  uint64_t unavailable{ 0 };
+  PerfCounterValues totals{};
+
+  //! @returns the average number of instructions per cycle or 0 if nothing was measured.
+  double instructionsPerCycle() const;
+};
+
+/**
+ * @brief Group of the hardware performance counters (cycles, instructions, cache misses and branch misses) of the
+ * calling thread, opened via perf_event_open().
+ *
+ * Only the user space part of the thread is counted, so the default setting of /proc/sys/kernel/perf_event_paranoid
+ * (2) suffices. If the counters cannot be opened (no permission, virtual machine without PMU, no Linux) the group
+ * stays closed and a warning is logged once.
+ */
+class PerfCounterGroup
+{
+public:
+  static constexpr std::size_t NUMBER_OF_COUNTERS{ 4 };
+
+public:
+  PerfCounterGroup();
+  ~PerfCounterGroup();
+
+  PerfCounterGroup(const PerfCounterGroup&) = delete;
+  PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+public:
+  bool isOpen() const;
+  //! @returns false if the counters are not open or could not be read.
+  bool read(PerfCounterValues& values) const;
+
+  //! @returns the group of the calling thread, which is opened by the first call in each thread.
+  static const PerfCounterGroup& ofCurrentThread();
+
+private:
+  void close();
+
+private:
+  std::array<int, NUMBER_OF_COUNTERS> fds_{ { -1, -1, -1, -1 } };
+};
+
+/**
+ * @brief Sums up the hardware performance counters of one processing stage over all threads executing it.
+ *
+ * Recording is done via PerfCounterScope and costs two read() system calls, therefore it is disabled by default.
+ * Any number of threads may record and take snapshots concurrently.
+ */
+class PerfCounters
+{
+public:
+  explicit PerfCounters(const bool& enabled = false);
+
+public:
+  bool isEnabled() const;
+  void add(const PerfCounterValues& begin, const PerfCounterValues& end);
+  void addUnavailable();
+
+  PerfCounterSnapshot snapshot() const;
+
+private:
+  const bool enabled_;
+
+  std::atomic<uint64_t> samples_{ 0 };
+  std::atomic<uint64_t> unavailable_{ 0 };
+  std::atomic<uint64_t> cycles_{ 0 };
+  std::atomic<uint64_t> instructions_{ 0 };
+  std::atomic<uint64_t> cache_misses_{ 0 };
+  std::atomic<uint64_t> branch_misses_{ 0 };
+};
+
+/**
+ * @brief Adds the hardware performance counters of the calling thread during the lifetime of the object to the
+ * specified PerfCounters. Does nothing if the PerfCounters are disabled.
+ */
+class PerfCounterScope
+{
+public:
+  explicit PerfCounterScope(PerfCounters& counters);
+  ~PerfCounterScope();
+
+  PerfCounterScope(const PerfCounterScope&) = delete;
+  PerfCounterScope& operator=(const PerfCounterScope&) = delete;
+
+private:
+  PerfCounters& counters_;
+  const PerfCounterGroup* group_{ nullptr };
+  PerfCounterValues begin_{};
+};
+
+inline double PerfCounterSnapshot::instructionsPerCycle() const
+{
+  if (totals.cycles == 0)
+  {
+    return 0.;
+  }
+  return static_cast<double>(totals.instructions) / static_cast<double>(totals.cycles);
+}
+
+inline PerfCounterGroup::PerfCounterGroup()
+{
+#ifdef __linux__
+  static const std::array<uint64_t, NUMBER_OF_COUNTERS> EVENTS{ { PERF_COUNT_HW_CPU_CYCLES,
+                                                                  PERF_COUNT_HW_INSTRUCTIONS,
+                                                                  PERF_COUNT_HW_CACHE_MISSES,
+                                                                  PERF_COUNT_HW_BRANCH_MISSES } };
+  for (std::size_t i = 0; i < NUMBER_OF_COUNTERS; ++i)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = EVENTS[i];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // The first counter is the group leader. The group is scheduled as a whole, so the counters are consistent.
+    const int group_fd{ i == 0 ? -1 : fds_[0] };
+    fds_[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+    if (fds_[i] < 0)
+    {
+      PSENSCAN_WARN_ONCE("PerfCounters",
+                         "Hardware performance counters are not available: {}. (Check "
+                         "/proc/sys/kernel/perf_event_paranoid or the PMU support of the virtual machine.)",
+                         std::strerror(errno));
+      close();
+      return;
+    }
+  }
+#else
+  PSENSCAN_WARN_ONCE("PerfCounters", "Hardware performance counters are only supported on Linux.");
+#endif
+}
+
+inline PerfCounterGroup::~PerfCounterGroup()
+{
+  close();
+}
+
+inline void PerfCounterGroup::close()
+{
+#ifdef __linux__
+  for (int& fd : fds_)
+  {
+    if (fd >= 0)
+    {
+      ::close(fd);
+    }
+    fd = -1;
+  }
+#endif
+}
+
+inline bool PerfCounterGroup::isOpen() const
+{
+  return fds_[0] >= 0;
+}
+
+inline bool PerfCounterGroup::read(PerfCounterValues& values) const
+{
+  if (!isOpen())
+  {
+    return false;
+  }
+#ifdef __linux__
+  // Layout for PERF_FORMAT_GROUP: number of counters followed by the values in the order of their creation.
+  struct
+  {
+    uint64_t nr;
+    uint64_t values[NUMBER_OF_COUNTERS];
+  } group_values;
+  if (::read(fds_[0], &group_values, sizeof(group_values)) != static_cast<ssize_t>(sizeof(group_values)))
+  {
+    return false;  // LCOV_EXCL_LINE
+  }
+  values.cycles = group_values.values[0];
+  values.instructions = group_values.values[1];
+  values.cache_misses = group_values.values[2];
+  values.branch_misses = group_values.values[3];
+  return true;
+#else
+  return false;
+#endif
+}
+
+inline const PerfCounterGroup& PerfCounterGroup::ofCurrentThread()
+{
+  static thread_local PerfCounterGroup group;
+  return group;
+}
+
+inline PerfCounters::PerfCounters(const bool& enabled) : enabled_(enabled)
+{
+}
+
+inline bool PerfCounters::isEnabled() const
+{
+  return enabled_;
+}
+
+inline void PerfCounters::add(const PerfCounterValues& begin, const PerfCounterValues& end)
+{
+  samples_.fetch_add(1, std::memory_order_relaxed);
+  cycles_.fetch_add(end.cycles - begin.cycles, std::memory_order_relaxed);
+  instructions_.fetch_add(end.instructions - begin.instructions, std::memory_order_relaxed);
+  cache_misses_.fetch_add(end.cache_misses - begin.cache_misses, std::memory_order_relaxed);
+  branch_misses_.fetch_add(end.branch_misses - begin.branch_misses, std::memory_order_relaxed);
+}
+
+inline void PerfCounters::addUnavailable()
+{
+  unavailable_.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline PerfCounterSnapshot PerfCounters::snapshot() const
+{
+  PerfCounterSnapshot snapshot;
+  snapshot.samples = samples_.load(std::memory_order_relaxed);
+  snapshot.unavailable = unavailable_.load(std::memory_order_relaxed);
+  snapshot.totals.cycles = cycles_.load(std::memory_order_relaxed);
+  snapshot.totals.instructions = instructions_.load(std::memory_order_relaxed);
+  snapshot.totals.cache_misses = cache_misses_.load(std::memory_order_relaxed);
+  snapshot.totals.branch_misses = branch_misses_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+inline PerfCounterScope::PerfCounterScope(PerfCounters& counters) : counters_(counters)
+{
+  if (!counters_.isEnabled())
+  {
+    return;
+  }
+  group_ = &PerfCounterGroup::ofCurrentThread();
+  if (!group_->read(begin_))
+  {
+    group_ = nullptr;
+    counters_.addUnavailable();
+  }
+}
+
+inline PerfCounterScope::~PerfCounterScope()
+{
+  PerfCounterValues end;
+  if (group_ && group_->read(end))
+  {
+    counters_.add(begin_, end);
+  }
+}
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_PERF_COUNTERS_H
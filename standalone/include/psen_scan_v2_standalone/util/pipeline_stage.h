@@ -0,0 +1,213 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_PIPELINE_STAGE_H
+#define PSEN_SCAN_V2_STANDALONE_PIPELINE_STAGE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "psen_scan_v2_standalone/util/logging.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+#include "psen_scan_v2_standalone/util/spsc_ring.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+/**
+ * @brief Snapshot of the metrics of a PipelineStage.
+ */
+struct StageStatistics
+{
+  //! Number of elements waiting in the queue of the stage.
+  std::size_t queue_depth{ 0 };
+  //! Maximal number of elements waiting in the queue since the stage was created.
+  std::size_t max_queue_depth{ 0 };
+  //! Number of processed elements.
+  uint64_t processed{ 0 };
+  //! Number of elements which were dropped, because the queue was full.
+  uint64_t dropped{ 0 };
+};
+
+/**
+ * @brief Thread processing the elements of a SpscRing with the specified handler.
+ *
+ * The producer never blocks: If the queue is full, the element is dropped and counted. The stage thread sleeps while
+ * the queue is empty and is only woken up by the producer in this case.
+ *
+ * If the handler throws, the error is logged and the stage stops processing as if stop() was called. Elements pushed
+ * afterwards stay in the queue until it is full and are dropped then.
+ */
+template <class T>
+class PipelineStage
+{
+public:
+  using Handler = std::function<void(T&)>;
+
+public:
+  PipelineStage(const std::size_t& capacity, const Handler& handler, const ThreadSettings& thread_settings);
+  ~PipelineStage();
+
+public:
+  /**
+   * @brief Writes the next element via write(T&) directly into the queue. (Producer only)
+   *
+   * @returns false if the queue is full.
+   */
+  template <class Writer>
+  bool tryPush(const Writer& write);
+
+  //! @brief Stops and joins the stage thread. Remaining elements are not processed.
+  void stop();
+
+  StageStatistics statistics() const;
+
+private:
+  void run();
+  void waitForElements();
+
+private:
+  SpscRing<T> ring_;
+  const Handler handler_;
+
+  std::mutex mutex_;
+  std::condition_variable elements_available_cv_;
+  std::atomic_bool sleeping_{ false };
+  std::atomic_bool stopped_{ false };
+
+  std::atomic<std::size_t> max_queue_depth_{ 0 };
+  std::atomic<uint64_t> processed_{ 0 };
+  std::atomic<uint64_t> dropped_{ 0 };
+
+  // Note: The thread must be declared last, so that all members are initialized when it starts.
+  std::thread thread_;
+};
+
+template <class T>
+inline PipelineStage<T>::PipelineStage(const std::size_t& capacity,
+                                       const Handler& handler,
+                                       const ThreadSettings& thread_settings)
+  : ring_(capacity), handler_(handler), thread_([this]() { run(); })
+{
+  applyThreadSettings(thread_, thread_settings);
+}
+
+template <class T>
+inline PipelineStage<T>::~PipelineStage()
+{
+  stop();
+}
+
+template <class T>
+template <class Writer>
+inline bool PipelineStage<T>::tryPush(const Writer& write)
+{
+  T* const slot{ ring_.beginPush() };
+  if (slot == nullptr)
+  {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  write(*slot);
+  ring_.commitPush();
+
+  const std::size_t queue_depth{ ring_.size() };
+  if (queue_depth > max_queue_depth_.load(std::memory_order_relaxed))
+  {
+    max_queue_depth_.store(queue_depth, std::memory_order_relaxed);
+  }
+
+  // Pairs with the fence in waitForElements(): Either the stage sees the new element or the producer sees that the
+  // stage is sleeping.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping_.load(std::memory_order_relaxed))
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    elements_available_cv_.notify_one();
+  }
+  return true;
+}
+
+template <class T>
+inline void PipelineStage<T>::stop()
+{
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  elements_available_cv_.notify_all();
+  if (thread_.joinable())
+  {
+    thread_.join();
+  }
+}
+
+template <class T>
+inline StageStatistics PipelineStage<T>::statistics() const
+{
+  StageStatistics statistics;
+  statistics.queue_depth = ring_.size();
+  statistics.max_queue_depth = max_queue_depth_.load(std::memory_order_relaxed);
+  statistics.processed = processed_.load(std::memory_order_relaxed);
+  statistics.dropped = dropped_.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+template <class T>
+inline void PipelineStage<T>::run()
+{
+  while (!stopped_)
+  {
+    T* const element{ ring_.front() };
+    if (element == nullptr)
+    {
+      waitForElements();
+      continue;
+    }
+
+    try
+    {
+      handler_(*element);
+    }
+    catch (const std::exception& e)
+    {
+      PSENSCAN_ERROR("PipelineStage", "Error while processing element: {}. Stopping the stage.", e.what());
+      stopped_ = true;
+    }
+    ring_.pop();
+    processed_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+template <class T>
+inline void PipelineStage<T>::waitForElements()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  sleeping_.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  elements_available_cv_.wait(lock, [this]() { return stopped_ || ring_.front() != nullptr; });
+  sleeping_.store(false, std::memory_order_relaxed);
+}
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_PIPELINE_STAGE_H
@@ -0,0 +1,63 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_PROBES_H
+#define PSEN_SCAN_V2_STANDALONE_PROBES_H
+
+/**
+ * @file probes.h
+ * @brief USDT (user statically-defined tracing) probes of the provider "psen_scan_v2".
+ *
+ * The probes are compiled in if PSENSCAN_ENABLE_USDT_PROBES is defined (CMake option ENABLE_USDT_PROBES, which
+ * requires sys/sdt.h from systemtap-sdt-dev). A probe which no tracer is attached to is a single nop instruction,
+ * so the probes can stay enabled in release builds. They can be listed with
+ *
+ *   bpftrace -l 'usdt:/path/to/executable:psen_scan_v2:*'
+ *
+ * Probes (arguments in brackets):
+ * - frame_received (number of bytes, port of the scanner): A datagram was received by a UDP client.
+ * - frame_decoded (scan counter, start angle in tenth of degree, number of measurements): A monitoring frame was
+ *   deserialized. The scan counter is 0 if the frame has none.
+ * - round_completed (scan counter, number of monitoring frames): A scan round contains all expected frames.
+ * - round_dropped (scan counter, reason as string): A frame or round was dropped by the scan buffer. The reason is
+ *   one of "incomplete", "outdated_frame" or "oversaturated".
+ * - scan_delivered (scan counter, number of measurements): The laser scan callback returned.
+ * - watchdog_timeout (timeout as string): A watchdog of the protocol fired. The timeout is one of "StartReplyTimeout"
+ *   or "MonitoringFrameTimeout".
+ *
+ * The arguments have to be integers or pointers, string arguments have to be literals.
+ *
+ * @see standalone/scripts/psen_scan_v2_frame_latency.bt for an example.
+ */
+
+#if defined(PSENSCAN_ENABLE_USDT_PROBES) && defined(__linux__)
+
+#include <sys/sdt.h>
+
+#define PSENSCAN_PROBE(name) STAP_PROBE(psen_scan_v2, name)
+#define PSENSCAN_PROBE1(name, arg1) STAP_PROBE1(psen_scan_v2, name, arg1)
+#define PSENSCAN_PROBE2(name, arg1, arg2) STAP_PROBE2(psen_scan_v2, name, arg1, arg2)
+#define PSENSCAN_PROBE3(name, arg1, arg2, arg3) STAP_PROBE3(psen_scan_v2, name, arg1, arg2, arg3)
+
+#else
+
+// The arguments are not evaluated, sizeof() only marks them as used to avoid warnings about unused variables.
+#define PSENSCAN_PROBE(name)
+#define PSENSCAN_PROBE1(name, arg1) static_cast<void>(sizeof(arg1))
+#define PSENSCAN_PROBE2(name, arg1, arg2) static_cast<void>(sizeof(arg1) + sizeof(arg2))
+#define PSENSCAN_PROBE3(name, arg1, arg2, arg3) static_cast<void>(sizeof(arg1) + sizeof(arg2) + sizeof(arg3))
+
+#endif
+
+#endif  // PSEN_SCAN_V2_STANDALONE_PROBES_H
@@ -0,0 +1,186 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_REALTIME_H
+#define PSEN_SCAN_V2_STANDALONE_REALTIME_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+#include <boost/optional.hpp>
+
+#include "psen_scan_v2_standalone/util/logging.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+//! @brief Maximal length of a thread name (excluding the terminating null character) supported by Linux.
+static constexpr std::size_t MAX_THREAD_NAME_LENGTH{ 15 };
+//! @brief Valid range of real-time priorities for the SCHED_FIFO policy.
+static constexpr int MIN_FIFO_PRIORITY{ 1 };
+static constexpr int MAX_FIFO_PRIORITY{ 99 };
+
+/**
+ * @brief Lists the roles of the threads created by the driver.
+ */
+enum class ThreadRole
+{
+  //! @brief Threads running the io_service of the UDP clients.
+  io = 0,
+  //! @brief Threads of the watchdogs monitoring the scanner replies and monitoring frames.
+  watchdog = 1,
+  //! @brief Threads dispatching protocol events and user callbacks apart from the io threads.
+  dispatcher = 2
+};
+
+//! @brief Number of elements in ThreadRole.
+static constexpr std::size_t NUMBER_OF_THREAD_ROLES{ 3 };
+
+/**
+ * @brief Scheduling attributes which are applied to a thread of the driver.
+ *
+ * - An empty name leaves the name inherited from the creating thread.
+ * - Without a priority the thread keeps the default (non real-time) scheduling policy.
+ * - A cpu affinity mask of 0 does not restrict the thread to any cpu. Otherwise bit n allows cpu n.
+ */
+struct ThreadSettings
+{
+  std::string name{};
+  boost::optional<int> fifo_priority{};
+  uint64_t cpu_affinity_mask{ 0 };
+
+  /**
+   * @returns A copy of the settings whose name is extended by the specified suffix. The resulting name is cut off
+   * at MAX_THREAD_NAME_LENGTH characters.
+   */
+  ThreadSettings withNameSuffix(const std::string& suffix) const;
+};
+
+inline ThreadSettings ThreadSettings::withNameSuffix(const std::string& suffix) const
+{
+  ThreadSettings settings{ *this };
+  if (!settings.name.empty())
+  {
+    settings.name = (settings.name + suffix).substr(0, MAX_THREAD_NAME_LENGTH);
+  }
+  return settings;
+}
+
+/**
+ * @brief Applies the specified settings to the thread.
+ *
+ * Settings which cannot be applied (e.g. because of missing privileges for real-time scheduling) are reported as
+ * warning but do not stop the driver.
+ *
+ * @returns true if all settings could be applied, otherwise false.
+ */
+inline bool applyThreadSettings(std::thread& thread, const ThreadSettings& settings)
+{
+  bool success{ true };
+#ifdef __linux__
+  const pthread_t handle{ thread.native_handle() };
+  if (!settings.name.empty())
+  {
+    const int res{ pthread_setname_np(handle, settings.name.substr(0, MAX_THREAD_NAME_LENGTH).c_str()) };
+    if (res != 0)
+    {
+      PSENSCAN_WARN("ThreadSettings", "Could not set name of thread \"{}\": {}", settings.name, std::strerror(res));
+      success = false;
+    }
+  }
+
+  if (settings.cpu_affinity_mask != 0)
+  {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (std::size_t cpu = 0; cpu < 64; ++cpu)
+    {
+      if ((settings.cpu_affinity_mask >> cpu) & 1u)
+      {
+        CPU_SET(cpu, &cpu_set);
+      }
+    }
+    const int res{ pthread_setaffinity_np(handle, sizeof(cpu_set), &cpu_set) };
+    if (res != 0)
+    {
+      PSENSCAN_WARN("ThreadSettings",
+                    "Could not set cpu affinity mask {:#x} of thread \"{}\": {}",
+                    settings.cpu_affinity_mask,
+                    settings.name,
+                    std::strerror(res));
+      success = false;
+    }
+  }
+
+  if (settings.fifo_priority)
+  {
+    sched_param param{};
+    param.sched_priority = settings.fifo_priority.get();
+    const int res{ pthread_setschedparam(handle, SCHED_FIFO, &param) };
+    if (res != 0)
+    {
+      PSENSCAN_WARN("ThreadSettings",
+                    "Could not set real-time priority {} of thread \"{}\": {}"
+                    " (Please check the rtprio limit of the user.)",
+                    settings.fifo_priority.get(),
+                    settings.name,
+                    std::strerror(res));
+      success = false;
+    }
+  }
+#else
+  if (!settings.name.empty() || settings.fifo_priority || settings.cpu_affinity_mask != 0)
+  {
+    PSENSCAN_WARN_ONCE("ThreadSettings", "Thread settings are only supported on Linux.");
+    success = false;
+  }
+#endif
+  return success;
+}
+
+/**
+ * @brief Locks all current and future pages of the process into RAM to avoid page faults on the hot path.
+ *
+ * @returns true on success, otherwise false (a warning is printed).
+ */
+inline bool lockMemory()
+{
+#ifdef __linux__
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+  {
+    PSENSCAN_WARN("ThreadSettings",
+                  "Could not lock memory: {} (Please check the memlock limit of the user.)",
+                  std::strerror(errno));
+    return false;
+  }
+  return true;
+#else
+  PSENSCAN_WARN("ThreadSettings", "Locking memory is only supported on Linux.");
+  return false;
+#endif
+}
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_REALTIME_H
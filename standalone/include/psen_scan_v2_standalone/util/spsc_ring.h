@@ -0,0 +1,146 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_SPSC_RING_H
+#define PSEN_SCAN_V2_STANDALONE_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+//! @brief Assumed size of a cache line, used to keep the indices of producer and consumer apart.
+static constexpr std::size_t CACHE_LINE_SIZE{ 64 };
+
+/**
+ * @brief Lock-free bounded queue for exactly one producer thread and one consumer thread.
+ *
+ * The elements are preallocated and reused. The producer writes directly into the next free slot (beginPush(),
+ * commitPush()) and the consumer reads directly from the oldest slot (front(), pop()). Buffers owned by the elements
+ * (e.g. the capacity of a std::vector) are therefore kept, so that no memory is allocated in the steady state.
+ */
+template <class T>
+class SpscRing
+{
+public:
+  //! @param capacity Maximal number of elements. It is rounded up to the next power of two.
+  explicit SpscRing(const std::size_t& capacity);
+
+public:
+  //! @returns the slot to write the next element to or nullptr if the ring is full. (Producer only)
+  T* beginPush();
+  //! @brief Publishes the element written to the slot returned by beginPush(). (Producer only)
+  void commitPush();
+
+  //! @returns the oldest element or nullptr if the ring is empty. (Consumer only)
+  T* front();
+  //! @brief Releases the slot of the element returned by front(). (Consumer only)
+  void pop();
+
+  //! @returns the number of elements. The result is only a snapshot if called concurrently to push or pop.
+  std::size_t size() const;
+  std::size_t capacity() const;
+
+private:
+  static std::size_t roundUpToPowerOfTwo(const std::size_t& value);
+
+private:
+  std::vector<T> slots_;
+  const std::size_t mask_;
+
+  //! @brief Index of the next element to read. Only written by the consumer.
+  std::atomic<std::size_t> head_{ 0 };
+  char head_padding_[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>)];
+  //! @brief Index of the next element to write. Only written by the producer.
+  std::atomic<std::size_t> tail_{ 0 };
+  char tail_padding_[CACHE_LINE_SIZE - sizeof(std::atomic<std::size_t>)];
+};
+
+template <class T>
+inline SpscRing<T>::SpscRing(const std::size_t& capacity)
+  : slots_(roundUpToPowerOfTwo(capacity)), mask_(slots_.size() - 1)
+{
+  if (capacity == 0)
+  {
+    throw std::invalid_argument("Capacity of the ring must not be 0");
+  }
+}
+
+template <class T>
+inline std::size_t SpscRing<T>::roundUpToPowerOfTwo(const std::size_t& value)
+{
+  std::size_t result{ 1 };
+  while (result < value)
+  {
+    result <<= 1;
+  }
+  return result;
+}
+
+template <class T>
+inline T* SpscRing<T>::beginPush()
+{
+  const std::size_t tail{ tail_.load(std::memory_order_relaxed) };
+  if (tail - head_.load(std::memory_order_acquire) == slots_.size())
+  {
+    return nullptr;
+  }
+  return &slots_[tail & mask_];
+}
+
+template <class T>
+inline void SpscRing<T>::commitPush()
+{
+  tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <class T>
+inline T* SpscRing<T>::front()
+{
+  const std::size_t head{ head_.load(std::memory_order_relaxed) };
+  if (head == tail_.load(std::memory_order_acquire))
+  {
+    return nullptr;
+  }
+  return &slots_[head & mask_];
+}
+
+template <class T>
+inline void SpscRing<T>::pop()
+{
+  head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <class T>
+inline std::size_t SpscRing<T>::size() const
+{
+  const std::size_t head{ head_.load(std::memory_order_acquire) };
+  const std::size_t tail{ tail_.load(std::memory_order_acquire) };
+  return tail >= head ? tail - head : 0;
+}
+
+template <class T>
+inline std::size_t SpscRing<T>::capacity() const
+{
+  return slots_.size();
+}
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_SPSC_RING_H
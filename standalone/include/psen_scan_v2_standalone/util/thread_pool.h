@@ -0,0 +1,224 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_THREAD_POOL_H
+#define PSEN_SCAN_V2_STANDALONE_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "psen_scan_v2_standalone/util/executor.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+/**
+ * @brief Fixed-size thread pool with one task queue per worker and work stealing.
+ *
+ * Tasks posted from a worker thread are queued at the posting worker, all other tasks are distributed round robin.
+ * A worker processes its own queue in FIFO order. If its queue is empty, it steals the newest task of another worker,
+ * so that tasks are always processed by whichever worker is free.
+ *
+ * Remaining tasks are processed before the destructor returns.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * @param num_threads Number of worker threads.
+   * @param thread_settings Settings applied to all workers. The index of the worker is appended to the name.
+   */
+  explicit ThreadPool(const std::size_t& num_threads, const ThreadSettings& thread_settings = ThreadSettings());
+  ~ThreadPool();
+
+public:
+  void post(std::function<void()> task);
+
+  //! @returns an executor posting the tasks to this pool.
+  Executor executor();
+
+  std::size_t numberOfThreads() const;
+
+  //! @returns a number of worker threads matching the number of available cores (at least one).
+  static std::size_t defaultNumberOfThreads();
+
+private:
+  struct Worker
+  {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+private:
+  void work(const std::size_t& index);
+  bool popOwnTask(const std::size_t& index, std::function<void()>& task);
+  bool stealTask(const std::size_t& index, std::function<void()>& task);
+
+  //! @returns the index of the worker calling this function or numberOfThreads() if called from other threads.
+  std::size_t currentWorkerIndex() const;
+
+private:
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+
+  std::atomic<std::size_t> num_pending_tasks_{ 0 };
+  std::atomic<std::size_t> next_worker_{ 0 };
+
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  bool terminated_{ false };
+};
+
+inline ThreadPool::ThreadPool(const std::size_t& num_threads, const ThreadSettings& thread_settings)
+{
+  if (num_threads == 0)
+  {
+    throw std::invalid_argument("Thread pool needs at least one thread");
+  }
+
+  for (std::size_t i = 0; i < num_threads; ++i)
+  {
+    workers_.emplace_back(new Worker());
+  }
+  threads_.reserve(num_threads);
+  for (std::size_t i = 0; i < num_threads; ++i)
+  {
+    threads_.emplace_back([this, i]() { work(i); });
+    applyThreadSettings(threads_.back(), thread_settings.withNameSuffix(std::to_string(i)));
+  }
+}
+
+inline ThreadPool::~ThreadPool()
+{
+  {
+    const std::lock_guard<std::mutex> lock(sleep_mutex_);
+    terminated_ = true;
+  }
+  sleep_cv_.notify_all();
+  for (auto& thread : threads_)
+  {
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+  }
+}
+
+inline std::size_t ThreadPool::numberOfThreads() const
+{
+  return workers_.size();
+}
+
+inline std::size_t ThreadPool::defaultNumberOfThreads()
+{
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+inline std::size_t ThreadPool::currentWorkerIndex() const
+{
+  const auto it{ std::find_if(threads_.begin(), threads_.end(), [](const std::thread& thread) {
+    return thread.get_id() == std::this_thread::get_id();
+  }) };
+  return static_cast<std::size_t>(std::distance(threads_.begin(), it));
+}
+
+inline void ThreadPool::post(std::function<void()> task)
+{
+  std::size_t index{ currentWorkerIndex() };
+  if (index >= workers_.size())
+  {
+    index = next_worker_++ % workers_.size();
+  }
+  ++num_pending_tasks_;
+  {
+    const std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+    workers_[index]->tasks.push_back(std::move(task));
+  }
+  {
+    // Taking the lock ensures that no worker misses the notification between checking for tasks and sleeping.
+    const std::lock_guard<std::mutex> lock(sleep_mutex_);
+  }
+  sleep_cv_.notify_one();
+}
+
+inline Executor ThreadPool::executor()
+{
+  return [this](std::function<void()> task) { post(std::move(task)); };
+}
+
+inline bool ThreadPool::popOwnTask(const std::size_t& index, std::function<void()>& task)
+{
+  const std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+  if (workers_[index]->tasks.empty())
+  {
+    return false;
+  }
+  task = std::move(workers_[index]->tasks.front());
+  workers_[index]->tasks.pop_front();
+  return true;
+}
+
+inline bool ThreadPool::stealTask(const std::size_t& index, std::function<void()>& task)
+{
+  for (std::size_t i = 1; i < workers_.size(); ++i)
+  {
+    Worker& victim{ *workers_[(index + i) % workers_.size()] };
+    const std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty())
+    {
+      task = std::move(victim.tasks.back());
+      victim.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void ThreadPool::work(const std::size_t& index)
+{
+  while (true)
+  {
+    std::function<void()> task;
+    if (popOwnTask(index, task) || stealTask(index, task))
+    {
+      --num_pending_tasks_;
+      task();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleep_cv_.wait(lock, [this]() { return terminated_ || num_pending_tasks_ > 0; });
+    if (terminated_ && num_pending_tasks_ == 0)
+    {
+      return;
+    }
+  }
+}
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSEN_SCAN_V2_STANDALONE_THREAD_POOL_H
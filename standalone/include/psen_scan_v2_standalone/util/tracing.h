@@ -0,0 +1,394 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#ifndef PSEN_SCAN_V2_STANDALONE_TRACING_H
+#define PSEN_SCAN_V2_STANDALONE_TRACING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <fmt/format.h>
+
+#include "psen_scan_v2_standalone/util/latency_histogram.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace util
+{
+//! @brief A span of the hot path recorded by the Tracer.
+struct TraceEvent
+{
+  //! Has to be a string literal, only the pointer is stored.
+  const char* name{ nullptr };
+  LatencyClock::time_point begin{};
+  LatencyClock::time_point end{};
+};
+
+/**
+ * @brief Ring buffer holding the most recent spans of one thread.
+ *
+ * Only the owning thread pushes events. The mutex is merely taken by the thread dumping the trace, so it is not
+ * contended during normal operation.
+ */
+class TraceBuffer
+{
+public:
+  TraceBuffer(const std::size_t& capacity, const uint64_t& thread_id, const std::string& thread_name);
+
+public:
+  void push(const TraceEvent& event);
+  //! @returns the buffered events, oldest first.
+  std::vector<TraceEvent> events() const;
+  void clear();
+
+  uint64_t threadId() const;
+  const std::string& threadName() const;
+
+private:
+  const uint64_t thread_id_;
+  const std::string thread_name_;
+
+  mutable std::mutex mutex_;
+  std::vector<TraceEvent> events_;
+  std::size_t next_{ 0 };
+  bool wrapped_{ false };
+};
+
+/**
+ * @brief Records spans of the hot path (receive, deserialization, state machine, watchdogs, user callback) and
+ * exports them in the Chrome trace event format, which can be opened with chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Tracing is disabled by default. While disabled a span costs a single relaxed atomic load. Once enabled each
+ * thread records into its own ring buffer of BUFFER_CAPACITY events, so that only the most recent spans are kept.
+ * The buffers of finished threads are kept till the next call of clear(), so that they can still be dumped.
+ *
+ * The tracer is a process-wide singleton, the spans are not assigned to the scanner which caused them. Therefore
+ * enable() and disable() are counted, so that tracing stays enabled till every user who enabled it disabled it again.
+ *
+ * The instrumentation can be removed completely at compile time by defining PSENSCAN_DISABLE_TRACING
+ * (CMake option ENABLE_TRACING=OFF).
+ *
+ * @see PSENSCAN_TRACE_SPAN
+ */
+class Tracer
+{
+public:
+  static constexpr std::size_t BUFFER_CAPACITY{ 16384 };
+
+public:
+  static Tracer& instance();
+
+public:
+  //! @brief Enables tracing for one more user.
+  void enable();
+  /**
+   * @brief Disables tracing for one user. Calls without a matching enable() are ignored.
+   *
+   * @returns true if tracing is disabled afterwards, i.e. there is no other user left.
+   */
+  bool disable();
+  bool isEnabled() const;
+
+  //! @brief Adds a span to the ring buffer of the calling thread. The name has to be a string literal.
+  void record(const char* name, const LatencyClock::time_point& begin, const LatencyClock::time_point& end);
+
+  //! @brief Writes all buffered spans as Chrome trace JSON. Can be called while spans are recorded.
+  void writeChromeTrace(std::ostream& os) const;
+  //! @throws std::runtime_error if the file cannot be written.
+  void writeChromeTrace(const std::string& file_name) const;
+
+  //! @brief Drops all buffered spans and the buffers of finished threads.
+  void clear();
+
+private:
+  Tracer() = default;
+
+  TraceBuffer& threadBuffer();
+  static std::string currentThreadName();
+
+private:
+  std::atomic_bool enabled_{ false };
+  std::mutex users_mutex_;
+  std::size_t number_of_users_{ 0 };
+
+  mutable std::mutex buffers_mutex_;
+  std::vector<std::shared_ptr<TraceBuffer>> buffers_;
+  uint64_t next_thread_id_{ 1 };
+};
+
+/**
+ * @brief Records the lifetime of the object as span, if the Tracer is enabled at the time of the construction.
+ *
+ * Use the PSENSCAN_TRACE_SPAN macro instead of this class, so that the span can be compiled out.
+ */
+class TraceSpan
+{
+public:
+  explicit TraceSpan(const char* name);
+  ~TraceSpan();
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+  const char* name_;
+  const bool enabled_;
+  LatencyClock::time_point begin_{};
+};
+
+inline TraceBuffer::TraceBuffer(const std::size_t& capacity, const uint64_t& thread_id, const std::string& thread_name)
+  : thread_id_(thread_id), thread_name_(thread_name), events_(capacity)
+{
+}
+
+inline void TraceBuffer::push(const TraceEvent& event)
+{
+  const std::lock_guard<std::mutex> lock(mutex_);
+  events_[next_] = event;
+  if (++next_ == events_.size())
+  {
+    next_ = 0;
+    wrapped_ = true;
+  }
+}
+
+inline std::vector<TraceEvent> TraceBuffer::events() const
+{
+  const std::lock_guard<std::mutex> lock(mutex_);
+  if (!wrapped_)
+  {
+    return std::vector<TraceEvent>(events_.cbegin(), events_.cbegin() + next_);
+  }
+  std::vector<TraceEvent> events(events_.cbegin() + next_, events_.cend());
+  events.insert(events.end(), events_.cbegin(), events_.cbegin() + next_);
+  return events;
+}
+
+inline void TraceBuffer::clear()
+{
+  const std::lock_guard<std::mutex> lock(mutex_);
+  next_ = 0;
+  wrapped_ = false;
+}
+
+inline uint64_t TraceBuffer::threadId() const
+{
+  return thread_id_;
+}
+
+inline const std::string& TraceBuffer::threadName() const
+{
+  return thread_name_;
+}
+
+inline Tracer& Tracer::instance()
+{
+  static Tracer tracer;
+  return tracer;
+}
+
+inline void Tracer::enable()
+{
+  const std::lock_guard<std::mutex> lock(users_mutex_);
+  ++number_of_users_;
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+inline bool Tracer::disable()
+{
+  const std::lock_guard<std::mutex> lock(users_mutex_);
+  if (number_of_users_ > 0)
+  {
+    --number_of_users_;
+  }
+  enabled_.store(number_of_users_ > 0, std::memory_order_relaxed);
+  return number_of_users_ == 0;
+}
+
+inline bool Tracer::isEnabled() const
+{
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+inline void Tracer::record(const char* name, const LatencyClock::time_point& begin, const LatencyClock::time_point& end)
+{
+  threadBuffer().push(TraceEvent{ name, begin, end });
+}
+
+inline TraceBuffer& Tracer::threadBuffer()
+{
+  // The thread keeps one reference, so that the buffer is known to be finished once only the tracer holds it.
+  static thread_local std::shared_ptr<TraceBuffer> buffer;
+  if (!buffer)
+  {
+    const std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffer = std::make_shared<TraceBuffer>(std::size_t{ BUFFER_CAPACITY }, next_thread_id_++, currentThreadName());
+    buffers_.push_back(buffer);
+  }
+  return *buffer;
+}
+
+inline std::string Tracer::currentThreadName()
+{
+#ifdef __linux__
+  char name[16]{};
+  if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0)
+  {
+    return name;
+  }
+#endif
+  return "";  // LCOV_EXCL_LINE
+}
+
+namespace tracing
+{
+inline std::string escapeJson(const std::string& str)
+{
+  std::string escaped;
+  for (const char& c : str)
+  {
+    if (c == '"' || c == '\\')
+    {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+inline double toMicroseconds(const LatencyClock::duration& duration)
+{
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+}  // namespace tracing
+
+inline void Tracer::writeChromeTrace(std::ostream& os) const
+{
+  std::vector<std::shared_ptr<TraceBuffer>> buffers;
+  {
+    const std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffers = buffers_;
+  }
+#ifdef __linux__
+  const int pid{ static_cast<int>(getpid()) };
+#else
+  const int pid{ 0 };
+#endif
+
+  os << "{\"traceEvents\":[";
+  bool first{ true };
+  const auto separator = [&first]() {
+    const char* sep{ first ? "\n" : ",\n" };
+    first = false;
+    return sep;
+  };
+  for (const auto& buffer : buffers)
+  {
+    os << separator()
+       << fmt::format(R"({{"name":"thread_name","ph":"M","pid":{},"tid":{},"args":{{"name":"{}"}}}})",
+                      pid,
+                      buffer->threadId(),
+                      tracing::escapeJson(buffer->threadName()));
+    for (const TraceEvent& event : buffer->events())
+    {
+      os << separator()
+         << fmt::format(R"({{"name":"{}","cat":"psen_scan_v2","ph":"X","pid":{},"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                        event.name,
+                        pid,
+                        buffer->threadId(),
+                        tracing::toMicroseconds(event.begin.time_since_epoch()),
+                        tracing::toMicroseconds(event.end - event.begin));
+    }
+  }
+  os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+inline void Tracer::writeChromeTrace(const std::string& file_name) const
+{
+  std::ofstream file(file_name);
+  if (!file)
+  {
+    throw std::runtime_error("Could not open trace file " + file_name);
+  }
+  writeChromeTrace(file);
+  if (!file)
+  {
+    throw std::runtime_error("Could not write trace file " + file_name);  // LCOV_EXCL_LINE
+  }
+}
+
+inline void Tracer::clear()
+{
+  const std::lock_guard<std::mutex> lock(buffers_mutex_);
+  std::vector<std::shared_ptr<TraceBuffer>> buffers_of_running_threads;
+  for (const auto& buffer : buffers_)
+  {
+    if (buffer.use_count() > 1)
+    {
+      buffer->clear();
+      buffers_of_running_threads.push_back(buffer);
+    }
+  }
+  buffers_ = std::move(buffers_of_running_threads);
+}
+
+inline TraceSpan::TraceSpan(const char* name) : name_(name), enabled_(Tracer::instance().isEnabled())
+{
+  if (enabled_)
+  {
+    begin_ = LatencyClock::now();
+  }
+}
+
+inline TraceSpan::~TraceSpan()
+{
+  if (enabled_)
+  {
+    Tracer::instance().record(name_, begin_, LatencyClock::now());
+  }
+}
+
+}  // namespace util
+}  // namespace psen_scan_v2_standalone
+
+#define PSENSCAN_TRACE_CONCAT_INTERNAL(a, b) a##b
+#define PSENSCAN_TRACE_CONCAT(a, b) PSENSCAN_TRACE_CONCAT_INTERNAL(a, b)
+
+/**
+ * @brief Records the rest of the enclosing scope as span with the specified name (a string literal).
+ *
+ * Expands to nothing if PSENSCAN_DISABLE_TRACING is defined.
+ */
+#ifdef PSENSCAN_DISABLE_TRACING
+#define PSENSCAN_TRACE_SPAN(name)
+#else
+#define PSENSCAN_TRACE_SPAN(name)                                                                                      \
+  const psen_scan_v2_standalone::util::TraceSpan PSENSCAN_TRACE_CONCAT(psenscan_trace_span_, __LINE__)(name)
+#endif
+
+#endif  // PSEN_SCAN_V2_STANDALONE_TRACING_H
@@ -15,13 +15,18 @@
 #ifndef PSEN_SCAN_V2_STANDALONE_WATCHDOG_H
 #define PSEN_SCAN_V2_STANDALONE_WATCHDOG_H
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <thread>
 #include <atomic>
 #include <condition_variable>
+#include <stdexcept>
+#include <vector>
 
 #include "psen_scan_v2_standalone/util/async_barrier.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+#include "psen_scan_v2_standalone/util/tracing.h"
 
 namespace psen_scan_v2_standalone
 {
@@ -35,14 +40,25 @@ namespace util
  *
  * After the specified timeout time has passed the timeout_handler is called and the timer restarts.
  * This continues as long as the watchdog exists.
+ *
+ * Instead of a single timeout a schedule of timeouts can be specified: The n-th call of the timeout_handler happens
+ * after the n-th timeout of the schedule, the last timeout is repeated from then on. A reset() restarts the current
+ * timeout, it does not rewind the schedule.
  */
 class Watchdog
 {
 public:
   using Timeout = const std::chrono::high_resolution_clock::duration;
+  using Schedule = std::vector<std::chrono::high_resolution_clock::duration>;
 
 public:
-  Watchdog(const Timeout& timeout, const std::function<void()>& timeout_handler);
+  Watchdog(const Timeout& timeout,
+           const std::function<void()>& timeout_handler,
+           const ThreadSettings& thread_settings = ThreadSettings());
+  //! @throws std::invalid_argument if the schedule is empty.
+  Watchdog(const Schedule& schedule,
+           const std::function<void()>& timeout_handler,
+           const ThreadSettings& thread_settings = ThreadSettings());
   ~Watchdog();
 
 public:
@@ -50,6 +66,8 @@ public:
   void reset();
 
 private:
+  static const Schedule& validated(const Schedule& schedule);
+
   /**
    * @returns std::cv_status::timeout if the specified timeout has expired or std::cv_status::no_timeout
    * if the condition variable was notified.
@@ -68,22 +86,35 @@ private:
   std::thread timer_thread_;
 };
 
-inline Watchdog::Watchdog(const Timeout& timeout, const std::function<void()>& timeout_handler)
-  : timer_thread_([this, timeout, timeout_handler]() {
+inline Watchdog::Watchdog(const Timeout& timeout,
+                          const std::function<void()>& timeout_handler,
+                          const ThreadSettings& thread_settings)
+  : Watchdog(Schedule{ timeout }, timeout_handler, thread_settings)
+{
+}
+
+inline Watchdog::Watchdog(const Schedule& schedule,
+                          const std::function<void()>& timeout_handler,
+                          const ThreadSettings& thread_settings)
+  : timer_thread_([this, schedule = validated(schedule), timeout_handler]() {
     thread_startetd_barrier_.release();
+    std::size_t timeout_index{ 0 };
     while (!terminated_)
     {
-      if ((this->wait_for(timeout) == std::cv_status::timeout) && !terminated_)
+      if ((this->wait_for(schedule[timeout_index]) == std::cv_status::timeout) && !terminated_)
       {
+        PSENSCAN_TRACE_SPAN("watchdog");
+        timeout_index = std::min(timeout_index + 1, schedule.size() - 1);
         timeout_handler();
       }
     }
   })
 {
+  applyThreadSettings(timer_thread_, thread_settings);
   // The timer_thread does not always immediately start because the system schedules threads
   // "at a whim". To ensure that the thread is running after the completion of the constructor,
   // we wait until the first command of the thread is executed.
-  if (!thread_startetd_barrier_.waitTillRelease(timeout))
+  if (!thread_startetd_barrier_.waitTillRelease(*std::max_element(schedule.begin(), schedule.end())))
   {
     // Difficult to test because this is a timing problem.
     // LCOV_EXCL_START
@@ -92,6 +123,15 @@ inline Watchdog::Watchdog(const Timeout& timeout, const std::function<void()>& t
   }
 }
 
+inline const Watchdog::Schedule& Watchdog::validated(const Schedule& schedule)
+{
+  if (schedule.empty())
+  {
+    throw std::invalid_argument("The schedule of a watchdog needs at least one timeout");
+  }
+  return schedule;
+}
+
 inline std::cv_status Watchdog::wait_for(const Timeout& timeout)
 {
   std::unique_lock<std::mutex> lk(cv_m_);
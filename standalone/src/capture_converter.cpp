@@ -0,0 +1,279 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+#include <boost/optional.hpp>
+
+#include "psen_scan_v2_standalone/capture_converter.h"
+
+#include "psen_scan_v2_standalone/scanner_configuration.h"
+#include "psen_scan_v2_standalone/configuration/default_parameters.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/laserscan_conversions.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
+#include "psen_scan_v2_standalone/protocol_layer/scan_buffer.h"
+#include "psen_scan_v2_standalone/protocol_layer/scanner_state_machine.h"
+
+namespace psen_scan_v2_standalone
+{
+using communication_layer::RecordedDatagram;
+using data_conversion_layer::monitoring_frame::Message;
+
+//! @brief More chunks than threads balance the load if the chunks take different times.
+static constexpr std::size_t CHUNKS_PER_THREAD{ 4 };
+
+namespace
+{
+struct ConvertedChunk
+{
+  std::vector<CapturedScan> scans;
+  CaptureConversionStatistics statistics;
+};
+}  // namespace
+
+static boost::optional<Message> deserialize(const RecordedDatagram& datagram)
+{
+  try
+  {
+    Message frame{ data_conversion_layer::monitoring_frame::deserialize(datagram.data, datagram.data.size()) };
+    // Throws if the frame has no scan counter.
+    frame.scanCounter();
+    return frame;
+  }
+  catch (const std::runtime_error&)
+  {
+    return boost::none;
+  }
+}
+
+static void addScan(const std::vector<Message>& frames,
+                    const std::chrono::nanoseconds& timestamp,
+                    ConvertedChunk& chunk)
+{
+  if (std::all_of(frames.begin(), frames.end(), [](const Message& frame) { return frame.measurements().empty(); }))
+  {
+    return;
+  }
+  try
+  {
+    chunk.scans.push_back(CapturedScan{ timestamp, data_conversion_layer::LaserScanConverter::toLaserScan(frames) });
+    ++chunk.statistics.scans;
+  }
+  catch (const data_conversion_layer::ScannerProtocolViolationError&)
+  {
+    ++chunk.statistics.dropped_rounds;
+  }
+}
+
+/**
+ * @brief Converts the datagrams of a chunk like a single ScanBuffer would convert them as part of the whole capture.
+ *
+ * Only the first round of the capture is dropped silently if it is incomplete. Incomplete rounds at the start of
+ * later chunks and at the end of all chunks but the last are counted as dropped, like the ScanBuffer counts them if
+ * the next round starts. Therefore, the result does not depend on the number of chunks.
+ */
+static ConvertedChunk convertChunk(std::vector<RecordedDatagram>::const_iterator begin,
+                                   const std::vector<RecordedDatagram>::const_iterator& end,
+                                   const bool& fragmented_scans,
+                                   const bool& first_chunk,
+                                   const bool& last_chunk)
+{
+  ConvertedChunk chunk;
+  protocol_layer::ScanBuffer scan_buffer(protocol_layer::DEFAULT_NUM_MSG_PER_ROUND, !first_chunk);
+  boost::optional<uint32_t> first_scan_counter;
+  for (; begin != end; ++begin)
+  {
+    ++chunk.statistics.datagrams;
+    const auto frame{ deserialize(*begin) };
+    if (!frame)
+    {
+      ++chunk.statistics.decode_errors;
+      continue;
+    }
+    if (!first_scan_counter)
+    {
+      first_scan_counter = frame->scanCounter();
+    }
+
+    try
+    {
+      scan_buffer.add(*frame);
+      if (scan_buffer.hasIncompleteFirstRound())
+      {
+        scan_buffer.takeIncompleteFirstRound();
+        ++chunk.statistics.dropped_rounds;
+      }
+      if (!fragmented_scans && scan_buffer.isRoundComplete())
+      {
+        addScan(scan_buffer.getMsgs(), begin->timestamp, chunk);
+      }
+    }
+    catch (const protocol_layer::OutdatedMessageError&)
+    {
+      ++chunk.statistics.outdated_frames;
+    }
+    catch (const protocol_layer::ScanRoundError&)
+    {
+      ++chunk.statistics.dropped_rounds;
+    }
+    if (fragmented_scans)
+    {
+      addScan({ *frame }, begin->timestamp, chunk);
+    }
+  }
+
+  // The next chunk starts with the next round, which ends the last round of this chunk.
+  const std::vector<Message> last_round{ scan_buffer.getMsgs() };
+  const bool first_round_of_capture{ first_chunk && !last_round.empty() &&
+                                     last_round[0].scanCounter() == *first_scan_counter };
+  if (!last_chunk && !first_round_of_capture && !last_round.empty() &&
+      last_round.size() < protocol_layer::DEFAULT_NUM_MSG_PER_ROUND)
+  {
+    ++chunk.statistics.dropped_rounds;
+  }
+  return chunk;
+}
+
+static void add(const CaptureConversionStatistics& chunk_statistics, CaptureConversionStatistics& statistics)
+{
+  statistics.datagrams += chunk_statistics.datagrams;
+  statistics.scans += chunk_statistics.scans;
+  statistics.decode_errors += chunk_statistics.decode_errors;
+  statistics.dropped_rounds += chunk_statistics.dropped_rounds;
+  statistics.outdated_frames += chunk_statistics.outdated_frames;
+}
+
+CaptureConverter::CaptureConverter(const bool& fragmented_scans, const std::size_t& number_of_threads)
+  : fragmented_scans_(fragmented_scans), number_of_threads_(number_of_threads)
+{
+  if (number_of_threads_ == 0)
+  {
+    throw std::invalid_argument("The conversion needs at least one thread");
+  }
+}
+
+std::vector<std::size_t> CaptureConverter::findChunks(const std::vector<RecordedDatagram>& datagrams,
+                                                      const std::size_t& number_of_chunks)
+{
+  std::vector<std::size_t> chunks;
+  if (datagrams.empty())
+  {
+    return chunks;
+  }
+  chunks.push_back(0);
+  const std::size_t size{ datagrams.size() };
+  for (std::size_t chunk = 1; chunk < number_of_chunks; ++chunk)
+  {
+    // Moves the boundary forward to the first datagram of the next scan round. A round starts with a scan counter
+    // higher than all before. The round before the boundary is taken into account, so that outdated frames do not
+    // start a chunk. Frames which are outdated by more than one round are not expected.
+    std::size_t i{ std::max(chunk * size / number_of_chunks, chunks.back() + 1) };
+    boost::optional<uint32_t> max_scan_counter;
+    const std::size_t lookback_begin{ i > protocol_layer::DEFAULT_NUM_MSG_PER_ROUND ?
+                                          i - protocol_layer::DEFAULT_NUM_MSG_PER_ROUND :
+                                          0 };
+    for (std::size_t j = lookback_begin; j < i && j < size; ++j)
+    {
+      const auto frame{ deserialize(datagrams[j]) };
+      if (frame && (!max_scan_counter || frame->scanCounter() > *max_scan_counter))
+      {
+        max_scan_counter = frame->scanCounter();
+      }
+    }
+    for (; i < size; ++i)
+    {
+      const auto frame{ deserialize(datagrams[i]) };
+      if (!frame)
+      {
+        continue;
+      }
+      if (max_scan_counter && frame->scanCounter() > *max_scan_counter)
+      {
+        break;
+      }
+      if (!max_scan_counter)
+      {
+        max_scan_counter = frame->scanCounter();
+      }
+    }
+    if (i >= size)
+    {
+      break;
+    }
+    chunks.push_back(i);
+  }
+  return chunks;
+}
+
+CaptureConversionStatistics CaptureConverter::convert(const std::vector<RecordedDatagram>& datagrams,
+                                                      const ScanHandler& handler) const
+{
+  const std::vector<std::size_t> chunks{ findChunks(datagrams, number_of_threads_ * CHUNKS_PER_THREAD) };
+  std::vector<std::future<ConvertedChunk>> converted_chunks(chunks.size());
+
+  util::ThreadSettings thread_settings;
+  thread_settings.name = configuration::CAPTURE_CONVERTER_THREAD_NAME;
+  util::ThreadPool pool(number_of_threads_, thread_settings);
+  std::size_t next_chunk{ 0 };
+  const auto post_next_chunk = [&]() {
+    const auto begin{ datagrams.begin() + static_cast<std::ptrdiff_t>(chunks[next_chunk]) };
+    const auto end{ next_chunk + 1 < chunks.size() ?
+                        datagrams.begin() + static_cast<std::ptrdiff_t>(chunks[next_chunk + 1]) :
+                        datagrams.end() };
+    const bool fragmented_scans{ fragmented_scans_ };
+    const bool first_chunk{ next_chunk == 0 };
+    const bool last_chunk{ next_chunk + 1 == chunks.size() };
+    auto task{ std::make_shared<std::packaged_task<ConvertedChunk()>>(
+        [begin, end, fragmented_scans, first_chunk, last_chunk]() {
+          return convertChunk(begin, end, fragmented_scans, first_chunk, last_chunk);
+        }) };
+    converted_chunks[next_chunk++] = task->get_future();
+    pool.post([task]() { (*task)(); });
+  };
+
+  // Limits the number of converted chunks waiting for the handler.
+  while (next_chunk < std::min(chunks.size(), 2 * number_of_threads_))
+  {
+    post_next_chunk();
+  }
+  CaptureConversionStatistics statistics;
+  for (auto& converted_chunk : converted_chunks)
+  {
+    const ConvertedChunk chunk{ converted_chunk.get() };
+    if (next_chunk < chunks.size())
+    {
+      post_next_chunk();
+    }
+    for (const auto& scan : chunk.scans)
+    {
+      handler(scan);
+    }
+    add(chunk.statistics, statistics);
+  }
+  return statistics;
+}
+
+std::vector<CapturedScan> CaptureConverter::convert(const std::vector<RecordedDatagram>& datagrams) const
+{
+  std::vector<CapturedScan> scans;
+  convert(datagrams, [&scans](const CapturedScan& scan) { scans.push_back(scan); });
+  return scans;
+}
+
+}  // namespace psen_scan_v2_standalone
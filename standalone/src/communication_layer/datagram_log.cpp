@@ -0,0 +1,557 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+#include <fmt/format.h>
+
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace communication_layer
+{
+static const std::string DATAGRAM_LOG_MAGIC{ "PSENDGRM" };
+static constexpr uint32_t DATAGRAM_LOG_VERSION{ 1 };
+static const std::string FLIGHT_RECORDING_MAGIC{ "PSENFLRC" };
+static constexpr uint32_t FLIGHT_RECORDING_VERSION{ 1 };
+
+static constexpr uint32_t PCAP_MAGIC_MICROSECONDS{ 0xa1b2c3d4 };
+static constexpr uint32_t PCAP_MAGIC_NANOSECONDS{ 0xa1b23c4d };
+static constexpr uint32_t PCAPNG_MAGIC{ 0x0a0d0d0a };
+static constexpr std::size_t PCAP_HEADER_SIZE{ 24 };
+static constexpr std::size_t PCAP_LINK_TYPE_OFFSET{ 20 };
+static constexpr std::size_t PCAP_RECORD_HEADER_SIZE{ 16 };
+static constexpr uint16_t PCAP_VERSION_MAJOR{ 2 };
+static constexpr uint16_t PCAP_VERSION_MINOR{ 4 };
+static constexpr uint32_t PCAP_SNAP_LENGTH{ 65535 };
+//! Upper limit of the snap length used by tcpdump and Wireshark.
+static constexpr std::size_t PCAP_MAX_RECORD_SIZE{ 262144 };
+
+// Link types, see https://www.tcpdump.org/linktypes.html
+static constexpr uint32_t LINKTYPE_NULL{ 0 };
+static constexpr uint32_t LINKTYPE_ETHERNET{ 1 };
+static constexpr uint32_t LINKTYPE_RAW{ 101 };
+static constexpr uint32_t LINKTYPE_LINUX_SLL{ 113 };
+static constexpr uint32_t LINKTYPE_IPV4{ 228 };
+static constexpr uint32_t LINKTYPE_LINUX_SLL2{ 276 };
+
+static constexpr uint16_t ETHERTYPE_IPV4{ 0x0800 };
+static constexpr uint16_t ETHERTYPE_VLAN{ 0x8100 };
+static constexpr uint16_t ETHERTYPE_QINQ{ 0x88a8 };
+static constexpr uint32_t NULL_FAMILY_INET{ 2 };
+
+static constexpr std::size_t IPV4_MIN_HEADER_SIZE{ 20 };
+static constexpr uint8_t IP_PROTOCOL_UDP{ 17 };
+static constexpr uint8_t IPV4_TIME_TO_LIVE{ 64 };
+static constexpr uint16_t IP_MORE_FRAGMENTS{ 0x2000 };
+static constexpr uint16_t IP_FRAGMENT_OFFSET_MASK{ 0x1fff };
+static constexpr std::size_t UDP_HEADER_SIZE{ 8 };
+//! Maximal payload of a UDP datagram.
+static constexpr std::size_t MAX_DATAGRAM_SIZE{ 65507 };
+
+DatagramLogError::DatagramLogError(const std::string& msg) : std::runtime_error(msg)
+{
+}
+
+template <typename T>
+static std::size_t encodeLittleEndian(char* buffer, const T& value)
+{
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+  {
+    buffer[i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff);
+  }
+  return sizeof(T);
+}
+
+template <typename T>
+static std::size_t encodeBigEndian(char* buffer, const T& value)
+{
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+  {
+    buffer[i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * (sizeof(T) - 1 - i))) & 0xff);
+  }
+  return sizeof(T);
+}
+
+template <typename T>
+static T readLittleEndian(const char* data)
+{
+  uint64_t value{ 0 };
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+  {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+  }
+  return static_cast<T>(value);
+}
+
+template <typename T>
+static T readBigEndian(const char* data)
+{
+  uint64_t value{ 0 };
+  for (std::size_t i = 0; i < sizeof(T); ++i)
+  {
+    value = (value << 8) | static_cast<uint8_t>(data[i]);
+  }
+  return static_cast<T>(value);
+}
+
+static bool readExactly(std::istream& is, char* data, const std::size_t& length)
+{
+  is.read(data, static_cast<std::streamsize>(length));
+  return static_cast<std::size_t>(is.gcount()) == length;
+}
+
+std::size_t encodeDatagramLogHeader(char* buffer)
+{
+  std::copy(DATAGRAM_LOG_MAGIC.begin(), DATAGRAM_LOG_MAGIC.end(), buffer);
+  const std::size_t size{ DATAGRAM_LOG_MAGIC.size() };
+  return size + encodeLittleEndian<uint32_t>(buffer + size, DATAGRAM_LOG_VERSION);
+}
+
+std::size_t encodeDatagramLogRecordHeader(char* buffer,
+                                          const std::chrono::nanoseconds& timestamp,
+                                          const std::size_t& length)
+{
+  std::size_t size{ encodeLittleEndian<uint64_t>(buffer, static_cast<uint64_t>(timestamp.count())) };
+  size += encodeLittleEndian<uint32_t>(buffer + size, static_cast<uint32_t>(length));
+  return size;
+}
+
+std::size_t encodeFlightRecordingHeader(char* buffer, const uint64_t& capacity)
+{
+  std::fill(buffer, buffer + FLIGHT_RECORDING_HEADER_SIZE, 0);
+  std::copy(FLIGHT_RECORDING_MAGIC.begin(), FLIGHT_RECORDING_MAGIC.end(), buffer);
+  encodeLittleEndian<uint32_t>(buffer + FLIGHT_RECORDING_MAGIC.size(), FLIGHT_RECORDING_VERSION);
+  encodeLittleEndian<uint64_t>(buffer + FLIGHT_RECORDING_CAPACITY_OFFSET, capacity);
+  return FLIGHT_RECORDING_HEADER_SIZE;
+}
+
+std::size_t encodeFlightRecordHeader(char* buffer, const std::chrono::nanoseconds& timestamp, const std::size_t& length)
+{
+  const std::size_t size{ encodeDatagramLogRecordHeader(buffer, timestamp, length) };
+  std::fill(buffer + size, buffer + FLIGHT_RECORD_HEADER_SIZE, 0);
+  return FLIGHT_RECORD_HEADER_SIZE;
+}
+
+std::size_t encodePcapHeader(char* buffer)
+{
+  std::size_t size{ encodeLittleEndian<uint32_t>(buffer, PCAP_MAGIC_NANOSECONDS) };
+  size += encodeLittleEndian<uint16_t>(buffer + size, PCAP_VERSION_MAJOR);
+  size += encodeLittleEndian<uint16_t>(buffer + size, PCAP_VERSION_MINOR);
+  size += encodeLittleEndian<uint32_t>(buffer + size, 0);  // time zone
+  size += encodeLittleEndian<uint32_t>(buffer + size, 0);  // accuracy of the timestamps
+  size += encodeLittleEndian<uint32_t>(buffer + size, PCAP_SNAP_LENGTH);
+  size += encodeLittleEndian<uint32_t>(buffer + size, LINKTYPE_IPV4);
+  return size;
+}
+
+//! @returns the internet checksum (RFC 1071) of the IPv4 header.
+static uint16_t ipv4HeaderChecksum(const char* header)
+{
+  uint32_t sum{ 0 };
+  for (std::size_t i = 0; i < IPV4_MIN_HEADER_SIZE; i += 2)
+  {
+    sum += readBigEndian<uint16_t>(header + i);
+  }
+  while (sum > 0xffff)
+  {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return static_cast<uint16_t>(~sum);
+}
+
+std::size_t encodePcapRecordHeader(char* buffer,
+                                   const std::chrono::nanoseconds& timestamp,
+                                   const std::size_t& length,
+                                   const UdpEndpoints& endpoints)
+{
+  const auto seconds{ std::chrono::duration_cast<std::chrono::seconds>(timestamp) };
+  const std::size_t packet_length{ IPV4_MIN_HEADER_SIZE + UDP_HEADER_SIZE + length };
+  std::size_t size{ encodeLittleEndian<uint32_t>(buffer, static_cast<uint32_t>(seconds.count())) };
+  size += encodeLittleEndian<uint32_t>(buffer + size, static_cast<uint32_t>((timestamp - seconds).count()));
+  size += encodeLittleEndian<uint32_t>(buffer + size, static_cast<uint32_t>(packet_length));
+  size += encodeLittleEndian<uint32_t>(buffer + size, static_cast<uint32_t>(packet_length));
+
+  char* ip_header{ buffer + size };
+  size += encodeBigEndian<uint8_t>(buffer + size, 0x45);  // version 4, header length 20 bytes
+  size += encodeBigEndian<uint8_t>(buffer + size, 0);
+  size += encodeBigEndian<uint16_t>(buffer + size, static_cast<uint16_t>(packet_length));
+  size += encodeBigEndian<uint16_t>(buffer + size, 0);  // identification
+  size += encodeBigEndian<uint16_t>(buffer + size, 0);  // flags and fragment offset
+  size += encodeBigEndian<uint8_t>(buffer + size, IPV4_TIME_TO_LIVE);
+  size += encodeBigEndian<uint8_t>(buffer + size, IP_PROTOCOL_UDP);
+  size += encodeBigEndian<uint16_t>(buffer + size, 0);  // checksum, see below
+  size += encodeBigEndian<uint32_t>(buffer + size, endpoints.source_ip);
+  size += encodeBigEndian<uint32_t>(buffer + size, endpoints.destination_ip);
+  encodeBigEndian<uint16_t>(ip_header + 10, ipv4HeaderChecksum(ip_header));
+
+  size += encodeBigEndian<uint16_t>(buffer + size, endpoints.source_port);
+  size += encodeBigEndian<uint16_t>(buffer + size, endpoints.destination_port);
+  size += encodeBigEndian<uint16_t>(buffer + size, static_cast<uint16_t>(UDP_HEADER_SIZE + length));
+  size += encodeBigEndian<uint16_t>(buffer + size, 0);  // no checksum
+  return size;
+}
+
+void writeDatagramLogHeader(std::ostream& os)
+{
+  std::array<char, MAX_FILE_HEADER_SIZE> header;
+  os.write(header.data(), static_cast<std::streamsize>(encodeDatagramLogHeader(header.data())));
+}
+
+void writeDatagramLogRecord(std::ostream& os,
+                            const std::chrono::nanoseconds& timestamp,
+                            const char* data,
+                            const std::size_t& length)
+{
+  std::array<char, MAX_RECORD_HEADER_SIZE> header;
+  const std::size_t header_size{ encodeDatagramLogRecordHeader(header.data(), timestamp, length) };
+  os.write(header.data(), static_cast<std::streamsize>(header_size));
+  os.write(data, static_cast<std::streamsize>(length));
+}
+
+std::vector<RecordedDatagram> readDatagramLog(std::istream& is)
+{
+  std::array<char, 12> header;
+  if (!readExactly(is, header.data(), header.size()) ||
+      std::string(header.data(), DATAGRAM_LOG_MAGIC.size()) != DATAGRAM_LOG_MAGIC)
+  {
+    throw DatagramLogError("No raw datagram log.");
+  }
+  const auto version{ readLittleEndian<uint32_t>(header.data() + DATAGRAM_LOG_MAGIC.size()) };
+  if (version != DATAGRAM_LOG_VERSION)
+  {
+    throw DatagramLogError(fmt::format("Unsupported version {} of the raw datagram log.", version));
+  }
+
+  std::vector<RecordedDatagram> datagrams;
+  std::array<char, 12> record_header;
+  while (readExactly(is, record_header.data(), record_header.size()))
+  {
+    RecordedDatagram datagram;
+    datagram.timestamp = std::chrono::nanoseconds(readLittleEndian<uint64_t>(record_header.data()));
+    const auto length{ readLittleEndian<uint32_t>(record_header.data() + 8) };
+    if (length > MAX_DATAGRAM_SIZE)
+    {
+      throw DatagramLogError(fmt::format("Corrupt raw datagram log, a datagram has {} bytes.", length));
+    }
+    datagram.data.resize(length);
+    if (!readExactly(is, datagram.data.data(), datagram.data.size()))
+    {
+      break;
+    }
+    datagrams.push_back(std::move(datagram));
+  }
+  return datagrams;
+}
+
+std::vector<RecordedDatagram> readFlightRecording(std::istream& is)
+{
+  std::array<char, FLIGHT_RECORDING_HEADER_SIZE> header;
+  if (!readExactly(is, header.data(), header.size()) ||
+      std::string(header.data(), FLIGHT_RECORDING_MAGIC.size()) != FLIGHT_RECORDING_MAGIC)
+  {
+    throw DatagramLogError("No flight recording.");
+  }
+  const auto version{ readLittleEndian<uint32_t>(header.data() + FLIGHT_RECORDING_MAGIC.size()) };
+  if (version != FLIGHT_RECORDING_VERSION)
+  {
+    throw DatagramLogError(fmt::format("Unsupported version {} of the flight recording.", version));
+  }
+  const auto capacity{ readLittleEndian<uint64_t>(header.data() + FLIGHT_RECORDING_CAPACITY_OFFSET) };
+  const auto tail{ readLittleEndian<uint64_t>(header.data() + FLIGHT_RECORDING_TAIL_OFFSET) };
+  const auto head{ readLittleEndian<uint64_t>(header.data() + FLIGHT_RECORDING_HEAD_OFFSET) };
+  if (capacity == 0 || capacity % FLIGHT_RECORD_ALIGNMENT != 0 || head < tail || head - tail > capacity)
+  {
+    throw DatagramLogError("Corrupt header of the flight recording.");
+  }
+
+  std::string ring(capacity, '\0');
+  if (!readExactly(is, &ring[0], ring.size()))
+  {
+    throw DatagramLogError("Truncated flight recording.");
+  }
+  // Copies from the ring, wrapping around its end.
+  const auto copy = [&ring, &capacity](const uint64_t& position, const std::size_t& length, char* destination) {
+    const std::size_t offset{ static_cast<std::size_t>(position % capacity) };
+    const std::size_t first{ std::min<std::size_t>(length, ring.size() - offset) };
+    std::copy(ring.data() + offset, ring.data() + offset + first, destination);
+    std::copy(ring.data(), ring.data() + length - first, destination + first);
+  };
+
+  std::vector<RecordedDatagram> datagrams;
+  std::array<char, FLIGHT_RECORD_HEADER_SIZE> record_header;
+  for (uint64_t position = tail; position < head;)
+  {
+    if (head - position < FLIGHT_RECORD_HEADER_SIZE)
+    {
+      throw DatagramLogError("Corrupt flight recording, a record header is truncated.");
+    }
+    copy(position, record_header.size(), record_header.data());
+    RecordedDatagram datagram;
+    datagram.timestamp = std::chrono::nanoseconds(readLittleEndian<uint64_t>(record_header.data()));
+    const auto length{ readLittleEndian<uint32_t>(record_header.data() + 8) };
+    if (length > MAX_DATAGRAM_SIZE || length > head - position - FLIGHT_RECORD_HEADER_SIZE)
+    {
+      throw DatagramLogError(fmt::format("Corrupt flight recording, a datagram has {} bytes.", length));
+    }
+    datagram.data.resize(length);
+    copy(position + FLIGHT_RECORD_HEADER_SIZE, length, datagram.data.data());
+    datagrams.push_back(std::move(datagram));
+    position += (FLIGHT_RECORD_HEADER_SIZE + length + FLIGHT_RECORD_ALIGNMENT - 1) / FLIGHT_RECORD_ALIGNMENT *
+                FLIGHT_RECORD_ALIGNMENT;
+  }
+  return datagrams;
+}
+
+namespace
+{
+/**
+ * @brief Reassembles fragmented IPv4 packets.
+ */
+class Ipv4Reassembler
+{
+public:
+  /**
+   * @returns the complete payload of the packet, once all fragments have been added.
+   */
+  boost::optional<std::string> add(const char* ip_packet, const std::size_t& header_size, const std::size_t& length);
+
+private:
+  using Key = std::tuple<uint32_t, uint32_t, uint16_t>;
+  struct Fragments
+  {
+    std::map<std::size_t, std::string> payloads;
+    boost::optional<std::size_t> total_size;
+  };
+  std::map<Key, Fragments> pending_;
+};
+
+boost::optional<std::string>
+Ipv4Reassembler::add(const char* ip_packet, const std::size_t& header_size, const std::size_t& length)
+{
+  const auto flags_and_offset{ readBigEndian<uint16_t>(ip_packet + 6) };
+  const std::size_t offset{ static_cast<std::size_t>(flags_and_offset & IP_FRAGMENT_OFFSET_MASK) * 8 };
+  const bool more_fragments{ (flags_and_offset & IP_MORE_FRAGMENTS) != 0 };
+  std::string payload(ip_packet + header_size, length - header_size);
+  if (offset == 0 && !more_fragments)
+  {
+    return payload;
+  }
+
+  const Key key{ readBigEndian<uint32_t>(ip_packet + 12),
+                 readBigEndian<uint32_t>(ip_packet + 16),
+                 readBigEndian<uint16_t>(ip_packet + 4) };
+  Fragments& fragments{ pending_[key] };
+  if (!more_fragments)
+  {
+    fragments.total_size = offset + payload.size();
+  }
+  fragments.payloads[offset] = std::move(payload);
+  if (!fragments.total_size)
+  {
+    return boost::none;
+  }
+
+  std::string reassembled;
+  for (const auto& fragment : fragments.payloads)
+  {
+    if (fragment.first != reassembled.size())
+    {
+      return boost::none;
+    }
+    reassembled += fragment.second;
+  }
+  if (reassembled.size() != fragments.total_size.value())
+  {
+    return boost::none;
+  }
+  pending_.erase(key);
+  return reassembled;
+}
+
+//! @returns the offset of the IPv4 header within the captured frame, if the frame contains an IPv4 packet.
+boost::optional<std::size_t> ipv4Offset(const uint32_t& link_type, const std::string& frame, const bool& swapped)
+{
+  switch (link_type)
+  {
+    case LINKTYPE_NULL:
+    {
+      if (frame.size() < 4)
+      {
+        return boost::none;
+      }
+      // The address family is stored in the byte order of the capturing host.
+      const auto family{ swapped ? readBigEndian<uint32_t>(frame.data()) : readLittleEndian<uint32_t>(frame.data()) };
+      return family == NULL_FAMILY_INET ? boost::optional<std::size_t>(4) : boost::none;
+    }
+    case LINKTYPE_ETHERNET:
+    {
+      std::size_t ethertype_offset{ 12 };
+      while (frame.size() >= ethertype_offset + 2)
+      {
+        const auto ethertype{ readBigEndian<uint16_t>(frame.data() + ethertype_offset) };
+        if (ethertype == ETHERTYPE_VLAN || ethertype == ETHERTYPE_QINQ)
+        {
+          ethertype_offset += 4;
+          continue;
+        }
+        return ethertype == ETHERTYPE_IPV4 ? boost::optional<std::size_t>(ethertype_offset + 2) : boost::none;
+      }
+      return boost::none;
+    }
+    case LINKTYPE_RAW:
+    case LINKTYPE_IPV4:
+      return std::size_t{ 0 };
+    case LINKTYPE_LINUX_SLL:
+      if (frame.size() < 16 || readBigEndian<uint16_t>(frame.data() + 14) != ETHERTYPE_IPV4)
+      {
+        return boost::none;
+      }
+      return std::size_t{ 16 };
+    case LINKTYPE_LINUX_SLL2:
+      if (frame.size() < 20 || readBigEndian<uint16_t>(frame.data()) != ETHERTYPE_IPV4)
+      {
+        return boost::none;
+      }
+      return std::size_t{ 20 };
+    default:
+      return boost::none;
+  }
+}
+}  // namespace
+
+std::vector<RecordedDatagram> readPcap(std::istream& is, const boost::optional<unsigned short>& udp_port)
+{
+  std::array<char, PCAP_HEADER_SIZE> header;
+  if (!readExactly(is, header.data(), header.size()))
+  {
+    throw DatagramLogError("No pcap file.");
+  }
+  const auto magic{ readLittleEndian<uint32_t>(header.data()) };
+  const auto swapped_magic{ readBigEndian<uint32_t>(header.data()) };
+  if (magic == PCAPNG_MAGIC)
+  {
+    throw DatagramLogError("pcapng files are not supported. Convert the file with \"editcap -F pcap\".");
+  }
+  if (magic != PCAP_MAGIC_MICROSECONDS && magic != PCAP_MAGIC_NANOSECONDS &&
+      swapped_magic != PCAP_MAGIC_MICROSECONDS && swapped_magic != PCAP_MAGIC_NANOSECONDS)
+  {
+    throw DatagramLogError("No pcap file.");
+  }
+  // The header is written in the byte order of the capturing host.
+  const bool swapped{ magic != PCAP_MAGIC_MICROSECONDS && magic != PCAP_MAGIC_NANOSECONDS };
+  const auto read32 = [swapped](const char* data) {
+    return swapped ? readBigEndian<uint32_t>(data) : readLittleEndian<uint32_t>(data);
+  };
+  const bool nanoseconds{ (swapped ? swapped_magic : magic) == PCAP_MAGIC_NANOSECONDS };
+  const uint32_t link_type{ read32(header.data() + PCAP_LINK_TYPE_OFFSET) & 0xffff };
+  if (link_type != LINKTYPE_NULL && link_type != LINKTYPE_ETHERNET && link_type != LINKTYPE_RAW &&
+      link_type != LINKTYPE_LINUX_SLL && link_type != LINKTYPE_IPV4 && link_type != LINKTYPE_LINUX_SLL2)
+  {
+    throw DatagramLogError(fmt::format("Unsupported link type {} of the pcap file.", link_type));
+  }
+
+  std::vector<RecordedDatagram> datagrams;
+  Ipv4Reassembler reassembler;
+  std::array<char, PCAP_RECORD_HEADER_SIZE> record_header;
+  std::string frame;
+  while (readExactly(is, record_header.data(), record_header.size()))
+  {
+    const std::size_t captured_length{ read32(record_header.data() + 8) };
+    if (captured_length > PCAP_MAX_RECORD_SIZE)
+    {
+      throw DatagramLogError(fmt::format("Corrupt pcap file, a packet has {} bytes.", captured_length));
+    }
+    frame.resize(captured_length);
+    if (!readExactly(is, &frame[0], frame.size()))
+    {
+      break;
+    }
+    const auto ip_offset{ ipv4Offset(link_type, frame, swapped) };
+    if (!ip_offset || frame.size() < ip_offset.value() + IPV4_MIN_HEADER_SIZE)
+    {
+      continue;
+    }
+    const char* ip_packet{ frame.data() + ip_offset.value() };
+    const std::size_t header_size{ static_cast<std::size_t>(ip_packet[0] & 0x0f) * 4 };
+    const std::size_t length{ readBigEndian<uint16_t>(ip_packet + 2) };
+    // Truncated packets (snap length too small) cannot be replayed.
+    if ((static_cast<uint8_t>(ip_packet[0]) >> 4) != 4 || static_cast<uint8_t>(ip_packet[9]) != IP_PROTOCOL_UDP ||
+        header_size < IPV4_MIN_HEADER_SIZE || length < header_size || frame.size() - ip_offset.value() < length)
+    {
+      continue;
+    }
+    const auto udp_packet{ reassembler.add(ip_packet, header_size, length) };
+    if (!udp_packet || udp_packet->size() < UDP_HEADER_SIZE)
+    {
+      continue;
+    }
+    const auto source_port{ readBigEndian<uint16_t>(udp_packet->data()) };
+    const auto destination_port{ readBigEndian<uint16_t>(udp_packet->data() + 2) };
+    const std::size_t udp_length{ readBigEndian<uint16_t>(udp_packet->data() + 4) };
+    if ((udp_port && source_port != udp_port.value() && destination_port != udp_port.value()) ||
+        udp_length < UDP_HEADER_SIZE || udp_length > udp_packet->size())
+    {
+      continue;
+    }
+
+    RecordedDatagram datagram;
+    const auto fraction{ read32(record_header.data() + 4) };
+    datagram.timestamp = std::chrono::seconds(read32(record_header.data())) +
+                         (nanoseconds ? std::chrono::nanoseconds(fraction) : std::chrono::microseconds(fraction));
+    datagram.data.assign(udp_packet->begin() + UDP_HEADER_SIZE, udp_packet->begin() + udp_length);
+    datagrams.push_back(std::move(datagram));
+  }
+  return datagrams;
+}
+
+std::vector<RecordedDatagram> readRecording(const std::string& filename,
+                                            const boost::optional<unsigned short>& udp_port)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file)
+  {
+    throw DatagramLogError(fmt::format("Could not open {}.", filename));
+  }
+  std::array<char, 8> magic{};
+  file.read(magic.data(), magic.size());
+  file.clear();
+  file.seekg(0);
+  if (std::string(magic.data(), magic.size()) == DATAGRAM_LOG_MAGIC)
+  {
+    return readDatagramLog(file);
+  }
+  if (std::string(magic.data(), magic.size()) == FLIGHT_RECORDING_MAGIC)
+  {
+    return readFlightRecording(file);
+  }
+  try
+  {
+    return readPcap(file, udp_port);
+  }
+  catch (const DatagramLogError& e)
+  {
+    throw DatagramLogError(
+        fmt::format("{} is neither a raw datagram log, a flight recording nor a pcap file: {}", filename, e.what()));
+  }
+}
+
+}  // namespace communication_layer
+}  // namespace psen_scan_v2_standalone
@@ -0,0 +1,226 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "psen_scan_v2_standalone/communication_layer/datagram_recorder.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/raw_scanner_data.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace communication_layer
+{
+//! Amount of data written at once.
+static constexpr std::size_t BATCH_SIZE{ 1 << 20 };
+//! Alignment of buffers, sizes and file offsets required by O_DIRECT on common file systems.
+static constexpr std::size_t BLOCK_SIZE{ 4096 };
+//! The batch can take one more record after reaching BATCH_SIZE.
+static constexpr std::size_t BATCH_CAPACITY{ (BATCH_SIZE + MAX_RECORD_HEADER_SIZE +
+                                              data_conversion_layer::MAX_UDP_PAKET_SIZE + BLOCK_SIZE - 1) /
+                                             BLOCK_SIZE * BLOCK_SIZE };
+//! Time the writer thread sleeps if the queue is empty.
+static constexpr std::chrono::milliseconds IDLE_PERIOD{ 10 };
+//! Maximal time a record stays in the batch, so that the file is useful even if the process crashes.
+static constexpr std::chrono::seconds FLUSH_PERIOD{ 1 };
+
+constexpr std::size_t DatagramRecorder::DEFAULT_QUEUE_CAPACITY;
+
+static bool isPcapFilename(const std::string& filename)
+{
+  static const std::string PCAP_EXTENSION{ ".pcap" };
+  return filename.size() >= PCAP_EXTENSION.size() &&
+         filename.compare(filename.size() - PCAP_EXTENSION.size(), PCAP_EXTENSION.size(), PCAP_EXTENSION) == 0;
+}
+
+void DatagramRecorder::AlignedDeleter::operator()(char* buffer) const
+{
+  std::free(buffer);
+}
+
+DatagramRecorder::DatagramRecorder(const std::string& filename,
+                                   const UdpEndpoints& endpoints,
+                                   const std::size_t& queue_capacity,
+                                   const util::ThreadSettings& thread_settings)
+  : filename_(filename), pcap_(isPcapFilename(filename)), endpoints_(endpoints), queue_(queue_capacity)
+{
+  constexpr int flags{ O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC };
+#ifdef O_DIRECT
+  fd_ = ::open(filename_.c_str(), flags | O_DIRECT, 0644);
+  direct_io_ = fd_ >= 0;
+  if (fd_ < 0 && errno == EINVAL)
+  {
+    // The file system (e.g. tmpfs) does not support O_DIRECT.
+    fd_ = ::open(filename_.c_str(), flags, 0644);
+  }
+#else
+  fd_ = ::open(filename_.c_str(), flags, 0644);
+#endif
+  if (fd_ < 0)
+  {
+    throw std::runtime_error(fmt::format("Could not open {}: {}", filename_, std::strerror(errno)));
+  }
+
+  void* batch{ nullptr };
+  if (posix_memalign(&batch, BLOCK_SIZE, BATCH_CAPACITY) != 0)
+  {
+    ::close(fd_);
+    throw std::bad_alloc();
+  }
+  batch_.reset(static_cast<char*>(batch));
+  batch_size_ = pcap_ ? encodePcapHeader(batch_.get()) : encodeDatagramLogHeader(batch_.get());
+
+  writer_thread_ = std::thread(&DatagramRecorder::writeLoop, this);
+  util::applyThreadSettings(writer_thread_, thread_settings);
+}
+
+DatagramRecorder::~DatagramRecorder()
+{
+  terminated_ = true;
+  if (writer_thread_.joinable())
+  {
+    writer_thread_.join();
+  }
+  ::close(fd_);
+  PSENSCAN_INFO("DatagramRecorder",
+                "Recorded {} datagrams to {}, dropped {}.",
+                numberOfRecordedDatagrams(),
+                filename_,
+                numberOfDroppedDatagrams());
+}
+
+void DatagramRecorder::tap(const std::chrono::nanoseconds& receive_time, const char* data, const std::size_t& length)
+{
+  RecordedDatagram* slot{ queue_.beginPush() };
+  if (!slot)
+  {
+    dropped_datagrams_.fetch_add(1, std::memory_order_relaxed);
+    PSENSCAN_WARN_THROTTLE(1 /* sec */, "DatagramRecorder", "The writer cannot keep up, dropping datagrams.");
+    return;
+  }
+  // The slots are reused, so their buffers only grow until they fit the largest datagram.
+  slot->timestamp = receive_time;
+  slot->data.assign(data, data + length);
+  queue_.commitPush();
+}
+
+uint64_t DatagramRecorder::numberOfRecordedDatagrams() const
+{
+  return recorded_datagrams_.load(std::memory_order_relaxed);
+}
+
+uint64_t DatagramRecorder::numberOfDroppedDatagrams() const
+{
+  return dropped_datagrams_.load(std::memory_order_relaxed);
+}
+
+void DatagramRecorder::writeLoop()
+{
+  auto last_write{ std::chrono::steady_clock::now() };
+  while (true)
+  {
+    // Read before draining the queue, so that no datagram queued before the termination is lost.
+    const bool terminated{ terminated_ };
+    while (const RecordedDatagram* datagram = queue_.front())
+    {
+      encode(*datagram);
+      queue_.pop();
+      if (batch_size_ >= BATCH_SIZE)
+      {
+        writeBatch(false);
+        last_write = std::chrono::steady_clock::now();
+      }
+    }
+    if (terminated)
+    {
+      break;
+    }
+    if (std::chrono::steady_clock::now() - last_write >= FLUSH_PERIOD)
+    {
+      writeBatch(false);
+      last_write = std::chrono::steady_clock::now();
+    }
+    std::this_thread::sleep_for(IDLE_PERIOD);
+  }
+  writeBatch(true);
+}
+
+void DatagramRecorder::encode(const RecordedDatagram& datagram)
+{
+  if (write_failed_)
+  {
+    dropped_datagrams_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  char* record{ batch_.get() + batch_size_ };
+  const std::size_t length{ datagram.data.size() };
+  const std::size_t header_size{ pcap_ ? encodePcapRecordHeader(record, datagram.timestamp, length, endpoints_) :
+                                         encodeDatagramLogRecordHeader(record, datagram.timestamp, length) };
+  std::copy(datagram.data.begin(), datagram.data.end(), record + header_size);
+  batch_size_ += header_size + datagram.data.size();
+  recorded_datagrams_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void DatagramRecorder::writeBatch(const bool& all)
+{
+  std::size_t size{ batch_size_ };
+#ifdef O_DIRECT
+  if (direct_io_ && all)
+  {
+    // The last block is incomplete, which O_DIRECT does not allow.
+    ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) & ~O_DIRECT);
+    direct_io_ = false;
+  }
+#endif
+  if (direct_io_)
+  {
+    size -= size % BLOCK_SIZE;
+  }
+
+  std::size_t written{ 0 };
+  while (written < size)
+  {
+    const ssize_t result{ ::write(fd_, batch_.get() + written, size - written) };
+    if (result < 0 && errno != EINTR)
+    {
+      PSENSCAN_ERROR(
+          "DatagramRecorder", "Could not write to {}: {}. Stopping the recording.", filename_, std::strerror(errno));
+      write_failed_ = true;
+      batch_size_ = 0;
+      return;
+    }
+    written += result > 0 ? static_cast<std::size_t>(result) : 0;
+  }
+  std::memmove(batch_.get(), batch_.get() + size, batch_size_ - size);
+  batch_size_ -= size;
+}
+
+}  // namespace communication_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // __linux__
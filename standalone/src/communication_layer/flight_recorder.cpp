@@ -0,0 +1,283 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "psen_scan_v2_standalone/communication_layer/flight_recorder.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The flight recorder stores the positions of the ring as native integers, which have to be little endian."
+#endif
+
+namespace psen_scan_v2_standalone
+{
+namespace communication_layer
+{
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "The positions are stored as plain uint64.");
+
+static std::size_t alignedRecordSize(const std::size_t& length)
+{
+  return (FLIGHT_RECORD_HEADER_SIZE + length + FLIGHT_RECORD_ALIGNMENT - 1) / FLIGHT_RECORD_ALIGNMENT *
+         FLIGHT_RECORD_ALIGNMENT;
+}
+
+FlightRecorder::FlightRecorder(const std::string& filename, const std::size_t& capacity)
+  : filename_(filename)
+  , capacity_((std::max<std::size_t>(capacity, 1) + FLIGHT_RECORD_ALIGNMENT - 1) / FLIGHT_RECORD_ALIGNMENT *
+              FLIGHT_RECORD_ALIGNMENT)
+{
+  fd_ = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0)
+  {
+    throw std::runtime_error(fmt::format("Could not open {}: {}", filename_, std::strerror(errno)));
+  }
+  mapping_size_ = FLIGHT_RECORDING_HEADER_SIZE + capacity_;
+  if (::ftruncate(fd_, static_cast<off_t>(mapping_size_)) != 0)
+  {
+    const int error{ errno };
+    ::close(fd_);
+    throw std::runtime_error(fmt::format("Could not resize {}: {}", filename_, std::strerror(error)));
+  }
+  void* mapping{ ::mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0) };
+  if (mapping == MAP_FAILED)
+  {
+    const int error{ errno };
+    ::close(fd_);
+    throw std::runtime_error(fmt::format("Could not map {}: {}", filename_, std::strerror(error)));
+  }
+  mapping_ = static_cast<char*>(mapping);
+  ring_ = mapping_ + FLIGHT_RECORDING_HEADER_SIZE;
+
+  // Allocates the pages of the page cache now instead of on the receive path.
+  std::fill(ring_, ring_ + capacity_, 0);
+  encodeFlightRecordingHeader(mapping_, capacity_);
+  tail_ = new (mapping_ + FLIGHT_RECORDING_TAIL_OFFSET) std::atomic<uint64_t>(0);
+  head_ = new (mapping_ + FLIGHT_RECORDING_HEAD_OFFSET) std::atomic<uint64_t>(0);
+}
+
+FlightRecorder::~FlightRecorder()
+{
+  if (signal_service_)
+  {
+    signal_service_->stop();
+    signal_thread_.join();
+  }
+  ::munmap(mapping_, mapping_size_);
+  ::close(fd_);
+  PSENSCAN_INFO("FlightRecorder",
+                "Recorded {} datagrams to {}, dropped {}.",
+                numberOfRecordedDatagrams(),
+                filename_,
+                numberOfDroppedDatagrams());
+}
+
+std::size_t FlightRecorder::capacityFor(const std::chrono::seconds& duration,
+                                        const double& datagrams_per_second,
+                                        const double& bytes_per_second)
+{
+  // Each record has a header and is padded to the alignment.
+  const double record_bytes_per_second{ datagrams_per_second * (FLIGHT_RECORD_HEADER_SIZE + FLIGHT_RECORD_ALIGNMENT) +
+                                        bytes_per_second };
+  return static_cast<std::size_t>(std::ceil(static_cast<double>(duration.count()) * record_bytes_per_second));
+}
+
+void FlightRecorder::tap(const std::chrono::nanoseconds& receive_time, const char* data, const std::size_t& length)
+{
+  const std::size_t record_size{ alignedRecordSize(length) };
+  if (record_size > capacity_)
+  {
+    dropped_datagrams_.fetch_add(1, std::memory_order_relaxed);
+    PSENSCAN_WARN_THROTTLE(1 /* sec */, "FlightRecorder", "Datagram of {} bytes does not fit into the ring.", length);
+    return;
+  }
+
+  const uint64_t head{ head_->load(std::memory_order_relaxed) };
+  uint64_t tail{ tail_->load(std::memory_order_relaxed) };
+  while (head + record_size - tail > capacity_)
+  {
+    tail += recordSizeAt(tail);
+  }
+  // Readers of a snapshot detect the overwritten records by rereading the tail after copying the ring.
+  tail_->store(tail, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  char header[FLIGHT_RECORD_HEADER_SIZE];
+  encodeFlightRecordHeader(header, receive_time, length);
+  copyToRing(head, header, FLIGHT_RECORD_HEADER_SIZE);
+  copyToRing(head + FLIGHT_RECORD_HEADER_SIZE, data, length);
+  head_->store(head + record_size, std::memory_order_release);
+  recorded_datagrams_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<RecordedDatagram> FlightRecorder::snapshot() const
+{
+  const uint64_t tail{ tail_->load(std::memory_order_acquire) };
+  const uint64_t head{ head_->load(std::memory_order_acquire) };
+  std::vector<char> ring(static_cast<std::size_t>(head - tail));
+  copyFromRing(tail, ring.size(), ring.data());
+  std::atomic_thread_fence(std::memory_order_acquire);
+  // Records before the current tail might have been overwritten while copying.
+  const uint64_t valid_tail{ std::max(tail, tail_->load(std::memory_order_relaxed)) };
+
+  std::vector<RecordedDatagram> datagrams;
+  for (uint64_t position = valid_tail; position < head;)
+  {
+    const char* record{ ring.data() + (position - tail) };
+    RecordedDatagram datagram;
+    uint64_t timestamp;
+    uint32_t length;
+    std::memcpy(&timestamp, record, sizeof(timestamp));
+    std::memcpy(&length, record + sizeof(timestamp), sizeof(length));
+    datagram.timestamp = std::chrono::nanoseconds(timestamp);
+    datagram.data.assign(record + FLIGHT_RECORD_HEADER_SIZE, record + FLIGHT_RECORD_HEADER_SIZE + length);
+    datagrams.push_back(std::move(datagram));
+    position += alignedRecordSize(length);
+  }
+  return datagrams;
+}
+
+void FlightRecorder::writeSnapshot(const std::string& filename) const
+{
+  const auto datagrams{ snapshot() };
+  std::ofstream file(filename, std::ios::binary);
+  writeDatagramLogHeader(file);
+  for (const auto& datagram : datagrams)
+  {
+    writeDatagramLogRecord(file, datagram.timestamp, datagram.data.data(), datagram.data.size());
+  }
+  file.flush();
+  if (!file)
+  {
+    throw std::runtime_error(fmt::format("Could not write the snapshot to {}.", filename));
+  }
+  PSENSCAN_INFO("FlightRecorder", "Wrote snapshot of {} datagrams to {}.", datagrams.size(), filename);
+}
+
+void FlightRecorder::snapshotOnSignal(const int& signal_number,
+                                      const std::string& snapshot_prefix,
+                                      const util::ThreadSettings& thread_settings)
+{
+  if (signal_service_)
+  {
+    throw std::logic_error("The snapshots on a signal are already enabled.");
+  }
+  signal_service_ = std::make_unique<boost::asio::io_service>();
+  signals_ = std::make_unique<boost::asio::signal_set>(*signal_service_, signal_number);
+  waitForSignal(snapshot_prefix);
+  signal_thread_ = std::thread([this]() { signal_service_->run(); });
+  util::applyThreadSettings(signal_thread_, thread_settings);
+}
+
+void FlightRecorder::waitForSignal(const std::string& snapshot_prefix)
+{
+  signals_->async_wait([this, snapshot_prefix](const boost::system::error_code& error, int /*signal_number*/) {
+    if (error)
+    {
+      return;
+    }
+    const auto now{ std::chrono::system_clock::now().time_since_epoch() };
+    try
+    {
+      writeSnapshot(fmt::format(
+          "{}_{}.log", snapshot_prefix, std::chrono::duration_cast<std::chrono::milliseconds>(now).count()));
+    }
+    catch (const std::runtime_error& e)
+    {
+      PSENSCAN_ERROR("FlightRecorder", "{}", e.what());
+    }
+    waitForSignal(snapshot_prefix);
+  });
+}
+
+std::size_t FlightRecorder::capacity() const
+{
+  return capacity_;
+}
+
+uint64_t FlightRecorder::numberOfRecordedDatagrams() const
+{
+  return recorded_datagrams_.load(std::memory_order_relaxed);
+}
+
+uint64_t FlightRecorder::numberOfDroppedDatagrams() const
+{
+  return dropped_datagrams_.load(std::memory_order_relaxed);
+}
+
+void FlightRecorder::copyToRing(const uint64_t& position, const char* data, const std::size_t& length)
+{
+  const std::size_t offset{ static_cast<std::size_t>(position % capacity_) };
+  const std::size_t first{ std::min(length, capacity_ - offset) };
+  std::memcpy(ring_ + offset, data, first);
+  std::memcpy(ring_, data + first, length - first);
+}
+
+void FlightRecorder::copyFromRing(const uint64_t& position, const std::size_t& length, char* destination) const
+{
+  const std::size_t offset{ static_cast<std::size_t>(position % capacity_) };
+  const std::size_t first{ std::min(length, capacity_ - offset) };
+  std::memcpy(destination, ring_ + offset, first);
+  std::memcpy(destination + first, ring_, length - first);
+}
+
+std::size_t FlightRecorder::recordSizeAt(const uint64_t& position) const
+{
+  char header[FLIGHT_RECORD_HEADER_SIZE];
+  copyFromRing(position, FLIGHT_RECORD_HEADER_SIZE, header);
+  uint32_t length;
+  std::memcpy(&length, header + sizeof(uint64_t), sizeof(length));
+  return alignedRecordSize(length);
+}
+
+std::vector<data_conversion_layer::monitoring_frame::Message>
+decodeMonitoringFrames(const std::vector<RecordedDatagram>& datagrams)
+{
+  std::vector<data_conversion_layer::monitoring_frame::Message> frames;
+  frames.reserve(datagrams.size());
+  for (const auto& datagram : datagrams)
+  {
+    try
+    {
+      frames.push_back(data_conversion_layer::monitoring_frame::deserialize(datagram.data, datagram.data.size()));
+    }
+    catch (const std::exception& e)
+    {
+      PSENSCAN_DEBUG("FlightRecorder", "Skipping datagram which is no valid monitoring frame: {}", e.what());
+    }
+  }
+  return frames;
+}
+
+}  // namespace communication_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // __linux__
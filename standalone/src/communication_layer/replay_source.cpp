@@ -0,0 +1,148 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <stdexcept>
+
+#include "psen_scan_v2_standalone/communication_layer/replay_source.h"
+
+#include "psen_scan_v2_standalone/util/tracing.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace communication_layer
+{
+constexpr double ReplaySource::AS_FAST_AS_POSSIBLE;
+
+ReplaySource::ReplaySource(const NewDataHandler& data_handler,
+                           std::vector<RecordedDatagram> datagrams,
+                           const double& speed,
+                           const util::ThreadSettings& thread_settings)
+  : data_handler_(data_handler)
+  , datagrams_(std::move(datagrams))
+  , speed_(speed)
+  , thread_settings_(thread_settings)
+{
+  if (!data_handler_)
+  {
+    throw std::invalid_argument("DataHandler is invalid");
+  }
+  if (speed_ < 0.)
+  {
+    throw std::invalid_argument("The replay speed must not be negative");
+  }
+}
+
+ReplaySource::~ReplaySource()
+{
+  stopReceiving();
+  {
+    const std::lock_guard<std::mutex> lock(terminated_mutex_);
+    terminated_ = true;
+  }
+  terminated_cv_.notify_all();
+  if (playback_thread_.joinable())
+  {
+    playback_thread_.join();
+  }
+}
+
+void ReplaySource::startAsyncReceiving(const ReceiveMode& modi)
+{
+  receive_single_datagram_ = modi == ReceiveMode::single;
+  receiving_ = true;
+}
+
+void ReplaySource::write(const data_conversion_layer::RawData& /*data*/)
+{
+}
+
+void ReplaySource::stopReceiving()
+{
+  receiving_ = false;
+}
+
+boost::asio::ip::address_v4 ReplaySource::getHostIp()
+{
+  return boost::asio::ip::address_v4::loopback();
+}
+
+uint64_t ReplaySource::numberOfReceivedDatagrams() const
+{
+  return received_datagrams_.load(std::memory_order_relaxed);
+}
+
+uint64_t ReplaySource::numberOfReceivedBytes() const
+{
+  return received_bytes_.load(std::memory_order_relaxed);
+}
+
+uint64_t ReplaySource::numberOfDroppedDatagrams() const
+{
+  return 0;
+}
+
+std::future<void> ReplaySource::play()
+{
+  if (playback_thread_.joinable())
+  {
+    throw std::logic_error("The playback has already been started");
+  }
+  auto finished{ finished_.get_future() };
+  playback_thread_ = std::thread(&ReplaySource::playBack, this);
+  util::applyThreadSettings(playback_thread_, thread_settings_);
+  return finished;
+}
+
+void ReplaySource::playBack()
+{
+  const auto start{ std::chrono::steady_clock::now() };
+  for (const auto& datagram : datagrams_)
+  {
+    {
+      std::unique_lock<std::mutex> lock(terminated_mutex_);
+      if (speed_ != AS_FAST_AS_POSSIBLE)
+      {
+        const std::chrono::duration<double, std::nano> offset{ (datagram.timestamp - datagrams_.front().timestamp) /
+                                                               speed_ };
+        terminated_cv_.wait_until(lock,
+                                  start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset),
+                                  [this]() { return terminated_; });
+      }
+      if (terminated_)
+      {
+        break;
+      }
+    }
+    if (!receiving_)
+    {
+      continue;
+    }
+    if (receive_single_datagram_)
+    {
+      receiving_ = false;
+    }
+    received_datagrams_.fetch_add(1, std::memory_order_relaxed);
+    received_bytes_.fetch_add(datagram.data.size(), std::memory_order_relaxed);
+    {
+      PSENSCAN_TRACE_SPAN("replay_receive");
+      data_handler_(datagram.data, datagram.data.size());
+    }
+  }
+  finished_.set_value();
+}
+
+}  // namespace communication_layer
+}  // namespace psen_scan_v2_standalone
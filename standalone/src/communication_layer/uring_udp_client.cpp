@@ -0,0 +1,618 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "psen_scan_v2_standalone/communication_layer/uring_udp_client.h"
+
+#ifdef PSENSCAN_ENABLE_IO_URING
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include "psen_scan_v2_standalone/util/logging.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace communication_layer
+{
+constexpr std::size_t UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS;
+
+// There is no wrapper of the C library for the io_uring system calls, the driver does not depend on liburing.
+static int ioUringSetup(const unsigned& entries, io_uring_params* params)
+{
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ioUringEnter(const int& ring_fd,
+                        const unsigned& to_submit,
+                        const unsigned& min_complete,
+                        const unsigned& flags)
+{
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int ioUringRegister(const int& ring_fd, const unsigned& opcode, const void* arg, const unsigned& nr_args)
+{
+  return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+static constexpr unsigned RING_ENTRIES{ 8 };
+static constexpr uint16_t BUFFER_GROUP{ 0 };
+//! @brief Index of the socket in the registered files.
+static constexpr int SOCKET_INDEX{ 0 };
+static constexpr std::size_t MAX_NUMBER_OF_BUFFERS{ 1u << 15 };
+
+//! @brief user_data of the submissions, which tells the completions apart.
+static constexpr uint64_t RECEIVE{ 1 };
+static constexpr uint64_t CANCEL_RECEIVE{ 2 };
+static constexpr uint64_t TERMINATE{ 3 };
+static constexpr uint64_t RECEIVE_MESSAGE{ 4 };
+
+//! @brief Room for the control message holding the receive timestamp of a datagram.
+static constexpr std::size_t CONTROL_SIZE{ CMSG_SPACE(sizeof(timespec)) };
+//! @brief Bytes which a multishot recvmsg writes in front of the datagram, the name of the sender is not requested.
+static constexpr std::size_t MESSAGE_HEADER_SIZE{ sizeof(io_uring_recvmsg_out) + CONTROL_SIZE };
+
+static std::string errorMessage(const std::string& what, const int& error_number)
+{
+  return what + ": " + std::strerror(error_number);
+}
+
+//! @brief Multishot receives with provided buffers are supported since Linux 6.0.
+static bool isKernelSupported()
+{
+  utsname name{};
+  int major{ 0 };
+  return uname(&name) == 0 && std::sscanf(name.release, "%d", &major) == 1 && major >= 6;
+}
+
+UringUdpClient::UringUdpClient(const NewDataHandler& data_handler,
+                               const ErrorHandler& error_handler,
+                               const unsigned short& host_port,
+                               const unsigned int& endpoint_ip,
+                               const unsigned short& endpoint_port,
+                               const util::ThreadSettings& thread_settings,
+                               const std::size_t& number_of_buffers,
+                               const std::size_t& max_datagram_size)
+  : data_handler_(data_handler), error_handler_(error_handler)
+{
+  if (!data_handler)
+  {
+    throw std::invalid_argument("New data handler is invalid");
+  }
+
+  if (!error_handler)
+  {
+    throw std::invalid_argument("Error handler is invalid");
+  }
+
+  if (!isKernelSupported())
+  {
+    throw UdpClientImpl::OpenConnectionFailure("The kernel does not support multishot receives of io_uring");
+  }
+
+  try
+  {
+    socket_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (socket_ < 0)
+    {
+      throw UdpClientImpl::OpenConnectionFailure(errorMessage("Could not open the socket", errno));
+    }
+
+    sockaddr_in host{};
+    host.sin_family = AF_INET;
+    host.sin_addr.s_addr = htonl(INADDR_ANY);
+    host.sin_port = htons(host_port);
+    if (::bind(socket_, reinterpret_cast<const sockaddr*>(&host), sizeof(host)) != 0)
+    {
+      throw UdpClientImpl::OpenConnectionFailure(errorMessage("Could not bind the socket", errno));
+    }
+
+    sockaddr_in endpoint{};
+    endpoint.sin_family = AF_INET;
+    endpoint.sin_addr.s_addr = htonl(endpoint_ip);
+    endpoint.sin_port = htons(endpoint_port);
+    if (::connect(socket_, reinterpret_cast<const sockaddr*>(&endpoint), sizeof(endpoint)) != 0)
+    {
+      throw UdpClientImpl::OpenConnectionFailure(errorMessage("Could not connect the socket", errno));
+    }
+
+    receive_message_.msg_controllen = CONTROL_SIZE;
+    payload_capacity_ = receiveBufferSize(max_datagram_size);
+    setUpRing();
+    setUpBufferRing(number_of_buffers, payload_capacity_ + MESSAGE_HEADER_SIZE);
+    if (ioUringRegister(ring_fd_, IORING_REGISTER_FILES, &socket_, 1) != 0)
+    {
+      throw UdpClientImpl::OpenConnectionFailure(errorMessage("Could not register the socket", errno));
+    }
+  }
+  catch (const UdpClientImpl::OpenConnectionFailure&)
+  {
+    closeAll();
+    throw;
+  }
+
+  io_thread_ = std::thread([this]() { completionLoop(); });
+  util::applyThreadSettings(io_thread_, thread_settings);
+}
+
+UringUdpClient::~UringUdpClient()
+{
+  closing_ = true;
+  {
+    const std::lock_guard<std::mutex> lock(submission_mutex_);
+    // The kernel must not write into the buffers anymore once they are freed, therefore, the receive is canceled
+    // and the io thread terminates not before its completion.
+    if (receive_armed_)
+    {
+      submit([this](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+        sqe.addr = receive_user_data_;
+        sqe.user_data = CANCEL_RECEIVE;
+      });
+    }
+    submit([](io_uring_sqe& sqe) {
+      sqe.opcode = IORING_OP_NOP;
+      sqe.user_data = TERMINATE;
+    });
+  }
+  if (io_thread_.joinable())
+  {
+    io_thread_.join();
+  }
+  closeAll();
+}
+
+void UringUdpClient::setUpRing()
+{
+  io_uring_params params{};
+  ring_fd_ = ioUringSetup(RING_ENTRIES, &params);
+  if (ring_fd_ < 0)
+  {
+    throw UdpClientImpl::OpenConnectionFailure(errorMessage("Could not set up the io_uring", errno));
+  }
+
+  rings_.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  rings_.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap{ (params.features & IORING_FEAT_SINGLE_MMAP) != 0 };
+  if (single_mmap)
+  {
+    rings_.sq_ring_size = std::max(rings_.sq_ring_size, rings_.cq_ring_size);
+  }
+
+  rings_.sq_ring = mmap(
+      nullptr, rings_.sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (rings_.sq_ring == MAP_FAILED)
+  {
+    rings_.sq_ring = nullptr;
+    throw UdpClientImpl::OpenConnectionFailure(errorMessage("Could not map the submission queue", errno));
+  }
+  if (single_mmap)
+  {
+    rings_.cq_ring = rings_.sq_ring;
+  }
+  else
+  {
+    rings_.cq_ring = mmap(
+        nullptr, rings_.cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (rings_.cq_ring == MAP_FAILED)
+    {
+      rings_.cq_ring = nullptr;
+      throw UdpClientImpl::OpenConnectionFailure(errorMessage("Could not map the completion queue", errno));
+    }
+  }
+
+  rings_.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes{ mmap(
+      nullptr, rings_.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES) };
+  if (sqes == MAP_FAILED)
+  {
+    throw UdpClientImpl::OpenConnectionFailure(errorMessage("Could not map the submission queue entries", errno));
+  }
+  rings_.sqes = static_cast<io_uring_sqe*>(sqes);
+
+  auto* sq_ring{ static_cast<char*>(rings_.sq_ring) };
+  rings_.sq_tail = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.tail);
+  rings_.sq_mask = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_mask);
+  rings_.sq_array = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.array);
+  auto* cq_ring{ static_cast<char*>(rings_.cq_ring) };
+  rings_.cq_head = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.head);
+  rings_.cq_tail = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.tail);
+  rings_.cq_mask = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.ring_mask);
+  rings_.cqes = reinterpret_cast<io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+}
+
+void UringUdpClient::setUpBufferRing(const std::size_t& number_of_buffers, const std::size_t& buffer_size)
+{
+  std::size_t entries{ 1 };
+  while (entries < std::min(number_of_buffers, MAX_NUMBER_OF_BUFFERS))
+  {
+    entries <<= 1;
+  }
+
+  // The ring has to be page aligned, which an anonymous mapping is.
+  buffer_ring_size_ = entries * sizeof(io_uring_buf);
+  void* buffer_ring{ mmap(nullptr, buffer_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+  if (buffer_ring == MAP_FAILED)
+  {
+    throw UdpClientImpl::OpenConnectionFailure(errorMessage("Could not allocate the buffer ring", errno));
+  }
+  buffer_ring_ = static_cast<io_uring_buf*>(buffer_ring);
+
+  io_uring_buf_reg registration{};
+  registration.ring_addr = reinterpret_cast<uint64_t>(buffer_ring_);
+  registration.ring_entries = static_cast<uint32_t>(entries);
+  registration.bgid = BUFFER_GROUP;
+  if (ioUringRegister(ring_fd_, IORING_REGISTER_PBUF_RING, &registration, 1) != 0)
+  {
+    throw UdpClientImpl::OpenConnectionFailure(errorMessage("Could not register the buffer ring", errno));
+  }
+
+  buffer_ring_mask_ = static_cast<uint16_t>(entries - 1);
+  buffers_.assign(entries, data_conversion_layer::RawData(buffer_size));
+  for (std::size_t buffer_id = 0; buffer_id < entries; ++buffer_id)
+  {
+    recycleBuffer(static_cast<uint16_t>(buffer_id));
+  }
+}
+
+void UringUdpClient::closeAll()
+{
+  if (rings_.sqes)
+  {
+    munmap(rings_.sqes, rings_.sqes_size);
+  }
+  if (rings_.cq_ring && rings_.cq_ring != rings_.sq_ring)
+  {
+    munmap(rings_.cq_ring, rings_.cq_ring_size);
+  }
+  if (rings_.sq_ring)
+  {
+    munmap(rings_.sq_ring, rings_.sq_ring_size);
+  }
+  rings_ = Rings();
+  if (ring_fd_ >= 0)
+  {
+    // The registered socket is only released by the asynchronous teardown of the ring otherwise, which keeps the
+    // port in use for a moment after the destruction.
+    ioUringRegister(ring_fd_, IORING_UNREGISTER_FILES, nullptr, 0);
+    ::close(ring_fd_);
+    ring_fd_ = -1;
+  }
+  // The kernel releases the buffer ring when the ring is closed.
+  if (buffer_ring_)
+  {
+    munmap(buffer_ring_, buffer_ring_size_);
+    buffer_ring_ = nullptr;
+  }
+  if (socket_ >= 0)
+  {
+    ::close(socket_);
+    socket_ = -1;
+  }
+}
+
+template <typename Preparation>
+void UringUdpClient::submit(const Preparation& prepare)
+{
+  // Only this client writes the tail, the kernel reads it.
+  const unsigned tail{ *rings_.sq_tail };
+  const unsigned index{ tail & *rings_.sq_mask };
+  io_uring_sqe& sqe{ rings_.sqes[index] };
+  sqe = io_uring_sqe();
+  prepare(sqe);
+  rings_.sq_array[index] = index;
+  __atomic_store_n(rings_.sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+  while (ioUringEnter(ring_fd_, 1, 0, 0) < 0)
+  {
+    // LCOV_EXCL_START
+    if (errno != EINTR)
+    {
+      PSENSCAN_ERROR("UdpClient", "Could not submit to the io_uring: {}", std::strerror(errno));
+      return;
+    }
+    // LCOV_EXCL_STOP
+  }
+}
+
+void UringUdpClient::armReceive(const ReceiveMode& modi)
+{
+  receive_mode_ = modi;
+  if (receive_armed_)
+  {
+    return;
+  }
+  // The receive timestamps of the datagrams are only delivered as control messages of a multishot recvmsg.
+  const uint64_t user_data{ receive_timestamps_ && modi == ReceiveMode::continuous ? RECEIVE_MESSAGE : RECEIVE };
+  submit([this, &modi, &user_data](io_uring_sqe& sqe) {
+    if (user_data == RECEIVE_MESSAGE)
+    {
+      sqe.opcode = IORING_OP_RECVMSG;
+      sqe.addr = reinterpret_cast<uint64_t>(&receive_message_);
+      sqe.len = 1;
+    }
+    else
+    {
+      sqe.opcode = IORING_OP_RECV;
+    }
+    sqe.fd = SOCKET_INDEX;
+    sqe.flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+    sqe.buf_group = BUFFER_GROUP;
+    if (modi == ReceiveMode::continuous)
+    {
+      sqe.ioprio = IORING_RECV_MULTISHOT;
+    }
+    sqe.user_data = user_data;
+  });
+  receive_user_data_ = user_data;
+  receive_armed_ = true;
+}
+
+void UringUdpClient::recycleBuffer(const uint16_t& buffer_id)
+{
+  io_uring_buf& entry{ buffer_ring_[buffer_ring_tail_ & buffer_ring_mask_] };
+  entry.addr = reinterpret_cast<uint64_t>(buffers_[buffer_id].data());
+  entry.len = static_cast<uint32_t>(receiveLength(buffer_id));
+  entry.bid = buffer_id;
+  ++buffer_ring_tail_;
+  // The tail of the ring overlays the reserved field of its first entry (see struct io_uring_buf_ring).
+  __atomic_store_n(&buffer_ring_[0].resv, buffer_ring_tail_, __ATOMIC_RELEASE);
+}
+
+std::size_t UringUdpClient::receiveLength(const uint16_t& buffer_id) const
+{
+  return receive_timestamps_ ? buffers_[buffer_id].size() : payload_capacity_;
+}
+
+std::size_t UringUdpClient::unpackMessage(const uint16_t& buffer_id, std::chrono::nanoseconds& receive_time)
+{
+  auto& buffer{ buffers_[buffer_id] };
+  io_uring_recvmsg_out header{};
+  std::memcpy(&header, buffer.data(), sizeof(header));
+
+  msghdr message{};
+  message.msg_control = buffer.data() + sizeof(header);
+  message.msg_controllen = header.controllen;
+  receive_time = std::chrono::nanoseconds(0);
+  for (cmsghdr* control = CMSG_FIRSTHDR(&message); control != nullptr; control = CMSG_NXTHDR(&message, control))
+  {
+    if (control->cmsg_level == SOL_SOCKET && control->cmsg_type == SCM_TIMESTAMPNS)
+    {
+      timespec timestamp{};
+      std::memcpy(&timestamp, CMSG_DATA(control), sizeof(timestamp));
+      receive_time = std::chrono::seconds(timestamp.tv_sec) + std::chrono::nanoseconds(timestamp.tv_nsec);
+    }
+  }
+  if (receive_time == std::chrono::nanoseconds(0))
+  {
+    // LCOV_EXCL_START
+    receive_time =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch());
+    // LCOV_EXCL_STOP
+  }
+
+  std::memmove(buffer.data(),
+               buffer.data() + MESSAGE_HEADER_SIZE,
+               std::min<std::size_t>(header.payloadlen, buffer.size() - MESSAGE_HEADER_SIZE));
+  if ((header.flags & MSG_TRUNC) != 0)
+  {
+    return std::max<std::size_t>(header.payloadlen, payload_capacity_);
+  }
+  return header.payloadlen;
+}
+
+void UringUdpClient::completionLoop()
+{
+  bool running{ true };
+  while (running)
+  {
+    if (ioUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+    {
+      // LCOV_EXCL_START
+      PSENSCAN_ERROR("UdpClient", "Could not wait for the completions of the io_uring: {}", std::strerror(errno));
+      return;
+      // LCOV_EXCL_STOP
+    }
+
+    unsigned head{ *rings_.cq_head };
+    const unsigned tail{ __atomic_load_n(rings_.cq_tail, __ATOMIC_ACQUIRE) };
+    for (; head != tail; ++head)
+    {
+      running = handleCompletion(rings_.cqes[head & *rings_.cq_mask]) && running;
+    }
+    __atomic_store_n(rings_.cq_head, head, __ATOMIC_RELEASE);
+
+    if (!running)
+    {
+      // A cancellation of the receive may complete after the termination request.
+      const std::lock_guard<std::mutex> lock(submission_mutex_);
+      running = receive_armed_;
+    }
+  }
+}
+
+bool UringUdpClient::handleCompletion(const io_uring_cqe& cqe)
+{
+  if (cqe.user_data == TERMINATE)
+  {
+    return false;
+  }
+  if (cqe.user_data != RECEIVE && cqe.user_data != RECEIVE_MESSAGE)
+  {
+    return true;
+  }
+
+  // Cleared before the data handler is called, so that it can arm the next single receive.
+  const bool receive_finished{ (cqe.flags & IORING_CQE_F_MORE) == 0 };
+  if (receive_finished)
+  {
+    const std::lock_guard<std::mutex> lock(submission_mutex_);
+    receive_armed_ = false;
+  }
+
+  const util::AllocationTagScope allocation_tag(util::AllocationTag::udp);
+  const bool has_buffer{ (cqe.flags & IORING_CQE_F_BUFFER) != 0 };
+  const auto buffer_id{ static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT) };
+  if (!closing_)
+  {
+    std::size_t bytes_received{ cqe.res > 0 ? static_cast<std::size_t>(cqe.res) : 0u };
+    std::chrono::nanoseconds receive_time{ 0 };
+    if (bytes_received > 0 && has_buffer && cqe.user_data == RECEIVE_MESSAGE)
+    {
+      bytes_received = unpackMessage(buffer_id, receive_time);
+    }
+    else if (bytes_received > 0 && has_buffer && !taps_.empty())
+    {
+      // Only a single datagram is received without recvmsg, so the last timestamp of the socket belongs to it.
+      receive_time = socketReceiveTimestamp(socket_);
+    }
+
+    if (bytes_received >= payload_capacity_ && has_buffer)
+    {
+      PSENSCAN_WARN_THROTTLE(1 /* sec */,
+                             "UdpClient",
+                             "Dropped a datagram exceeding the receive buffer of {} bytes.",
+                             payload_capacity_);
+      error_handler_("Datagram truncated");
+    }
+    else if (bytes_received > 0 && has_buffer)
+    {
+      PSENSCAN_TRACE_SPAN("receive");
+      received_datagrams_.fetch_add(1, std::memory_order_relaxed);
+      received_bytes_.fetch_add(bytes_received, std::memory_order_relaxed);
+      const auto& data{ buffers_[buffer_id] };
+      for (const auto& tap : taps_)
+      {
+        tap->tap(receive_time, data.data(), bytes_received);
+      }
+      data_handler_(data, bytes_received);
+    }
+    else if (cqe.res >= 0)
+    {
+      // A recv keeps the buffer for the next datagram, if the datagram is empty, a recvmsg consumes it.
+      error_handler_("Received an empty datagram");
+    }
+    // -ENOBUFS only means that the kernel ran out of buffers, which are recycled by now.
+    else if (cqe.res != -ENOBUFS && cqe.res != -ECANCELED)
+    {
+      error_handler_(std::strerror(-cqe.res));
+    }
+  }
+  if (has_buffer)
+  {
+    recycleBuffer(buffer_id);
+  }
+
+  if (receive_finished)
+  {
+    const std::lock_guard<std::mutex> lock(submission_mutex_);
+    if (receive_mode_ == ReceiveMode::continuous && !closing_)
+    {
+      armReceive(ReceiveMode::continuous);
+    }
+  }
+  return true;
+}
+
+void UringUdpClient::startAsyncReceiving(const ReceiveMode& modi)
+{
+  const std::lock_guard<std::mutex> lock(submission_mutex_);
+  armReceive(modi);
+}
+
+void UringUdpClient::write(const data_conversion_layer::RawData& data)
+{
+  if (::send(socket_, data.data(), data.size(), MSG_DONTWAIT) < 0)
+  {
+    // LCOV_EXCL_START
+    PSENSCAN_ERROR("UdpClient", "Failed to send data. Error message: {}", std::strerror(errno));
+    return;
+    // LCOV_EXCL_STOP
+  }
+  PSENSCAN_DEBUG("UdpClient", "Data successfully send.");
+}
+
+void UringUdpClient::stopReceiving()
+{
+  closing_ = true;
+}
+
+boost::asio::ip::address_v4 UringUdpClient::getHostIp()
+{
+  sockaddr_in host{};
+  socklen_t size{ sizeof(host) };
+  if (getsockname(socket_, reinterpret_cast<sockaddr*>(&host), &size) != 0)
+  {
+    throw std::runtime_error(errorMessage("Could not determine the address of the socket", errno));
+  }
+  return boost::asio::ip::address_v4(ntohl(host.sin_addr.s_addr));
+}
+
+uint64_t UringUdpClient::numberOfReceivedDatagrams() const
+{
+  return received_datagrams_.load(std::memory_order_relaxed);
+}
+
+uint64_t UringUdpClient::numberOfReceivedBytes() const
+{
+  return received_bytes_.load(std::memory_order_relaxed);
+}
+
+uint64_t UringUdpClient::numberOfDroppedDatagrams() const
+{
+  return socketDrops(socket_);
+}
+
+bool UringUdpClient::attachSocketFilter(std::vector<sock_filter> program)
+{
+  return setSocketFilter(socket_, program);
+}
+
+void UringUdpClient::addDatagramTap(std::shared_ptr<IDatagramTap> tap)
+{
+  const int enable{ 1 };
+  if (setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) != 0)
+  {
+    PSENSCAN_WARN("UdpClient", "Could not enable the receive timestamps of the socket: {}", std::strerror(errno));
+  }
+  if (!receive_timestamps_)
+  {
+    receive_timestamps_ = true;
+    // While not receiving every entry of the ring holds a buffer, which gets the room for the header of a recvmsg.
+    for (std::size_t index = 0; index <= buffer_ring_mask_; ++index)
+    {
+      buffer_ring_[index].len = static_cast<uint32_t>(receiveLength(buffer_ring_[index].bid));
+    }
+  }
+  taps_.push_back(std::move(tap));
+}
+
+}  // namespace communication_layer
+}  // namespace psen_scan_v2_standalone
+
+#endif  // PSENSCAN_ENABLE_IO_URING
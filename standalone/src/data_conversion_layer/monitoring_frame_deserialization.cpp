@@ -21,6 +21,7 @@
 
 #include "psen_scan_v2_standalone/data_conversion_layer/diagnostics.h"
 #include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+#include "psen_scan_v2_standalone/util/probes.h"
 
 namespace psen_scan_v2_standalone
 {
@@ -121,6 +122,7 @@ monitoring_frame::Message deserialize(const data_conversion_layer::RawData& data
             "Header Id {:#04x} unknown. Cannot read additional field of monitoring frame.", additional_header.id()));
     }
   }
+  PSENSCAN_PROBE3(frame_decoded, msg.scan_counter_.value_or(0), msg.from_theta_.value(), msg.measurements_.size());
   return msg;
 }
 
@@ -84,10 +84,21 @@ void LaserScan::setIntensities(const IntensityData& intensities)
   intensities_ = intensities;
 }
 
+uint32_t LaserScan::getScanCounter() const
+{
+  return scan_counter_;
+}
+
+void LaserScan::setScanCounter(const uint32_t& scan_counter)
+{
+  scan_counter_ = scan_counter;
+}
+
 bool LaserScan::operator==(const LaserScan& scan) const
 {
   return ((max_scan_angle_ == scan.max_scan_angle_) && (min_scan_angle_ == scan.min_scan_angle_) &&
-          (resolution_ == scan.resolution_) && (measurements_.size() == scan.measurements_.size()) &&
+          (resolution_ == scan.resolution_) && (scan_counter_ == scan.scan_counter_) &&
+          (measurements_.size() == scan.measurements_.size()) &&
           std::equal(measurements_.begin(), measurements_.end(), scan.measurements_.begin()));
 }
 
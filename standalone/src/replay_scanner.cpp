@@ -0,0 +1,145 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "psen_scan_v2_standalone/replay_scanner.h"
+
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/scanner_reply_serialization_deserialization.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+namespace psen_scan_v2_standalone
+{
+using namespace psen_scan_v2_standalone::protocol_layer::scanner_events;
+
+ReplayScanner::WatchdogFactory::WatchdogFactory(ReplayScanner* scanner)
+  : protocol_layer::IWatchdogFactory(), scanner_(scanner)
+{
+  assert(scanner);
+}
+
+std::unique_ptr<util::Watchdog> ReplayScanner::WatchdogFactory::create(const util::Watchdog::Schedule& schedule,
+                                                                       const std::string& event_type)
+{
+  if (event_type == "StartReplyTimeout")
+  {
+    // The start reply is injected right after the start request, so the timeout is irrelevant.
+    return std::unique_ptr<util::Watchdog>(new util::Watchdog(schedule, []() {}));
+  }
+  if (event_type == "MonitoringFrameTimeout")
+  {
+    return std::unique_ptr<util::Watchdog>(
+        new util::Watchdog(schedule, std::bind(&ReplayScanner::triggerEvent<MonitoringFrameTimeout>, scanner_)));
+  }
+
+  // LCOV_EXCL_START
+  throw std::runtime_error("WatchdogFactory called with event for which no creation process exists.");
+  // LCOV_EXCL_STOP
+}
+
+protocol_layer::StateMachineArgs*
+ReplayScanner::createStateMachineArgs(std::vector<communication_layer::RecordedDatagram> datagrams, const double& speed)
+{
+  auto data_source{ std::make_unique<communication_layer::ReplaySource>(
+      [this](const data_conversion_layer::RawData& data, const std::size_t& num_bytes) {
+        try
+        {
+          triggerEventWithParam(RawMonitoringFrameReceived(data, num_bytes, util::LatencyClock::now()));
+        }
+        catch (const std::exception&)
+        {
+          // Already reported by the state machine, which stops receiving like with a real scanner. The exception
+          // must not terminate the playback thread.
+        }
+      },
+      std::move(datagrams),
+      speed,
+      config_.threadSettings(util::ThreadRole::io)) };
+  data_source_ = data_source.get();
+
+  return new protocol_layer::StateMachineArgs(
+      config_,
+      std::make_unique<communication_layer::ReplaySource>(
+          [](const data_conversion_layer::RawData&, const std::size_t&) {},
+          std::vector<communication_layer::RecordedDatagram>()),
+      std::move(data_source),
+      []() { PSENSCAN_DEBUG("Replay", "Scanner started."); },
+      []() { PSENSCAN_DEBUG("Replay", "Scanner stopped."); },
+      laser_scan_cb_,
+      std::unique_ptr<protocol_layer::IWatchdogFactory>(new WatchdogFactory(this)),
+      latency_histograms_,
+      perf_counters_);
+}
+
+ReplayScanner::ReplayScanner(const ScannerConfiguration& scanner_config,
+                             const IScanner::LaserScanCallback& laser_scan_cb,
+                             std::vector<communication_layer::RecordedDatagram> datagrams,
+                             const double& speed)
+  : config_(scanner_config)
+  , laser_scan_cb_(laser_scan_cb)
+  , perf_counters_(scanner_config.perfCountersEnabled())
+  , sm_(new protocol_layer::ScannerStateMachine(createStateMachineArgs(std::move(datagrams), speed)))
+{
+  if (!laser_scan_cb_)
+  {
+    throw std::invalid_argument("LaserScanCallback is invalid");
+  }
+  const std::lock_guard<std::mutex> lock(member_mutex_);
+  sm_->start();
+}
+
+ReplayScanner::~ReplayScanner()
+{
+  const std::lock_guard<std::mutex> lock(member_mutex_);
+  sm_->stop();
+}
+
+void ReplayScanner::injectReply(const data_conversion_layer::scanner_reply::Message::Type& type)
+{
+  using data_conversion_layer::scanner_reply::Message;
+  const data_conversion_layer::RawData reply{ data_conversion_layer::scanner_reply::serialize(
+      Message(type, Message::OperationResult::accepted)) };
+  triggerEventWithParam(RawReplyReceived(reply, reply.size(), util::LatencyClock::now()));
+}
+
+void ReplayScanner::run()
+{
+  if (has_run_)
+  {
+    throw std::logic_error("The replay can only be run once");
+  }
+  has_run_ = true;
+
+  triggerEvent<StartRequest>();
+  injectReply(data_conversion_layer::scanner_reply::Message::Type::start);
+
+  data_source_->play().wait();
+
+  triggerEvent<StopRequest>();
+  injectReply(data_conversion_layer::scanner_reply::Message::Type::stop);
+}
+
+ScannerStatistics ReplayScanner::getStatistics() const
+{
+  ScannerStatistics statistics;
+  statistics.protocol = sm_->protocolStatistics();
+  statistics.latencies = latency_histograms_.snapshot();
+  statistics.perf_counters = perf_counters_.snapshot();
+  return statistics;
+}
+
+}  // namespace psen_scan_v2_standalone
@@ -0,0 +1,569 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <fmt/format.h>
+
+#include "psen_scan_v2_standalone/scan_codec.h"
+
+#include "psen_scan_v2_standalone/util/binary_fields.h"
+#include "psen_scan_v2_standalone/util/bits.h"
+#include "psen_scan_v2_standalone/util/tenth_of_degree.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The header of the frames is written as native integers, which have to be little endian."
+#endif
+
+namespace psen_scan_v2_standalone
+{
+static constexpr uint8_t VERSION{ 1 };
+static constexpr std::size_t HEADER_SIZE{ 28 };
+static constexpr std::size_t VERSION_OFFSET{ 0 };
+static constexpr std::size_t FLAGS_OFFSET{ 1 };
+static constexpr std::size_t SEQUENCE_NUMBER_OFFSET{ 4 };
+static constexpr std::size_t SCAN_COUNTER_OFFSET{ 8 };
+static constexpr std::size_t RESOLUTION_OFFSET{ 12 };
+static constexpr std::size_t MIN_ANGLE_OFFSET{ 14 };
+static constexpr std::size_t MAX_ANGLE_OFFSET{ 16 };
+static constexpr std::size_t MEASUREMENT_COUNT_OFFSET{ 20 };
+static constexpr std::size_t INTENSITY_COUNT_OFFSET{ 24 };
+
+static constexpr uint8_t KEY_FRAME_FLAG{ 1 };
+static constexpr uint8_t BIT_PACKING_FLAG{ 2 };
+static constexpr uint8_t UNCOMPRESSED_FLAG{ 4 };
+
+static constexpr std::size_t BLOCK_SIZE{ 128 };
+//! @brief Differences of uint16 values need 17 bits, which are at most 3 bytes as varint.
+static constexpr std::size_t MAX_VARINT_SIZE{ 3 };
+static constexpr uint32_t MAX_BIT_WIDTH{ 17 };
+static constexpr std::size_t MAX_NUMBER_OF_VALUES{ 1 << 20 };
+
+static uint32_t zigzag(const int32_t& difference)
+{
+  return (static_cast<uint32_t>(difference) << 1) ^ static_cast<uint32_t>(difference >> 31);
+}
+
+static int32_t unzigzag(const uint32_t& value)
+{
+  return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+#if defined(__SSE2__)
+static __m128i zigzag(const __m128i& differences)
+{
+  return _mm_xor_si128(_mm_slli_epi32(differences, 1), _mm_srai_epi32(differences, 31));
+}
+
+static __m128i unzigzag(const __m128i& values)
+{
+  return _mm_xor_si128(_mm_srli_epi32(values, 1),
+                       _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(values, _mm_set1_epi32(1))));
+}
+#endif
+
+//! @brief Writes the zigzag encoded differences values[i] - references[i].
+static void encodeDifferences(
+    const uint16_t* values, const uint16_t* references, const std::size_t& size, uint32_t* result, const bool& simd)
+{
+  std::size_t i{ 0 };
+#if defined(__SSE2__)
+  if (simd)
+  {
+    const __m128i zero{ _mm_setzero_si128() };
+    for (; i + 8 <= size; i += 8)
+    {
+      const __m128i v{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)) };
+      const __m128i r{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(references + i)) };
+      const __m128i low{ _mm_sub_epi32(_mm_unpacklo_epi16(v, zero), _mm_unpacklo_epi16(r, zero)) };
+      const __m128i high{ _mm_sub_epi32(_mm_unpackhi_epi16(v, zero), _mm_unpackhi_epi16(r, zero)) };
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), zigzag(low));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i + 4), zigzag(high));
+    }
+  }
+#endif
+  for (; i < size; ++i)
+  {
+    result[i] = zigzag(static_cast<int32_t>(values[i]) - static_cast<int32_t>(references[i]));
+  }
+}
+
+//! @brief Adds the zigzag encoded differences to the values.
+static void addDifferences(uint16_t* values, const uint32_t* differences, const std::size_t& size, const bool& simd)
+{
+  std::size_t i{ 0 };
+#if defined(__SSE2__)
+  if (simd)
+  {
+    const __m128i zero{ _mm_setzero_si128() };
+    for (; i + 8 <= size; i += 8)
+    {
+      const __m128i v{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)) };
+      const __m128i d_low{ unzigzag(_mm_loadu_si128(reinterpret_cast<const __m128i*>(differences + i))) };
+      const __m128i d_high{ unzigzag(_mm_loadu_si128(reinterpret_cast<const __m128i*>(differences + i + 4))) };
+      // Sign extends the low 16 bits, since SSE2 can only pack signed integers with saturation.
+      const __m128i low{ _mm_srai_epi32(_mm_slli_epi32(_mm_add_epi32(_mm_unpacklo_epi16(v, zero), d_low), 16), 16) };
+      const __m128i high{ _mm_srai_epi32(_mm_slli_epi32(_mm_add_epi32(_mm_unpackhi_epi16(v, zero), d_high), 16), 16) };
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_packs_epi32(low, high));
+    }
+  }
+#endif
+  for (; i < size; ++i)
+  {
+    values[i] = static_cast<uint16_t>(static_cast<int32_t>(values[i]) + unzigzag(differences[i]));
+  }
+}
+
+//! @returns the end of the written varints.
+static char* encodeVarints(const uint32_t* values, const std::size_t& size, char* out, const bool& simd)
+{
+  std::size_t i{ 0 };
+#if defined(__SSE2__)
+  if (simd)
+  {
+    // Blocks of 16 values below 128 are written as bytes at once.
+    const __m128i zero{ _mm_setzero_si128() };
+    while (i + 16 <= size)
+    {
+      const __m128i v0{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)) };
+      const __m128i v1{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + 4)) };
+      const __m128i v2{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + 8)) };
+      const __m128i v3{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + 12)) };
+      const __m128i all{ _mm_or_si128(_mm_or_si128(v0, v1), _mm_or_si128(v2, v3)) };
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_srli_epi32(all, 7), zero)) != 0xFFFF)
+      {
+        break;
+      }
+      const __m128i bytes{ _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3)) };
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+      out += 16;
+      i += 16;
+    }
+  }
+#endif
+  for (; i < size; ++i)
+  {
+    uint32_t value{ values[i] };
+    while (value >= 0x80)
+    {
+      *out++ = static_cast<char>(value | 0x80);
+      value >>= 7;
+    }
+    *out++ = static_cast<char>(value);
+  }
+  return out;
+}
+
+static const char* decodeVarint(const char* begin, const char* end, uint32_t& value)
+{
+  value = 0;
+  for (std::size_t i = 0; i < MAX_VARINT_SIZE; ++i)
+  {
+    if (begin == end)
+    {
+      throw ScanCodecError("Frame ends within a varint");
+    }
+    const auto byte{ static_cast<uint8_t>(*begin++) };
+    value |= static_cast<uint32_t>(byte & 0x7F) << (7 * i);
+    if ((byte & 0x80) == 0)
+    {
+      return begin;
+    }
+  }
+  throw ScanCodecError("Varint is too long");
+}
+
+//! @returns the end of the read varints.
+static const char*
+decodeVarints(const char* begin, const char* end, const std::size_t& size, uint32_t* values, const bool& simd)
+{
+  std::size_t i{ 0 };
+  while (i < size)
+  {
+#if defined(__SSE2__)
+    if (simd && size - i >= 16 && end - begin >= 16)
+    {
+      // Bytes before the first byte with continuation bit are complete varints.
+      const __m128i bytes{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)) };
+      const int continuation_bits{ _mm_movemask_epi8(bytes) };
+      if (continuation_bits == 0)
+      {
+        const __m128i zero{ _mm_setzero_si128() };
+        const __m128i low{ _mm_unpacklo_epi8(bytes, zero) };
+        const __m128i high{ _mm_unpackhi_epi8(bytes, zero) };
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i + 4), _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i + 8), _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i + 12), _mm_unpackhi_epi16(high, zero));
+        begin += 16;
+        i += 16;
+        continue;
+      }
+      const int single_bytes{ __builtin_ctz(static_cast<unsigned int>(continuation_bits)) };
+      for (int j = 0; j < single_bytes; ++j)
+      {
+        values[i++] = static_cast<uint8_t>(*begin++);
+      }
+    }
+#endif
+    begin = decodeVarint(begin, end, values[i++]);
+  }
+  return begin;
+}
+
+static uint32_t bitWidth(const uint32_t& value)
+{
+  return value == 0 ? 0 : static_cast<uint32_t>(util::mostSignificantBit(value)) + 1;
+}
+
+//! @returns the end of the written blocks.
+static char* packBits(const uint32_t* values, const std::size_t& size, char* out)
+{
+  for (std::size_t block = 0; block < size; block += BLOCK_SIZE)
+  {
+    const std::size_t block_size{ std::min(BLOCK_SIZE, size - block) };
+    const uint32_t width{ bitWidth(
+        std::accumulate(values + block, values + block + block_size, uint32_t{ 0 }, std::bit_or<uint32_t>())) };
+    *out++ = static_cast<char>(width);
+
+    uint64_t bits{ 0 };
+    uint32_t number_of_bits{ 0 };
+    for (std::size_t i = block; i < block + block_size; ++i)
+    {
+      bits |= static_cast<uint64_t>(values[i]) << number_of_bits;
+      number_of_bits += width;
+      while (number_of_bits >= 8)
+      {
+        *out++ = static_cast<char>(bits);
+        bits >>= 8;
+        number_of_bits -= 8;
+      }
+    }
+    if (number_of_bits > 0)
+    {
+      *out++ = static_cast<char>(bits);
+    }
+  }
+  return out;
+}
+
+//! @returns the end of the read blocks.
+static const char* unpackBits(const char* begin, const char* end, const std::size_t& size, uint32_t* values)
+{
+  for (std::size_t block = 0; block < size; block += BLOCK_SIZE)
+  {
+    const std::size_t block_size{ std::min(BLOCK_SIZE, size - block) };
+    if (begin == end)
+    {
+      throw ScanCodecError("Frame ends within the bit packed values");
+    }
+    const uint32_t width{ static_cast<uint8_t>(*begin++) };
+    if (width > MAX_BIT_WIDTH)
+    {
+      throw ScanCodecError(fmt::format("Invalid bit width {}", width));
+    }
+    if (static_cast<std::size_t>(end - begin) < (block_size * width + 7) / 8)
+    {
+      throw ScanCodecError("Frame ends within the bit packed values");
+    }
+
+    const uint64_t mask{ (uint64_t{ 1 } << width) - 1 };
+    uint64_t bits{ 0 };
+    uint32_t number_of_bits{ 0 };
+    for (std::size_t i = block; i < block + block_size; ++i)
+    {
+      while (number_of_bits < width)
+      {
+        bits |= static_cast<uint64_t>(static_cast<uint8_t>(*begin++)) << number_of_bits;
+        number_of_bits += 8;
+      }
+      values[i] = static_cast<uint32_t>(bits & mask);
+      bits >>= width;
+      number_of_bits -= width;
+    }
+  }
+  return begin;
+}
+
+ScanCodecError::ScanCodecError(const std::string& msg) : std::runtime_error(msg)
+{
+}
+
+ScanEncoder::ScanEncoder(const ScanCodecOptions& options) : options_(options)
+{
+}
+
+void ScanEncoder::forceKeyFrame()
+{
+  force_key_frame_ = true;
+}
+
+std::vector<char> ScanEncoder::encode(const LaserScan& scan)
+{
+  std::vector<char> frame;
+  encode(scan, frame);
+  return frame;
+}
+
+void ScanEncoder::encode(const LaserScan& scan, std::vector<char>& frame)
+{
+  const auto& measurements{ scan.getMeasurements() };
+  const auto& intensities{ scan.getIntensities() };
+  if (measurements.size() > MAX_NUMBER_OF_VALUES || intensities.size() > MAX_NUMBER_OF_VALUES)
+  {
+    throw std::invalid_argument(fmt::format("Scans with more than {} values are not supported", MAX_NUMBER_OF_VALUES));
+  }
+  measurements_.resize(measurements.size());
+  std::transform(measurements.begin(), measurements.end(), measurements_.begin(), [](const double& measurement) {
+    return util::toUint16(measurement * 1000.);
+  });
+  intensities_.resize(intensities.size());
+  std::transform(intensities.begin(), intensities.end(), intensities_.begin(), util::toUint16);
+
+  const std::array<int16_t, 3> angles{ { scan.getScanResolution().value(),
+                                         scan.getMinScanAngle().value(),
+                                         scan.getMaxScanAngle().value() } };
+  const bool key_frame{ !options_.compression || force_key_frame_ ||
+                        frames_since_key_frame_ >= std::max<std::size_t>(options_.key_frame_interval, 1) ||
+                        angles != previous_angles_ || measurements_.size() != previous_measurements_.size() ||
+                        intensities_.size() != previous_intensities_.size() };
+
+  frame.resize(HEADER_SIZE);
+  std::fill(frame.begin(), frame.end(), 0);
+  util::writeField(frame.data(), VERSION_OFFSET, VERSION);
+  util::writeField(frame.data(), FLAGS_OFFSET, flags(key_frame));
+  util::writeField(frame.data(), SEQUENCE_NUMBER_OFFSET, sequence_number_);
+  util::writeField(frame.data(), SCAN_COUNTER_OFFSET, scan.getScanCounter());
+  util::writeField(frame.data(), RESOLUTION_OFFSET, angles[0]);
+  util::writeField(frame.data(), MIN_ANGLE_OFFSET, angles[1]);
+  util::writeField(frame.data(), MAX_ANGLE_OFFSET, angles[2]);
+  util::writeField(frame.data(), MEASUREMENT_COUNT_OFFSET, static_cast<uint32_t>(measurements_.size()));
+  util::writeField(frame.data(), INTENSITY_COUNT_OFFSET, static_cast<uint32_t>(intensities_.size()));
+  encodeValues(measurements_, previous_measurements_, key_frame, frame);
+  encodeValues(intensities_, previous_intensities_, key_frame, frame);
+
+  std::swap(measurements_, previous_measurements_);
+  std::swap(intensities_, previous_intensities_);
+  previous_angles_ = angles;
+  ++sequence_number_;
+  force_key_frame_ = false;
+  frames_since_key_frame_ = key_frame ? 1 : frames_since_key_frame_ + 1;
+}
+
+uint8_t ScanEncoder::flags(const bool& key_frame) const
+{
+  if (!options_.compression)
+  {
+    return KEY_FRAME_FLAG | UNCOMPRESSED_FLAG;
+  }
+  return static_cast<uint8_t>((key_frame ? KEY_FRAME_FLAG : 0) | (options_.bit_packing ? BIT_PACKING_FLAG : 0));
+}
+
+void ScanEncoder::encodeValues(const std::vector<uint16_t>& values,
+                               const std::vector<uint16_t>& previous_values,
+                               const bool& key_frame,
+                               std::vector<char>& frame)
+{
+  const std::size_t size{ values.size() };
+  if (!options_.compression)
+  {
+    const std::size_t offset{ frame.size() };
+    frame.resize(offset + size * sizeof(uint16_t));
+    std::memcpy(frame.data() + offset, values.data(), size * sizeof(uint16_t));
+    return;
+  }
+  zigzag_.resize(size);
+  if (key_frame && size > 0)
+  {
+    // A key frame contains the differences to the previous value of the same scan.
+    zigzag_[0] = zigzag(values[0]);
+    encodeDifferences(values.data() + 1, values.data(), size - 1, zigzag_.data() + 1, options_.simd);
+  }
+  else if (!key_frame)
+  {
+    encodeDifferences(values.data(), previous_values.data(), size, zigzag_.data(), options_.simd);
+  }
+
+  const std::size_t offset{ frame.size() };
+  frame.resize(offset + size * MAX_VARINT_SIZE + size / BLOCK_SIZE + 1);
+  char* const begin{ frame.data() + offset };
+  const char* const end{ options_.bit_packing ? packBits(zigzag_.data(), size, begin) :
+                                                encodeVarints(zigzag_.data(), size, begin, options_.simd) };
+  frame.resize(offset + static_cast<std::size_t>(end - begin));
+}
+
+ScanDecoder::ScanDecoder(const bool& simd) : simd_(simd)
+{
+}
+
+LaserScan ScanDecoder::decode(const std::vector<char>& frame)
+{
+  return decode(frame.data(), frame.size());
+}
+
+LaserScan ScanDecoder::decode(const char* data, const std::size_t& size)
+{
+  try
+  {
+    return decodeFrame(data, size);
+  }
+  catch (const ScanCodecError&)
+  {
+    ++errors_;
+    has_previous_frame_ = false;
+    throw;
+  }
+}
+
+std::size_t ScanDecoder::numberOfErrors() const
+{
+  return errors_;
+}
+
+LaserScan ScanDecoder::decodeFrame(const char* data, const std::size_t& size)
+{
+  if (size < HEADER_SIZE)
+  {
+    throw ScanCodecError(fmt::format("Frame of {} bytes is smaller than the header", size));
+  }
+  const auto version{ util::readField<uint8_t>(data, VERSION_OFFSET) };
+  if (version != VERSION)
+  {
+    throw ScanCodecError(fmt::format("Unsupported version {}", version));
+  }
+  const auto flags{ util::readField<uint8_t>(data, FLAGS_OFFSET) };
+  const bool key_frame{ (flags & KEY_FRAME_FLAG) != 0 };
+  const bool bit_packing{ (flags & BIT_PACKING_FLAG) != 0 };
+  const bool uncompressed{ (flags & UNCOMPRESSED_FLAG) != 0 };
+  if (uncompressed && !key_frame)
+  {
+    throw ScanCodecError("Uncompressed frame is no key frame");
+  }
+  const auto sequence_number{ util::readField<uint32_t>(data, SEQUENCE_NUMBER_OFFSET) };
+  const std::size_t number_of_measurements{ util::readField<uint32_t>(data, MEASUREMENT_COUNT_OFFSET) };
+  const std::size_t number_of_intensities{ util::readField<uint32_t>(data, INTENSITY_COUNT_OFFSET) };
+  if (number_of_measurements > MAX_NUMBER_OF_VALUES || number_of_intensities > MAX_NUMBER_OF_VALUES)
+  {
+    throw ScanCodecError("Frame contains too many values");
+  }
+  if (!key_frame && (!has_previous_frame_ || sequence_number != previous_sequence_number_ + 1))
+  {
+    throw ScanCodecError(fmt::format("Frame {} refers to a frame which was not decoded", sequence_number));
+  }
+  if (!key_frame && (number_of_measurements != measurements_.size() || number_of_intensities != intensities_.size()))
+  {
+    throw ScanCodecError(fmt::format("Frame {} does not match the previous frame", sequence_number));
+  }
+
+  LaserScan scan{ [&data]() {
+    try
+    {
+      return LaserScan(util::TenthOfDegree(util::readField<int16_t>(data, RESOLUTION_OFFSET)),
+                       util::TenthOfDegree(util::readField<int16_t>(data, MIN_ANGLE_OFFSET)),
+                       util::TenthOfDegree(util::readField<int16_t>(data, MAX_ANGLE_OFFSET)));
+    }
+    catch (const std::invalid_argument& e)
+    {
+      throw ScanCodecError(fmt::format("Frame contains an invalid scan: {}", e.what()));
+    }
+  }() };
+  scan.setScanCounter(util::readField<uint32_t>(data, SCAN_COUNTER_OFFSET));
+
+  const char* const end{ data + size };
+  const char* next{ data + HEADER_SIZE };
+  if (uncompressed)
+  {
+    next = copyValues(next, end, number_of_measurements, measurements_);
+    next = copyValues(next, end, number_of_intensities, intensities_);
+  }
+  else
+  {
+    next = decodeValues(next, end, number_of_measurements, key_frame, bit_packing, measurements_);
+    next = decodeValues(next, end, number_of_intensities, key_frame, bit_packing, intensities_);
+  }
+  if (next != end)
+  {
+    throw ScanCodecError(fmt::format("Frame {} contains {} unexpected bytes", sequence_number, end - next));
+  }
+
+  LaserScan::MeasurementData measurements(measurements_.size());
+  std::transform(measurements_.begin(), measurements_.end(), measurements.begin(), [](const uint16_t& measurement) {
+    return static_cast<double>(measurement) / 1000.;
+  });
+  scan.setMeasurements(measurements);
+  scan.setIntensities(LaserScan::IntensityData(intensities_.begin(), intensities_.end()));
+
+  has_previous_frame_ = true;
+  previous_sequence_number_ = sequence_number;
+  return scan;
+}
+
+const char* ScanDecoder::copyValues(const char* begin,
+                                    const char* end,
+                                    const std::size_t& number_of_values,
+                                    std::vector<uint16_t>& values)
+{
+  if (number_of_values * sizeof(uint16_t) > static_cast<std::size_t>(end - begin))
+  {
+    throw ScanCodecError("Frame is too short for its number of values");
+  }
+  values.resize(number_of_values);
+  std::memcpy(values.data(), begin, number_of_values * sizeof(uint16_t));
+  return begin + number_of_values * sizeof(uint16_t);
+}
+
+const char* ScanDecoder::decodeValues(const char* begin,
+                                      const char* end,
+                                      const std::size_t& number_of_values,
+                                      const bool& key_frame,
+                                      const bool& bit_packing,
+                                      std::vector<uint16_t>& values)
+{
+  // Each varint needs at least one byte, each block of bit packed values at least its width.
+  const std::size_t available{ static_cast<std::size_t>(end - begin) };
+  if (number_of_values > (bit_packing ? available * BLOCK_SIZE : available))
+  {
+    throw ScanCodecError("Frame is too short for its number of values");
+  }
+  zigzag_.resize(number_of_values);
+  const char* const next{ bit_packing ? unpackBits(begin, end, number_of_values, zigzag_.data()) :
+                                        decodeVarints(begin, end, number_of_values, zigzag_.data(), simd_) };
+  if (key_frame)
+  {
+    values.resize(number_of_values);
+    uint16_t previous_value{ 0 };
+    for (std::size_t i = 0; i < number_of_values; ++i)
+    {
+      previous_value = static_cast<uint16_t>(static_cast<int32_t>(previous_value) + unzigzag(zigzag_[i]));
+      values[i] = previous_value;
+    }
+  }
+  else
+  {
+    addDifferences(values.data(), zigzag_.data(), number_of_values, simd_);
+  }
+  return next;
+}
+
+}  // namespace psen_scan_v2_standalone
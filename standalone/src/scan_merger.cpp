@@ -0,0 +1,315 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "psen_scan_v2_standalone/scan_merger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/polar_cartesian_conversions.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+namespace psen_scan_v2_standalone
+{
+constexpr uint32_t ScanMerger::MAX_SCAN_COUNTER_DELAY;
+
+//! @returns the number of scan rounds lhs is newer than rhs, taking the wrap-around of the scan counter into account.
+static int32_t scanCounterDifference(const uint32_t& lhs, const uint32_t& rhs)
+{
+  return static_cast<int32_t>(lhs - rhs);
+}
+
+static bool isFragmentOf(const LaserScan& scan, const uint32_t& scan_counter, const int16_t& min_angle)
+{
+  return scan.getScanCounter() == scan_counter && scan.getMinScanAngle().value() != min_angle;
+}
+
+std::size_t CompositeScan::size() const
+{
+  return angles.size();
+}
+
+void CompositeScan::clear()
+{
+  angles.clear();
+  ranges.clear();
+  intensities.clear();
+  x.clear();
+  y.clear();
+  sources.clear();
+  scan_counters.clear();
+}
+
+ScanMerger::InputState::InputState(const ScanMergerInput& scan_merger_input) : input(scan_merger_input)
+{
+}
+
+ScanMerger::ScanMerger(const std::vector<ScanMergerInput>& inputs,
+                       const std::chrono::milliseconds& sync_window,
+                       const CompositeScanCallback& composite_scan_callback)
+  : inputs_(inputs.begin(), inputs.end()), sync_window_(sync_window), composite_scan_callback_(composite_scan_callback)
+{
+  if (inputs_.empty())
+  {
+    throw std::invalid_argument("At least one input is necessary to merge scans");
+  }
+  if (!composite_scan_callback_)
+  {
+    throw std::invalid_argument("Composite-scan-callback must not be null");
+  }
+  heap_.reserve(inputs_.size());
+}
+
+std::size_t ScanMerger::numberOfInputs() const
+{
+  return inputs_.size();
+}
+
+std::size_t ScanMerger::numberOfDroppedScans() const
+{
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return number_of_dropped_scans_;
+}
+
+IScanner::LaserScanCallback ScanMerger::laserScanCallback(const std::size_t& input_index)
+{
+  if (input_index >= inputs_.size())
+  {
+    throw std::out_of_range("Input index out of range");
+  }
+  return [this, input_index](const LaserScan& scan) { addScan(input_index, scan); };
+}
+
+void ScanMerger::addScan(const std::size_t& input_index, const LaserScan& scan, const Clock::time_point& arrival_time)
+{
+  if (input_index >= inputs_.size())
+  {
+    throw std::out_of_range("Input index out of range");
+  }
+
+  const std::lock_guard<std::mutex> lock(mutex_);
+  InputState& state{ inputs_[input_index] };
+  // The geometry of the last merged scan is still stored in min_angle, since it was the last transformed scan.
+  if ((state.pending_scan &&
+       isFragmentOf(scan, state.pending_scan->getScanCounter(), state.pending_scan->getMinScanAngle().value())) ||
+      (state.last_merged_scan_counter && isFragmentOf(scan, state.last_merged_scan_counter.get(), state.min_angle)))
+  {
+    throw std::invalid_argument("Fragmented scans cannot be merged, disable fragmented scans of the scanner");
+  }
+  if (state.last_merged_scan_counter &&
+      scanCounterDifference(scan.getScanCounter(), state.last_merged_scan_counter.get()) <
+          -static_cast<int32_t>(MAX_SCAN_COUNTER_DELAY))
+  {
+    PSENSCAN_INFO("ScanMerger",
+                  "Scan counter of input {} jumped back from {} to {}. Assuming a restart of the scanner.",
+                  input_index,
+                  state.last_merged_scan_counter.get(),
+                  scan.getScanCounter());
+    state.last_merged_scan_counter = boost::none;
+  }
+  if (state.last_merged_scan_counter &&
+      scanCounterDifference(scan.getScanCounter(), state.last_merged_scan_counter.get()) <= 0)
+  {
+    PSENSCAN_DEBUG("ScanMerger",
+                   "Dropped scan {} of input {}, because scan {} is already merged.",
+                   scan.getScanCounter(),
+                   input_index,
+                   state.last_merged_scan_counter.get());
+    ++number_of_dropped_scans_;
+    return;
+  }
+  if (state.pending_scan)
+  {
+    PSENSCAN_DEBUG("ScanMerger",
+                   "Dropped scan {} of input {}, because the scans of the other inputs are missing.",
+                   state.pending_scan->getScanCounter(),
+                   input_index);
+    ++number_of_dropped_scans_;
+  }
+  state.pending_scan.emplace(scan);
+  state.arrival_time = arrival_time;
+
+  for (std::size_t i = 0; i < inputs_.size(); ++i)
+  {
+    InputState& other{ inputs_[i] };
+    if (other.pending_scan && arrival_time - other.arrival_time > sync_window_)
+    {
+      PSENSCAN_DEBUG("ScanMerger",
+                     "Dropped scan {} of input {}, because it is older than the synchronization window.",
+                     other.pending_scan->getScanCounter(),
+                     i);
+      other.pending_scan = boost::none;
+      ++number_of_dropped_scans_;
+    }
+  }
+
+  if (!allScansPending())
+  {
+    return;
+  }
+
+  std::vector<const LaserScan*> scans;
+  scans.reserve(inputs_.size());
+  for (auto& input : inputs_)
+  {
+    scans.push_back(input.pending_scan.get_ptr());
+  }
+  mergeScans(scans, composite_scan_);
+  for (auto& input : inputs_)
+  {
+    input.last_merged_scan_counter = input.pending_scan->getScanCounter();
+    input.pending_scan = boost::none;
+  }
+  composite_scan_callback_(composite_scan_);
+}
+
+void ScanMerger::merge(const std::vector<LaserScan>& scans, CompositeScan& composite_scan)
+{
+  if (scans.size() != inputs_.size())
+  {
+    throw std::invalid_argument("Exactly one scan per input is necessary to merge scans");
+  }
+  std::vector<const LaserScan*> scan_ptrs;
+  scan_ptrs.reserve(scans.size());
+  for (const auto& scan : scans)
+  {
+    scan_ptrs.push_back(&scan);
+  }
+  mergeScans(scan_ptrs, composite_scan);
+}
+
+bool ScanMerger::allScansPending() const
+{
+  return std::all_of(inputs_.begin(), inputs_.end(), [](const InputState& state) { return state.pending_scan; });
+}
+
+void ScanMerger::mergeScans(const std::vector<const LaserScan*>& scans, CompositeScan& composite_scan)
+{
+  std::size_t total_size{ 0 };
+  for (std::size_t i = 0; i < inputs_.size(); ++i)
+  {
+    transform(inputs_[i], *scans[i]);
+    sortByAngle(inputs_[i]);
+    total_size += inputs_[i].order.size();
+  }
+
+  composite_scan.clear();
+  composite_scan.angles.reserve(total_size);
+  composite_scan.ranges.reserve(total_size);
+  composite_scan.intensities.reserve(total_size);
+  composite_scan.x.reserve(total_size);
+  composite_scan.y.reserve(total_size);
+  composite_scan.sources.reserve(total_size);
+  for (const auto& scan : scans)
+  {
+    composite_scan.scan_counters.push_back(scan->getScanCounter());
+  }
+
+  // K-way merge of the sorted points using a min-heap with one cursor per input.
+  const auto compare{ [](const MergeCursor& lhs, const MergeCursor& rhs) { return lhs.angle > rhs.angle; } };
+  heap_.clear();
+  for (std::size_t i = 0; i < inputs_.size(); ++i)
+  {
+    if (!inputs_[i].order.empty())
+    {
+      heap_.push_back(MergeCursor{ inputs_[i].angles[inputs_[i].order.front()], i, 0 });
+    }
+  }
+  std::make_heap(heap_.begin(), heap_.end(), compare);
+
+  while (!heap_.empty())
+  {
+    std::pop_heap(heap_.begin(), heap_.end(), compare);
+    MergeCursor& cursor{ heap_.back() };
+    const InputState& state{ inputs_[cursor.input_index] };
+    const std::size_t index{ state.order[cursor.position] };
+    const auto& intensities{ scans[cursor.input_index]->getIntensities() };
+
+    composite_scan.angles.push_back(state.angles[index]);
+    composite_scan.ranges.push_back(state.ranges[index]);
+    composite_scan.intensities.push_back(index < intensities.size() ? intensities[index] :
+                                                                      std::numeric_limits<double>::quiet_NaN());
+    composite_scan.x.push_back(state.x[index]);
+    composite_scan.y.push_back(state.y[index]);
+    composite_scan.sources.push_back(cursor.input_index);
+
+    if (++cursor.position < state.order.size())
+    {
+      cursor.angle = state.angles[state.order[cursor.position]];
+      std::push_heap(heap_.begin(), heap_.end(), compare);
+    }
+    else
+    {
+      heap_.pop_back();
+    }
+  }
+}
+
+void ScanMerger::transform(InputState& state, const LaserScan& scan)
+{
+  const auto& ranges{ scan.getMeasurements() };
+  if (state.min_angle != scan.getMinScanAngle().value() || state.resolution != scan.getScanResolution().value() ||
+      state.cosines.size() < ranges.size())
+  {
+    state.min_angle = scan.getMinScanAngle().value();
+    state.resolution = scan.getScanResolution().value();
+    const double first_angle{ scan.getMinScanAngle().toRad() - state.input.x_axis_rotation +
+                              state.input.mounting_pose.yaw };
+    data_conversion_layer::computeCosinesAndSines(
+        first_angle, scan.getScanResolution().toRad(), ranges.size(), state.cosines, state.sines);
+  }
+
+  data_conversion_layer::polarToCartesian(ranges,
+                                          state.cosines,
+                                          state.sines,
+                                          state.input.mounting_pose.x,
+                                          state.input.mounting_pose.y,
+                                          state.x,
+                                          state.y);
+  data_conversion_layer::cartesianToPolar(state.x, state.y, state.angles, state.ranges);
+}
+
+void ScanMerger::sortByAngle(InputState& state)
+{
+  state.order.clear();
+  for (std::size_t i = 0; i < state.ranges.size(); ++i)
+  {
+    // Invalid measurements (e.g. infinity) result in invalid coordinates and are not merged.
+    if (std::isfinite(state.ranges[i]))
+    {
+      state.order.push_back(i);
+    }
+  }
+  if (state.order.empty())
+  {
+    return;
+  }
+
+  // The points of a scan are sorted by their angle in the scan frame. If the scanner is located at the origin of the
+  // target frame, the angles in the target frame are still increasing apart from the wrap-around at +-pi.
+  // Only otherwise the points have to be sorted.
+  const auto by_angle{ [&state](const std::size_t& lhs, const std::size_t& rhs) {
+    return state.angles[lhs] < state.angles[rhs];
+  } };
+  std::rotate(state.order.begin(), std::min_element(state.order.begin(), state.order.end(), by_angle), state.order.end());
+  if (!std::is_sorted(state.order.begin(), state.order.end(), by_angle))
+  {
+    std::sort(state.order.begin(), state.order.end(), by_angle);
+  }
+}
+
+}  // namespace psen_scan_v2_standalone
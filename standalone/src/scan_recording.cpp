@@ -0,0 +1,429 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "psen_scan_v2_standalone/scan_recording.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "psen_scan_v2_standalone/util/binary_fields.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The scan recording is mapped into memory as native integers, which have to be little endian."
+#endif
+
+namespace psen_scan_v2_standalone
+{
+static constexpr char MAGIC[]{ "PSENSCNR" };
+static constexpr std::size_t MAGIC_SIZE{ 8 };
+static constexpr uint32_t VERSION{ 1 };
+
+static constexpr std::size_t FILE_HEADER_SIZE{ 64 };
+static constexpr std::size_t VERSION_OFFSET{ 8 };
+static constexpr std::size_t SCAN_COUNT_OFFSET{ 16 };
+static constexpr std::size_t INDEX_OFFSET_OFFSET{ 24 };
+
+static constexpr std::size_t RECORD_HEADER_SIZE{ 32 };
+static constexpr std::size_t TIMESTAMP_OFFSET{ 0 };
+static constexpr std::size_t SCAN_COUNTER_OFFSET{ 8 };
+static constexpr std::size_t RECORD_SIZE_OFFSET{ 12 };
+static constexpr std::size_t RESOLUTION_OFFSET{ 16 };
+static constexpr std::size_t MIN_ANGLE_OFFSET{ 18 };
+static constexpr std::size_t MAX_ANGLE_OFFSET{ 20 };
+static constexpr std::size_t MEASUREMENT_COUNT_OFFSET{ 24 };
+static constexpr std::size_t INTENSITY_COUNT_OFFSET{ 28 };
+static constexpr std::size_t RECORD_ALIGNMENT{ 8 };
+
+static_assert(sizeof(ScanIndexEntry) == 24, "The index is mapped into memory as array of ScanIndexEntry.");
+
+static std::size_t alignedRecordSize(const std::size_t& number_of_values)
+{
+  return (RECORD_HEADER_SIZE + number_of_values * sizeof(uint16_t) + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT *
+         RECORD_ALIGNMENT;
+}
+
+//! @returns the size of the record at the offset, or 0 if its header is inconsistent or it does not end before end.
+static std::size_t recordSize(const char* mapping, const std::size_t& offset, const std::size_t& end)
+{
+  if (offset > end || end - offset < RECORD_HEADER_SIZE)
+  {
+    return 0;
+  }
+  const char* record{ mapping + offset };
+  const std::size_t record_size{ util::readField<uint32_t>(record, RECORD_SIZE_OFFSET) };
+  const std::size_t number_of_values{
+    static_cast<std::size_t>(util::readField<uint32_t>(record, MEASUREMENT_COUNT_OFFSET)) +
+    util::readField<uint32_t>(record, INTENSITY_COUNT_OFFSET)
+  };
+  if (record_size != alignedRecordSize(number_of_values) || record_size > end - offset)
+  {
+    return 0;
+  }
+  return record_size;
+}
+
+ScanRecordingError::ScanRecordingError(const std::string& msg) : std::runtime_error(msg)
+{
+}
+
+ScanView::ScanView(const char* record) : record_(record)
+{
+}
+
+std::chrono::nanoseconds ScanView::timestamp() const
+{
+  return std::chrono::nanoseconds(util::readField<uint64_t>(record_, TIMESTAMP_OFFSET));
+}
+
+uint32_t ScanView::scanCounter() const
+{
+  return util::readField<uint32_t>(record_, SCAN_COUNTER_OFFSET);
+}
+
+util::TenthOfDegree ScanView::scanResolution() const
+{
+  return util::TenthOfDegree(util::readField<int16_t>(record_, RESOLUTION_OFFSET));
+}
+
+util::TenthOfDegree ScanView::minScanAngle() const
+{
+  return util::TenthOfDegree(util::readField<int16_t>(record_, MIN_ANGLE_OFFSET));
+}
+
+util::TenthOfDegree ScanView::maxScanAngle() const
+{
+  return util::TenthOfDegree(util::readField<int16_t>(record_, MAX_ANGLE_OFFSET));
+}
+
+std::size_t ScanView::size() const
+{
+  return util::readField<uint32_t>(record_, MEASUREMENT_COUNT_OFFSET);
+}
+
+const uint16_t* ScanView::ranges() const
+{
+  return reinterpret_cast<const uint16_t*>(record_ + RECORD_HEADER_SIZE);
+}
+
+std::size_t ScanView::numberOfIntensities() const
+{
+  return util::readField<uint32_t>(record_, INTENSITY_COUNT_OFFSET);
+}
+
+const uint16_t* ScanView::intensities() const
+{
+  return ranges() + size();
+}
+
+LaserScan ScanView::toLaserScan() const
+{
+  LaserScan scan(scanResolution(), minScanAngle(), maxScanAngle());
+  scan.setScanCounter(scanCounter());
+
+  LaserScan::MeasurementData measurements(size());
+  std::transform(ranges(), ranges() + size(), measurements.begin(), [](const uint16_t& range) {
+    return static_cast<double>(range) / 1000.;
+  });
+  scan.setMeasurements(measurements);
+
+  LaserScan::IntensityData intensity_data(intensities(), intensities() + numberOfIntensities());
+  scan.setIntensities(intensity_data);
+  return scan;
+}
+
+ScanRecordingWriter::ScanRecordingWriter(const std::string& filename)
+  : filename_(filename), write_buffer_(1024 * 1024)
+{
+  // The buffer has to be set before the file is opened.
+  file_.rdbuf()->pubsetbuf(write_buffer_.data(), static_cast<std::streamsize>(write_buffer_.size()));
+  file_.open(filename_, std::ios::binary | std::ios::trunc);
+  if (!file_)
+  {
+    throw ScanRecordingError(fmt::format("Could not open {}", filename_));
+  }
+  // The header is rewritten with the offset of the index on close.
+  writeHeader(0);
+  offset_ = FILE_HEADER_SIZE;
+}
+
+ScanRecordingWriter::~ScanRecordingWriter()
+{
+  try
+  {
+    close();
+  }
+  catch (const ScanRecordingError& e)
+  {
+    PSENSCAN_ERROR("ScanRecordingWriter", "{}", e.what());
+  }
+}
+
+void ScanRecordingWriter::writeHeader(const uint64_t& index_offset)
+{
+  char header[FILE_HEADER_SIZE]{};
+  std::memcpy(header, MAGIC, MAGIC_SIZE);
+  util::writeField(header, VERSION_OFFSET, VERSION);
+  util::writeField(header, SCAN_COUNT_OFFSET, static_cast<uint64_t>(index_.size()));
+  util::writeField(header, INDEX_OFFSET_OFFSET, index_offset);
+  file_.write(header, FILE_HEADER_SIZE);
+}
+
+void ScanRecordingWriter::write(const LaserScan& scan, const std::chrono::nanoseconds& timestamp)
+{
+  const auto& measurements{ scan.getMeasurements() };
+  const auto& intensities{ scan.getIntensities() };
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_)
+  {
+    throw ScanRecordingError(fmt::format("Cannot write to closed recording {}", filename_));
+  }
+
+  const std::size_t record_size{ alignedRecordSize(measurements.size() + intensities.size()) };
+  values_.resize((record_size - RECORD_HEADER_SIZE) / sizeof(uint16_t));
+  std::fill(values_.begin(), values_.end(), 0);
+  auto it{ std::transform(measurements.begin(), measurements.end(), values_.begin(), [](const double& measurement) {
+    return util::toUint16(measurement * 1000.);
+  }) };
+  std::transform(intensities.begin(), intensities.end(), it, util::toUint16);
+
+  char header[RECORD_HEADER_SIZE]{};
+  util::writeField(header, TIMESTAMP_OFFSET, static_cast<uint64_t>(timestamp.count()));
+  util::writeField(header, SCAN_COUNTER_OFFSET, scan.getScanCounter());
+  util::writeField(header, RECORD_SIZE_OFFSET, static_cast<uint32_t>(record_size));
+  util::writeField(header, RESOLUTION_OFFSET, scan.getScanResolution().value());
+  util::writeField(header, MIN_ANGLE_OFFSET, scan.getMinScanAngle().value());
+  util::writeField(header, MAX_ANGLE_OFFSET, scan.getMaxScanAngle().value());
+  util::writeField(header, MEASUREMENT_COUNT_OFFSET, static_cast<uint32_t>(measurements.size()));
+  util::writeField(header, INTENSITY_COUNT_OFFSET, static_cast<uint32_t>(intensities.size()));
+
+  file_.write(header, RECORD_HEADER_SIZE);
+  file_.write(reinterpret_cast<const char*>(values_.data()),
+              static_cast<std::streamsize>(values_.size() * sizeof(uint16_t)));
+  if (!file_)
+  {
+    throw ScanRecordingError(fmt::format("Could not write to {}", filename_));
+  }
+
+  index_.push_back(ScanIndexEntry{ static_cast<uint64_t>(timestamp.count()), offset_, scan.getScanCounter(), 0 });
+  offset_ += record_size;
+}
+
+IScanner::LaserScanCallback ScanRecordingWriter::laserScanCallback()
+{
+  return [this](const LaserScan& scan) {
+    try
+    {
+      write(scan);
+    }
+    catch (const ScanRecordingError& e)
+    {
+      PSENSCAN_ERROR_THROTTLE(1.0, "ScanRecordingWriter", "{}", e.what());
+    }
+  };
+}
+
+std::size_t ScanRecordingWriter::numberOfScans() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index_.size();
+}
+
+void ScanRecordingWriter::flush()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  file_.flush();
+}
+
+void ScanRecordingWriter::close()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_)
+  {
+    return;
+  }
+  closed_ = true;
+
+  file_.write(reinterpret_cast<const char*>(index_.data()),
+              static_cast<std::streamsize>(index_.size() * sizeof(ScanIndexEntry)));
+  file_.seekp(0);
+  writeHeader(offset_);
+  file_.close();
+  if (!file_)
+  {
+    throw ScanRecordingError(fmt::format("Could not write the index of {}", filename_));
+  }
+}
+
+ScanRecordingReader::ScanRecordingReader(const std::string& filename)
+{
+  fd_ = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0)
+  {
+    throw ScanRecordingError(fmt::format("Could not open {}: {}", filename, std::strerror(errno)));
+  }
+  struct stat file_status;
+  if (::fstat(fd_, &file_status) != 0 || static_cast<std::size_t>(file_status.st_size) < FILE_HEADER_SIZE)
+  {
+    ::close(fd_);
+    throw ScanRecordingError(fmt::format("{} is no scan recording", filename));
+  }
+  mapping_size_ = static_cast<std::size_t>(file_status.st_size);
+  void* mapping{ ::mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd_, 0) };
+  if (mapping == MAP_FAILED)
+  {
+    const int error{ errno };
+    ::close(fd_);
+    throw ScanRecordingError(fmt::format("Could not map {}: {}", filename, std::strerror(error)));
+  }
+  mapping_ = static_cast<const char*>(mapping);
+
+  try
+  {
+    if (std::memcmp(mapping_, MAGIC, MAGIC_SIZE) != 0)
+    {
+      throw ScanRecordingError(fmt::format("{} is no scan recording", filename));
+    }
+    const auto version{ util::readField<uint32_t>(mapping_, VERSION_OFFSET) };
+    if (version != VERSION)
+    {
+      throw ScanRecordingError(fmt::format("{} has the unsupported version {}", filename, version));
+    }
+
+    const auto index_offset{ util::readField<uint64_t>(mapping_, INDEX_OFFSET_OFFSET) };
+    if (index_offset == 0)
+    {
+      PSENSCAN_WARN("ScanRecordingReader", "{} was not closed, rebuilding the index.", filename);
+      rebuildIndex();
+      return;
+    }
+
+    size_ = util::readField<uint64_t>(mapping_, SCAN_COUNT_OFFSET);
+    if (index_offset < FILE_HEADER_SIZE || index_offset % RECORD_ALIGNMENT != 0 || index_offset > mapping_size_ ||
+        size_ > (mapping_size_ - index_offset) / sizeof(ScanIndexEntry))
+    {
+      throw ScanRecordingError(fmt::format("{} has an invalid index", filename));
+    }
+    index_ = reinterpret_cast<const ScanIndexEntry*>(mapping_ + index_offset);
+    // The records are checked like in rebuildIndex(), so that a ScanView never reads beyond its record.
+    if (std::any_of(index_, index_ + size_, [this, &index_offset](const ScanIndexEntry& entry) {
+          return entry.offset < FILE_HEADER_SIZE || entry.offset % RECORD_ALIGNMENT != 0 ||
+                 recordSize(mapping_, entry.offset, index_offset) == 0;
+        }))
+    {
+      throw ScanRecordingError(fmt::format("{} has an invalid index", filename));
+    }
+  }
+  catch (const ScanRecordingError&)
+  {
+    ::munmap(const_cast<char*>(mapping_), mapping_size_);
+    ::close(fd_);
+    throw;
+  }
+}
+
+ScanRecordingReader::~ScanRecordingReader()
+{
+  ::munmap(const_cast<char*>(mapping_), mapping_size_);
+  ::close(fd_);
+}
+
+void ScanRecordingReader::rebuildIndex()
+{
+  // The last record of a recording which was not closed may be truncated.
+  std::size_t offset{ FILE_HEADER_SIZE };
+  while (true)
+  {
+    const std::size_t record_size{ recordSize(mapping_, offset, mapping_size_) };
+    if (record_size == 0)
+    {
+      break;
+    }
+    const char* record{ mapping_ + offset };
+    rebuilt_index_.push_back(ScanIndexEntry{ util::readField<uint64_t>(record, TIMESTAMP_OFFSET),
+                                             offset,
+                                             util::readField<uint32_t>(record, SCAN_COUNTER_OFFSET),
+                                             0 });
+    offset += record_size;
+  }
+  index_ = rebuilt_index_.data();
+  size_ = rebuilt_index_.size();
+}
+
+std::size_t ScanRecordingReader::size() const
+{
+  return size_;
+}
+
+const ScanIndexEntry& ScanRecordingReader::entry(const std::size_t& position) const
+{
+  return index_[position];
+}
+
+ScanView ScanRecordingReader::operator[](const std::size_t& position) const
+{
+  return ScanView(mapping_ + entry(position).offset);
+}
+
+ScanView ScanRecordingReader::at(const std::size_t& position) const
+{
+  if (position >= size_)
+  {
+    throw std::out_of_range(fmt::format("No scan at position {}, the recording contains {} scans", position, size_));
+  }
+  return (*this)[position];
+}
+
+std::size_t ScanRecordingReader::findByTime(const std::chrono::nanoseconds& timestamp) const
+{
+  const auto key{ static_cast<uint64_t>(timestamp.count()) };
+  return static_cast<std::size_t>(
+      std::lower_bound(index_,
+                       index_ + size_,
+                       key,
+                       [](const ScanIndexEntry& entry, const uint64_t& key) { return entry.timestamp < key; }) -
+      index_);
+}
+
+std::size_t ScanRecordingReader::findByScanCounter(const uint32_t& scan_counter) const
+{
+  return static_cast<std::size_t>(
+      std::lower_bound(
+          index_,
+          index_ + size_,
+          scan_counter,
+          [](const ScanIndexEntry& entry, const uint32_t& scan_counter) { return entry.scan_counter < scan_counter; }) -
+      index_);
+}
+
+bool ScanRecordingReader::isComplete() const
+{
+  return rebuilt_index_.empty() && util::readField<uint64_t>(mapping_, INDEX_OFFSET_OFFSET) != 0;
+}
+
+}  // namespace psen_scan_v2_standalone
+
+#endif  // __linux__
@@ -0,0 +1,354 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "psen_scan_v2_standalone/scan_relay.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include "psen_scan_v2_standalone/util/logging.h"
+
+namespace psen_scan_v2_standalone
+{
+//! @brief Maximal payload of a UDP datagram over IPv4.
+static constexpr std::size_t MAX_DATAGRAM_SIZE{ 65507 };
+//! @brief Maximal number of frames sent or datagrams received with one system call.
+static constexpr std::size_t MAX_BATCH_SIZE{ 16 };
+static constexpr std::chrono::milliseconds IDLE_PERIOD{ 1 };
+//! @brief Period in which the receiver thread checks whether it is terminated.
+static constexpr std::chrono::milliseconds RECEIVE_TIMEOUT{ 100 };
+
+ScanRelayError::ScanRelayError(const std::string& msg) : std::runtime_error(msg)
+{
+}
+
+static in_addr toAddress(const std::string& ip)
+{
+  in_addr address{};
+  if (::inet_pton(AF_INET, ip.c_str(), &address) != 1)
+  {
+    throw std::invalid_argument(fmt::format("Invalid IPv4 address \"{}\"", ip));
+  }
+  return address;
+}
+
+static void
+setSocketOption(const int& fd, const int& level, const int& option, const void* value, const socklen_t& size)
+{
+  if (::setsockopt(fd, level, option, value, size) != 0)
+  {
+    const std::string error{ std::strerror(errno) };
+    ::close(fd);
+    throw ScanRelayError(fmt::format("Cannot set socket option {}: {}", option, error));
+  }
+}
+
+static int openSocket()
+{
+  const int fd{ ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0) };
+  if (fd < 0)
+  {
+    throw ScanRelayError(fmt::format("Cannot open socket: {}", std::strerror(errno)));
+  }
+  return fd;
+}
+
+ScanRelay::ScanRelay(const std::vector<ScanRelayDestination>& destinations, const ScanRelayOptions& options)
+  : options_(options)
+  , encoder_(options.codec)
+  , queue_(options.queue_capacity)
+  , batch_(MAX_BATCH_SIZE)
+  , iovecs_(MAX_BATCH_SIZE * destinations.size())
+  , messages_(MAX_BATCH_SIZE * destinations.size())
+{
+  if (destinations.empty())
+  {
+    throw std::invalid_argument("No destinations for the scans");
+  }
+  for (const auto& destination : destinations)
+  {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(destination.port);
+    address.sin_addr = toAddress(destination.ip);
+    destinations_.push_back(address);
+  }
+  in_addr multicast_interface{};
+  if (!options.multicast_interface.empty())
+  {
+    multicast_interface = toAddress(options.multicast_interface);
+  }
+
+  fd_ = openSocket();
+  setSocketOption(fd_, IPPROTO_IP, IP_MULTICAST_TTL, &options.multicast_ttl, sizeof(options.multicast_ttl));
+  if (!options.multicast_interface.empty())
+  {
+    setSocketOption(fd_, IPPROTO_IP, IP_MULTICAST_IF, &multicast_interface, sizeof(multicast_interface));
+  }
+
+  sender_thread_ = std::thread(&ScanRelay::sendLoop, this);
+  util::applyThreadSettings(sender_thread_, options.thread_settings);
+}
+
+ScanRelay::~ScanRelay()
+{
+  terminated_ = true;
+  if (sender_thread_.joinable())
+  {
+    sender_thread_.join();
+  }
+  ::close(fd_);
+  PSENSCAN_INFO("ScanRelay", "Sent {} datagrams, dropped {}.", numberOfSentDatagrams(), numberOfDroppedDatagrams());
+}
+
+void ScanRelay::send(const LaserScan& scan)
+{
+  if (key_frame_requested_.exchange(false))
+  {
+    encoder_.forceKeyFrame();
+  }
+  std::vector<char>* slot{ queue_.beginPush() };
+  if (!slot)
+  {
+    // The scan is not encoded, so the next frame refers to the last queued one and can still be decoded.
+    dropped_datagrams_.fetch_add(destinations_.size(), std::memory_order_relaxed);
+    PSENSCAN_WARN_THROTTLE(1 /* sec */, "ScanRelay", "The sender cannot keep up, dropping scans.");
+    return;
+  }
+  // The slots are reused, so their buffers only grow until they fit the largest frame.
+  encoder_.encode(scan, *slot);
+  if (slot->size() > MAX_DATAGRAM_SIZE)
+  {
+    encoder_.forceKeyFrame();
+    dropped_datagrams_.fetch_add(destinations_.size(), std::memory_order_relaxed);
+    PSENSCAN_WARN_THROTTLE(
+        1 /* sec */, "ScanRelay", "Encoded scan of {} bytes does not fit into a datagram, dropping it.", slot->size());
+    return;
+  }
+  queue_.commitPush();
+}
+
+IScanner::LaserScanCallback ScanRelay::laserScanCallback()
+{
+  return [this](const LaserScan& scan) { send(scan); };
+}
+
+uint64_t ScanRelay::numberOfSentDatagrams() const
+{
+  return sent_datagrams_.load(std::memory_order_relaxed);
+}
+
+uint64_t ScanRelay::numberOfDroppedDatagrams() const
+{
+  return dropped_datagrams_.load(std::memory_order_relaxed);
+}
+
+void ScanRelay::sendLoop()
+{
+  while (true)
+  {
+    // Read before draining the queue, so that no scan queued before the termination is lost.
+    const bool terminated{ terminated_ };
+    std::size_t number_of_frames{ 0 };
+    while (std::vector<char>* frame = queue_.front())
+    {
+      std::swap(batch_[number_of_frames++], *frame);
+      queue_.pop();
+      if (number_of_frames == MAX_BATCH_SIZE)
+      {
+        sendBatch(number_of_frames);
+        number_of_frames = 0;
+      }
+    }
+    sendBatch(number_of_frames);
+    if (terminated)
+    {
+      break;
+    }
+    std::this_thread::sleep_for(IDLE_PERIOD);
+  }
+}
+
+void ScanRelay::sendBatch(const std::size_t& number_of_frames)
+{
+  std::size_t number_of_messages{ 0 };
+  for (std::size_t frame = 0; frame < number_of_frames; ++frame)
+  {
+    for (auto& destination : destinations_)
+    {
+      iovecs_[number_of_messages].iov_base = batch_[frame].data();
+      iovecs_[number_of_messages].iov_len = batch_[frame].size();
+      auto& header{ messages_[number_of_messages].msg_hdr };
+      header = msghdr{};
+      header.msg_name = &destination;
+      header.msg_namelen = sizeof(destination);
+      header.msg_iov = &iovecs_[number_of_messages];
+      header.msg_iovlen = 1;
+      ++number_of_messages;
+    }
+  }
+
+  std::size_t offset{ 0 };
+  while (offset < number_of_messages)
+  {
+    // The socket is used non-blocking, a full send buffer drops datagrams instead of delaying the following scans.
+    const int sent{ ::sendmmsg(
+        fd_, &messages_[offset], static_cast<unsigned int>(number_of_messages - offset), MSG_DONTWAIT) };
+    if (sent < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      // Skips the datagram which failed, the receiver needs a key frame to continue.
+      PSENSCAN_WARN_THROTTLE(1 /* sec */, "ScanRelay", "Cannot send scan: {}", std::strerror(errno));
+      key_frame_requested_ = true;
+      dropped_datagrams_.fetch_add(1, std::memory_order_relaxed);
+      ++offset;
+      continue;
+    }
+    sent_datagrams_.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+    offset += static_cast<std::size_t>(sent);
+  }
+}
+
+ScanRelayReceiver::ScanRelayReceiver(const unsigned short& port,
+                                     const ScanHandler& handler,
+                                     const std::string& multicast_group,
+                                     const std::string& multicast_interface,
+                                     const util::ThreadSettings& thread_settings)
+  : handler_(handler)
+  , buffer_(MAX_BATCH_SIZE * MAX_DATAGRAM_SIZE)
+  , senders_(MAX_BATCH_SIZE)
+  , iovecs_(MAX_BATCH_SIZE)
+  , messages_(MAX_BATCH_SIZE)
+{
+  ip_mreq membership{};
+  if (!multicast_group.empty())
+  {
+    membership.imr_multiaddr = toAddress(multicast_group);
+    membership.imr_interface = toAddress(multicast_interface.empty() ? "0.0.0.0" : multicast_interface);
+  }
+
+  fd_ = openSocket();
+  // Allows several receivers of a multicast group on the same host.
+  const int reuse_address{ 1 };
+  setSocketOption(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse_address, sizeof(reuse_address));
+  const timeval timeout{ 0, std::chrono::duration_cast<std::chrono::microseconds>(RECEIVE_TIMEOUT).count() };
+  setSocketOption(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (::bind(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+  {
+    const std::string error{ std::strerror(errno) };
+    ::close(fd_);
+    throw ScanRelayError(fmt::format("Cannot bind to port {}: {}", port, error));
+  }
+  if (!multicast_group.empty())
+  {
+    setSocketOption(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership));
+  }
+
+  receiver_thread_ = std::thread(&ScanRelayReceiver::receiveLoop, this);
+  util::applyThreadSettings(receiver_thread_, thread_settings);
+}
+
+ScanRelayReceiver::~ScanRelayReceiver()
+{
+  terminated_ = true;
+  if (receiver_thread_.joinable())
+  {
+    receiver_thread_.join();
+  }
+  ::close(fd_);
+}
+
+uint64_t ScanRelayReceiver::numberOfReceivedScans() const
+{
+  return received_scans_.load(std::memory_order_relaxed);
+}
+
+uint64_t ScanRelayReceiver::numberOfDecodeErrors() const
+{
+  return decode_errors_.load(std::memory_order_relaxed);
+}
+
+void ScanRelayReceiver::receiveLoop()
+{
+  while (!terminated_)
+  {
+    for (std::size_t i = 0; i < MAX_BATCH_SIZE; ++i)
+    {
+      iovecs_[i].iov_base = buffer_.data() + i * MAX_DATAGRAM_SIZE;
+      iovecs_[i].iov_len = MAX_DATAGRAM_SIZE;
+      auto& header{ messages_[i].msg_hdr };
+      header = msghdr{};
+      header.msg_name = &senders_[i];
+      header.msg_namelen = sizeof(sockaddr_in);
+      header.msg_iov = &iovecs_[i];
+      header.msg_iovlen = 1;
+    }
+    // Blocks till the first datagram or the receive timeout, then takes all datagrams which are already available.
+    const int received{ ::recvmmsg(fd_, messages_.data(), MAX_BATCH_SIZE, MSG_WAITFORONE, nullptr) };
+    if (received < 0)
+    {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+      {
+        PSENSCAN_ERROR_THROTTLE(1 /* sec */, "ScanRelayReceiver", "Cannot receive scans: {}", std::strerror(errno));
+        std::this_thread::sleep_for(RECEIVE_TIMEOUT);
+      }
+      continue;
+    }
+    for (std::size_t i = 0; i < static_cast<std::size_t>(received); ++i)
+    {
+      const uint64_t sender{ (static_cast<uint64_t>(ntohl(senders_[i].sin_addr.s_addr)) << 16) |
+                             ntohs(senders_[i].sin_port) };
+      decode(sender, static_cast<const char*>(iovecs_[i].iov_base), messages_[i].msg_len);
+    }
+  }
+}
+
+void ScanRelayReceiver::decode(const uint64_t& sender, const char* data, const std::size_t& size)
+{
+  try
+  {
+    const LaserScan scan{ decoders_[sender].decode(data, size) };
+    received_scans_.fetch_add(1, std::memory_order_relaxed);
+    handler_(scan);
+  }
+  catch (const ScanCodecError& e)
+  {
+    decode_errors_.fetch_add(1, std::memory_order_relaxed);
+    PSENSCAN_WARN_THROTTLE(1 /* sec */, "ScanRelayReceiver", "{}", e.what());
+  }
+}
+
+}  // namespace psen_scan_v2_standalone
+
+#endif  // __linux__
@@ -0,0 +1,87 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "psen_scan_v2_standalone/scanner_manager.h"
+
+#include <stdexcept>
+
+#include "psen_scan_v2_standalone/util/logging.h"
+
+namespace psen_scan_v2_standalone
+{
+ScannerManager::ScannerManager(const std::size_t& num_worker_threads,
+                               const util::ThreadSettings& io_thread_settings,
+                               const util::ThreadSettings& worker_thread_settings)
+  : io_thread_([this]() { io_service_.run(); }), worker_pool_(num_worker_threads, worker_thread_settings)
+{
+  util::applyThreadSettings(io_thread_, io_thread_settings);
+  PSENSCAN_INFO("ScannerManager", "Using {} worker threads.", worker_pool_.numberOfThreads());
+}
+
+ScannerManager::~ScannerManager()
+{
+  // The scanners need the io thread and the worker pool while being destroyed.
+  scanners_.clear();
+
+  io_service_.stop();
+  if (io_thread_.joinable())
+  {
+    io_thread_.join();
+  }
+}
+
+IScanner& ScannerManager::addScanner(const ScannerConfiguration& scanner_config,
+                                     const IScanner::LaserScanCallback& laser_scan_cb)
+{
+  scanners_.emplace_back(new ScannerV2(scanner_config, laser_scan_cb, io_service_, worker_pool_.executor()));
+  return *scanners_.back();
+}
+
+std::vector<std::future<void>> ScannerManager::startAll()
+{
+  std::vector<std::future<void>> futures;
+  for (auto& scanner : scanners_)
+  {
+    futures.emplace_back(scanner->start());
+  }
+  return futures;
+}
+
+std::vector<std::future<void>> ScannerManager::stopAll()
+{
+  std::vector<std::future<void>> futures;
+  for (auto& scanner : scanners_)
+  {
+    futures.emplace_back(scanner->stop());
+  }
+  return futures;
+}
+
+IScanner& ScannerManager::scanner(const std::size_t& index)
+{
+  return *scanners_.at(index);
+}
+
+std::size_t ScannerManager::numberOfScanners() const
+{
+  return scanners_.size();
+}
+
+std::size_t ScannerManager::numberOfWorkerThreads() const
+{
+  return worker_pool_.numberOfThreads();
+}
+
+}  // namespace psen_scan_v2_standalone
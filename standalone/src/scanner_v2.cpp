@@ -16,9 +16,18 @@
 #include "psen_scan_v2_standalone/scanner_v2.h"
 
 #include <cassert>
+#include <exception>
+#include <memory>
 #include <stdexcept>
 
 #include "psen_scan_v2_standalone/scanner_configuration.h"
+#include "psen_scan_v2_standalone/communication_layer/datagram_recorder.h"
+#include "psen_scan_v2_standalone/communication_layer/flight_recorder.h"
+#include "psen_scan_v2_standalone/communication_layer/uring_udp_client.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_filter.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/scanner_reply_msg.h"
+#include "psen_scan_v2_standalone/util/allocation_tags.h"
 
 namespace psen_scan_v2_standalone
 {
@@ -26,29 +35,64 @@ using namespace psen_scan_v2_standalone::protocol_layer::scanner_events;
 
 // clang-format off
 #define BIND_EVENT(event_name)\
-  std::bind(&ScannerV2::triggerEvent<event_name>, this)
+  [this](const std::string&){ dispatch(std::bind(&ScannerV2::triggerEvent<event_name>, this)); }
 
+// The data handler is called directly by the receive handler of the UDP client, so the receive time is taken here.
 #define BIND_RAW_DATA_EVENT(event_name)\
-  [this](const data_conversion_layer::RawData& data, const std::size_t& num_bytes){ triggerEventWithParam(event_name(data, num_bytes)); }
+  [this](const data_conversion_layer::RawData& data, const std::size_t& num_bytes){ triggerRawDataEvent<event_name>(data, num_bytes, util::LatencyClock::now()); }
 // clang-format on
 
+//! The control client only receives replies, which have a fixed size.
+static constexpr std::size_t MAX_REPLY_SIZE{ data_conversion_layer::scanner_reply::Message::SIZE };
+
+//! @returns the size of a monitoring frame with the given number of measurements for the configured fields.
+static std::size_t monitoringFrameSize(const ScannerConfiguration& config, const std::size_t& measurements)
+{
+  return data_conversion_layer::monitoring_frame::maxSize(
+      measurements, config.intensitiesEnabled(), config.diagnosticsEnabled());
+}
+
+//! @returns the size of the largest monitoring frame, which contains all measurements of the configured scan range.
+static std::size_t maxMonitoringFrameSize(const ScannerConfiguration& config)
+{
+  const int range{ config.scanRange().getEnd().value() - config.scanRange().getStart().value() };
+  return monitoringFrameSize(config, static_cast<std::size_t>(range / config.scanResolution().value() + 1));
+}
+
+#ifdef __linux__
+static constexpr double MONITORING_FRAMES_PER_SECOND{ DEFAULT_NUM_MSG_PER_ROUND / configuration::TIME_PER_SCAN_IN_S };
+
+//! @returns an upper bound of the number of bytes of the monitoring frames sent by the scanner per second.
+static double monitoringBytesPerSecond(const ScannerConfiguration& config)
+{
+  // The measurements of a scan round are split up into its frames, the other fields are contained in each of them.
+  return static_cast<double>(maxMonitoringFrameSize(config) +
+                             (DEFAULT_NUM_MSG_PER_ROUND - 1) * monitoringFrameSize(config, 0)) /
+         configuration::TIME_PER_SCAN_IN_S;
+}
+#endif
+
 ScannerV2::WatchdogFactory::WatchdogFactory(ScannerV2* scanner) : IWatchdogFactory(), scanner_(scanner)
 {
   assert(scanner);
 }
 
-std::unique_ptr<util::Watchdog> ScannerV2::WatchdogFactory::create(const util::Watchdog::Timeout& timeout,
+std::unique_ptr<util::Watchdog> ScannerV2::WatchdogFactory::create(const util::Watchdog::Schedule& schedule,
                                                                    const std::string& event_type)
 {
   if (event_type == "StartReplyTimeout")
   {
     return std::unique_ptr<util::Watchdog>(
-        new util::Watchdog(timeout, std::bind(&ScannerV2::triggerEvent<scanner_events::StartTimeout>, scanner_)));
+        new util::Watchdog(schedule,
+                           std::bind(&ScannerV2::triggerEvent<scanner_events::StartTimeout>, scanner_),
+                           scanner_->getConfig().threadSettings(util::ThreadRole::watchdog)));
   }
   if (event_type == "MonitoringFrameTimeout")
   {
-    return std::unique_ptr<util::Watchdog>(new util::Watchdog(
-        timeout, std::bind(&ScannerV2::triggerEvent<scanner_events::MonitoringFrameTimeout>, scanner_)));
+    return std::unique_ptr<util::Watchdog>(
+        new util::Watchdog(schedule,
+                           std::bind(&ScannerV2::triggerEvent<scanner_events::MonitoringFrameTimeout>, scanner_),
+                           scanner_->getConfig().threadSettings(util::ThreadRole::watchdog)));
   }
 
   // LCOV_EXCL_START
@@ -56,6 +100,186 @@ std::unique_ptr<util::Watchdog> ScannerV2::WatchdogFactory::create(const util::W
   // LCOV_EXCL_STOP
 }
 
+std::unique_ptr<communication_layer::UdpClientImpl>
+ScannerV2::createUdpClient(const communication_layer::NewDataHandler& data_handler,
+                           const communication_layer::ErrorHandler& error_handler,
+                           const unsigned short& host_port,
+                           const unsigned short& endpoint_port,
+                           const util::ThreadSettings& thread_settings,
+                           const std::size_t& max_datagram_size)
+{
+  if (shared_io_service_)
+  {
+    return std::make_unique<communication_layer::UdpClientImpl>(*shared_io_service_,
+                                                                data_handler,
+                                                                error_handler,
+                                                                host_port,
+                                                                IScanner::getConfig().clientIp(),
+                                                                endpoint_port,
+                                                                max_datagram_size);
+  }
+  return std::make_unique<communication_layer::UdpClientImpl>(data_handler,
+                                                              error_handler,
+                                                              host_port,
+                                                              IScanner::getConfig().clientIp(),
+                                                              endpoint_port,
+                                                              thread_settings,
+                                                              max_datagram_size);
+}
+
+std::unique_ptr<communication_layer::IUdpClient> ScannerV2::createDataClient()
+{
+  const ScannerConfiguration& config{ IScanner::getConfig() };
+  if (config.ioUringEnabled())
+  {
+#ifdef PSENSCAN_ENABLE_IO_URING
+    if (shared_io_service_)
+    {
+      PSENSCAN_WARN("Scanner", "io_uring is not supported for scanners sharing their threads. Ignoring it.");
+    }
+    else
+    {
+      try
+      {
+        auto data_client{ std::make_unique<communication_layer::UringUdpClient>(
+            createMonitoringFrameHandler(),
+            BIND_EVENT(MonitoringFrameReceivedError),
+            config.hostUDPPortData(),
+            config.clientIp(),
+            config.scannerDataPort(),
+            config.threadSettings(util::ThreadRole::io),
+            communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS,
+            maxMonitoringFrameSize(config)) };
+        setUpDataClient(*data_client);
+        return data_client;
+      }
+      catch (const communication_layer::UdpClientImpl::OpenConnectionFailure& ex)
+      {
+        PSENSCAN_WARN("Scanner", "Cannot receive via io_uring ({}). Falling back to Boost.Asio.", ex.what());
+      }
+    }
+#else
+    PSENSCAN_WARN("Scanner", "The driver is compiled without io_uring (see ENABLE_IO_URING). Ignoring it.");
+#endif
+  }
+
+  auto data_client{ createUdpClient(createMonitoringFrameHandler(),
+                                    BIND_EVENT(MonitoringFrameReceivedError),
+                                    config.hostUDPPortData(),
+                                    config.scannerDataPort(),
+                                    config.threadSettings(util::ThreadRole::io),
+                                    maxMonitoringFrameSize(config)) };
+  setUpDataClient(*data_client);
+  return data_client;
+}
+
+template <typename Client>
+void ScannerV2::setUpDataClient(Client& data_client)
+{
+  const ScannerConfiguration& config{ IScanner::getConfig() };
+#ifdef __linux__
+  // Foreign datagrams, e.g. broadcasts, are dropped by the kernel instead of waking up the io thread.
+  data_client.attachSocketFilter(data_conversion_layer::monitoring_frame::createSocketFilter());
+#endif
+  if (config.datagramRecordingFile())
+  {
+#ifdef __linux__
+    communication_layer::UdpEndpoints endpoints;
+    endpoints.source_ip = config.clientIp();
+    endpoints.source_port = config.scannerDataPort();
+    endpoints.destination_ip = config.hostIp().value_or(0);
+    endpoints.destination_port = config.hostUDPPortData();
+    data_client.addDatagramTap(
+        std::make_shared<communication_layer::DatagramRecorder>(config.datagramRecordingFile().value(), endpoints));
+#else
+    PSENSCAN_WARN("Scanner", "Recording datagrams is only supported on Linux. Ignoring it.");
+#endif
+  }
+  if (config.flightRecorderFile())
+  {
+#ifdef __linux__
+    flight_recorder_ = std::make_shared<communication_layer::FlightRecorder>(
+        config.flightRecorderFile().value(),
+        communication_layer::FlightRecorder::capacityFor(
+            config.flightRecorderDuration(), MONITORING_FRAMES_PER_SECOND, monitoringBytesPerSecond(config)));
+    if (config.flightRecorderSnapshotSignal())
+    {
+      flight_recorder_->snapshotOnSignal(config.flightRecorderSnapshotSignal().value(),
+                                         config.flightRecorderFile().value());
+    }
+    data_client.addDatagramTap(flight_recorder_);
+#else
+    PSENSCAN_WARN("Scanner", "The flight recorder is only supported on Linux. Ignoring it.");
+#endif
+  }
+}
+
+std::unique_ptr<protocol_layer::MonitoringFramePipeline> ScannerV2::createPipeline()
+{
+  if (!IScanner::getConfig().pipelinedProcessingEnabled())
+  {
+    return nullptr;
+  }
+  if (shared_io_service_)
+  {
+    PSENSCAN_WARN("Scanner", "Pipelined processing is not supported for scanners sharing their threads. Ignoring it.");
+    return nullptr;
+  }
+  return std::make_unique<protocol_layer::MonitoringFramePipeline>(
+      [this](const data_conversion_layer::monitoring_frame::Message& frame,
+             const util::LatencyClock::time_point& receive_time) {
+        triggerEventWithParam(scanner_events::MonitoringFrameReceived(frame, receive_time));
+      },
+      [this](const std::exception_ptr& exception) {
+        triggerEventWithParam(scanner_events::MonitoringFrameDecodingFailed(exception));
+      },
+      IScanner::getConfig().threadSettings(util::ThreadRole::dispatcher),
+      latency_histograms_.deserialization,
+      perf_counters_.deserialization);
+}
+
+communication_layer::NewDataHandler ScannerV2::createMonitoringFrameHandler()
+{
+  if (pipeline_)
+  {
+    return [this](const data_conversion_layer::RawData& data, const std::size_t& num_bytes) {
+      pipeline_->push(data, num_bytes, util::LatencyClock::now());
+    };
+  }
+  return BIND_RAW_DATA_EVENT(RawMonitoringFrameReceived);
+}
+
+IScanner::LaserScanCallback ScannerV2::createLaserScanCallback() const
+{
+  const util::Executor& executor{ IScanner::getConfig().callbackExecutor() };
+  if (!executor)
+  {
+    return IScanner::getLaserScanCB();
+  }
+  // The task must not access the scanner, because it might run after the destruction of the scanner.
+  // The tasks are serialized, so that a multi-threaded executor runs the callback in the order of the scans.
+  const LaserScanCallback laser_scan_cb{ IScanner::getLaserScanCB() };
+  const util::Executor serial_executor{ util::serialExecutor(executor) };
+  return [serial_executor, laser_scan_cb](const LaserScan& scan) {
+    const auto scan_copy{ std::make_shared<LaserScan>(scan) };
+    serial_executor([laser_scan_cb, scan_copy]() {
+      PSENSCAN_TRACE_SPAN("laser_scan_callback_task");
+      const util::AllocationTagScope allocation_tag(util::AllocationTag::callback);
+      laser_scan_cb(*scan_copy);
+    });
+  };
+}
+
+void ScannerV2::dispatch(const std::function<void()>& task)
+{
+  if (strand_)
+  {
+    strand_->post(task);
+    return;
+  }
+  task();
+}
+
 StateMachineArgs* ScannerV2::createStateMachineArgs()
 {
   return new StateMachineArgs(
@@ -64,27 +288,46 @@ StateMachineArgs* ScannerV2::createStateMachineArgs()
       // The following includes calls to std::bind which are not marked correctly
       // by some gcc versions, see https://gcc.gnu.org/bugzilla/show_bug.cgi?id=96006
       // UDP clients
-      std::make_unique<communication_layer::UdpClientImpl>(BIND_RAW_DATA_EVENT(RawReplyReceived),
-                                                           BIND_EVENT(ReplyReceiveError),
-                                                           IScanner::getConfig().hostUDPPortControl(),
-                                                           IScanner::getConfig().clientIp(),
-                                                           IScanner::getConfig().scannerControlPort()),
-      std::make_unique<communication_layer::UdpClientImpl>(BIND_RAW_DATA_EVENT(RawMonitoringFrameReceived),
-                                                           BIND_EVENT(MonitoringFrameReceivedError),
-                                                           IScanner::getConfig().hostUDPPortData(),
-                                                           IScanner::getConfig().clientIp(),
-                                                           IScanner::getConfig().scannerDataPort()),
+      createUdpClient(BIND_RAW_DATA_EVENT(RawReplyReceived),
+                      BIND_EVENT(ReplyReceiveError),
+                      IScanner::getConfig().hostUDPPortControl(),
+                      IScanner::getConfig().scannerControlPort(),
+                      IScanner::getConfig().threadSettings(util::ThreadRole::io).withNameSuffix("_ctrl"),
+                      MAX_REPLY_SIZE),
+      createDataClient(),
       // Callbacks
       std::bind(&ScannerV2::scannerStartedCB, this),
       std::bind(&ScannerV2::scannerStoppedCB, this),
       // LCOV_EXCL_STOP
-      IScanner::getLaserScanCB(),
-      std::unique_ptr<IWatchdogFactory>(new WatchdogFactory(this)));
+      createLaserScanCallback(),
+      std::unique_ptr<IWatchdogFactory>(new WatchdogFactory(this)),
+      latency_histograms_,
+      perf_counters_);
 }  // namespace psen_scan_v2_standalone
 
 ScannerV2::ScannerV2(const ScannerConfiguration& scanner_config, const LaserScanCallback& laser_scan_cb)
-  : IScanner(scanner_config, laser_scan_cb), sm_(new ScannerStateMachine(createStateMachineArgs()))
+  : IScanner(scanner_config, laser_scan_cb)
+  , perf_counters_(scanner_config.perfCountersEnabled())
+  , pipeline_(createPipeline())
+  , sm_(new ScannerStateMachine(createStateMachineArgs()))
+{
+  enableTracing();
+  const std::lock_guard<std::mutex> lock(member_mutex_);
+  sm_->start();
+}
+
+ScannerV2::ScannerV2(const ScannerConfiguration& scanner_config,
+                     const LaserScanCallback& laser_scan_cb,
+                     boost::asio::io_service& io_service,
+                     const util::Executor& executor)
+  : IScanner(scanner_config, laser_scan_cb)
+  , perf_counters_(scanner_config.perfCountersEnabled())
+  , shared_io_service_(&io_service)
+  , strand_(new util::Strand(executor))
+  , pipeline_(createPipeline())
+  , sm_(new ScannerStateMachine(createStateMachineArgs()))
 {
+  enableTracing();
   const std::lock_guard<std::mutex> lock(member_mutex_);
   sm_->start();
 }
@@ -93,8 +336,51 @@ ScannerV2::~ScannerV2()
 {
   PSENSCAN_DEBUG("Scanner", "Destruction called.");
 
+  if (strand_)
+  {
+    // Drop the data which were not processed, yet. Otherwise they might be processed during the destruction.
+    strand_->shutdown();
+  }
+  if (pipeline_)
+  {
+    // The assembly stage must not access the state machine while it is destroyed.
+    pipeline_->stop();
+  }
+
   const std::lock_guard<std::mutex> lock(member_mutex_);
   sm_->stop();
+  writeTrace();
+}
+
+void ScannerV2::enableTracing() const
+{
+  if (IScanner::getConfig().traceFile())
+  {
+    util::Tracer::instance().enable();
+  }
+}
+
+void ScannerV2::writeTrace() const
+{
+  const boost::optional<std::string>& trace_file{ IScanner::getConfig().traceFile() };
+  if (!trace_file)
+  {
+    return;
+  }
+  try
+  {
+    util::Tracer::instance().writeChromeTrace(trace_file.value());
+    PSENSCAN_INFO("Scanner", "Wrote trace to {}.", trace_file.value());
+  }
+  catch (const std::runtime_error& e)
+  {
+    PSENSCAN_ERROR("Scanner", "Could not write trace: {}", e.what());
+  }
+  // The spans are kept for the trace files of other scanners which are still tracing.
+  if (util::Tracer::instance().disable())
+  {
+    util::Tracer::instance().clear();
+  }
 }
 
 std::future<void> ScannerV2::start()
@@ -107,6 +393,11 @@ std::future<void> ScannerV2::start()
     return std::future<void>();
   }
 
+  if (IScanner::getConfig().memoryLockingEnabled())
+  {
+    util::lockMemory();
+  }
+
   // No call to triggerEvent() because lock already taken
   sm_->process_event(scanner_events::StartRequest());
   // Due to the fact that the getting of the future should always succeed (because of the
@@ -133,6 +424,39 @@ std::future<void> ScannerV2::stop()
   return scanner_has_stopped_.value().get_future();
 }
 
+ScannerStatistics ScannerV2::getStatistics() const
+{
+  ScannerStatistics statistics;
+  statistics.protocol = getProtocolStatistics();
+  statistics.latencies = latency_histograms_.snapshot();
+  statistics.perf_counters = perf_counters_.snapshot();
+  if (pipeline_)
+  {
+    statistics.pipeline = pipeline_->statistics();
+  }
+  return statistics;
+}
+
+void ScannerV2::writeFlightRecorderSnapshot(const std::string& filename) const
+{
+#ifdef __linux__
+  if (!flight_recorder_)
+  {
+    throw std::logic_error("No flight recorder configured.");
+  }
+  flight_recorder_->writeSnapshot(filename);
+#else
+  throw std::logic_error("The flight recorder is only supported on Linux.");
+#endif
+}
+
+protocol_layer::ProtocolStatistics ScannerV2::getProtocolStatistics() const
+{
+  // Only atomic counters of the state machine are read, so the member mutex is not needed.
+  // The decoding errors of the pipeline are counted by the state machine, too (see MonitoringFrameDecodingFailed).
+  return sm_->protocolStatistics();
+}
+
 // PLEASE NOTE:
 // The callback does not take a member lock because the callback is always called
 // via call to triggerEvent() or triggerEventWithParam() which already take the mutex.
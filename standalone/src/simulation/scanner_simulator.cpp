@@ -0,0 +1,388 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include <fmt/format.h>
+
+#include "psen_scan_v2_standalone/simulation/scanner_simulator.h"
+
+#include "psen_scan_v2_standalone/data_conversion_layer/diagnostics.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/raw_processing.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/scanner_reply_msg.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/scanner_reply_serialization_deserialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/stop_request_serialization.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+namespace psen_scan_v2_standalone
+{
+namespace simulation
+{
+using boost::asio::ip::udp;
+
+// Layout of the start request, see data_conversion_layer::start_request::serialize().
+static constexpr std::size_t START_REQUEST_SIZE{ 58 };
+static constexpr std::size_t OP_CODE_OFFSET{ 16 };
+static constexpr std::size_t HOST_IP_OFFSET{ 20 };
+static constexpr std::size_t HOST_DATA_PORT_OFFSET{ 24 };
+static constexpr std::size_t INTENSITIES_ENABLED_OFFSET{ 27 };
+static constexpr std::size_t DIAGNOSTICS_ENABLED_OFFSET{ 33 };
+static constexpr std::size_t MASTER_SCAN_RANGE_OFFSET{ 34 };
+static constexpr uint8_t MASTER_DEVICE_MASK{ 0b00001000 };
+static constexpr uint32_t OP_CODE_START{ 0x35 };
+
+static constexpr std::size_t CONTROL_BUFFER_SIZE{ 1024 };
+//! Upper limit of ScanRange.
+static constexpr int MAX_SCAN_ANGLE{ 2750 };
+
+using DiagnosticMessages = std::vector<data_conversion_layer::monitoring_frame::diagnostic::Message>;
+static const DiagnosticMessages SIMULATED_DIAGNOSTIC_ERRORS{
+  { configuration::ScannerId::master, data_conversion_layer::monitoring_frame::diagnostic::ErrorLocation(1, 7) }
+};
+
+ControlMessageFailure::ControlMessageFailure(const std::string& msg) : std::runtime_error(msg)
+{
+}
+
+template <typename T>
+static T readAt(const data_conversion_layer::RawData& data, const std::size_t& offset)
+{
+  std::istringstream is(std::string(data.cbegin() + offset, data.cbegin() + offset + sizeof(T)));
+  return data_conversion_layer::raw_processing::read<T>(is);
+}
+
+StartRequestSettings parseStartRequest(const data_conversion_layer::RawData& data)
+{
+  if (data.size() != START_REQUEST_SIZE)
+  {
+    throw ControlMessageFailure(
+        fmt::format("Start request has {} bytes instead of the expected {} bytes.", data.size(), START_REQUEST_SIZE));
+  }
+  if (readAt<uint32_t>(data, OP_CODE_OFFSET) != OP_CODE_START)
+  {
+    throw ControlMessageFailure("Control message is no start request.");
+  }
+
+  StartRequestSettings settings;
+  // The host ip is sent in big endian.
+  settings.host_ip = fmt::format("{}.{}.{}.{}",
+                                 static_cast<uint8_t>(data.at(HOST_IP_OFFSET)),
+                                 static_cast<uint8_t>(data.at(HOST_IP_OFFSET + 1)),
+                                 static_cast<uint8_t>(data.at(HOST_IP_OFFSET + 2)),
+                                 static_cast<uint8_t>(data.at(HOST_IP_OFFSET + 3)));
+  settings.host_data_port = readAt<uint16_t>(data, HOST_DATA_PORT_OFFSET);
+  settings.intensities_enabled = (data.at(INTENSITIES_ENABLED_OFFSET) & MASTER_DEVICE_MASK) != 0;
+  settings.diagnostics_enabled = (data.at(DIAGNOSTICS_ENABLED_OFFSET) & MASTER_DEVICE_MASK) != 0;
+
+  const util::TenthOfDegree start{ readAt<int16_t>(data, MASTER_SCAN_RANGE_OFFSET) };
+  const util::TenthOfDegree end{ readAt<int16_t>(data, MASTER_SCAN_RANGE_OFFSET + 2) };
+  settings.resolution = util::TenthOfDegree{ readAt<int16_t>(data, MASTER_SCAN_RANGE_OFFSET + 4) };
+  try
+  {
+    settings.scan_range = ScanRange(start, end);
+  }
+  catch (const std::logic_error& e)
+  {
+    throw ControlMessageFailure(fmt::format("Start request has an invalid scan range: {}", e.what()));
+  }
+  if (settings.resolution.value() <= 0)
+  {
+    throw ControlMessageFailure("Start request has an invalid resolution.");
+  }
+  return settings;
+}
+
+std::vector<FrameLayout> computeFrameLayout(const ScanRange& scan_range, const util::TenthOfDegree& resolution)
+{
+  const int resolution_value{ std::max<int>(resolution.value(), 1) };
+  const int start{ scan_range.getStart().value() };
+  const int end{ scan_range.getEnd().value() };
+  const int number_of_sectors{ static_cast<int>(FRAMES_PER_SCAN_ROUND) };
+  // The measurements are taken at start + i * resolution for i in [0, number_of_measurements).
+  const int number_of_measurements{ (end - start) / resolution_value };
+
+  const auto firstMeasurementFrom = [&](const int& angle) {
+    const int index{ angle <= start ? 0 : (angle - start + resolution_value - 1) / resolution_value };
+    return std::min(index, number_of_measurements);
+  };
+
+  std::vector<FrameLayout> layout;
+  for (int sector = 0; sector < number_of_sectors; ++sector)
+  {
+    const int sector_begin{ MAX_SCAN_ANGLE * sector / number_of_sectors };
+    const int sector_end{ MAX_SCAN_ANGLE * (sector + 1) / number_of_sectors };
+    const int first{ firstMeasurementFrom(sector_begin) };
+    const int last{ firstMeasurementFrom(sector_end) };
+    const int from_theta{ first < last ? start + first * resolution_value : sector_begin };
+    layout.push_back(FrameLayout{ util::TenthOfDegree(static_cast<int16_t>(from_theta)),
+                                  static_cast<std::size_t>(last - first) });
+  }
+  return layout;
+}
+
+ScannerSimulator::ScannerSimulator(const std::string& ip,
+                                   const unsigned short& control_port,
+                                   const unsigned short& data_port,
+                                   const SimulationParameters& parameters)
+  : parameters_(parameters)
+  , control_socket_(io_service_, udp::endpoint(boost::asio::ip::address_v4::from_string(ip), control_port))
+  , data_socket_(io_service_, udp::endpoint(boost::asio::ip::address_v4::from_string(ip), data_port))
+  , control_buffer_(CONTROL_BUFFER_SIZE)
+  , random_generator_(parameters.seed)
+{
+  asyncReceiveControlMessage();
+  io_service_thread_ = std::thread([this]() { io_service_.run(); });
+  streaming_thread_ = std::thread([this]() { streamMonitoringFrames(); });
+  PSENSCAN_INFO(
+      "ScannerSimulator", "Simulating scanner {} (control port: {}, data port: {}).", ip, control_port, data_port);
+}
+
+ScannerSimulator::~ScannerSimulator()
+{
+  {
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    terminate_ = true;
+  }
+  settings_changed_.notify_all();
+  streaming_thread_.join();
+
+  io_service_.stop();
+  io_service_thread_.join();
+}
+
+SimulatorStatistics ScannerSimulator::statistics() const
+{
+  SimulatorStatistics statistics;
+  statistics.start_requests = start_requests_.load(std::memory_order_relaxed);
+  statistics.stop_requests = stop_requests_.load(std::memory_order_relaxed);
+  statistics.scan_rounds = scan_rounds_.load(std::memory_order_relaxed);
+  statistics.sent_frames = sent_frames_.load(std::memory_order_relaxed);
+  statistics.lost_frames = lost_frames_.load(std::memory_order_relaxed);
+  statistics.reordered_frames = reordered_frames_.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+void ScannerSimulator::asyncReceiveControlMessage()
+{
+  control_socket_.async_receive_from(
+      boost::asio::buffer(control_buffer_),
+      control_sender_,
+      [this](const boost::system::error_code& error_code, const std::size_t& bytes_received) {
+        if (error_code == boost::asio::error::operation_aborted)
+        {
+          return;
+        }
+        if (error_code)
+        {
+          PSENSCAN_ERROR("ScannerSimulator", "Failed to receive control message: {}", error_code.message());
+        }
+        else
+        {
+          handleControlMessage(data_conversion_layer::RawData(control_buffer_.cbegin(),
+                                                              control_buffer_.cbegin() + bytes_received));
+        }
+        asyncReceiveControlMessage();
+      });
+}
+
+void ScannerSimulator::handleControlMessage(const data_conversion_layer::RawData& data)
+{
+  if (data.size() < OP_CODE_OFFSET + sizeof(uint32_t))
+  {
+    PSENSCAN_WARN("ScannerSimulator", "Ignoring control message with only {} bytes.", data.size());
+    return;
+  }
+
+  const uint32_t op_code{ readAt<uint32_t>(data, OP_CODE_OFFSET) };
+  if (op_code == OP_CODE_START)
+  {
+    StartRequestSettings settings;
+    try
+    {
+      settings = parseStartRequest(data);
+    }
+    catch (const ControlMessageFailure& e)
+    {
+      PSENSCAN_WARN("ScannerSimulator", "Ignoring start request: {}", e.what());
+      return;
+    }
+    ++start_requests_;
+    // Like the scanner, the reply is sent before the first monitoring frame.
+    sendReply(op_code);
+    {
+      std::lock_guard<std::mutex> lock(settings_mutex_);
+      settings_ = settings;
+    }
+    settings_changed_.notify_all();
+  }
+  else if (op_code == data_conversion_layer::stop_request::OPCODE)
+  {
+    ++stop_requests_;
+    {
+      std::lock_guard<std::mutex> lock(settings_mutex_);
+      settings_ = boost::none;
+    }
+    settings_changed_.notify_all();
+    sendReply(op_code);
+  }
+  else
+  {
+    PSENSCAN_WARN("ScannerSimulator", "Ignoring control message with unknown op code {:#x}.", op_code);
+  }
+}
+
+void ScannerSimulator::sendReply(const uint32_t& op_code)
+{
+  const data_conversion_layer::RawData reply{ data_conversion_layer::scanner_reply::serialize(
+      op_code,
+      static_cast<uint32_t>(data_conversion_layer::scanner_reply::Message::OperationResult::accepted)) };
+  boost::system::error_code error_code;
+  control_socket_.send_to(boost::asio::buffer(reply), control_sender_, 0, error_code);
+  if (error_code)
+  {
+    PSENSCAN_ERROR("ScannerSimulator", "Failed to send reply: {}", error_code.message());
+  }
+}
+
+std::vector<data_conversion_layer::monitoring_frame::Message>
+ScannerSimulator::createScanRound(const StartRequestSettings& settings, const uint32_t& scan_counter) const
+{
+  const DiagnosticMessages diagnostic_messages{ settings.diagnostics_enabled && parameters_.diagnostic_errors ?
+                                                    SIMULATED_DIAGNOSTIC_ERRORS :
+                                                    DiagnosticMessages{} };
+
+  std::vector<data_conversion_layer::monitoring_frame::Message> frames;
+  for (const auto& frame : computeFrameLayout(settings.scan_range, settings.resolution))
+  {
+    // A smooth contour of a room with some structure, so that the data compresses like real data.
+    std::vector<double> measurements(frame.number_of_measurements);
+    std::vector<double> intensities;
+    for (std::size_t i = 0; i < frame.number_of_measurements; ++i)
+    {
+      const double angle{ (frame.from_theta.value() + static_cast<double>(i * settings.resolution.value())) / 10. };
+      measurements[i] = std::round(10. * (3. + std::sin(angle / 20.) + 0.2 * std::sin(angle))) / 10.;
+    }
+    if (settings.intensities_enabled)
+    {
+      intensities.resize(frame.number_of_measurements);
+      std::transform(measurements.cbegin(), measurements.cend(), intensities.begin(), [](const double& distance) {
+        return std::round(4000. / distance);
+      });
+    }
+
+    // Frames with intensities always contain the diagnostics field, which is ignored by the driver if not enabled.
+    if (settings.intensities_enabled || settings.diagnostics_enabled)
+    {
+      frames.emplace_back(
+          frame.from_theta, settings.resolution, scan_counter, measurements, intensities, diagnostic_messages);
+    }
+    else
+    {
+      frames.emplace_back(frame.from_theta, settings.resolution, scan_counter, measurements);
+    }
+  }
+  return frames;
+}
+
+void ScannerSimulator::sendFrame(const data_conversion_layer::monitoring_frame::Message& frame,
+                                 const udp::endpoint& receiver)
+{
+  const data_conversion_layer::RawData data{ data_conversion_layer::monitoring_frame::serialize(frame) };
+  boost::system::error_code error_code;
+  data_socket_.send_to(boost::asio::buffer(data), receiver, 0, error_code);
+  if (error_code)
+  {
+    PSENSCAN_WARN_THROTTLE(1, "ScannerSimulator", "Failed to send monitoring frame: {}", error_code.message());
+    return;
+  }
+  ++sent_frames_;
+}
+
+void ScannerSimulator::streamMonitoringFrames()
+{
+  std::uniform_real_distribution<double> probability(0., 1.);
+  std::uniform_int_distribution<int64_t> jitter_us(0, parameters_.jitter.count());
+  uint32_t scan_counter{ 0 };
+
+  std::unique_lock<std::mutex> lock(settings_mutex_);
+  while (!terminate_)
+  {
+    if (!settings_)
+    {
+      settings_changed_.wait(lock);
+      continue;
+    }
+
+    const StartRequestSettings settings{ *settings_ };
+    lock.unlock();
+
+    const udp::endpoint receiver(boost::asio::ip::address_v4::from_string(settings.host_ip), settings.host_data_port);
+    const std::vector<data_conversion_layer::monitoring_frame::Message> frames{ createScanRound(settings,
+                                                                                                ++scan_counter) };
+    const auto round_start{ std::chrono::steady_clock::now() };
+    const std::chrono::nanoseconds round_period{ static_cast<int64_t>(1e9 / parameters_.scan_rate_hz) };
+    const std::chrono::nanoseconds frame_period{ round_period / static_cast<int64_t>(frames.size()) };
+
+    // Initialized explicitly, since gcc reports the default constructed optional as maybe-uninitialized.
+    boost::optional<std::size_t> held_back_frame{ boost::make_optional(false, std::size_t{ 0 }) };
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+      lock.lock();
+      settings_changed_.wait_until(lock,
+                                   round_start + frame_period * static_cast<int64_t>(i) +
+                                       std::chrono::microseconds(jitter_us(random_generator_)),
+                                   [this]() { return terminate_ || !settings_; });
+      const bool streaming{ !terminate_ && settings_ };
+      lock.unlock();
+      if (!streaming)
+      {
+        break;
+      }
+
+      if (probability(random_generator_) < parameters_.loss_probability)
+      {
+        ++lost_frames_;
+        continue;
+      }
+      if (!held_back_frame && i + 1 < frames.size() &&
+          probability(random_generator_) < parameters_.reorder_probability)
+      {
+        held_back_frame = i;
+        ++reordered_frames_;
+        continue;
+      }
+      sendFrame(frames.at(i), receiver);
+      if (held_back_frame)
+      {
+        sendFrame(frames.at(*held_back_frame), receiver);
+        held_back_frame = boost::none;
+      }
+    }
+    if (held_back_frame)
+    {
+      sendFrame(frames.at(*held_back_frame), receiver);
+    }
+    ++scan_rounds_;
+
+    lock.lock();
+    settings_changed_.wait_until(lock, round_start + round_period, [this]() { return terminate_ || !settings_; });
+  }
+}
+
+}  // namespace simulation
+}  // namespace psen_scan_v2_standalone
@@ -0,0 +1,250 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Cold-start benchmark: time from the construction of a ScannerV2 till its first LaserScan.
+ *
+ * A ScannerMock plays a scanner which was just power-cycled: It ignores the given number of start requests (as if
+ * it was still booting), answers the next one and then streams monitoring frames of a full scan range (275 deg with
+ * 0.1 deg resolution in 6 frames per scan round) with the rate of a real scanner (33 Hz). The streaming starts at
+ * a different frame of the scan round in each repetition, like a real scanner which is already rotating.
+ * Unfragmented scans are measured with and without fast start (see ScannerConfigurationBuilder::enableFastStart()).
+ *
+ * For each mode and number of ignored start requests one line of JSON is printed on stdout containing the medians
+ * over all repetitions of:
+ * - the duration of the construction of the ScannerV2,
+ * - the duration from the call of start() till the scanner is started,
+ * - the duration from the construction till the entry into the first laser scan callback (and its maximum),
+ * - the fraction of the scan range covered by the first LaserScan.
+ *
+ * Usage: benchmark_cold_start [repetitions] [ignored_start_requests...]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "psen_scan_v2_standalone/util/integrationtest_helper.h"
+#include "psen_scan_v2_standalone/communication_layer/scanner_mock.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scanner_config_builder.h"
+#include "psen_scan_v2_standalone/scanner_v2.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/stop_request_serialization.h"
+#include "psen_scan_v2_standalone/util/latency_histogram.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace psen_scan_v2_standalone_test;
+using namespace ::testing;
+
+static const std::string HOST_IP_ADDRESS{ "127.0.0.1" };
+static const std::vector<unsigned int> DEFAULT_IGNORED_START_REQUESTS{ 0, 1 };
+static constexpr std::size_t DEFAULT_REPETITIONS{ 6 };
+static constexpr std::size_t FRAMES_PER_ROUND{ 6 };
+static constexpr double SCAN_RATE_HZ{ 33. };
+static constexpr std::chrono::seconds TIMEOUT{ 5 };
+
+static const ScanRange SCAN_RANGE{ util::TenthOfDegree(0), util::TenthOfDegree(2750) };
+static const util::TenthOfDegree SCAN_RESOLUTION{ 1 };
+
+static ScannerConfiguration generateScannerConfig(const PortHolder& port_holder, const bool& fast_start)
+{
+  return ScannerConfigurationBuilder()
+      .hostIP(HOST_IP_ADDRESS)
+      .hostDataPort(port_holder.data_port_host)
+      .hostControlPort(port_holder.control_port_host)
+      .scannerIp(HOST_IP_ADDRESS)
+      .scannerDataPort(port_holder.data_port_scanner)
+      .scannerControlPort(port_holder.control_port_scanner)
+      .scanRange(SCAN_RANGE)
+      .scanResolution(SCAN_RESOLUTION)
+      .enableFragmentedScans(false)
+      .enableFastStart(fast_start)
+      .build();
+}
+
+static util::TenthOfDegree startOfFragment(const std::size_t& fragment)
+{
+  return util::TenthOfDegree(static_cast<int16_t>(SCAN_RANGE.getEnd().value() * static_cast<int>(fragment) /
+                                                  static_cast<int>(FRAMES_PER_ROUND)));
+}
+
+static data_conversion_layer::RawData serializeFrame(const uint32_t& scan_counter, const std::size_t& fragment)
+{
+  const auto start{ startOfFragment(fragment) };
+  const auto num_measurements{ static_cast<unsigned int>((startOfFragment(fragment + 1) - start).value()) };
+  return data_conversion_layer::monitoring_frame::serialize(data_conversion_layer::monitoring_frame::Message(
+      start, SCAN_RESOLUTION, scan_counter, generateMeasurements(num_measurements, 0., 10.)));
+}
+
+static double toUs(const std::chrono::nanoseconds& duration)
+{
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+static double median(std::vector<double> values)
+{
+  std::sort(values.begin(), values.end());
+  return values.empty() ? 0. : values[values.size() / 2];
+}
+
+struct ColdStart
+{
+  std::chrono::nanoseconds construction{};
+  std::chrono::nanoseconds start{};
+  std::chrono::nanoseconds first_scan{};
+  double coverage{ 0. };
+};
+
+static ColdStart measureColdStart(const bool& fast_start,
+                                  const unsigned int& ignored_start_requests,
+                                  const std::size_t& first_fragment)
+{
+  const PortHolder port_holder{ ++GLOBAL_PORT_HOLDER };
+  NiceMock<ScannerMock> mock(HOST_IP_ADDRESS, port_holder);
+
+  std::promise<void> streaming_started;
+  std::atomic_bool streaming{ true };
+  unsigned int start_requests{ 0 };
+  ON_CALL(mock, receiveControlMsg(_, _)).WillByDefault(InvokeWithoutArgs([&]() {
+    if (++start_requests == ignored_start_requests + 1)
+    {
+      mock.sendStartReply();
+      streaming_started.set_value();
+    }
+  }));
+  ON_CALL(mock, receiveControlMsg(_, data_conversion_layer::stop_request::serialize()))
+      .WillByDefault(InvokeWithoutArgs([&mock]() { mock.sendStopReply(); }));
+
+  // The frames are sent by a thread of their own, like a scanner which keeps rotating.
+  auto streaming_done{ std::async(std::launch::async, [&, first_frame = streaming_started.get_future()]() {
+    first_frame.wait();
+    const std::chrono::nanoseconds frame_period{ static_cast<int64_t>(1e9 / (SCAN_RATE_HZ * FRAMES_PER_ROUND)) };
+    auto next_send_time{ util::LatencyClock::now() };
+    for (std::size_t frame = first_fragment; streaming; ++frame)
+    {
+      std::this_thread::sleep_until(next_send_time);
+      mock.sendSerializedMonitoringFrame(
+          serializeFrame(static_cast<uint32_t>(frame / FRAMES_PER_ROUND + 1), frame % FRAMES_PER_ROUND));
+      next_send_time += frame_period;
+    }
+  }) };
+
+  std::promise<util::LatencyClock::time_point> first_scan;
+  std::atomic_bool first_scan_received{ false };
+  double coverage{ 0. };
+  const auto laser_scan_cb = [&](const LaserScan& scan) {
+    const auto now{ util::LatencyClock::now() };
+    if (!first_scan_received.exchange(true))
+    {
+      coverage = static_cast<double>(scan.getMeasurements().size()) / SCAN_RANGE.getEnd().value();
+      first_scan.set_value(now);
+    }
+  };
+
+  mock.startContinuousListeningForControlMsg();
+  auto first_scan_future{ first_scan.get_future() };
+  const auto construction_start{ util::LatencyClock::now() };
+  ScannerV2 scanner(generateScannerConfig(port_holder, fast_start), laser_scan_cb);
+  const auto start_call{ util::LatencyClock::now() };
+  auto started{ scanner.start() };
+  if (started.wait_for(TIMEOUT) != std::future_status::ready)
+  {
+    std::cerr << "Scanner did not start" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  const auto start_end{ util::LatencyClock::now() };
+  if (first_scan_future.wait_for(TIMEOUT) != std::future_status::ready)
+  {
+    std::cerr << "No laser scan received" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  ColdStart result;
+  result.construction = start_call - construction_start;
+  result.start = start_end - start_call;
+  result.first_scan = first_scan_future.get() - construction_start;
+  result.coverage = coverage;
+
+  scanner.stop().wait_for(TIMEOUT);
+  streaming = false;
+  streaming_done.wait();
+  return result;
+}
+
+static void runBenchmark(const bool& fast_start,
+                         const unsigned int& ignored_start_requests,
+                         const std::size_t& repetitions,
+                         std::ostream& results)
+{
+  std::vector<double> construction_us, start_us, first_scan_us, coverage;
+  for (std::size_t repetition = 0; repetition < repetitions; ++repetition)
+  {
+    const ColdStart cold_start{ measureColdStart(fast_start, ignored_start_requests, repetition % FRAMES_PER_ROUND) };
+    construction_us.push_back(toUs(cold_start.construction));
+    start_us.push_back(toUs(cold_start.start));
+    first_scan_us.push_back(toUs(cold_start.first_scan));
+    coverage.push_back(cold_start.coverage);
+  }
+  results << "{\"benchmark\": \"cold_start\", \"fast_start\": " << (fast_start ? "true" : "false")
+          << ", \"ignored_start_requests\": " << ignored_start_requests << ", \"repetitions\": " << repetitions
+          << ", \"construction_us\": " << median(construction_us) << ", \"start_us\": " << median(start_us)
+          << ", \"first_scan_us\": " << median(first_scan_us)
+          << ", \"first_scan_max_us\": " << *std::max_element(first_scan_us.begin(), first_scan_us.end())
+          << ", \"first_scan_coverage\": " << median(coverage) << "}" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_ERROR);
+  const std::size_t repetitions{ argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : DEFAULT_REPETITIONS };
+  std::vector<unsigned int> ignored_start_requests;
+  for (int i = 2; i < argc; ++i)
+  {
+    ignored_start_requests.push_back(static_cast<unsigned int>(std::atoi(argv[i])));
+  }
+  if (ignored_start_requests.empty())
+  {
+    ignored_start_requests = DEFAULT_IGNORED_START_REQUESTS;
+  }
+  if (repetitions == 0)
+  {
+    std::cerr << "Usage: benchmark_cold_start [repetitions] [ignored_start_requests...]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The ScannerMock reports the replies on std::cout, therefore, the results use their own stream.
+  std::ostream results(std::cout.rdbuf());
+  std::cout.setstate(std::ios_base::failbit);
+  for (const auto& ignored : ignored_start_requests)
+  {
+    for (const bool fast_start : { false, true })
+    {
+      runBenchmark(fast_start, ignored, repetitions, results);
+    }
+  }
+  return 0;
+}
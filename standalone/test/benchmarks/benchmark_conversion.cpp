@@ -0,0 +1,134 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Micro-benchmark of the data conversion layer.
+ *
+ * The stages are measured with the frames of a full scan round (275 deg with 0.1 deg resolution in 6 frames,
+ * including intensities and diagnostics):
+ * - deserialize: monitoring_frame::deserialize() of one frame,
+ * - to_laser_scan: LaserScanConverter::toLaserScan() of the 6 frames of one scan round.
+ *
+ * Each stage is repeated several times and the median of the repetitions is reported, so that single disturbances
+ * of the machine do not show up in the result. For each stage one line of JSON is printed on stdout.
+ *
+ * Usage: benchmark_conversion [iterations_per_repetition]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "psen_scan_v2_standalone/util/integrationtest_helper.h"
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/laserscan_conversions.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace psen_scan_v2_standalone_test;
+
+static constexpr std::size_t DEFAULT_ITERATIONS{ 2000 };
+static constexpr std::size_t REPETITIONS{ 7 };
+static constexpr std::size_t FRAMES_PER_ROUND{ 6 };
+static constexpr int MAX_SCAN_ANGLE{ 2750 };
+
+//! Keeps the compiler from optimizing the benchmarked calls away.
+static volatile std::size_t sink{ 0 };
+
+static std::vector<data_conversion_layer::monitoring_frame::Message> createScanRound()
+{
+  std::vector<data_conversion_layer::monitoring_frame::Message> frames;
+  for (std::size_t i = 0; i < FRAMES_PER_ROUND; ++i)
+  {
+    const int start{ MAX_SCAN_ANGLE * static_cast<int>(i) / static_cast<int>(FRAMES_PER_ROUND) };
+    const int end{ MAX_SCAN_ANGLE * static_cast<int>(i + 1) / static_cast<int>(FRAMES_PER_ROUND) };
+    const auto num_measurements{ static_cast<unsigned int>(end - start) };
+    frames.emplace_back(util::TenthOfDegree(static_cast<int16_t>(start)),
+                        util::TenthOfDegree(1),
+                        42,
+                        generateMeasurements(num_measurements, 0., 10.),
+                        generateIntensities(num_measurements, 0., 17000.),
+                        std::vector<data_conversion_layer::monitoring_frame::diagnostic::Message>{
+                            { configuration::ScannerId::master,
+                              data_conversion_layer::monitoring_frame::diagnostic::ErrorLocation(1, 7) } });
+  }
+  return frames;
+}
+
+//! @returns the median time of one iteration over all repetitions in microseconds.
+static double measure(const std::size_t& iterations, const std::function<void()>& iteration)
+{
+  std::vector<double> times_us;
+  for (std::size_t repetition = 0; repetition < REPETITIONS; ++repetition)
+  {
+    const auto start{ std::chrono::steady_clock::now() };
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+      iteration();
+    }
+    const std::chrono::duration<double, std::micro> duration{ std::chrono::steady_clock::now() - start };
+    times_us.push_back(duration.count() / static_cast<double>(iterations));
+  }
+  std::nth_element(times_us.begin(), times_us.begin() + REPETITIONS / 2, times_us.end());
+  return times_us[REPETITIONS / 2];
+}
+
+static void printResult(const std::string& stage, const std::size_t& iterations, const double& time_per_iteration_us)
+{
+  std::cout << "{\"benchmark\": \"conversion\", \"stage\": \"" << stage << "\", \"iterations\": " << iterations
+            << ", \"repetitions\": " << REPETITIONS << ", \"time_per_iteration_us\": " << time_per_iteration_us
+            << ", \"iterations_per_s\": " << 1e6 / time_per_iteration_us << "}" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_WARN);
+  const std::size_t iterations{ argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : DEFAULT_ITERATIONS };
+  if (iterations == 0)
+  {
+    std::cerr << "The number of iterations must be positive." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const auto frames{ createScanRound() };
+  std::vector<data_conversion_layer::RawData> serialized_frames;
+  for (const auto& frame : frames)
+  {
+    serialized_frames.push_back(data_conversion_layer::monitoring_frame::serialize(frame));
+  }
+
+  std::size_t next_frame{ 0 };
+  printResult("deserialize", iterations, measure(iterations, [&]() {
+                const auto& data{ serialized_frames[next_frame++ % serialized_frames.size()] };
+                const auto frame{ data_conversion_layer::monitoring_frame::deserialize(data, data.size()) };
+                sink = sink + frame.measurements().size();
+              }));
+
+  printResult("to_laser_scan", iterations, measure(iterations, [&]() {
+                sink = sink + data_conversion_layer::LaserScanConverter::toLaserScan(frames).getMeasurements().size();
+              }));
+  return 0;
+}
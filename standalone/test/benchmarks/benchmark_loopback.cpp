@@ -0,0 +1,265 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * End-to-end benchmark of a ScannerV2 receiving monitoring frames from a ScannerMock via loopback.
+ *
+ * For each rate multiplier the mock streams pre-serialized monitoring frames of a full scan range (275 deg with
+ * 0.1 deg resolution in 6 frames per scan round) with the given multiple of the rate of a real scanner (33 Hz) for
+ * the given duration. Fragmented scans are enabled, so that every frame results in one call of the laser scan
+ * callback.
+ * If the driver is compiled with ENABLE_IO_URING, every rate is measured a second time with the data client
+ * receiving via io_uring (benchmark "loopback_io_uring").
+ *
+ * For each rate and receive backend one line of JSON is printed on stdout containing:
+ * - the offered and the sustained throughput in frames per second,
+ * - the frames which did not reach the laser scan callback and the datagrams dropped by the kernel (drops column of
+ *   /proc/net/udp for the data socket of the driver),
+ * - the latency from the sending of a frame by the mock till the entry into the laser scan callback.
+ *
+ * Usage: benchmark_loopback [duration_s] [rate_multiplier...]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "psen_scan_v2_standalone/util/integrationtest_helper.h"
+#include "psen_scan_v2_standalone/communication_layer/scanner_mock.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scanner_config_builder.h"
+#include "psen_scan_v2_standalone/scanner_v2.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/stop_request_serialization.h"
+#include "psen_scan_v2_standalone/util/latency_histogram.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace psen_scan_v2_standalone_test;
+using namespace ::testing;
+
+static const std::string HOST_IP_ADDRESS{ "127.0.0.1" };
+static const std::vector<unsigned int> DEFAULT_RATE_MULTIPLIERS{ 1, 5, 10, 20, 50 };
+static constexpr double DEFAULT_DURATION_S{ 2. };
+static constexpr std::size_t FRAMES_PER_ROUND{ 6 };
+static constexpr double SCAN_RATE_HZ{ 33. };
+static constexpr std::chrono::seconds TIMEOUT{ 2 };
+
+static const ScanRange SCAN_RANGE{ util::TenthOfDegree(0), util::TenthOfDegree(2750) };
+static const util::TenthOfDegree SCAN_RESOLUTION{ 1 };
+
+static ScannerConfiguration generateScannerConfig(const PortHolder& port_holder, const bool& io_uring)
+{
+  return ScannerConfigurationBuilder()
+      .hostIP(HOST_IP_ADDRESS)
+      .hostDataPort(port_holder.data_port_host)
+      .hostControlPort(port_holder.control_port_host)
+      .scannerIp(HOST_IP_ADDRESS)
+      .scannerDataPort(port_holder.data_port_scanner)
+      .scannerControlPort(port_holder.control_port_scanner)
+      .scanRange(SCAN_RANGE)
+      .scanResolution(SCAN_RESOLUTION)
+      .enableFragmentedScans(true)
+      .enableIoUring(io_uring)
+      .build();
+}
+
+static util::TenthOfDegree startOfFragment(const std::size_t& fragment)
+{
+  return util::TenthOfDegree(static_cast<int16_t>(SCAN_RANGE.getEnd().value() * static_cast<int>(fragment) /
+                                                  static_cast<int>(FRAMES_PER_ROUND)));
+}
+
+//! @returns the serialized frames of the specified scan round, which differ only in the scan counter.
+static std::vector<data_conversion_layer::RawData> serializeScanRound(const uint32_t& scan_counter)
+{
+  std::vector<data_conversion_layer::RawData> frames;
+  for (std::size_t fragment = 0; fragment < FRAMES_PER_ROUND; ++fragment)
+  {
+    const auto start{ startOfFragment(fragment) };
+    const auto num_measurements{ static_cast<unsigned int>((startOfFragment(fragment + 1) - start).value()) };
+    frames.push_back(data_conversion_layer::monitoring_frame::serialize(data_conversion_layer::monitoring_frame::Message(
+        start, SCAN_RESOLUTION, scan_counter, generateMeasurements(num_measurements, 0., 10.))));
+  }
+  return frames;
+}
+
+//! @returns the number of datagrams dropped by the kernel for the UDP socket bound to the specified local port.
+static uint64_t kernelDropsOfPort(const int& port)
+{
+  std::ifstream udp_table("/proc/net/udp");
+  std::string line;
+  std::getline(udp_table, line);  // header
+  while (std::getline(udp_table, line))
+  {
+    std::istringstream fields(line);
+    std::string slot, local_address;
+    fields >> slot >> local_address;
+    const auto port_pos{ local_address.find(':') };
+    if (port_pos == std::string::npos || std::stoi(local_address.substr(port_pos + 1), nullptr, 16) != port)
+    {
+      continue;
+    }
+    std::string field;
+    std::string last_field;
+    while (fields >> field)
+    {
+      last_field = field;
+    }
+    return std::stoull(last_field);
+  }
+  return 0;
+}
+
+static double toUs(const std::chrono::nanoseconds& duration)
+{
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+static void runBenchmark(const unsigned int& rate_multiplier,
+                         const double& duration_s,
+                         const bool& io_uring,
+                         std::ostream& results)
+{
+  const PortHolder port_holder{ ++GLOBAL_PORT_HOLDER };
+  NiceMock<ScannerMock> mock(HOST_IP_ADDRESS, port_holder);
+  ON_CALL(mock, receiveControlMsg(_, _)).WillByDefault(InvokeWithoutArgs([&mock]() { mock.sendStartReply(); }));
+  ON_CALL(mock, receiveControlMsg(_, data_conversion_layer::stop_request::serialize()))
+      .WillByDefault(InvokeWithoutArgs([&mock]() { mock.sendStopReply(); }));
+
+  const double frame_rate{ SCAN_RATE_HZ * FRAMES_PER_ROUND * rate_multiplier };
+  const auto num_rounds{ static_cast<std::size_t>(duration_s * SCAN_RATE_HZ * rate_multiplier) };
+  const std::size_t num_frames{ num_rounds * FRAMES_PER_ROUND };
+  const std::chrono::nanoseconds frame_period{ static_cast<int64_t>(1e9 / frame_rate) };
+
+  std::vector<data_conversion_layer::RawData> frames;
+  for (std::size_t round = 0; round < num_rounds; ++round)
+  {
+    const auto round_frames{ serializeScanRound(static_cast<uint32_t>(round + 1)) };
+    frames.insert(frames.end(), round_frames.begin(), round_frames.end());
+  }
+  std::map<int16_t, std::size_t> fragment_of_start_angle;
+  for (std::size_t fragment = 0; fragment < FRAMES_PER_ROUND; ++fragment)
+  {
+    fragment_of_start_angle[startOfFragment(fragment).value()] = fragment;
+  }
+
+  // The send times are written before the sending and read by the callback, which runs after the receiving.
+  std::unique_ptr<std::atomic<int64_t>[]> send_times(new std::atomic<int64_t>[num_frames]);
+  util::LatencyHistogram latencies;
+  std::atomic<std::size_t> num_received_frames{ 0 };
+  std::atomic<int64_t> last_receive_time{ 0 };
+  const auto laser_scan_cb = [&](const LaserScan& scan) {
+    const int64_t now{ util::LatencyClock::now().time_since_epoch().count() };
+    const auto fragment{ fragment_of_start_angle.find(scan.getMinScanAngle().value()) };
+    const std::size_t index{ (scan.getScanCounter() - 1) * FRAMES_PER_ROUND +
+                             (fragment != fragment_of_start_angle.end() ? fragment->second : 0) };
+    if (index < num_frames)
+    {
+      latencies.record(std::chrono::nanoseconds(now - send_times[index].load(std::memory_order_acquire)));
+    }
+    last_receive_time.store(now, std::memory_order_relaxed);
+    ++num_received_frames;
+  };
+
+  ScannerV2 scanner(generateScannerConfig(port_holder, io_uring), laser_scan_cb);
+  mock.startListeningForControlMsg();
+  if (scanner.start().wait_for(TIMEOUT) != std::future_status::ready)
+  {
+    std::cerr << "Scanner did not start" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  const uint64_t kernel_drops_start{ kernelDropsOfPort(port_holder.data_port_host) };
+
+  const auto start{ util::LatencyClock::now() };
+  auto next_send_time{ start };
+  for (std::size_t i = 0; i < num_frames; ++i)
+  {
+    std::this_thread::sleep_until(next_send_time);
+    send_times[i].store(util::LatencyClock::now().time_since_epoch().count(), std::memory_order_release);
+    mock.sendSerializedMonitoringFrame(frames[i]);
+    next_send_time += frame_period;
+  }
+  const auto send_end{ util::LatencyClock::now() };
+
+  const auto receive_deadline{ send_end + TIMEOUT };
+  while (num_received_frames < num_frames && util::LatencyClock::now() < receive_deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const uint64_t kernel_drops{ kernelDropsOfPort(port_holder.data_port_host) - kernel_drops_start };
+
+  mock.startListeningForControlMsg();
+  scanner.stop().wait_for(TIMEOUT);
+
+  const std::size_t num_received{ num_received_frames };
+  const double send_duration_s{ std::chrono::duration<double>(send_end - start).count() };
+  const double receive_duration_s{
+    std::chrono::duration<double>(util::LatencyClock::time_point(util::LatencyClock::duration(last_receive_time)) -
+                                  start)
+        .count()
+  };
+  const util::LatencySnapshot latency{ latencies.snapshot() };
+  results << "{\"benchmark\": \"" << (io_uring ? "loopback_io_uring" : "loopback")
+          << "\", \"rate_multiplier\": " << rate_multiplier
+          << ", \"target_frames_per_s\": " << frame_rate << ", \"sent_frames\": " << num_frames
+          << ", \"received_frames\": " << num_received
+          << ", \"lost_frames\": " << num_frames - std::min(num_frames, num_received)
+          << ", \"kernel_drops\": " << kernel_drops
+          << ", \"offered_frames_per_s\": " << static_cast<double>(num_frames) / send_duration_s
+          << ", \"sustained_frames_per_s\": "
+          << (receive_duration_s > 0. ? static_cast<double>(num_received) / receive_duration_s : 0.)
+          << ", \"latency_p50_us\": " << toUs(latency.p50) << ", \"latency_p99_us\": " << toUs(latency.p99)
+          << ", \"latency_p999_us\": " << toUs(latency.p999) << ", \"latency_max_us\": " << toUs(latency.max) << "}"
+          << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_ERROR);
+  const double duration_s{ argc > 1 ? std::atof(argv[1]) : DEFAULT_DURATION_S };
+  std::vector<unsigned int> rate_multipliers;
+  for (int i = 2; i < argc; ++i)
+  {
+    rate_multipliers.push_back(static_cast<unsigned int>(std::atoi(argv[i])));
+  }
+  if (rate_multipliers.empty())
+  {
+    rate_multipliers = DEFAULT_RATE_MULTIPLIERS;
+  }
+
+  // The ScannerMock reports the replies on std::cout, therefore, the results use their own stream.
+  std::ostream results(std::cout.rdbuf());
+  std::cout.setstate(std::ios_base::failbit);
+  for (const auto& rate_multiplier : rate_multipliers)
+  {
+    runBenchmark(rate_multiplier, duration_s, false, results);
+#ifdef PSENSCAN_ENABLE_IO_URING
+    runBenchmark(rate_multiplier, duration_s, true, results);
+#endif
+  }
+  return 0;
+}
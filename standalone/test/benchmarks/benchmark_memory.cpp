@@ -0,0 +1,311 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Heap and RSS profile of a ScannerV2 receiving full scans (275 deg with 0.1 deg resolution in 6 frames per scan
+ * round) from a ScannerMock via loopback with the rate of a real scanner.
+ *
+ * The global operator new is replaced by a counting one, which attributes each allocation to the util::AllocationTag
+ * of the allocating thread (udp, decode, buffer, conversion, callback or other). Only the allocations after a warm-up
+ * of one second are counted, so that the result shows the steady state of a running session.
+ *
+ * One line of JSON is printed on stdout containing:
+ * - the allocations per frame and the bytes allocated per scan, in total and per subsystem,
+ * - the net allocations (allocations minus deallocations), which grow if memory is leaked,
+ * - the resident set size before and after the measurement and its peak.
+ *
+ * The allocations of other threads (e.g. watchdogs, the mock and this harness) are reported as "other" and are not
+ * included in the totals.
+ *
+ * Usage: benchmark_memory [duration_s]
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "psen_scan_v2_standalone/util/integrationtest_helper.h"
+#include "psen_scan_v2_standalone/communication_layer/scanner_mock.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scanner_config_builder.h"
+#include "psen_scan_v2_standalone/scanner_v2.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/stop_request_serialization.h"
+#include "psen_scan_v2_standalone/util/allocation_tags.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace psen_scan_v2_standalone_test;
+using namespace ::testing;
+
+namespace
+{
+std::atomic_bool counting{ false };
+std::array<std::atomic<uint64_t>, util::NUMBER_OF_ALLOCATION_TAGS> allocations{};
+std::array<std::atomic<uint64_t>, util::NUMBER_OF_ALLOCATION_TAGS> allocated_bytes{};
+std::atomic<uint64_t> deallocations{ 0 };
+
+void* countedAllocation(const std::size_t& size)
+{
+  if (counting.load(std::memory_order_relaxed))
+  {
+    const auto tag{ static_cast<std::size_t>(util::currentAllocationTag()) };
+    allocations[tag].fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes[tag].fetch_add(size, std::memory_order_relaxed);
+  }
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void countedDeallocation(void* ptr) noexcept
+{
+  if (ptr && counting.load(std::memory_order_relaxed))
+  {
+    deallocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  std::free(ptr);
+}
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+  void* ptr{ countedAllocation(size) };
+  if (!ptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return countedAllocation(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return countedAllocation(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  countedDeallocation(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  countedDeallocation(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  countedDeallocation(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+  countedDeallocation(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  countedDeallocation(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  countedDeallocation(ptr);
+}
+
+static const std::string HOST_IP_ADDRESS{ "127.0.0.1" };
+static constexpr double DEFAULT_DURATION_S{ 5. };
+static constexpr double WARM_UP_S{ 1. };
+static constexpr std::size_t FRAMES_PER_ROUND{ 6 };
+static constexpr double SCAN_RATE_HZ{ 33. };
+static constexpr std::chrono::seconds TIMEOUT{ 2 };
+
+static const ScanRange SCAN_RANGE{ util::TenthOfDegree(0), util::TenthOfDegree(2750) };
+static const util::TenthOfDegree SCAN_RESOLUTION{ 1 };
+
+static ScannerConfiguration generateScannerConfig(const PortHolder& port_holder)
+{
+  return ScannerConfigurationBuilder()
+      .hostIP(HOST_IP_ADDRESS)
+      .hostDataPort(port_holder.data_port_host)
+      .hostControlPort(port_holder.control_port_host)
+      .scannerIp(HOST_IP_ADDRESS)
+      .scannerDataPort(port_holder.data_port_scanner)
+      .scannerControlPort(port_holder.control_port_scanner)
+      .scanRange(SCAN_RANGE)
+      .scanResolution(SCAN_RESOLUTION)
+      .build();
+}
+
+//! @returns the serialized frames of the specified scan round.
+static std::vector<data_conversion_layer::RawData> serializeScanRound(const uint32_t& scan_counter)
+{
+  std::vector<data_conversion_layer::RawData> frames;
+  for (std::size_t fragment = 0; fragment < FRAMES_PER_ROUND; ++fragment)
+  {
+    const int start{ SCAN_RANGE.getEnd().value() * static_cast<int>(fragment) / static_cast<int>(FRAMES_PER_ROUND) };
+    const int end{ SCAN_RANGE.getEnd().value() * static_cast<int>(fragment + 1) / static_cast<int>(FRAMES_PER_ROUND) };
+    frames.push_back(data_conversion_layer::monitoring_frame::serialize(
+        data_conversion_layer::monitoring_frame::Message(util::TenthOfDegree(static_cast<int16_t>(start)),
+                                                         SCAN_RESOLUTION,
+                                                         scan_counter,
+                                                         generateMeasurements(
+                                                             static_cast<unsigned int>(end - start), 0., 10.))));
+  }
+  return frames;
+}
+
+//! @returns the value of the specified field of /proc/self/status in kB, e.g. VmRSS or VmHWM.
+static uint64_t processStatusKb(const std::string& field)
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (line.compare(0, field.size() + 1, field + ":") == 0)
+    {
+      std::istringstream value(line.substr(field.size() + 1));
+      uint64_t kb{ 0 };
+      value >> kb;
+      return kb;
+    }
+  }
+  return 0;
+}
+
+static double perUnit(const uint64_t& value, const uint64_t& units)
+{
+  return units > 0 ? static_cast<double>(value) / static_cast<double>(units) : 0.;
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_ERROR);
+  const double duration_s{ argc > 1 ? std::atof(argv[1]) : DEFAULT_DURATION_S };
+  if (duration_s <= 0.)
+  {
+    std::cerr << "The duration must be positive." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The ScannerMock reports the replies on std::cout, therefore, the results use their own stream.
+  std::ostream results(std::cout.rdbuf());
+  std::cout.setstate(std::ios_base::failbit);
+
+  const PortHolder port_holder{ ++GLOBAL_PORT_HOLDER };
+  NiceMock<ScannerMock> mock(HOST_IP_ADDRESS, port_holder);
+  ON_CALL(mock, receiveControlMsg(_, _)).WillByDefault(InvokeWithoutArgs([&mock]() { mock.sendStartReply(); }));
+  ON_CALL(mock, receiveControlMsg(_, data_conversion_layer::stop_request::serialize()))
+      .WillByDefault(InvokeWithoutArgs([&mock]() { mock.sendStopReply(); }));
+
+  const auto num_warm_up_rounds{ static_cast<std::size_t>(WARM_UP_S * SCAN_RATE_HZ) };
+  const auto num_rounds{ num_warm_up_rounds + static_cast<std::size_t>(duration_s * SCAN_RATE_HZ) };
+  const std::chrono::nanoseconds frame_period{ static_cast<int64_t>(1e9 / (SCAN_RATE_HZ * FRAMES_PER_ROUND)) };
+  std::vector<std::vector<data_conversion_layer::RawData>> rounds;
+  for (std::size_t round = 0; round < num_rounds; ++round)
+  {
+    rounds.push_back(serializeScanRound(static_cast<uint32_t>(round + 1)));
+  }
+
+  std::atomic<uint64_t> num_received_scans{ 0 };
+  ScannerV2 scanner(generateScannerConfig(port_holder), [&num_received_scans](const LaserScan&) {
+    num_received_scans.fetch_add(1, std::memory_order_relaxed);
+  });
+  mock.startListeningForControlMsg();
+  if (scanner.start().wait_for(TIMEOUT) != std::future_status::ready)
+  {
+    std::cerr << "Scanner did not start" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  uint64_t frames_start{ 0 };
+  uint64_t scans_start{ 0 };
+  uint64_t rss_start_kb{ 0 };
+  auto next_send_time{ std::chrono::steady_clock::now() };
+  for (std::size_t round = 0; round < num_rounds; ++round)
+  {
+    if (round == num_warm_up_rounds)
+    {
+      frames_start = scanner.getStatistics().protocol.frames_received;
+      scans_start = num_received_scans;
+      rss_start_kb = processStatusKb("VmRSS");
+      counting = true;
+    }
+    for (const auto& frame : rounds[round])
+    {
+      std::this_thread::sleep_until(next_send_time);
+      mock.sendSerializedMonitoringFrame(frame);
+      next_send_time += frame_period;
+    }
+  }
+  // Let the last frames arrive.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  counting = false;
+
+  const uint64_t num_frames{ scanner.getStatistics().protocol.frames_received - frames_start };
+  const uint64_t num_scans{ num_received_scans - scans_start };
+  const uint64_t rss_end_kb{ processStatusKb("VmRSS") };
+
+  mock.startListeningForControlMsg();
+  scanner.stop().wait_for(TIMEOUT);
+
+  uint64_t total_allocations{ 0 };
+  uint64_t total_bytes{ 0 };
+  uint64_t all_allocations{ 0 };
+  std::ostringstream subsystems;
+  for (std::size_t i = 0; i < util::NUMBER_OF_ALLOCATION_TAGS; ++i)
+  {
+    const auto tag{ static_cast<util::AllocationTag>(i) };
+    const std::string name{ util::allocationTagName(tag) };
+    all_allocations += allocations[i];
+    if (tag != util::AllocationTag::other)
+    {
+      total_allocations += allocations[i];
+      total_bytes += allocated_bytes[i];
+    }
+    subsystems << ", \"" << name << "_allocations_per_frame\": " << perUnit(allocations[i], num_frames) << ", \""
+               << name << "_bytes_per_scan\": " << perUnit(allocated_bytes[i], num_scans);
+  }
+
+  results << "{\"benchmark\": \"memory\", \"duration_s\": " << duration_s << ", \"frames\": " << num_frames
+          << ", \"scans\": " << num_scans << ", \"allocations_per_frame\": " << perUnit(total_allocations, num_frames)
+          << ", \"bytes_per_frame\": " << perUnit(total_bytes, num_frames)
+          << ", \"allocations_per_scan\": " << perUnit(total_allocations, num_scans)
+          << ", \"bytes_per_scan\": " << perUnit(total_bytes, num_scans)
+          << ", \"net_allocations\": " << static_cast<int64_t>(all_allocations - deallocations) << subsystems.str()
+          << ", \"rss_start_kb\": " << rss_start_kb << ", \"rss_end_kb\": " << rss_end_kb
+          << ", \"rss_growth_kb\": " << static_cast<int64_t>(rss_end_kb - rss_start_kb)
+          << ", \"peak_rss_kb\": " << processStatusKb("VmHWM") << "}" << std::endl;
+  return 0;
+}
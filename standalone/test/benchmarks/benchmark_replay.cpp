@@ -0,0 +1,138 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Throughput benchmark of the protocol implementation, fed by a ReplayScanner instead of a socket.
+ *
+ * The datagrams are played back as fast as possible, so the result is the cpu time of the complete processing of
+ * a monitoring frame (deserialization, scan buffer, conversion to a LaserScan) without any network stack. Without a
+ * recording, scan rounds of a full scan range (275 deg with 0.1 deg resolution in 6 frames per scan round) are
+ * synthesized. A recording (pcap file or raw datagram log) of a scanner configured with
+ * the full scan range can be given instead.
+ *
+ * The replay is repeated several times and one line of JSON with the medians is printed on stdout.
+ *
+ * Usage: benchmark_replay [rounds] [recording]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "psen_scan_v2_standalone/util/integrationtest_helper.h"
+
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/communication_layer/replay_source.h"
+#include "psen_scan_v2_standalone/configuration/default_parameters.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/replay_scanner.h"
+#include "psen_scan_v2_standalone/scanner_config_builder.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace psen_scan_v2_standalone_test;
+
+static constexpr std::size_t DEFAULT_ROUNDS{ 2000 };
+static constexpr std::size_t REPETITIONS{ 5 };
+static constexpr std::size_t FRAMES_PER_ROUND{ 6 };
+static constexpr int MAX_SCAN_ANGLE{ 2750 };
+//! Frame period of a scanner with 33 Hz, used as timestamps of the synthesized datagrams.
+static constexpr std::chrono::microseconds FRAME_PERIOD{ 5050 };
+
+static const util::TenthOfDegree SCAN_RESOLUTION{ 1 };
+
+static std::vector<communication_layer::RecordedDatagram> synthesizeRecording(const std::size_t& rounds)
+{
+  std::vector<communication_layer::RecordedDatagram> datagrams;
+  datagrams.reserve(rounds * FRAMES_PER_ROUND);
+  for (std::size_t round = 0; round < rounds; ++round)
+  {
+    for (std::size_t frame = 0; frame < FRAMES_PER_ROUND; ++frame)
+    {
+      const int start{ MAX_SCAN_ANGLE * static_cast<int>(frame) / static_cast<int>(FRAMES_PER_ROUND) };
+      const int end{ MAX_SCAN_ANGLE * static_cast<int>(frame + 1) / static_cast<int>(FRAMES_PER_ROUND) };
+      const auto num_measurements{ static_cast<unsigned int>(end - start) };
+      const data_conversion_layer::monitoring_frame::Message msg(util::TenthOfDegree(static_cast<int16_t>(start)),
+                                                                 SCAN_RESOLUTION,
+                                                                 static_cast<uint32_t>(round + 1),
+                                                                 generateMeasurements(num_measurements, 0., 10.));
+      datagrams.push_back(communication_layer::RecordedDatagram{
+          FRAME_PERIOD * datagrams.size(), data_conversion_layer::monitoring_frame::serialize(msg) });
+    }
+  }
+  return datagrams;
+}
+
+static double median(std::vector<double> values)
+{
+  std::sort(values.begin(), values.end());
+  return values.empty() ? 0. : values[values.size() / 2];
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_ERROR);
+  const std::size_t rounds{ argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : DEFAULT_ROUNDS };
+  if (rounds == 0)
+  {
+    std::cerr << "Usage: benchmark_replay [rounds] [recording]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string source{ argc > 2 ? argv[2] : "synthetic" };
+  const std::vector<communication_layer::RecordedDatagram> recording{
+    argc > 2 ? communication_layer::readRecording(argv[2], configuration::DATA_PORT_OF_SCANNER_DEVICE) :
+               synthesizeRecording(rounds)
+  };
+
+  const ScannerConfiguration config{ ScannerConfigurationBuilder()
+                                         .scannerIp("192.168.0.10")
+                                         .scanRange(ScanRange{ util::TenthOfDegree(0),
+                                                               util::TenthOfDegree(MAX_SCAN_ANGLE) })
+                                         .scanResolution(SCAN_RESOLUTION)
+                                         .build() };
+
+  std::vector<double> frames_per_s, scans_per_s, us_per_frame;
+  std::size_t bytes{ 0 };
+  for (const auto& datagram : recording)
+  {
+    bytes += datagram.data.size();
+  }
+  for (std::size_t repetition = 0; repetition < REPETITIONS; ++repetition)
+  {
+    ReplayScanner scanner(
+        config, [](const LaserScan&) {}, recording, communication_layer::ReplaySource::AS_FAST_AS_POSSIBLE);
+    const auto start{ std::chrono::steady_clock::now() };
+    scanner.run();
+    const std::chrono::duration<double> duration{ std::chrono::steady_clock::now() - start };
+    const protocol_layer::ProtocolStatistics statistics{ scanner.getStatistics().protocol };
+    frames_per_s.push_back(statistics.frames_received / duration.count());
+    scans_per_s.push_back(statistics.scans_completed / duration.count());
+    us_per_frame.push_back(statistics.frames_received > 0 ? duration.count() * 1e6 / statistics.frames_received : 0.);
+  }
+
+  std::cout << "{\"benchmark\": \"replay\", \"source\": \"" << source << "\", \"datagrams\": " << recording.size()
+            << ", \"bytes\": " << bytes << ", \"repetitions\": " << REPETITIONS
+            << ", \"frames_per_s\": " << median(frames_per_s) << ", \"scans_per_s\": " << median(scans_per_s)
+            << ", \"us_per_frame\": " << median(us_per_frame) << "}" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Benchmark of the ScanEncoder and ScanDecoder.
+ *
+ * The scans are read from a scan recording (see ScanRecordingWriter) or, without recording, generated: full scans
+ * (275 degrees, 0.1 degree resolution, with intensities) of a static scene with a few millimeters of noise.
+ * For varints and bit packing, each with the scalar and the SSE2 implementation, one line of JSON is printed on
+ * stdout with the compression ratio (compared to uint16 measurements and intensities) and the throughput of encoding
+ * and decoding in GB/s of uint16 values.
+ *
+ * Usage: benchmark_scan_codec [scan_recording] [repetitions]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scan_codec.h"
+#include "psen_scan_v2_standalone/scan_recording.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+using namespace psen_scan_v2_standalone;
+
+static constexpr std::size_t NUM_GENERATED_SCANS{ 330 };
+static constexpr std::size_t NUM_MEASUREMENTS{ 2750 };
+static constexpr std::size_t DEFAULT_REPETITIONS{ 10 };
+
+static std::vector<LaserScan> generateScans()
+{
+  std::vector<LaserScan> scans;
+  for (uint32_t scan_counter = 1; scan_counter <= NUM_GENERATED_SCANS; ++scan_counter)
+  {
+    LaserScan scan(util::TenthOfDegree(1), util::TenthOfDegree(0), util::TenthOfDegree(NUM_MEASUREMENTS));
+    scan.setScanCounter(scan_counter);
+    LaserScan::MeasurementData measurements(NUM_MEASUREMENTS);
+    LaserScan::IntensityData intensities(NUM_MEASUREMENTS);
+    for (std::size_t i = 0; i < NUM_MEASUREMENTS; ++i)
+    {
+      const double noise{ static_cast<double>(std::rand() % 7) - 3. };
+      measurements[i] = std::round(2000. + 1000. * std::sin(0.01 * static_cast<double>(i)) + noise) / 1000.;
+      intensities[i] = static_cast<double>(1000 + i % 100 + std::rand() % 3);
+    }
+    scan.setMeasurements(measurements);
+    scan.setIntensities(intensities);
+    scans.push_back(scan);
+  }
+  return scans;
+}
+
+static std::vector<LaserScan> readScans(const std::string& filename)
+{
+#ifdef __linux__
+  ScanRecordingReader reader(filename);
+  std::vector<LaserScan> scans;
+  for (std::size_t i = 0; i < reader.size(); ++i)
+  {
+    scans.push_back(reader[i].toLaserScan());
+  }
+  return scans;
+#else
+  throw std::runtime_error("Scan recordings are only supported on Linux.");
+#endif
+}
+
+static void runBenchmark(const std::vector<LaserScan>& scans,
+                         const bool& bit_packing,
+                         const bool& simd,
+                         const std::size_t& repetitions)
+{
+  ScanCodecOptions options;
+  options.bit_packing = bit_packing;
+  options.simd = simd;
+
+  std::size_t raw_bytes{ 0 };
+  for (const auto& scan : scans)
+  {
+    raw_bytes += (scan.getMeasurements().size() + scan.getIntensities().size()) * sizeof(uint16_t);
+  }
+
+  std::vector<std::vector<char>> frames(scans.size());
+  double encode_s{ 0. };
+  double decode_s{ 0. };
+  uint64_t checksum{ 0 };
+  for (std::size_t repetition = 0; repetition < repetitions; ++repetition)
+  {
+    ScanEncoder encoder(options);
+    auto start{ std::chrono::steady_clock::now() };
+    for (std::size_t i = 0; i < scans.size(); ++i)
+    {
+      encoder.encode(scans[i], frames[i]);
+    }
+    encode_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ScanDecoder decoder(simd);
+    start = std::chrono::steady_clock::now();
+    for (const auto& frame : frames)
+    {
+      checksum += decoder.decode(frame).getScanCounter();
+    }
+    decode_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  std::size_t compressed_bytes{ 0 };
+  for (const auto& frame : frames)
+  {
+    compressed_bytes += frame.size();
+  }
+  const double total_bytes{ static_cast<double>(raw_bytes * repetitions) };
+  std::cout << "{\"benchmark\": \"scan_codec\", \"bit_packing\": " << (bit_packing ? "true" : "false")
+            << ", \"simd\": " << (simd ? "true" : "false") << ", \"scans\": " << scans.size()
+            << ", \"raw_bytes\": " << raw_bytes << ", \"compressed_bytes\": " << compressed_bytes
+            << ", \"compression_ratio\": " << static_cast<double>(raw_bytes) / static_cast<double>(compressed_bytes)
+            << ", \"encode_gb_per_s\": " << total_bytes / encode_s / 1e9
+            << ", \"decode_gb_per_s\": " << total_bytes / decode_s / 1e9 << ", \"checksum\": " << checksum << "}"
+            << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_WARN);
+  const std::vector<LaserScan> scans{ argc > 1 ? readScans(argv[1]) : generateScans() };
+  const std::size_t repetitions{ argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : DEFAULT_REPETITIONS };
+  if (scans.empty() || repetitions == 0)
+  {
+    std::cerr << "Usage: benchmark_scan_codec [scan_recording] [repetitions]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  for (const bool bit_packing : { false, true })
+  {
+    for (const bool simd : { false, true })
+    {
+      runBenchmark(scans, bit_packing, simd, repetitions);
+    }
+  }
+  return 0;
+}
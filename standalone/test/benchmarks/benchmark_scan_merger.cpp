@@ -0,0 +1,128 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Benchmark of the ScanMerger with 1 to 8 scanners, each providing full scans (275 degrees, 0.1 degree resolution).
+ *
+ * The scans are added in a single thread, so the result shows which rate of composite scans one core can sustain.
+ * For each number of scanners one line of JSON is printed on stdout.
+ *
+ * Usage: benchmark_scan_merger [num_composite_scans]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <boost/math/constants/constants.hpp>
+
+#include "psen_scan_v2_standalone/configuration/default_parameters.h"
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scan_merger.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+using namespace psen_scan_v2_standalone;
+
+static const std::vector<std::size_t> NUMBERS_OF_SCANNERS{ 1, 2, 4, 8 };
+static constexpr std::size_t DEFAULT_NUM_COMPOSITE_SCANS{ 330 };
+static constexpr double TARGET_RATE_HZ{ 33. };
+static constexpr double ROBOT_RADIUS{ 0.5 };
+static const util::TenthOfDegree RESOLUTION{ 1 };
+static const util::TenthOfDegree MIN_ANGLE{ 0 };
+static const util::TenthOfDegree MAX_ANGLE{ 2750 };
+
+static LaserScan createScan(const std::size_t& scanner_index, const uint32_t& scan_counter)
+{
+  LaserScan scan(RESOLUTION, MIN_ANGLE, MAX_ANGLE);
+  const std::size_t num_measurements{ static_cast<std::size_t>((MAX_ANGLE.value() - MIN_ANGLE.value()) /
+                                                               RESOLUTION.value()) };
+  std::vector<double> measurements(num_measurements);
+  std::vector<double> intensities(num_measurements);
+  for (std::size_t i = 0; i < num_measurements; ++i)
+  {
+    measurements[i] = 2. + std::sin(0.01 * static_cast<double>(i + scanner_index * 100));
+    intensities[i] = static_cast<double>(i % 100);
+  }
+  scan.setMeasurements(measurements);
+  scan.setIntensities(intensities);
+  scan.setScanCounter(scan_counter);
+  return scan;
+}
+
+//! @returns the inputs of scanners which are mounted on a circle around the origin and look outwards.
+static std::vector<ScanMergerInput> createInputs(const std::size_t& num_scanners)
+{
+  std::vector<ScanMergerInput> inputs(num_scanners);
+  for (std::size_t i = 0; i < num_scanners; ++i)
+  {
+    const double yaw{ 2. * boost::math::double_constants::pi * static_cast<double>(i) /
+                      static_cast<double>(num_scanners) };
+    inputs[i].mounting_pose = MountingPose{ ROBOT_RADIUS * std::cos(yaw), ROBOT_RADIUS * std::sin(yaw), yaw };
+  }
+  return inputs;
+}
+
+static void runBenchmark(const std::size_t& num_scanners, const std::size_t& num_composite_scans)
+{
+  std::vector<std::vector<LaserScan>> scans(num_composite_scans);
+  for (std::size_t round = 0; round < num_composite_scans; ++round)
+  {
+    for (std::size_t i = 0; i < num_scanners; ++i)
+    {
+      scans[round].push_back(createScan(i, static_cast<uint32_t>(round + 1)));
+    }
+  }
+
+  std::size_t num_points{ 0 };
+  std::size_t num_received_composite_scans{ 0 };
+  ScanMerger merger(createInputs(num_scanners), std::chrono::milliseconds(15), [&](const CompositeScan& composite_scan) {
+    num_points += composite_scan.size();
+    ++num_received_composite_scans;
+  });
+
+  const auto start{ std::chrono::steady_clock::now() };
+  for (std::size_t round = 0; round < num_composite_scans; ++round)
+  {
+    for (std::size_t i = 0; i < num_scanners; ++i)
+    {
+      merger.addScan(i, scans[round][i]);
+    }
+  }
+  const double duration_s{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+  const double time_per_composite_scan_us{ duration_s * 1e6 / static_cast<double>(num_composite_scans) };
+  const double max_rate_hz{ 1e6 / time_per_composite_scan_us };
+
+  std::cout << "{\"benchmark\": \"scan_merger\", \"num_scanners\": " << num_scanners
+            << ", \"composite_scans\": " << num_received_composite_scans
+            << ", \"dropped_scans\": " << merger.numberOfDroppedScans()
+            << ", \"points_per_composite_scan\": " << num_points / std::max<std::size_t>(1, num_received_composite_scans)
+            << ", \"time_per_composite_scan_us\": " << time_per_composite_scan_us << ", \"max_rate_hz\": " << max_rate_hz
+            << ", \"sustains_33hz\": " << (max_rate_hz >= TARGET_RATE_HZ ? "true" : "false") << "}" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_WARN);
+  const std::size_t num_composite_scans{ argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) :
+                                                    DEFAULT_NUM_COMPOSITE_SCANS };
+  for (const auto& num_scanners : NUMBERS_OF_SCANNERS)
+  {
+    runBenchmark(num_scanners, num_composite_scans);
+  }
+  return 0;
+}
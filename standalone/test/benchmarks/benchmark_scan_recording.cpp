@@ -0,0 +1,169 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Benchmark of the scan recording with full scans (275 degrees, 0.1 degree resolution, with intensities).
+ *
+ * Measures the rate at which the ScanRecordingWriter writes scans and the ScanRecordingReader reads them, once
+ * zero-copy via the ScanViews and once copied into LaserScans. As reference, the same scans are decoded from their
+ * monitoring frames (6 per scan) like a replay of recorded datagrams does it. One line of JSON is printed on stdout.
+ *
+ * Usage: benchmark_scan_recording [num_scans] [filename]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/laserscan_conversions.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scan_recording.h"
+#include "psen_scan_v2_standalone/util/logging.h"
+
+using namespace psen_scan_v2_standalone;
+
+static constexpr std::size_t DEFAULT_NUM_SCANS{ 3300 };
+static const std::string DEFAULT_FILENAME{ "/tmp/benchmark_scan_recording.scans" };
+static constexpr int16_t NUM_MEASUREMENTS{ 2750 };
+static constexpr int16_t FRAMES_PER_SCAN{ 6 };
+static const util::TenthOfDegree RESOLUTION{ 1 };
+
+static std::vector<double> createMeasurements(const int16_t& from, const int16_t& to)
+{
+  std::vector<double> measurements;
+  for (int16_t i = from; i < to; ++i)
+  {
+    measurements.push_back(std::round(2000. + 1000. * std::sin(0.01 * i)) / 1000.);
+  }
+  return measurements;
+}
+
+static std::vector<double> createIntensities(const int16_t& from, const int16_t& to)
+{
+  std::vector<double> intensities;
+  for (int16_t i = from; i < to; ++i)
+  {
+    intensities.push_back(static_cast<double>(i % 1000));
+  }
+  return intensities;
+}
+
+static std::vector<data_conversion_layer::RawData> serializeFrames(const uint32_t& scan_counter)
+{
+  std::vector<data_conversion_layer::RawData> frames;
+  for (int16_t frame = 0; frame < FRAMES_PER_SCAN; ++frame)
+  {
+    const int16_t from{ static_cast<int16_t>(NUM_MEASUREMENTS * frame / FRAMES_PER_SCAN) };
+    const int16_t to{ static_cast<int16_t>(NUM_MEASUREMENTS * (frame + 1) / FRAMES_PER_SCAN) };
+    frames.push_back(data_conversion_layer::monitoring_frame::serialize(
+        data_conversion_layer::monitoring_frame::Message(util::TenthOfDegree(from),
+                                                         RESOLUTION,
+                                                         scan_counter,
+                                                         createMeasurements(from, to),
+                                                         createIntensities(from, to),
+                                                         {})));
+  }
+  return frames;
+}
+
+static double secondsSince(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_WARN);
+  const std::size_t num_scans{ argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : DEFAULT_NUM_SCANS };
+  const std::string filename{ argc > 2 ? argv[2] : DEFAULT_FILENAME };
+
+  // All scans of a recording look alike, so one scan (as frames and as LaserScan) is reused.
+  const auto frames{ serializeFrames(1) };
+  std::vector<data_conversion_layer::monitoring_frame::Message> messages;
+  for (const auto& frame : frames)
+  {
+    messages.push_back(data_conversion_layer::monitoring_frame::deserialize(frame, frame.size()));
+  }
+  LaserScan scan{ data_conversion_layer::LaserScanConverter::toLaserScan(messages) };
+
+  auto start{ std::chrono::steady_clock::now() };
+  {
+    ScanRecordingWriter writer(filename);
+    for (std::size_t i = 0; i < num_scans; ++i)
+    {
+      scan.setScanCounter(static_cast<uint32_t>(i + 1));
+      writer.write(scan, std::chrono::milliseconds(30 * i));
+    }
+  }
+  const double write_s{ secondsSince(start) };
+
+  uint64_t checksum{ 0 };
+  std::size_t file_size{ 0 };
+  start = std::chrono::steady_clock::now();
+  {
+    ScanRecordingReader reader(filename);
+    for (std::size_t i = 0; i < reader.size(); ++i)
+    {
+      const auto view{ reader[i] };
+      for (std::size_t j = 0; j < view.size(); ++j)
+      {
+        checksum += view.ranges()[j];
+      }
+      file_size += 32 + 2 * (view.size() + view.numberOfIntensities());
+    }
+  }
+  const double read_view_s{ secondsSince(start) };
+
+  start = std::chrono::steady_clock::now();
+  {
+    ScanRecordingReader reader(filename);
+    for (std::size_t i = 0; i < reader.size(); ++i)
+    {
+      checksum += reader[i].toLaserScan().getScanCounter();
+    }
+  }
+  const double read_copy_s{ secondsSince(start) };
+
+  start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < num_scans; ++i)
+  {
+    messages.clear();
+    for (const auto& frame : frames)
+    {
+      messages.push_back(data_conversion_layer::monitoring_frame::deserialize(frame, frame.size()));
+    }
+    checksum += data_conversion_layer::LaserScanConverter::toLaserScan(messages).getScanCounter();
+  }
+  const double decode_s{ secondsSince(start) };
+  std::remove(filename.c_str());
+
+  const double n{ static_cast<double>(num_scans) };
+  std::cout << "{\"benchmark\": \"scan_recording\", \"scans\": " << num_scans << ", \"bytes\": " << file_size
+            << ", \"write_scans_per_s\": " << n / write_s << ", \"read_view_scans_per_s\": " << n / read_view_s
+            << ", \"read_view_gb_per_s\": " << static_cast<double>(file_size) / read_view_s / 1e9
+            << ", \"read_copy_scans_per_s\": " << n / read_copy_s
+            << ", \"decode_frames_scans_per_s\": " << n / decode_s
+            << ", \"speedup_view\": " << decode_s / read_view_s << ", \"speedup_copy\": " << decode_s / read_copy_s
+            << ", \"checksum\": " << checksum << "}" << std::endl;
+  return 0;
+}
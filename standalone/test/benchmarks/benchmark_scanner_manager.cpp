@@ -0,0 +1,194 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Benchmark of the ScannerManager with 1 to 32 simulated scanners (ScannerMock).
+ *
+ * Every simulated scanner sends monitoring frames with the rate of a real scanner (6 frames per scan round at 33 Hz).
+ * For each number of scanners one line of JSON is printed on stdout, containing the received scans, the lost frames,
+ * the cpu time per frame and the maximal number of threads of the process.
+ *
+ * Usage: benchmark_scanner_manager [num_rounds_per_scanner]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <gmock/gmock.h>
+
+#include "psen_scan_v2_standalone/util/integrationtest_helper.h"
+#include "psen_scan_v2_standalone/communication_layer/scanner_mock.h"
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scanner_config_builder.h"
+#include "psen_scan_v2_standalone/scanner_manager.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/start_request.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/start_request_serialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/stop_request_serialization.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace psen_scan_v2_standalone_test;
+using namespace ::testing;
+
+static const std::string HOST_IP_ADDRESS{ "127.0.0.1" };
+static const std::vector<std::size_t> NUMBERS_OF_SCANNERS{ 1, 2, 4, 8, 16, 32 };
+static constexpr std::size_t DEFAULT_NUM_ROUNDS{ 33 };
+static constexpr std::size_t FRAMES_PER_ROUND{ 6 };
+static constexpr std::chrono::microseconds FRAME_PERIOD{ 1000000 / (33 * FRAMES_PER_ROUND) };
+static constexpr std::chrono::seconds RECEIVE_TIMEOUT{ 2 };
+
+static ScannerConfiguration generateScannerConfig(const PortHolder& port_holder)
+{
+  return ScannerConfigurationBuilder()
+      .hostIP(HOST_IP_ADDRESS)
+      .hostDataPort(port_holder.data_port_host)
+      .hostControlPort(port_holder.control_port_host)
+      .scannerIp(HOST_IP_ADDRESS)
+      .scannerDataPort(port_holder.data_port_scanner)
+      .scannerControlPort(port_holder.control_port_scanner)
+      .scanRange(DEFAULT_SCAN_RANGE)
+      .scanResolution(DEFAULT_SCAN_RESOLUTION)
+      .enableFragmentedScans(true)
+      .build();
+}
+
+static unsigned int numberOfThreadsOfProcess()
+{
+  std::ifstream status("/proc/self/status");
+  std::string key;
+  while (status >> key)
+  {
+    if (key == "Threads:")
+    {
+      unsigned int num_threads{ 0 };
+      status >> num_threads;
+      return num_threads;
+    }
+  }
+  return 0;
+}
+
+static double cpuTimeInUs()
+{
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static void runBenchmark(const std::size_t& num_scanners, const std::size_t& num_rounds, std::ostream& results)
+{
+  std::vector<PortHolder> port_holders;
+  std::vector<std::unique_ptr<NiceMock<ScannerMock>>> scanner_mocks;
+  for (std::size_t i = 0; i < num_scanners; ++i)
+  {
+    port_holders.push_back(++GLOBAL_PORT_HOLDER);
+    scanner_mocks.emplace_back(new NiceMock<ScannerMock>(HOST_IP_ADDRESS, port_holders.back()));
+    auto& mock{ *scanner_mocks.back() };
+    ON_CALL(mock, receiveControlMsg(_, _)).WillByDefault(InvokeWithoutArgs([&mock]() { mock.sendStartReply(); }));
+    ON_CALL(mock, receiveControlMsg(_, data_conversion_layer::stop_request::serialize()))
+        .WillByDefault(InvokeWithoutArgs([&mock]() { mock.sendStopReply(); }));
+  }
+
+  std::atomic<std::size_t> num_received_scans{ 0 };
+  ScannerManager manager;
+  for (std::size_t i = 0; i < num_scanners; ++i)
+  {
+    manager.addScanner(generateScannerConfig(port_holders[i]), [&num_received_scans](const LaserScan&) {
+      ++num_received_scans;
+    });
+  }
+
+  for (auto& mock : scanner_mocks)
+  {
+    mock->startListeningForControlMsg();
+  }
+  for (auto& future : manager.startAll())
+  {
+    future.wait();
+  }
+
+  std::vector<data_conversion_layer::monitoring_frame::Message> frames;
+  for (std::size_t round = 0; round < num_rounds; ++round)
+  {
+    const auto round_frames{ createMonitoringFrameMsgsForScanRound(static_cast<uint32_t>(round + 1), FRAMES_PER_ROUND) };
+    frames.insert(frames.end(), round_frames.begin(), round_frames.end());
+  }
+
+  unsigned int max_num_threads{ numberOfThreadsOfProcess() };
+  const double cpu_time_start{ cpuTimeInUs() };
+  const auto start{ std::chrono::steady_clock::now() };
+  auto next_send_time{ start };
+  for (const auto& frame : frames)
+  {
+    for (auto& mock : scanner_mocks)
+    {
+      mock->sendMonitoringFrame(frame);
+    }
+    next_send_time += FRAME_PERIOD;
+    std::this_thread::sleep_until(next_send_time);
+  }
+  max_num_threads = std::max(max_num_threads, numberOfThreadsOfProcess());
+
+  const std::size_t num_sent_frames{ frames.size() * num_scanners };
+  const auto receive_deadline{ std::chrono::steady_clock::now() + RECEIVE_TIMEOUT };
+  while (num_received_scans < num_sent_frames && std::chrono::steady_clock::now() < receive_deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const double duration_s{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+  const double cpu_time_us{ cpuTimeInUs() - cpu_time_start };
+
+  for (auto& mock : scanner_mocks)
+  {
+    mock->startListeningForControlMsg();
+  }
+  for (auto& future : manager.stopAll())
+  {
+    future.wait_for(RECEIVE_TIMEOUT);
+  }
+
+  results << "{\"benchmark\": \"scanner_manager\", \"num_scanners\": " << num_scanners
+            << ", \"num_worker_threads\": " << manager.numberOfWorkerThreads()
+            << ", \"max_num_threads\": " << max_num_threads << ", \"sent_frames\": " << num_sent_frames
+            << ", \"received_scans\": " << num_received_scans << ", \"lost_frames\": "
+            << num_sent_frames - std::min<std::size_t>(num_sent_frames, num_received_scans)
+            << ", \"duration_s\": " << duration_s
+            << ", \"cpu_time_per_frame_us\": " << cpu_time_us / static_cast<double>(num_sent_frames) << "}"
+            << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_WARN);
+  const std::size_t num_rounds{ argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : DEFAULT_NUM_ROUNDS };
+
+  // The ScannerMock reports every sent frame on std::cout, therefore, the results use their own stream.
+  std::ostream results(std::cout.rdbuf());
+  std::cout.setstate(std::ios_base::failbit);
+  for (const auto& num_scanners : NUMBERS_OF_SCANNERS)
+  {
+    runBenchmark(num_scanners, num_rounds, results);
+  }
+  return 0;
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Compares benchmark results with the baseline and fails if a metric got worse than its tolerance allows.
+ *
+ * Usage: check_benchmark_regression <results> <baseline> <tolerances>
+ *
+ * All files contain one JSON object per line (see benchmark_regression.h). The results and the baseline have to
+ * contain an environment record of the same build type.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "psen_scan_v2_standalone/util/benchmark_regression.h"
+
+using namespace psen_scan_v2_standalone_test::benchmark_regression;
+
+static std::vector<Record> readFile(const std::string& file_name)
+{
+  std::ifstream file(file_name);
+  if (!file)
+  {
+    throw std::runtime_error("Could not open " + file_name);
+  }
+  return readRecords(file);
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc != 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " <results> <baseline> <tolerances>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try
+  {
+    const std::vector<Record> results{ readFile(argv[1]) };
+    const std::vector<Record> baseline{ readFile(argv[2]) };
+    const Environment results_environment{ environment(results) };
+    const Environment baseline_environment{ environment(baseline) };
+    if (results_environment.build_type != baseline_environment.build_type)
+    {
+      std::cerr << "The baseline was recorded with build type " << baseline_environment.build_type
+                << ", the results with build type " << results_environment.build_type
+                << ". Results of different build types are not comparable." << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (results_environment.host != baseline_environment.host)
+    {
+      std::cout << "Warning: The baseline was recorded on " << baseline_environment.host << ", the results on "
+                << results_environment.host << ". The comparison is only meaningful on the same machine." << std::endl;
+    }
+
+    const CheckResult result{ check(baseline, results, parseRules(readFile(argv[3]))) };
+    for (const auto& comparison : result.comparisons)
+    {
+      std::cout << (comparison.regression ? "REGRESSION " : "ok         ") << std::left << std::setw(36)
+                << comparison.record << std::setw(28) << comparison.metric << std::right
+                << " baseline: " << std::setw(12) << comparison.baseline << " current: " << std::setw(12)
+                << comparison.current << " limit: " << std::setw(12) << comparison.limit << "\n";
+    }
+    for (const auto& missing : result.missing)
+    {
+      std::cout << "MISSING    " << missing << "\n";
+    }
+    std::cout << (result.passed() ? "No performance regression." :
+                                    "Performance regression detected. If it is intended, refresh the baseline.")
+              << std::endl;
+    return result.passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,43 @@
+# Runs the benchmarks and compares their results with the baseline, see README.md.
+#
+# Expects the variables CHECKER, BENCHMARK_CONVERSION, BENCHMARK_LOOPBACK, BASELINE, TOLERANCES, RESULTS and
+# BUILD_TYPE. With UPDATE_BASELINE=ON the results replace the baseline instead of being compared with it.
+
+foreach(variable CHECKER BENCHMARK_CONVERSION BENCHMARK_LOOPBACK BASELINE TOLERANCES RESULTS BUILD_TYPE)
+  if(NOT DEFINED ${variable})
+    message(FATAL_ERROR "${variable} is not set")
+  endif()
+endforeach()
+
+if(UPDATE_BASELINE AND NOT BUILD_TYPE STREQUAL "Release")
+  message(FATAL_ERROR "The baseline has to be recorded with a Release build, not with build type \"${BUILD_TYPE}\"")
+endif()
+
+# The checker refuses to compare results and baseline of different build types and warns about different hosts.
+cmake_host_system_information(RESULT host QUERY HOSTNAME)
+file(WRITE ${RESULTS} "{\"benchmark\": \"environment\", \"build_type\": \"${BUILD_TYPE}\", \"host\": \"${host}\"}\n")
+
+function(run_benchmark)
+  execute_process(COMMAND ${ARGN} OUTPUT_VARIABLE output RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Benchmark \"${ARGN}\" failed: ${result}")
+  endif()
+  file(APPEND ${RESULTS} "${output}")
+endfunction()
+
+run_benchmark(${BENCHMARK_CONVERSION})
+# 1 second at the rate of a real scanner and at 5 times the rate.
+run_benchmark(${BENCHMARK_LOOPBACK} 1 1 5)
+
+if(UPDATE_BASELINE)
+  file(STRINGS ${RESULTS} records REGEX "^{")
+  string(REPLACE ";" "\n" records "${records}")
+  file(WRITE ${BASELINE} "${records}\n")
+  message(STATUS "Updated ${BASELINE}")
+  return()
+endif()
+
+execute_process(COMMAND ${CHECKER} ${RESULTS} ${BASELINE} ${TOLERANCES} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Performance regression check failed, the results are in ${RESULTS}")
+endif()
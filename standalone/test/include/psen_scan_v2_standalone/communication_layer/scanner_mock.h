@@ -83,6 +83,8 @@ public:
   void sendStartReply();
   void sendStopReply();
   void sendMonitoringFrame(const data_conversion_layer::monitoring_frame::Message& msg);
+  //! @brief Sends an already serialized monitoring frame without any output, e.g. for benchmarks.
+  void sendSerializedMonitoringFrame(const data_conversion_layer::RawData& data);
   void sendEmptyMonitoringFrame();
 
 private:
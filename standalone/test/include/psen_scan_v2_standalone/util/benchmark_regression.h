@@ -0,0 +1,130 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef PSEN_SCAN_V2_STANDALONE_TEST_BENCHMARK_REGRESSION_H
+#define PSEN_SCAN_V2_STANDALONE_TEST_BENCHMARK_REGRESSION_H
+
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace psen_scan_v2_standalone_test
+{
+/**
+ * @brief Comparison of benchmark results with a stored baseline.
+ *
+ * The benchmarks print one flat JSON object per line, e.g.
+ * {"benchmark": "loopback", "rate_multiplier": 5, "latency_p99_us": 812.3, ...}.
+ *
+ * The rules of the comparison are JSON lines as well:
+ * - {"benchmark": "loopback", "key": "rate_multiplier"} identifies the records of a benchmark by the value of the
+ *   key field. Benchmarks without key have only one record.
+ * - {"benchmark": "loopback", "metric": "latency_p99_us", "better": "lower", "relative": 1.0, "absolute": 200}
+ *   allows the metric to get worse than the baseline by the relative tolerance (times the baseline value) plus the
+ *   absolute tolerance. Metrics without rule are not compared.
+ */
+namespace benchmark_regression
+{
+//! @brief One line of benchmark output: the fields and their values, strings without quotes.
+using Record = std::map<std::string, std::string>;
+
+/**
+ * @brief Parses a flat JSON object.
+ *
+ * @throws std::invalid_argument if the line is no JSON object or contains nested objects or arrays.
+ */
+Record parseRecord(const std::string& line);
+
+//! @brief Parses all lines of the stream starting with '{', other output of the benchmarks is skipped.
+std::vector<Record> readRecords(std::istream& is);
+
+enum class Direction
+{
+  lower_is_better,
+  higher_is_better
+};
+
+struct Tolerance
+{
+  std::string benchmark;
+  std::string metric;
+  Direction direction{ Direction::lower_is_better };
+  double relative{ 0. };
+  double absolute{ 0. };
+
+  //! @returns the worst value of the metric which is no regression.
+  double limit(const double& baseline) const;
+  bool isRegression(const double& baseline, const double& current) const;
+};
+
+struct Rules
+{
+  //! Key field of each benchmark.
+  std::map<std::string, std::string> keys;
+  std::vector<Tolerance> tolerances;
+};
+
+//! @throws std::invalid_argument if a rule is incomplete or has invalid values.
+Rules parseRules(const std::vector<Record>& records);
+
+/**
+ * @brief Build type and host of a benchmark run, stored as record
+ * {"benchmark": "environment", "build_type": "Release", "host": "ci-runner-1"}.
+ *
+ * Results are only comparable with a baseline of the same build type and host.
+ */
+struct Environment
+{
+  std::string build_type;
+  std::string host;
+};
+
+//! @throws std::invalid_argument if the records contain no environment record or its build type is empty.
+Environment environment(const std::vector<Record>& records);
+
+struct Comparison
+{
+  //! Benchmark and key of the record, e.g. "loopback rate_multiplier=5".
+  std::string record;
+  std::string metric;
+  double baseline;
+  double current;
+  double limit;
+  bool regression;
+};
+
+struct CheckResult
+{
+  std::vector<Comparison> comparisons;
+  //! Records or metrics of the baseline which are missing in the current results.
+  std::vector<std::string> missing;
+
+  bool passed() const;
+};
+
+/**
+ * @brief Compares the metrics of all baseline records, for which a tolerance exists, with the current results.
+ *
+ * Current records without baseline are ignored, so that new benchmarks do not fail before the baseline is refreshed.
+ *
+ * @throws std::invalid_argument if a compared value is no number.
+ */
+CheckResult check(const std::vector<Record>& baseline, const std::vector<Record>& current, const Rules& rules);
+
+}  // namespace benchmark_regression
+}  // namespace psen_scan_v2_standalone_test
+
+#endif  // PSEN_SCAN_V2_STANDALONE_TEST_BENCHMARK_REGRESSION_H
@@ -36,7 +36,7 @@ using namespace psen_scan_v2_standalone;
 static constexpr ScanRange DEFAULT_SCAN_RANGE{ util::TenthOfDegree(0), util::TenthOfDegree(60) };
 static constexpr util::TenthOfDegree DEFAULT_SCAN_RESOLUTION{ 2 };
 
-static double randDouble(double low, double high)
+inline double randDouble(double low, double high)
 {
   static std::default_random_engine re{};
   using Dist = std::uniform_real_distribution<double>;
@@ -44,12 +44,12 @@ static double randDouble(double low, double high)
   return uid(re, Dist::param_type{ low, high });
 }
 
-static double restrictToOneDigitsAfterComma(const double& value)
+inline double restrictToOneDigitsAfterComma(const double& value)
 {
   return std::round(value * 10.) / 10.;
 }
 
-static std::vector<double> generateMeasurements(const unsigned int& num_elements, const double& low, const double& high)
+inline std::vector<double> generateMeasurements(const unsigned int& num_elements, const double& low, const double& high)
 {
   std::vector<double> vec(num_elements);
   // The scanner sends tenth degree values. Therefore, restrict values to one digit after the comma.
@@ -57,7 +57,7 @@ static std::vector<double> generateMeasurements(const unsigned int& num_elements
   return vec;
 }
 
-static std::vector<double> generateIntensities(const unsigned int& num_elements, const double& low, const double& high)
+inline std::vector<double> generateIntensities(const unsigned int& num_elements, const double& low, const double& high)
 {
   std::vector<double> vec(num_elements);
   // The scanner sends intensities as int values, therefore, the values are rounded.
@@ -65,7 +65,7 @@ static std::vector<double> generateIntensities(const unsigned int& num_elements,
   return vec;
 }
 
-static data_conversion_layer::monitoring_frame::Message
+inline data_conversion_layer::monitoring_frame::Message
 createValidMonitoringFrameMsg(const uint32_t scan_counter = 42,
                               const util::TenthOfDegree start_angle = DEFAULT_SCAN_RANGE.getStart(),
                               const util::TenthOfDegree end_angle = DEFAULT_SCAN_RANGE.getEnd())
@@ -89,7 +89,7 @@ createValidMonitoringFrameMsg(const uint32_t scan_counter = 42,
       start_angle, resolution, scan_counter, measurements, intensities, diagnostic_messages);
 }
 
-static std::vector<data_conversion_layer::monitoring_frame::Message>
+inline std::vector<data_conversion_layer::monitoring_frame::Message>
 createValidMonitoringFrameMsgs(const uint32_t scan_counter, const std::size_t num_elements)
 {
   std::vector<data_conversion_layer::monitoring_frame::Message> msgs(num_elements);
@@ -97,7 +97,7 @@ createValidMonitoringFrameMsgs(const uint32_t scan_counter, const std::size_t nu
   return msgs;
 }
 
-static std::vector<data_conversion_layer::monitoring_frame::Message>
+inline std::vector<data_conversion_layer::monitoring_frame::Message>
 createMonitoringFrameMsgsForScanRound(const uint32_t scan_counter, const std::size_t num_elements)
 {
   std::vector<data_conversion_layer::monitoring_frame::Message> msgs(num_elements);
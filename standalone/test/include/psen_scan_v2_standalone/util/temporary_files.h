@@ -0,0 +1,73 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef PSEN_SCAN_V2_STANDALONE_TEST_TEMPORARY_FILES_H
+#define PSEN_SCAN_V2_STANDALONE_TEST_TEMPORARY_FILES_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace psen_scan_v2_standalone_test
+{
+/**
+ * @returns the name of a file in testing::TempDir(), which is unique for the running test and the suffix.
+ *
+ * @note The file is not removed automatically, see TemporaryFilesTest for that.
+ */
+inline std::string temporaryFilename(const std::string& suffix)
+{
+  // test_case_name(), because the gtest of ROS melodic does not provide test_suite_name().
+  const testing::TestInfo* test_info{ testing::UnitTest::GetInstance()->current_test_info() };
+  return testing::TempDir() + test_info->test_case_name() + "_" + test_info->name() + suffix;
+}
+
+/**
+ * @brief Test fixture handing out names of temporary files, which are removed after each test.
+ */
+class TemporaryFilesTest : public testing::Test
+{
+protected:
+  //! @returns the name of a temporary file (see temporaryFilename()), which is removed after the test.
+  std::string filename(const std::string& suffix)
+  {
+    const std::string name{ temporaryFilename(suffix) };
+    removeAfterTest(name);
+    return name;
+  }
+
+  //! @brief Removes the file after the test, e.g. a file created by the software under test.
+  void removeAfterTest(const std::string& name)
+  {
+    filenames_.push_back(name);
+  }
+
+  void TearDown() override
+  {
+    for (const auto& name : filenames_)
+    {
+      std::remove(name.c_str());
+    }
+  }
+
+private:
+  std::vector<std::string> filenames_;
+};
+
+}  // namespace psen_scan_v2_standalone_test
+
+#endif  // PSEN_SCAN_V2_STANDALONE_TEST_TEMPORARY_FILES_H
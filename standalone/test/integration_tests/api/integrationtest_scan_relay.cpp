@@ -0,0 +1,191 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scan_relay.h"
+#include "psen_scan_v2_standalone/util/tenth_of_degree.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static const std::string LOOPBACK_IP{ "127.0.0.1" };
+static const std::string MULTICAST_GROUP{ "239.255.74.2" };
+static constexpr unsigned short UNICAST_PORT{ 55210 };
+static constexpr unsigned short SECOND_UNICAST_PORT{ 55211 };
+static constexpr unsigned short MULTICAST_PORT{ 55212 };
+static constexpr std::chrono::seconds WAIT_TIMEOUT{ 3 };
+//! @brief Time for the receivers to join the multicast group before the first scan is sent.
+static constexpr std::chrono::milliseconds JOIN_DELAY{ 100 };
+
+static LaserScan createScan(const uint32_t& scan_counter)
+{
+  LaserScan scan(util::TenthOfDegree(1), util::TenthOfDegree(0), util::TenthOfDegree(2750));
+  scan.setScanCounter(scan_counter);
+  LaserScan::MeasurementData measurements;
+  LaserScan::IntensityData intensities;
+  for (unsigned int i = 0; i < 2750; ++i)
+  {
+    measurements.push_back(static_cast<double>(1000 + (i * 7 + scan_counter * 3) % 200) / 1000.);
+    intensities.push_back(static_cast<double>((i + scan_counter) % 4096));
+  }
+  scan.setMeasurements(measurements);
+  scan.setIntensities(intensities);
+  return scan;
+}
+
+class ScanCollector
+{
+public:
+  void add(const LaserScan& scan)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    scans_.push_back(scan);
+    cv_.notify_all();
+  }
+
+  std::vector<LaserScan> waitForScans(const std::size_t& number)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, WAIT_TIMEOUT, [this, &number]() { return scans_.size() >= number; });
+    return scans_;
+  }
+
+  ScanRelayReceiver::ScanHandler handler()
+  {
+    return [this](const LaserScan& scan) { add(scan); };
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<LaserScan> scans_;
+};
+
+static void expectScans(const std::vector<LaserScan>& scans, const uint32_t& number)
+{
+  ASSERT_EQ(number, scans.size());
+  for (uint32_t i = 0; i < number; ++i)
+  {
+    EXPECT_EQ(createScan(i + 1), scans[i]);
+  }
+}
+
+TEST(ScanRelayTest, shouldRelayScansToUnicastDestination)
+{
+  ScanCollector collector;
+  ScanRelayReceiver receiver(UNICAST_PORT, collector.handler());
+  ScanRelay relay({ { LOOPBACK_IP, UNICAST_PORT } });
+
+  for (uint32_t scan_counter = 1; scan_counter <= 20; ++scan_counter)
+  {
+    relay.send(createScan(scan_counter));
+  }
+  expectScans(collector.waitForScans(20), 20);
+  EXPECT_EQ(0u, receiver.numberOfDecodeErrors());
+  EXPECT_EQ(0u, relay.numberOfDroppedDatagrams());
+}
+
+TEST(ScanRelayTest, shouldRelayUncompressedScansToAllDestinations)
+{
+  ScanCollector first_collector;
+  ScanCollector second_collector;
+  ScanRelayReceiver first_receiver(UNICAST_PORT, first_collector.handler());
+  ScanRelayReceiver second_receiver(SECOND_UNICAST_PORT, second_collector.handler());
+  ScanRelayOptions options;
+  options.codec.compression = false;
+  ScanRelay relay({ { LOOPBACK_IP, UNICAST_PORT }, { LOOPBACK_IP, SECOND_UNICAST_PORT } }, options);
+
+  const auto callback{ relay.laserScanCallback() };
+  for (uint32_t scan_counter = 1; scan_counter <= 5; ++scan_counter)
+  {
+    callback(createScan(scan_counter));
+  }
+  expectScans(first_collector.waitForScans(5), 5);
+  expectScans(second_collector.waitForScans(5), 5);
+}
+
+TEST(ScanRelayTest, shouldRelayScansToMulticastGroupOnLoopback)
+{
+  ScanCollector first_collector;
+  ScanCollector second_collector;
+  ScanRelayReceiver first_receiver(MULTICAST_PORT, first_collector.handler(), MULTICAST_GROUP, LOOPBACK_IP);
+  ScanRelayReceiver second_receiver(MULTICAST_PORT, second_collector.handler(), MULTICAST_GROUP, LOOPBACK_IP);
+  ScanRelayOptions options;
+  options.multicast_interface = LOOPBACK_IP;
+  ScanRelay relay({ { MULTICAST_GROUP, MULTICAST_PORT } }, options);
+  std::this_thread::sleep_for(JOIN_DELAY);
+
+  for (uint32_t scan_counter = 1; scan_counter <= 20; ++scan_counter)
+  {
+    relay.send(createScan(scan_counter));
+  }
+  expectScans(first_collector.waitForScans(20), 20);
+  expectScans(second_collector.waitForScans(20), 20);
+}
+
+TEST(ScanRelayTest, shouldRecoverWithKeyFrameAfterReceiverJoinedLate)
+{
+  ScanRelayOptions options;
+  options.codec.key_frame_interval = 5;
+  ScanRelay relay({ { LOOPBACK_IP, UNICAST_PORT } }, options);
+  relay.send(createScan(1));
+  relay.send(createScan(2));
+  // Wait till the scans are sent, so that they are lost.
+  const auto deadline{ std::chrono::steady_clock::now() + WAIT_TIMEOUT };
+  while (relay.numberOfSentDatagrams() < 2 && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  ScanCollector collector;
+  ScanRelayReceiver receiver(UNICAST_PORT, collector.handler());
+  for (uint32_t scan_counter = 3; scan_counter <= 10; ++scan_counter)
+  {
+    relay.send(createScan(scan_counter));
+  }
+  // The deltas of scan 3 to 5 cannot be decoded, scan 6 is a key frame.
+  const auto scans{ collector.waitForScans(5) };
+  ASSERT_EQ(5u, scans.size());
+  EXPECT_EQ(createScan(6), scans[0]);
+  EXPECT_EQ(createScan(10), scans[4]);
+  EXPECT_EQ(3u, receiver.numberOfDecodeErrors());
+}
+
+TEST(ScanRelayTest, shouldThrowOnInvalidDestinations)
+{
+  EXPECT_THROW(ScanRelay({}), std::invalid_argument);
+  EXPECT_THROW(ScanRelay({ { "not an ip", UNICAST_PORT } }), std::invalid_argument);
+  EXPECT_THROW(ScanRelayReceiver(UNICAST_PORT, [](const LaserScan&) {}, "not an ip"), std::invalid_argument);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
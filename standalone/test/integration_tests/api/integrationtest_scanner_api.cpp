@@ -17,10 +17,13 @@
 #include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <cstdio>
+#include <fstream>
 #include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -32,6 +35,7 @@
 // Test frameworks
 #include "psen_scan_v2_standalone/util/integrationtest_helper.h"
 #include "psen_scan_v2_standalone/util/mock_console_bridge_output_handler.h"
+#include "psen_scan_v2_standalone/util/temporary_files.h"
 #include "psen_scan_v2_standalone/communication_layer/scanner_mock.h"
 
 // Software under testing
@@ -40,8 +44,12 @@
 #include "psen_scan_v2_standalone/scanner_configuration.h"
 #include "psen_scan_v2_standalone/scanner_config_builder.h"
 #include "psen_scan_v2_standalone/scanner_v2.h"
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
 #include "psen_scan_v2_standalone/data_conversion_layer/start_request.h"
 #include "psen_scan_v2_standalone/data_conversion_layer/start_request_serialization.h"
+#include "psen_scan_v2_standalone/util/tracing.h"
 
 namespace psen_scan_v2_standalone_test
 {
@@ -70,6 +78,7 @@ protected:
   void SetUp() override;
   void setUpScannerConfig(const std::string& host_ip = HOST_IP_ADDRESS, bool fragmented = FRAGMENTED_SCAN);
   ScannerConfiguration generateScannerConfig(const std::string& host_ip, bool fragmented);
+  ScannerConfigurationBuilder createScannerConfigBuilder(const std::string& host_ip, bool fragmented);
   void setUpScannerV2();
   void setUpNiceScannerMock();
   void setUpStrictScannerMock();
@@ -97,18 +106,22 @@ void ScannerAPITests::setUpScannerConfig(const std::string& host_ip, bool fragme
 
 ScannerConfiguration ScannerAPITests::generateScannerConfig(const std::string& host_ip, bool fragmented)
 {
-  auto config_builder = ScannerConfigurationBuilder()
-                            .hostIP(host_ip)
-                            .hostDataPort(port_holder_.data_port_host)
-                            .hostControlPort(port_holder_.control_port_host)
-                            .scannerIp(SCANNER_IP_ADDRESS)
-                            .scannerDataPort(port_holder_.data_port_scanner)
-                            .scannerControlPort(port_holder_.control_port_scanner)
-                            .scanRange(DEFAULT_SCAN_RANGE)
-                            .scanResolution(DEFAULT_SCAN_RESOLUTION)
-                            .enableIntensities()
-                            .enableFragmentedScans(fragmented);
-  return config_builder.build();
+  return createScannerConfigBuilder(host_ip, fragmented).build();
+}
+
+ScannerConfigurationBuilder ScannerAPITests::createScannerConfigBuilder(const std::string& host_ip, bool fragmented)
+{
+  return ScannerConfigurationBuilder()
+      .hostIP(host_ip)
+      .hostDataPort(port_holder_.data_port_host)
+      .hostControlPort(port_holder_.control_port_host)
+      .scannerIp(SCANNER_IP_ADDRESS)
+      .scannerDataPort(port_holder_.data_port_scanner)
+      .scannerControlPort(port_holder_.control_port_scanner)
+      .scanRange(DEFAULT_SCAN_RANGE)
+      .scanResolution(DEFAULT_SCAN_RESOLUTION)
+      .enableIntensities()
+      .enableFragmentedScans(fragmented);
 }
 
 void ScannerAPITests::setUpScannerV2()
@@ -284,6 +297,47 @@ TEST_F(ScannerAPITests, shouldReturnInvalidFutureWhenStopIsCalledSecondTime)
   EXPECT_EQ(stop_future.wait_for(DEFAULT_TIMEOUT), std::future_status::ready) << "Scanner::stop() not finished";
 }
 
+TEST_F(ScannerAPITests, shouldStopWhileMonitoringFramesAreReceived)
+{
+  setUpScannerConfig();
+  setUpScannerV2();
+  setUpNiceScannerMock();
+  prepareScannerMockStartReply();
+
+  util::Barrier laser_scan_cb_entered_barrier;
+  util::Barrier laser_scan_cb_released_barrier;
+  EXPECT_CALL(user_callbacks_, LaserScanCallback(_))
+      .WillOnce(InvokeWithoutArgs([&laser_scan_cb_entered_barrier, &laser_scan_cb_released_barrier]() {
+        laser_scan_cb_entered_barrier.release();
+        laser_scan_cb_released_barrier.waitTillRelease(DEFAULT_TIMEOUT);
+      }))
+      .WillRepeatedly(Return());
+
+  nice_scanner_mock_->startListeningForControlMsg();
+  const auto start_future = scanner_->start();
+  start_future.wait();
+
+  const data_conversion_layer::monitoring_frame::Message msg{ createValidMonitoringFrameMsg() };
+  nice_scanner_mock_->sendMonitoringFrame(msg);
+  ASSERT_TRUE(laser_scan_cb_entered_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Monitoring frame not received";
+
+  // Queue up frames, so that the data handler waits for the scanner while the stop request is processed.
+  for (int i = 0; i < 20; ++i)
+  {
+    nice_scanner_mock_->sendMonitoringFrame(msg);
+  }
+
+  nice_scanner_mock_->startListeningForControlMsg();
+  auto stop_call{ std::async(std::launch::async, [this]() { return scanner_->stop(); }) };
+  std::this_thread::sleep_for(100ms);
+  laser_scan_cb_released_barrier.release();
+
+  ASSERT_EQ(stop_call.wait_for(DEFAULT_TIMEOUT), std::future_status::ready) << "Scanner::stop() blocked";
+  const auto stop_future = stop_call.get();
+  nice_scanner_mock_->sendStopReply();
+  EXPECT_EQ(stop_future.wait_for(DEFAULT_TIMEOUT), std::future_status::ready) << "Scanner::stop() not finished";
+}
+
 TEST_F(ScannerAPITests, testStartReplyTimeout)
 {
   INJECT_NICE_LOG_MOCK;
@@ -358,6 +412,125 @@ TEST_F(ScannerAPITests, LaserScanShouldContainAllInfosTransferedByMonitoringFram
   REMOVE_LOG_MOCK
 }
 
+TEST_F(ScannerAPITests, shouldRecordLatenciesOfAllStagesBeforeLaserScanCallback)
+{
+  INJECT_LOG_MOCK
+  setUpScannerConfig();
+  setUpScannerV2();
+  setUpNiceScannerMock();
+  prepareScannerMockStartReply();
+
+  util::Barrier monitoring_frame_barrier;
+  EXPECT_CALL(user_callbacks_, LaserScanCallback(_)).WillOnce(OpenBarrier(&monitoring_frame_barrier));
+  EXPECT_ANY_LOG().Times(AnyNumber());
+
+  nice_scanner_mock_->startListeningForControlMsg();
+  auto promis = scanner_->start();
+  promis.wait_for(DEFAULT_TIMEOUT);
+  nice_scanner_mock_->sendMonitoringFrame(createValidMonitoringFrameMsg());
+
+  ASSERT_TRUE(monitoring_frame_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Monitoring frame not received";
+  // The latency of the callback itself is recorded after the callback returned, so it is not checked here.
+  const protocol_layer::LatencyStatistics latencies{ scanner_->getStatistics().latencies };
+  EXPECT_EQ(1u, latencies.deserialization.count);
+  EXPECT_EQ(1u, latencies.scan_buffer.count);
+  EXPECT_EQ(1u, latencies.conversion.count);
+  EXPECT_EQ(1u, latencies.receive_to_callback.count);
+  EXPECT_GE(latencies.receive_to_callback.max, latencies.deserialization.max + latencies.conversion.max);
+  REMOVE_LOG_MOCK
+}
+
+TEST_F(ScannerAPITests, shouldMeasurePerfCountersOfDecodingAndConversionIfEnabled)
+{
+  INJECT_LOG_MOCK
+  config_.reset(new ScannerConfiguration(ScannerConfigurationBuilder()
+                                             .hostIP(HOST_IP_ADDRESS)
+                                             .hostDataPort(port_holder_.data_port_host)
+                                             .hostControlPort(port_holder_.control_port_host)
+                                             .scannerIp(SCANNER_IP_ADDRESS)
+                                             .scannerDataPort(port_holder_.data_port_scanner)
+                                             .scannerControlPort(port_holder_.control_port_scanner)
+                                             .scanRange(DEFAULT_SCAN_RANGE)
+                                             .scanResolution(DEFAULT_SCAN_RESOLUTION)
+                                             .enableFragmentedScans(FRAGMENTED_SCAN)
+                                             .enablePerfCounters()
+                                             .build()));
+  setUpScannerV2();
+  setUpNiceScannerMock();
+  prepareScannerMockStartReply();
+
+  util::Barrier monitoring_frame_barrier;
+  EXPECT_CALL(user_callbacks_, LaserScanCallback(_)).WillOnce(OpenBarrier(&monitoring_frame_barrier));
+  EXPECT_ANY_LOG().Times(AnyNumber());
+
+  nice_scanner_mock_->startListeningForControlMsg();
+  auto promis = scanner_->start();
+  promis.wait_for(DEFAULT_TIMEOUT);
+  nice_scanner_mock_->sendMonitoringFrame(createValidMonitoringFrameMsg());
+
+  ASSERT_TRUE(monitoring_frame_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Monitoring frame not received";
+  // Depending on the permissions of the test environment the stages are either measured or counted as unavailable.
+  const protocol_layer::PerfCounterStatistics perf_counters{ scanner_->getStatistics().perf_counters };
+  EXPECT_EQ(1u, perf_counters.deserialization.samples + perf_counters.deserialization.unavailable);
+  EXPECT_EQ(1u, perf_counters.conversion.samples + perf_counters.conversion.unavailable);
+  REMOVE_LOG_MOCK
+}
+
+TEST_F(ScannerAPITests, shouldCountLostAndInvalidMonitoringFrames)
+{
+  INJECT_LOG_MOCK
+  setUpScannerConfig(HOST_IP_ADDRESS, UNFRAGMENTED_SCAN);
+  setUpScannerV2();
+  setUpNiceScannerMock();
+  prepareScannerMockStartReply();
+
+  const auto first_round{ createMonitoringFrameMsgsForScanRound(2, 6) };
+  // Rounds 3 and 4 are lost completely and round 5 is incomplete.
+  auto incomplete_round{ createMonitoringFrameMsgsForScanRound(5, 6) };
+  incomplete_round.resize(3);
+  const auto outdated_frame{ createValidMonitoringFrameMsg(4) };
+  const auto last_round{ createMonitoringFrameMsgsForScanRound(6, 6) };
+
+  util::Barrier last_scan_barrier;
+  EXPECT_CALL(user_callbacks_, LaserScanCallback(_))
+      .WillOnce(Return())
+      .WillOnce(OpenBarrier(&last_scan_barrier));
+  EXPECT_ANY_LOG().Times(AnyNumber());
+
+  nice_scanner_mock_->startListeningForControlMsg();
+  auto promis = scanner_->start();
+  promis.wait_for(DEFAULT_TIMEOUT);
+
+  for (const auto& msg : first_round)
+  {
+    nice_scanner_mock_->sendMonitoringFrame(msg);
+  }
+  for (const auto& msg : incomplete_round)
+  {
+    nice_scanner_mock_->sendMonitoringFrame(msg);
+  }
+  nice_scanner_mock_->sendMonitoringFrame(outdated_frame);
+  for (const auto& msg : last_round)
+  {
+    nice_scanner_mock_->sendMonitoringFrame(msg);
+  }
+
+  ASSERT_TRUE(last_scan_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Last laser scan not received";
+  const protocol_layer::ProtocolStatistics statistics{ scanner_->getProtocolStatistics() };
+  EXPECT_EQ(16u, statistics.datagrams_received);
+  EXPECT_GT(statistics.bytes_received, statistics.datagrams_received);
+  EXPECT_EQ(0u, statistics.datagrams_dropped);
+  EXPECT_EQ(16u, statistics.frames_received);
+  EXPECT_GE(statistics.scans_completed, 1u) << "The last scan is counted after the callback returned";
+  EXPECT_EQ(2u, statistics.scan_counter_gaps);
+  EXPECT_EQ(1u, statistics.outdated_frames);
+  EXPECT_EQ(1u, statistics.dropped_rounds);
+  EXPECT_EQ(0u, statistics.oversaturated_rounds);
+  EXPECT_EQ(0u, statistics.decode_errors);
+  EXPECT_EQ(0u, statistics.monitoring_frame_timeouts);
+  REMOVE_LOG_MOCK
+}
+
 TEST_F(ScannerAPITests, shouldCallLaserScanCBOnlyOneTimeWithAllInformationWhenUnfragmentedScanIsEnabled)
 {
   INJECT_LOG_MOCK
@@ -391,6 +564,308 @@ TEST_F(ScannerAPITests, shouldCallLaserScanCBOnlyOneTimeWithAllInformationWhenUn
   REMOVE_LOG_MOCK
 }
 
+#ifdef __linux__
+TEST_F(ScannerAPITests, shouldKeepMonitoringFramesInFlightRecorder)
+{
+  INJECT_LOG_MOCK
+  const std::string flight_recording{ temporaryFilename(".ring") };
+  const std::string snapshot{ flight_recording + ".log" };
+  config_.reset(new ScannerConfiguration(
+      createScannerConfigBuilder(HOST_IP_ADDRESS, UNFRAGMENTED_SCAN).flightRecorder(flight_recording).build()));
+  setUpScannerV2();
+  setUpNiceScannerMock();
+  prepareScannerMockStartReply();
+
+  const auto msgs{ createMonitoringFrameMsgsForScanRound(2, 6) };
+  util::Barrier monitoring_frame_barrier;
+  EXPECT_CALL(user_callbacks_, LaserScanCallback(_)).WillOnce(OpenBarrier(&monitoring_frame_barrier));
+  EXPECT_ANY_LOG().Times(AnyNumber());
+
+  nice_scanner_mock_->startListeningForControlMsg();
+  scanner_->start().wait_for(DEFAULT_TIMEOUT);
+  for (const auto& msg : msgs)
+  {
+    nice_scanner_mock_->sendMonitoringFrame(msg);
+  }
+  ASSERT_TRUE(monitoring_frame_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Monitoring frame not received";
+
+  // The serialization limits the range of the intensities, so the frames are compared after a round trip.
+  std::vector<data_conversion_layer::monitoring_frame::Message> sent_msgs;
+  for (const auto& msg : msgs)
+  {
+    const auto data{ data_conversion_layer::monitoring_frame::serialize(msg) };
+    sent_msgs.push_back(data_conversion_layer::monitoring_frame::deserialize(data, data.size()));
+  }
+
+  scanner_->writeFlightRecorderSnapshot(snapshot);
+  std::ifstream log(snapshot, std::ios::binary);
+  EXPECT_EQ(sent_msgs, communication_layer::decodeMonitoringFrames(communication_layer::readDatagramLog(log)));
+
+  scanner_.reset();
+  EXPECT_EQ(sent_msgs,
+            communication_layer::decodeMonitoringFrames(communication_layer::readRecording(flight_recording)));
+  std::remove(flight_recording.c_str());
+  std::remove(snapshot.c_str());
+  REMOVE_LOG_MOCK
+}
+#endif
+
+TEST_F(ScannerAPITests, shouldThrowOnSnapshotWithoutFlightRecorder)
+{
+  setUpScannerConfig();
+  setUpScannerV2();
+  EXPECT_THROW(scanner_->writeFlightRecorderSnapshot(temporaryFilename(".log")), std::logic_error);
+}
+
+TEST_F(ScannerAPITests, shouldDisableTracingWhenLastTracingScannerIsDestroyed)
+{
+  const std::string trace_file{ temporaryFilename(".json") };
+  config_.reset(new ScannerConfiguration(
+      createScannerConfigBuilder(HOST_IP_ADDRESS, FRAGMENTED_SCAN).traceFile(trace_file).build()));
+  // Another user of the process-wide tracer.
+  util::Tracer::instance().enable();
+  setUpScannerV2();
+  scanner_.reset();
+  EXPECT_TRUE(util::Tracer::instance().isEnabled());
+
+  setUpScannerV2();
+  util::Tracer::instance().disable();
+  EXPECT_TRUE(util::Tracer::instance().isEnabled());
+  scanner_.reset();
+  EXPECT_FALSE(util::Tracer::instance().isEnabled());
+  std::remove(trace_file.c_str());
+}
+
+TEST_F(ScannerAPITests, shouldPassIncompleteFirstRoundWhenFastStartIsEnabled)
+{
+  INJECT_LOG_MOCK
+  config_.reset(new ScannerConfiguration(ScannerConfigurationBuilder()
+                                             .hostIP(HOST_IP_ADDRESS)
+                                             .hostDataPort(port_holder_.data_port_host)
+                                             .hostControlPort(port_holder_.control_port_host)
+                                             .scannerIp(SCANNER_IP_ADDRESS)
+                                             .scannerDataPort(port_holder_.data_port_scanner)
+                                             .scannerControlPort(port_holder_.control_port_scanner)
+                                             .scanRange(DEFAULT_SCAN_RANGE)
+                                             .scanResolution(DEFAULT_SCAN_RESOLUTION)
+                                             .enableFragmentedScans(UNFRAGMENTED_SCAN)
+                                             .enableFastStart()
+                                             .build()));
+  setUpScannerV2();
+  setUpNiceScannerMock();
+  prepareScannerMockStartReply();
+
+  // The receiving starts in the middle of the first round.
+  auto first_round{ createMonitoringFrameMsgsForScanRound(2, 6) };
+  first_round.erase(first_round.begin(), first_round.begin() + 2);
+  const auto second_round{ createMonitoringFrameMsgsForScanRound(3, 6) };
+
+  util::Barrier second_scan_barrier;
+  {
+    InSequence seq;
+    EXPECT_CALL(user_callbacks_, LaserScanCallback(data_conversion_layer::LaserScanConverter::toLaserScan(first_round)))
+        .Times(1);
+    EXPECT_CALL(user_callbacks_,
+                LaserScanCallback(data_conversion_layer::LaserScanConverter::toLaserScan(second_round)))
+        .WillOnce(OpenBarrier(&second_scan_barrier));
+  }
+  EXPECT_ANY_LOG().Times(AnyNumber());
+
+  nice_scanner_mock_->startListeningForControlMsg();
+  auto promis = scanner_->start();
+  promis.wait_for(DEFAULT_TIMEOUT);
+
+  for (const auto& msg : first_round)
+  {
+    nice_scanner_mock_->sendMonitoringFrame(msg);
+  }
+  for (const auto& msg : second_round)
+  {
+    nice_scanner_mock_->sendMonitoringFrame(msg);
+  }
+
+  ASSERT_TRUE(second_scan_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Second laser scan not received";
+  EXPECT_EQ(0u, scanner_->getProtocolStatistics().dropped_rounds);
+  REMOVE_LOG_MOCK
+}
+
+TEST_F(ScannerAPITests, shouldRetryStartRequestEarlyWhenFastStartIsEnabled)
+{
+  INJECT_NICE_LOG_MOCK;
+  config_.reset(new ScannerConfiguration(ScannerConfigurationBuilder()
+                                             .hostIP(HOST_IP_ADDRESS)
+                                             .hostDataPort(port_holder_.data_port_host)
+                                             .hostControlPort(port_holder_.control_port_host)
+                                             .scannerIp(SCANNER_IP_ADDRESS)
+                                             .scannerDataPort(port_holder_.data_port_scanner)
+                                             .scannerControlPort(port_holder_.control_port_scanner)
+                                             .scanRange(DEFAULT_SCAN_RANGE)
+                                             .scanResolution(DEFAULT_SCAN_RESOLUTION)
+                                             .enableFastStart()
+                                             .build()));
+  setUpScannerV2();
+  setUpStrictScannerMock();
+
+  util::Barrier twice_called_barrier;
+  {
+    InSequence seq;
+    EXPECT_CALL(*strict_scanner_mock_, receiveControlMsg(_, _)).Times(1);
+    EXPECT_CALL(*strict_scanner_mock_, receiveControlMsg(_, _)).WillOnce(OpenBarrier(&twice_called_barrier));
+    EXPECT_CALL(*strict_scanner_mock_, receiveControlMsg(_, _)).Times(AnyNumber());
+  }
+
+  strict_scanner_mock_->startContinuousListeningForControlMsg();
+  const auto start_future{ std::async(std::launch::async, [this]() {
+    const auto scanner_start = scanner_->start();
+    scanner_start.wait();
+  }) };
+
+  // Without fast start the start request is repeated after one second.
+  EXPECT_TRUE(twice_called_barrier.waitTillRelease(500ms)) << "Start request not repeated early";
+  strict_scanner_mock_->sendStartReply();
+  EXPECT_EQ(start_future.wait_for(DEFAULT_TIMEOUT), std::future_status::ready) << "Scanner::start() not finished";
+  REMOVE_LOG_MOCK
+}
+
+TEST_F(ScannerAPITests, shouldCallLaserScanCBWithAllInformationWhenPipelinedProcessingIsEnabled)
+{
+  INJECT_LOG_MOCK
+  config_.reset(new ScannerConfiguration(ScannerConfigurationBuilder()
+                                             .hostIP(HOST_IP_ADDRESS)
+                                             .hostDataPort(port_holder_.data_port_host)
+                                             .hostControlPort(port_holder_.control_port_host)
+                                             .scannerIp(SCANNER_IP_ADDRESS)
+                                             .scannerDataPort(port_holder_.data_port_scanner)
+                                             .scannerControlPort(port_holder_.control_port_scanner)
+                                             .scanRange(DEFAULT_SCAN_RANGE)
+                                             .scanResolution(DEFAULT_SCAN_RESOLUTION)
+                                             .enableIntensities()
+                                             .enableFragmentedScans(UNFRAGMENTED_SCAN)
+                                             .enablePipelinedProcessing()
+                                             .build()));
+  setUpScannerV2();
+  setUpNiceScannerMock();
+  prepareScannerMockStartReply();
+
+  std::vector<psen_scan_v2_standalone::data_conversion_layer::monitoring_frame::Message> msgs =
+      createMonitoringFrameMsgsForScanRound(2, 6);
+
+  util::Barrier monitoring_frame_barrier;
+
+  EXPECT_CALL(user_callbacks_, LaserScanCallback(data_conversion_layer::LaserScanConverter::toLaserScan(msgs)))
+      .Times(1)
+      .WillOnce(OpenBarrier(&monitoring_frame_barrier));
+
+  EXPECT_ANY_LOG().Times(AnyNumber());
+
+  nice_scanner_mock_->startListeningForControlMsg();
+  auto promis = scanner_->start();
+  promis.wait_for(DEFAULT_TIMEOUT);
+
+  for (const auto& msg : msgs)
+  {
+    nice_scanner_mock_->sendMonitoringFrame(msg);
+  }
+
+  EXPECT_TRUE(monitoring_frame_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Monitoring frame not received";
+  // The processed counters are incremented after the handler returned, so only the queues are checked here.
+  const protocol_layer::PipelineStatistics statistics{ scanner_->getStatistics().pipeline };
+  EXPECT_GE(statistics.decode.max_queue_depth, 1u);
+  EXPECT_GE(statistics.assembly.max_queue_depth, 1u);
+  EXPECT_EQ(0u, statistics.decode.dropped);
+  EXPECT_EQ(0u, statistics.assembly.dropped);
+  REMOVE_LOG_MOCK
+}
+
+TEST_F(ScannerAPITests, shouldSendStopRequestOnDecodingFailureWhenPipelinedProcessingIsEnabled)
+{
+  INJECT_LOG_MOCK
+  config_.reset(new ScannerConfiguration(
+      createScannerConfigBuilder(HOST_IP_ADDRESS, FRAGMENTED_SCAN).enablePipelinedProcessing().build()));
+  setUpScannerV2();
+  setUpNiceScannerMock();
+  prepareScannerMockStartReply();
+
+  EXPECT_CALL(user_callbacks_, LaserScanCallback(_)).Times(0);
+  EXPECT_ANY_LOG().Times(AnyNumber());
+
+  nice_scanner_mock_->startListeningForControlMsg();
+  const auto start_future = scanner_->start();
+  start_future.wait();
+
+  util::Barrier stop_req_received_barrier;
+  EXPECT_CALL(*nice_scanner_mock_, receiveControlMsg(_, data_conversion_layer::stop_request::serialize()))
+      .WillOnce(OpenBarrier(&stop_req_received_barrier));
+
+  // Replace the id of the first additional field by an unknown one.
+  data_conversion_layer::RawData invalid_frame{ data_conversion_layer::monitoring_frame::serialize(
+      createValidMonitoringFrameMsg()) };
+  invalid_frame.at(data_conversion_layer::monitoring_frame::NUMBER_OF_BYTES_FIXED_FIELDS) = 0x7f;
+  nice_scanner_mock_->startListeningForControlMsg();
+  nice_scanner_mock_->sendSerializedMonitoringFrame(invalid_frame);
+
+  EXPECT_TRUE(stop_req_received_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Stop request not received";
+  EXPECT_EQ(1u, scanner_->getProtocolStatistics().decode_errors);
+  REMOVE_LOG_MOCK
+}
+
+struct PostedTasks
+{
+  std::mutex mutex;
+  std::vector<std::function<void()>> tasks;
+  util::Barrier posted_barrier;
+};
+
+TEST_F(ScannerAPITests, shouldCallLaserScanCBViaConfiguredCallbackExecutor)
+{
+  INJECT_LOG_MOCK
+  // Shared with the executor, because the executor is destroyed together with the scanner.
+  const auto posted_tasks{ std::make_shared<PostedTasks>() };
+  config_.reset(new ScannerConfiguration(ScannerConfigurationBuilder()
+                                             .hostIP(HOST_IP_ADDRESS)
+                                             .hostDataPort(port_holder_.data_port_host)
+                                             .hostControlPort(port_holder_.control_port_host)
+                                             .scannerIp(SCANNER_IP_ADDRESS)
+                                             .scannerDataPort(port_holder_.data_port_scanner)
+                                             .scannerControlPort(port_holder_.control_port_scanner)
+                                             .scanRange(DEFAULT_SCAN_RANGE)
+                                             .scanResolution(DEFAULT_SCAN_RESOLUTION)
+                                             .enableIntensities()
+                                             .enableFragmentedScans(FRAGMENTED_SCAN)
+                                             .callbackExecutor([posted_tasks](std::function<void()> task) {
+                                               const std::lock_guard<std::mutex> lock(posted_tasks->mutex);
+                                               posted_tasks->tasks.push_back(std::move(task));
+                                               posted_tasks->posted_barrier.release();
+                                             })
+                                             .build()));
+  setUpScannerV2();
+  setUpNiceScannerMock();
+  prepareScannerMockStartReply();
+
+  const data_conversion_layer::monitoring_frame::Message msg{ createValidMonitoringFrameMsg() };
+  EXPECT_ANY_LOG().Times(AnyNumber());
+
+  // The callback must only be called by the executor.
+  EXPECT_CALL(user_callbacks_, LaserScanCallback(_)).Times(0);
+
+  nice_scanner_mock_->startListeningForControlMsg();
+  auto promis = scanner_->start();
+  promis.wait_for(DEFAULT_TIMEOUT);
+  nice_scanner_mock_->sendMonitoringFrame(msg);
+
+  ASSERT_TRUE(posted_tasks->posted_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Laser scan not posted to executor";
+  Mock::VerifyAndClearExpectations(&user_callbacks_);
+
+  // The task still calls the callback after the scanner has been destroyed.
+  scanner_.reset();
+  EXPECT_CALL(user_callbacks_, LaserScanCallback(data_conversion_layer::LaserScanConverter::toLaserScan({ msg })))
+      .Times(1);
+  const std::lock_guard<std::mutex> lock(posted_tasks->mutex);
+  ASSERT_EQ(1u, posted_tasks->tasks.size());
+  posted_tasks->tasks.front()();
+  REMOVE_LOG_MOCK
+}
+
 TEST_F(ScannerAPITests, shouldShowOneUserMsgIfFirstTwoScanRoundsStartEarly)
 {
   INJECT_LOG_MOCK
@@ -497,11 +972,13 @@ TEST_F(ScannerAPITests, shouldNotCallLaserscanCallbackInCaseOfEmptyMonitoringFra
   util::Barrier empty_msg_received;
   // Needed to allow all other log messages which might be received
   EXPECT_ANY_LOG().Times(AnyNumber());
+#ifndef __linux__
   EXPECT_LOG_SHORT(
       WARN,
       "StateMachine: No transition in state \"WaitForMonitoringFrame\" for event \"MonitoringFrameReceivedError\".")
       .Times(1)
       .WillOnce(OpenBarrier(&empty_msg_received));
+#endif
 
   nice_scanner_mock_->startListeningForControlMsg();
   auto promis = scanner_->start();
@@ -509,7 +986,17 @@ TEST_F(ScannerAPITests, shouldNotCallLaserscanCallbackInCaseOfEmptyMonitoringFra
 
   std::cout << "ScannerAPITests: Send empty monitoring frame..." << std::endl;
   nice_scanner_mock_->sendEmptyMonitoringFrame();
+#ifdef __linux__
+  // The socket filter of the data client drops the empty datagram in the kernel.
+  const auto deadline{ std::chrono::steady_clock::now() + DEFAULT_TIMEOUT };
+  while (scanner_->getProtocolStatistics().datagrams_dropped == 0 && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(1u, scanner_->getProtocolStatistics().datagrams_dropped) << "Empty monitoring frame not dropped";
+#else
   EXPECT_TRUE(empty_msg_received.waitTillRelease(DEFAULT_TIMEOUT)) << "Empty monitoring frame not received";
+#endif
 
   std::cout << "ScannerAPITests: Send valid monitoring frame..." << std::endl;
   nice_scanner_mock_->sendMonitoringFrame(createValidMonitoringFrameMsg());
@@ -0,0 +1,204 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+// Test frameworks
+#include "psen_scan_v2_standalone/util/integrationtest_helper.h"
+#include "psen_scan_v2_standalone/communication_layer/scanner_mock.h"
+
+// Software under testing
+#include "psen_scan_v2_standalone/util/async_barrier.h"
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scanner_configuration.h"
+#include "psen_scan_v2_standalone/scanner_config_builder.h"
+#include "psen_scan_v2_standalone/scanner_manager.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/start_request.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/start_request_serialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/stop_request_serialization.h"
+
+namespace psen_scan_v2_standalone_test
+{
+using namespace psen_scan_v2_standalone;
+using namespace ::testing;
+
+static const std::string HOST_IP_ADDRESS{ "127.0.0.1" };
+static const std::string SCANNER_IP_ADDRESS{ "127.0.0.1" };
+static constexpr std::chrono::seconds DEFAULT_TIMEOUT{ 3 };
+static constexpr std::size_t NUM_SCANNERS{ 4 };
+static constexpr std::size_t NUM_WORKER_THREADS{ 2 };
+
+class UserCallbacks
+{
+public:
+  MOCK_METHOD2(LaserScanCallback, void(const std::size_t&, const LaserScan&));
+};
+
+static ScannerConfiguration generateScannerConfig(const PortHolder& port_holder)
+{
+  return ScannerConfigurationBuilder()
+      .hostIP(HOST_IP_ADDRESS)
+      .hostDataPort(port_holder.data_port_host)
+      .hostControlPort(port_holder.control_port_host)
+      .scannerIp(SCANNER_IP_ADDRESS)
+      .scannerDataPort(port_holder.data_port_scanner)
+      .scannerControlPort(port_holder.control_port_scanner)
+      .scanRange(DEFAULT_SCAN_RANGE)
+      .scanResolution(DEFAULT_SCAN_RESOLUTION)
+      .enableIntensities()
+      .enableFragmentedScans(true)
+      .build();
+}
+
+static unsigned int numberOfThreadsOfProcess()
+{
+  std::ifstream status("/proc/self/status");
+  std::string key;
+  while (status >> key)
+  {
+    if (key == "Threads:")
+    {
+      unsigned int num_threads{ 0 };
+      status >> num_threads;
+      return num_threads;
+    }
+  }
+  return 0;
+}
+
+class ScannerManagerTests : public testing::Test
+{
+protected:
+  void SetUp() override;
+  void addScanners(const std::size_t& num_scanners);
+
+protected:
+  std::vector<PortHolder> port_holders_;
+  std::vector<std::unique_ptr<NiceMock<ScannerMock>>> scanner_mocks_;
+  UserCallbacks user_callbacks_;
+  std::unique_ptr<ScannerManager> manager_;
+};
+
+void ScannerManagerTests::SetUp()
+{
+  for (std::size_t i = 0; i < NUM_SCANNERS; ++i)
+  {
+    port_holders_.push_back(++GLOBAL_PORT_HOLDER);
+    scanner_mocks_.emplace_back(new NiceMock<ScannerMock>(HOST_IP_ADDRESS, port_holders_.back()));
+    auto& mock{ *scanner_mocks_.back() };
+    ON_CALL(mock,
+            receiveControlMsg(_,
+                              data_conversion_layer::start_request::serialize(data_conversion_layer::start_request::Message(
+                                  generateScannerConfig(port_holders_.back())))))
+        .WillByDefault(InvokeWithoutArgs([&mock]() { mock.sendStartReply(); }));
+    ON_CALL(mock, receiveControlMsg(_, data_conversion_layer::stop_request::serialize()))
+        .WillByDefault(InvokeWithoutArgs([&mock]() { mock.sendStopReply(); }));
+  }
+  manager_.reset(new ScannerManager(NUM_WORKER_THREADS));
+}
+
+void ScannerManagerTests::addScanners(const std::size_t& num_scanners)
+{
+  for (std::size_t i = 0; i < num_scanners; ++i)
+  {
+    manager_->addScanner(generateScannerConfig(port_holders_.at(i)),
+                         [this, i](const LaserScan& scan) { user_callbacks_.LaserScanCallback(i, scan); });
+  }
+}
+
+TEST_F(ScannerManagerTests, shouldUseSpecifiedNumberOfWorkerThreads)
+{
+  EXPECT_EQ(NUM_WORKER_THREADS, manager_->numberOfWorkerThreads());
+}
+
+TEST_F(ScannerManagerTests, shouldNotCreateThreadsPerScanner)
+{
+  const auto num_threads_before{ numberOfThreadsOfProcess() };
+  addScanners(NUM_SCANNERS);
+  EXPECT_EQ(NUM_SCANNERS, manager_->numberOfScanners());
+  // Threads of previous tests might still be finishing, therefore, the number might also decrease.
+  EXPECT_LE(numberOfThreadsOfProcess(), num_threads_before);
+}
+
+TEST_F(ScannerManagerTests, shouldStartAndStopAllScanners)
+{
+  addScanners(NUM_SCANNERS);
+  for (auto& mock : scanner_mocks_)
+  {
+    mock->startListeningForControlMsg();
+  }
+  for (auto& future : manager_->startAll())
+  {
+    EXPECT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT)) << "Scanner::start() not finished";
+  }
+
+  for (auto& mock : scanner_mocks_)
+  {
+    mock->startListeningForControlMsg();
+  }
+  for (auto& future : manager_->stopAll())
+  {
+    EXPECT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT)) << "Scanner::stop() not finished";
+  }
+}
+
+TEST_F(ScannerManagerTests, shouldInformUserAboutScansOfAllScanners)
+{
+  addScanners(NUM_SCANNERS);
+  const auto msg{ createValidMonitoringFrameMsg() };
+
+  std::vector<std::unique_ptr<util::Barrier>> scan_barriers;
+  for (std::size_t i = 0; i < NUM_SCANNERS; ++i)
+  {
+    scan_barriers.emplace_back(new util::Barrier());
+    EXPECT_CALL(user_callbacks_,
+                LaserScanCallback(i, data_conversion_layer::LaserScanConverter::toLaserScan({ msg })))
+        .WillOnce(OpenBarrier(scan_barriers.back().get()));
+  }
+
+  for (auto& mock : scanner_mocks_)
+  {
+    mock->startListeningForControlMsg();
+  }
+  for (auto& future : manager_->startAll())
+  {
+    ASSERT_EQ(std::future_status::ready, future.wait_for(DEFAULT_TIMEOUT)) << "Scanner::start() not finished";
+  }
+
+  for (auto& mock : scanner_mocks_)
+  {
+    mock->sendMonitoringFrame(msg);
+  }
+  for (std::size_t i = 0; i < NUM_SCANNERS; ++i)
+  {
+    EXPECT_TRUE(scan_barriers[i]->waitTillRelease(DEFAULT_TIMEOUT)) << "No scan of scanner " << i << " received";
+  }
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleMock(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -17,6 +17,8 @@
 #include <functional>
 #include <chrono>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include <boost/asio.hpp>
 
@@ -25,7 +27,9 @@
 
 #include "psen_scan_v2_standalone/util/async_barrier.h"
 #include "psen_scan_v2_standalone/data_conversion_layer/raw_scanner_data.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_filter.h"
 #include "psen_scan_v2_standalone/communication_layer/udp_client.h"
+#include "psen_scan_v2_standalone/communication_layer/uring_udp_client.h"
 
 #include "psen_scan_v2_standalone/communication_layer/mock_udp_server.h"
 
@@ -120,6 +124,12 @@ ACTION_P(OpenBarrier, barrier)
   barrier->release();
 }
 
+class DatagramTapMock : public communication_layer::IDatagramTap
+{
+public:
+  MOCK_METHOD3(tap, void(const std::chrono::nanoseconds&, const char*, const std::size_t&));
+};
+
 TEST_F(UdpClientTests, testGetHostIp)
 {
   EXPECT_EQ(HOST_IP_ADDRESS, udp_client_->getHostIp().to_string());
@@ -145,6 +155,81 @@ TEST_F(UdpClientTests, testSingleAsyncReadOperation)
   EXPECT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
 }
 
+TEST_F(UdpClientTests, shouldCountReceivedDatagramsAndBytes)
+{
+  util::Barrier client_received_data_barrier;
+  EXPECT_CALL(*this, handleNewData(_, send_array_.size())).WillOnce(OpenBarrier(&client_received_data_barrier));
+  EXPECT_EQ(0u, udp_client_->numberOfReceivedDatagrams());
+
+  udp_client_->startAsyncReceiving(communication_layer::ReceiveMode::single);
+  sendTestDataToClient();
+  ASSERT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+  EXPECT_EQ(1u, udp_client_->numberOfReceivedDatagrams());
+  EXPECT_EQ(send_array_.size(), udp_client_->numberOfReceivedBytes());
+}
+
+#ifdef __linux__
+//! @returns the fixed fields of a monitoring frame with the given values, followed by a few bytes of payload.
+static data_conversion_layer::RawData createFrameHeader(const uint32_t& op_code,
+                                                        const uint32_t& working_mode,
+                                                        const uint32_t& transaction_type)
+{
+  data_conversion_layer::RawData data(24, 0);
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    data[4 + i] = static_cast<char>((op_code >> (8 * i)) & 0xFF);
+    data[8 + i] = static_cast<char>((working_mode >> (8 * i)) & 0xFF);
+    data[12 + i] = static_cast<char>((transaction_type >> (8 * i)) & 0xFF);
+  }
+  return data;
+}
+
+TEST_F(UdpClientTests, shouldDropForeignDatagramsWithMonitoringFrameFilter)
+{
+  using namespace data_conversion_layer::monitoring_frame;
+  const auto frame{ createFrameHeader(OP_CODE_MONITORING_FRAME, ONLINE_WORKING_MODE, GUI_MONITORING_TRANSACTION) };
+  util::Barrier client_received_data_barrier;
+  EXPECT_CALL(*this, handleNewData(_, frame.size())).WillOnce(OpenBarrier(&client_received_data_barrier));
+  ASSERT_TRUE(udp_client_->attachSocketFilter(createSocketFilter()));
+
+  udp_client_->startAsyncReceiving(communication_layer::ReceiveMode::single);
+  // Datagrams arrive in order on the loopback interface, so the foreign ones are handled before the frame.
+  mock_udp_server_.asyncSend(host_endpoint, createFrameHeader(0xCB, ONLINE_WORKING_MODE, GUI_MONITORING_TRANSACTION));
+  mock_udp_server_.asyncSend(host_endpoint, createFrameHeader(OP_CODE_MONITORING_FRAME, 1, GUI_MONITORING_TRANSACTION));
+  mock_udp_server_.asyncSend(host_endpoint, createFrameHeader(OP_CODE_MONITORING_FRAME, ONLINE_WORKING_MODE, 6));
+  sendTestDataToClient();
+  mock_udp_server_.asyncSend(host_endpoint, frame);
+
+  ASSERT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+  EXPECT_EQ(1u, udp_client_->numberOfReceivedDatagrams());
+  EXPECT_EQ(4u, udp_client_->numberOfDroppedDatagrams());
+}
+#endif
+
+TEST_F(UdpClientTests, shouldPassReceivedDatagramWithReceiveTimeToTap)
+{
+  std::unique_ptr<DatagramTapMock> tap{ new DatagramTapMock() };
+  std::chrono::nanoseconds receive_time{ 0 };
+  std::string tapped_data;
+  EXPECT_CALL(*tap, tap(_, _, send_array_.size()))
+      .WillOnce(Invoke([&](const std::chrono::nanoseconds& time, const char* data, const std::size_t& length) {
+        receive_time = time;
+        tapped_data.assign(data, length);
+      }));
+  udp_client_->addDatagramTap(std::move(tap));
+
+  util::Barrier client_received_data_barrier;
+  EXPECT_CALL(*this, handleNewData(_, send_array_.size())).WillOnce(OpenBarrier(&client_received_data_barrier));
+  const auto send_time{ std::chrono::system_clock::now().time_since_epoch() };
+  udp_client_->startAsyncReceiving(communication_layer::ReceiveMode::single);
+  sendTestDataToClient();
+  ASSERT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+
+  EXPECT_EQ(std::string(send_array_.begin(), send_array_.end()), tapped_data);
+  EXPECT_GE(receive_time, std::chrono::duration_cast<std::chrono::nanoseconds>(send_time));
+  EXPECT_LT(receive_time - send_time, DEFAULT_TIMEOUT);
+}
+
 TEST_F(UdpClientTests, Should_NotCallErrorHandler_WhenDestroyedWhileAsyncReceivePending)
 {
   EXPECT_CALL(*this, handleError(_)).Times(0);
@@ -163,6 +248,38 @@ TEST_F(UdpClientTests, testErrorHandlingForReceive)
   EXPECT_TRUE(error_handler_called_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Error handler should have been called";
 }
 
+TEST(ReceiveBufferSizeTest, shouldHoldOneByteMoreThanTheLargestDatagramInWholeCacheLines)
+{
+  EXPECT_EQ(64u, communication_layer::receiveBufferSize(16));
+  EXPECT_EQ(64u, communication_layer::receiveBufferSize(63));
+  EXPECT_EQ(128u, communication_layer::receiveBufferSize(64));
+  EXPECT_EQ(65536u, communication_layer::receiveBufferSize(data_conversion_layer::MAX_UDP_PAKET_SIZE));
+}
+
+TEST_F(UdpClientTests, shouldCallErrorHandlerInsteadOfDataHandlerOnTruncatedDatagram)
+{
+  // The client of the fixture occupies the port.
+  udp_client_.reset();
+  udp_client_.reset(new communication_layer::UdpClientImpl(std::bind(&UdpClientTests::handleNewData, this, _1, _2),
+                                                           std::bind(&UdpClientTests::handleError, this, _1),
+                                                           HOST_UDP_PORT,
+                                                           INADDR_LOOPBACK,
+                                                           UDP_MOCK_PORT,
+                                                           util::ThreadSettings(),
+                                                           send_array_.size()));
+  util::Barrier error_handler_called_barrier;
+  util::Barrier client_received_data_barrier;
+  EXPECT_CALL(*this, handleError(_)).WillOnce(OpenBarrier(&error_handler_called_barrier));
+  EXPECT_CALL(*this, handleNewData(_, send_array_.size())).WillOnce(OpenBarrier(&client_received_data_barrier));
+
+  udp_client_->startAsyncReceiving();
+  const data_conversion_layer::RawData oversized_datagram(communication_layer::receiveBufferSize(send_array_.size()));
+  mock_udp_server_.asyncSend(host_endpoint, oversized_datagram);
+  sendTestDataToClient();
+  EXPECT_TRUE(error_handler_called_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Error handler should have been called";
+  EXPECT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+}
+
 TEST_F(UdpClientTests, testWriteOperation)
 {
   std::string str = "Hello!";
@@ -201,6 +318,232 @@ TEST_F(UdpClientTests, testWritingWhileReceiving)
   EXPECT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
 }
 
+#ifdef PSENSCAN_ENABLE_IO_URING
+class UringUdpClientTests : public UdpClientTests
+{
+protected:
+  std::unique_ptr<communication_layer::UringUdpClient>
+  createUringClient(const std::size_t& number_of_buffers,
+                    const std::size_t& max_datagram_size = data_conversion_layer::MAX_UDP_PAKET_SIZE)
+  {
+    // The client of the base fixture occupies the port.
+    udp_client_.reset();
+    return std::unique_ptr<communication_layer::UringUdpClient>(
+        new communication_layer::UringUdpClient(std::bind(&UdpClientTests::handleNewData, this, _1, _2),
+                                                std::bind(&UdpClientTests::handleError, this, _1),
+                                                HOST_UDP_PORT,
+                                                INADDR_LOOPBACK,
+                                                UDP_MOCK_PORT,
+                                                util::ThreadSettings(),
+                                                number_of_buffers,
+                                                max_datagram_size));
+  }
+};
+
+TEST_F(UringUdpClientTests, shouldReturnHostIp)
+{
+  const auto uring_client{ createUringClient(communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS) };
+  EXPECT_EQ(HOST_IP_ADDRESS, uring_client->getHostIp().to_string());
+}
+
+TEST_F(UringUdpClientTests, shouldReceiveMoreDatagramsThanBuffersWhileReceivingContinuously)
+{
+  static constexpr std::size_t NUMBER_OF_DATAGRAMS{ 20 };
+  const auto uring_client{ createUringClient(2) };
+  util::Barrier client_received_data_barrier;
+  std::size_t received{ 0 };
+  EXPECT_CALL(*this, handleNewData(_, send_array_.size()))
+      .Times(static_cast<int>(NUMBER_OF_DATAGRAMS))
+      .WillRepeatedly(InvokeWithoutArgs([&]() {
+        if (++received == NUMBER_OF_DATAGRAMS)
+        {
+          client_received_data_barrier.release();
+        }
+      }));
+
+  uring_client->startAsyncReceiving();
+  for (std::size_t i = 0; i < NUMBER_OF_DATAGRAMS; ++i)
+  {
+    sendTestDataToClient();
+  }
+  ASSERT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+  EXPECT_EQ(NUMBER_OF_DATAGRAMS, uring_client->numberOfReceivedDatagrams());
+  EXPECT_EQ(NUMBER_OF_DATAGRAMS * send_array_.size(), uring_client->numberOfReceivedBytes());
+}
+
+TEST_F(UringUdpClientTests, shouldReceiveOnlyOneDatagramInSingleMode)
+{
+  const auto uring_client{ createUringClient(communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS) };
+  util::Barrier client_received_data_barrier;
+  EXPECT_CALL(*this, handleNewData(_, send_array_.size())).WillOnce(OpenBarrier(&client_received_data_barrier));
+
+  uring_client->startAsyncReceiving(communication_layer::ReceiveMode::single);
+  sendTestDataToClient();
+  sendTestDataToClient();
+  ASSERT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(1u, uring_client->numberOfReceivedDatagrams());
+}
+
+TEST_F(UringUdpClientTests, shouldDropForeignDatagramsWithMonitoringFrameFilter)
+{
+  using namespace data_conversion_layer::monitoring_frame;
+  const auto uring_client{ createUringClient(communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS) };
+  const auto frame{ createFrameHeader(OP_CODE_MONITORING_FRAME, ONLINE_WORKING_MODE, GUI_MONITORING_TRANSACTION) };
+  util::Barrier client_received_data_barrier;
+  EXPECT_CALL(*this, handleNewData(_, frame.size())).WillOnce(OpenBarrier(&client_received_data_barrier));
+  ASSERT_TRUE(uring_client->attachSocketFilter(createSocketFilter()));
+
+  uring_client->startAsyncReceiving();
+  sendTestDataToClient();
+  mock_udp_server_.asyncSend(host_endpoint, frame);
+
+  ASSERT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+  EXPECT_EQ(1u, uring_client->numberOfReceivedDatagrams());
+  EXPECT_EQ(1u, uring_client->numberOfDroppedDatagrams());
+}
+
+TEST_F(UringUdpClientTests, shouldPassReceivedDatagramToTap)
+{
+  const auto uring_client{ createUringClient(communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS) };
+  std::unique_ptr<DatagramTapMock> tap{ new DatagramTapMock() };
+  std::chrono::nanoseconds receive_time{ 0 };
+  std::string tapped_data;
+  EXPECT_CALL(*tap, tap(_, _, send_array_.size()))
+      .WillOnce(Invoke([&](const std::chrono::nanoseconds& time, const char* data, const std::size_t& length) {
+        receive_time = time;
+        tapped_data.assign(data, length);
+      }));
+  uring_client->addDatagramTap(std::move(tap));
+
+  util::Barrier client_received_data_barrier;
+  EXPECT_CALL(*this, handleNewData(_, send_array_.size())).WillOnce(OpenBarrier(&client_received_data_barrier));
+  const auto send_time{ std::chrono::system_clock::now().time_since_epoch() };
+  uring_client->startAsyncReceiving(communication_layer::ReceiveMode::single);
+  sendTestDataToClient();
+  ASSERT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+
+  EXPECT_EQ(std::string(send_array_.begin(), send_array_.end()), tapped_data);
+  EXPECT_GE(receive_time, std::chrono::duration_cast<std::chrono::nanoseconds>(send_time));
+  EXPECT_LT(receive_time - send_time, DEFAULT_TIMEOUT);
+}
+
+TEST_F(UringUdpClientTests, shouldPassKernelReceiveTimeOfEachDatagramToTapWhileReceivingContinuously)
+{
+  const auto uring_client{ createUringClient(communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS) };
+  std::unique_ptr<DatagramTapMock> tap{ new DatagramTapMock() };
+  std::vector<std::chrono::nanoseconds> receive_times;
+  EXPECT_CALL(*tap, tap(_, _, send_array_.size()))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](const std::chrono::nanoseconds& time, const char*, const std::size_t&) {
+        receive_times.push_back(time);
+      }));
+  uring_client->addDatagramTap(std::move(tap));
+
+  // The second datagram is received by the kernel while the io thread is still busy with the first one.
+  util::Barrier first_datagram_barrier;
+  util::Barrier client_received_data_barrier;
+  std::chrono::nanoseconds first_datagram_handled{ 0 };
+  std::vector<std::string> received_data;
+  EXPECT_CALL(*this, handleNewData(_, send_array_.size()))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](const data_conversion_layer::RawData& data, const std::size_t& length) {
+        received_data.emplace_back(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(length));
+        if (received_data.size() == 1)
+        {
+          first_datagram_barrier.release();
+          std::this_thread::sleep_for(std::chrono::milliseconds(100));
+          first_datagram_handled = std::chrono::system_clock::now().time_since_epoch();
+        }
+        else
+        {
+          client_received_data_barrier.release();
+        }
+      }));
+
+  uring_client->startAsyncReceiving();
+  sendTestDataToClient();
+  ASSERT_TRUE(first_datagram_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+  sendTestDataToClient();
+  ASSERT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+
+  const std::string sent_data(send_array_.begin(), send_array_.end());
+  EXPECT_EQ(std::vector<std::string>({ sent_data, sent_data }), received_data);
+  ASSERT_EQ(2u, receive_times.size());
+  EXPECT_LT(receive_times[0], receive_times[1]);
+  EXPECT_LT(receive_times[1], first_datagram_handled);
+}
+
+TEST_F(UringUdpClientTests, shouldCallErrorHandlerOnEmptyDatagram)
+{
+  const auto uring_client{ createUringClient(communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS) };
+  util::Barrier error_handler_called_barrier;
+  EXPECT_CALL(*this, handleError(_)).WillOnce(OpenBarrier(&error_handler_called_barrier));
+
+  uring_client->startAsyncReceiving(communication_layer::ReceiveMode::single);
+  sendEmptyTestDataToClient();
+  EXPECT_TRUE(error_handler_called_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Error handler should have been called";
+}
+
+TEST_F(UringUdpClientTests, shouldCallErrorHandlerInsteadOfDataHandlerOnTruncatedDatagram)
+{
+  const auto uring_client{ createUringClient(communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS,
+                                             send_array_.size()) };
+  util::Barrier error_handler_called_barrier;
+  util::Barrier client_received_data_barrier;
+  EXPECT_CALL(*this, handleError(_)).WillOnce(OpenBarrier(&error_handler_called_barrier));
+  EXPECT_CALL(*this, handleNewData(_, send_array_.size())).WillOnce(OpenBarrier(&client_received_data_barrier));
+
+  uring_client->startAsyncReceiving();
+  const data_conversion_layer::RawData oversized_datagram(communication_layer::receiveBufferSize(send_array_.size()));
+  mock_udp_server_.asyncSend(host_endpoint, oversized_datagram);
+  sendTestDataToClient();
+  EXPECT_TRUE(error_handler_called_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Error handler should have been called";
+  EXPECT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+}
+
+TEST_F(UringUdpClientTests, shouldCallErrorHandlerInsteadOfDataHandlerOnTruncatedDatagramWhenTapped)
+{
+  const auto uring_client{ createUringClient(communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS,
+                                             send_array_.size()) };
+  std::unique_ptr<DatagramTapMock> tap{ new DatagramTapMock() };
+  EXPECT_CALL(*tap, tap(_, _, send_array_.size())).Times(1);
+  uring_client->addDatagramTap(std::move(tap));
+  util::Barrier error_handler_called_barrier;
+  util::Barrier client_received_data_barrier;
+  EXPECT_CALL(*this, handleError(_)).WillOnce(OpenBarrier(&error_handler_called_barrier));
+  EXPECT_CALL(*this, handleNewData(_, send_array_.size())).WillOnce(OpenBarrier(&client_received_data_barrier));
+
+  uring_client->startAsyncReceiving();
+  const data_conversion_layer::RawData oversized_datagram(communication_layer::receiveBufferSize(send_array_.size()));
+  mock_udp_server_.asyncSend(host_endpoint, oversized_datagram);
+  sendTestDataToClient();
+  EXPECT_TRUE(error_handler_called_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Error handler should have been called";
+  EXPECT_TRUE(client_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Udp client did not receive data";
+}
+
+TEST_F(UringUdpClientTests, shouldNotCallErrorHandlerWhenDestroyedWhileReceiving)
+{
+  EXPECT_CALL(*this, handleError(_)).Times(0);
+
+  auto uring_client{ createUringClient(communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS) };
+  uring_client->startAsyncReceiving();
+  uring_client.reset();
+}
+
+TEST_F(UringUdpClientTests, shouldWriteData)
+{
+  const auto uring_client{ createUringClient(communication_layer::UringUdpClient::DEFAULT_NUMBER_OF_BUFFERS) };
+  util::Barrier server_mock_received_data_barrier;
+  EXPECT_CALL(*this, receivedUdpMsg(_, send_array_)).WillOnce(OpenBarrier(&server_mock_received_data_barrier));
+
+  mock_udp_server_.asyncReceive();
+  uring_client->write(send_array_);
+
+  EXPECT_TRUE(server_mock_received_data_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Server mock did not receive data";
+}
+#endif
+
 }  // namespace psen_scan_v2_standalone_test
 
 int main(int argc, char* argv[])
@@ -0,0 +1,154 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scanner_config_builder.h"
+#include "psen_scan_v2_standalone/scanner_v2.h"
+#include "psen_scan_v2_standalone/simulation/scanner_simulator.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static const std::string IP_ADDRESS{ "127.0.0.1" };
+// Outside of the port ranges of the ScannerMock tests, so that the tests can run in parallel.
+static constexpr unsigned short SCANNER_CONTROL_PORT{ 4500 };
+static constexpr unsigned short SCANNER_DATA_PORT{ 8500 };
+static constexpr int HOST_CONTROL_PORT{ 58500 };
+static constexpr int HOST_DATA_PORT{ 46500 };
+
+static const ScanRange SCAN_RANGE{ util::TenthOfDegree(0), util::TenthOfDegree(2750) };
+static const util::TenthOfDegree RESOLUTION{ 2 };
+static constexpr std::size_t NUMBER_OF_SCANS{ 3 };
+static constexpr std::chrono::seconds TIMEOUT{ 3 };
+
+class ScannerSimulatorTests : public testing::Test
+{
+protected:
+  ScannerConfiguration generateScannerConfig(const unsigned short& port_offset) const
+  {
+    return ScannerConfigurationBuilder()
+        .hostIP(IP_ADDRESS)
+        .hostDataPort(HOST_DATA_PORT + port_offset)
+        .hostControlPort(HOST_CONTROL_PORT + port_offset)
+        .scannerIp(IP_ADDRESS)
+        .scannerDataPort(SCANNER_DATA_PORT + port_offset)
+        .scannerControlPort(SCANNER_CONTROL_PORT + port_offset)
+        .scanRange(SCAN_RANGE)
+        .scanResolution(RESOLUTION)
+        .enableIntensities(true)
+        .enableDiagnostics(true)
+        .build();
+  }
+
+  simulation::SimulationParameters fastParameters() const
+  {
+    simulation::SimulationParameters parameters;
+    parameters.scan_rate_hz = 10 * simulation::DEFAULT_SCAN_RATE_HZ;
+    return parameters;
+  }
+};
+
+TEST_F(ScannerSimulatorTests, shouldDeliverCompleteScansOfRequestedRange)
+{
+  const unsigned short port_offset{ 0 };
+  simulation::ScannerSimulator simulator(
+      IP_ADDRESS, SCANNER_CONTROL_PORT + port_offset, SCANNER_DATA_PORT + port_offset, fastParameters());
+
+  std::atomic<std::size_t> number_of_scans{ 0 };
+  std::promise<LaserScan> last_scan;
+  ScannerV2 scanner(generateScannerConfig(port_offset), [&](const LaserScan& scan) {
+    if (++number_of_scans == NUMBER_OF_SCANS)
+    {
+      last_scan.set_value(scan);
+    }
+  });
+  ASSERT_EQ(std::future_status::ready, scanner.start().wait_for(TIMEOUT));
+
+  auto last_scan_future{ last_scan.get_future() };
+  ASSERT_EQ(std::future_status::ready, last_scan_future.wait_for(TIMEOUT));
+  const LaserScan scan{ last_scan_future.get() };
+  EXPECT_EQ(SCAN_RANGE.getStart(), scan.getMinScanAngle());
+  EXPECT_EQ(RESOLUTION, scan.getScanResolution());
+  EXPECT_EQ(static_cast<std::size_t>(SCAN_RANGE.getEnd().value() / RESOLUTION.value()),
+            scan.getMeasurements().size());
+  EXPECT_EQ(scan.getMeasurements().size(), scan.getIntensities().size());
+
+  EXPECT_EQ(std::future_status::ready, scanner.stop().wait_for(TIMEOUT));
+  const simulation::SimulatorStatistics statistics{ simulator.statistics() };
+  EXPECT_EQ(1u, statistics.start_requests);
+  EXPECT_EQ(1u, statistics.stop_requests);
+  EXPECT_GE(statistics.scan_rounds, NUMBER_OF_SCANS);
+}
+
+TEST_F(ScannerSimulatorTests, shouldNotDeliverScansIfAllFramesAreLost)
+{
+  const unsigned short port_offset{ 1 };
+  simulation::SimulationParameters parameters{ fastParameters() };
+  parameters.loss_probability = 1.;
+  simulation::ScannerSimulator simulator(
+      IP_ADDRESS, SCANNER_CONTROL_PORT + port_offset, SCANNER_DATA_PORT + port_offset, parameters);
+
+  std::atomic<std::size_t> number_of_scans{ 0 };
+  ScannerV2 scanner(generateScannerConfig(port_offset), [&](const LaserScan&) { ++number_of_scans; });
+  ASSERT_EQ(std::future_status::ready, scanner.start().wait_for(TIMEOUT));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(std::future_status::ready, scanner.stop().wait_for(TIMEOUT));
+
+  EXPECT_EQ(0u, number_of_scans);
+  const simulation::SimulatorStatistics statistics{ simulator.statistics() };
+  EXPECT_EQ(0u, statistics.sent_frames);
+  EXPECT_GT(statistics.lost_frames, 0u);
+}
+
+TEST_F(ScannerSimulatorTests, shouldDeliverScansDespiteReorderedFrames)
+{
+  const unsigned short port_offset{ 2 };
+  simulation::SimulationParameters parameters{ fastParameters() };
+  parameters.reorder_probability = 1.;
+  parameters.jitter = std::chrono::microseconds(100);
+  simulation::ScannerSimulator simulator(
+      IP_ADDRESS, SCANNER_CONTROL_PORT + port_offset, SCANNER_DATA_PORT + port_offset, parameters);
+
+  std::promise<void> scans_received;
+  std::atomic<std::size_t> number_of_scans{ 0 };
+  ScannerV2 scanner(generateScannerConfig(port_offset), [&](const LaserScan&) {
+    if (++number_of_scans == NUMBER_OF_SCANS)
+    {
+      scans_received.set_value();
+    }
+  });
+  ASSERT_EQ(std::future_status::ready, scanner.start().wait_for(TIMEOUT));
+  EXPECT_EQ(std::future_status::ready, scans_received.get_future().wait_for(TIMEOUT));
+  EXPECT_EQ(std::future_status::ready, scanner.stop().wait_for(TIMEOUT));
+
+  EXPECT_GT(simulator.statistics().reordered_frames, 0u);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -118,6 +118,11 @@ void ScannerMock::sendMonitoringFrame(const data_conversion_layer::monitoring_fr
   data_server_.asyncSend(monitoring_frame_receiver_, data_conversion_layer::monitoring_frame::serialize(msg));
 }
 
+void ScannerMock::sendSerializedMonitoringFrame(const data_conversion_layer::RawData& data)
+{
+  data_server_.asyncSend(monitoring_frame_receiver_, data);
+}
+
 void ScannerMock::sendEmptyMonitoringFrame()
 {
   psen_scan_v2_standalone::data_conversion_layer::RawData data;
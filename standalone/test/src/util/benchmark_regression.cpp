@@ -0,0 +1,340 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+#include "psen_scan_v2_standalone/util/benchmark_regression.h"
+
+namespace psen_scan_v2_standalone_test
+{
+namespace benchmark_regression
+{
+namespace
+{
+class RecordParser
+{
+public:
+  explicit RecordParser(const std::string& line) : line_(line)
+  {
+  }
+
+  Record parse()
+  {
+    Record record;
+    expect('{');
+    if (peek() == '}')
+    {
+      ++pos_;
+      return finish(record);
+    }
+    while (true)
+    {
+      const std::string field{ parseString() };
+      expect(':');
+      record[field] = parseValue();
+      if (peek() == ',')
+      {
+        ++pos_;
+        continue;
+      }
+      expect('}');
+      return finish(record);
+    }
+  }
+
+private:
+  char peek()
+  {
+    while (pos_ < line_.size() && std::isspace(static_cast<unsigned char>(line_[pos_])))
+    {
+      ++pos_;
+    }
+    return pos_ < line_.size() ? line_[pos_] : '\0';
+  }
+
+  void expect(const char& c)
+  {
+    if (peek() != c)
+    {
+      fail(std::string("expected '") + c + "'");
+    }
+    ++pos_;
+  }
+
+  std::string parseString()
+  {
+    expect('"');
+    std::string value;
+    while (pos_ < line_.size() && line_[pos_] != '"')
+    {
+      if (line_[pos_] == '\\' && pos_ + 1 < line_.size())
+      {
+        ++pos_;
+      }
+      value += line_[pos_++];
+    }
+    if (pos_ >= line_.size())
+    {
+      fail("unterminated string");
+    }
+    ++pos_;
+    return value;
+  }
+
+  std::string parseValue()
+  {
+    const char c{ peek() };
+    if (c == '"')
+    {
+      return parseString();
+    }
+    if (c == '{' || c == '[')
+    {
+      fail("nested objects and arrays are not supported");
+    }
+    const std::size_t begin{ pos_ };
+    while (pos_ < line_.size() && line_[pos_] != ',' && line_[pos_] != '}' &&
+           !std::isspace(static_cast<unsigned char>(line_[pos_])))
+    {
+      ++pos_;
+    }
+    if (pos_ == begin)
+    {
+      fail("missing value");
+    }
+    return line_.substr(begin, pos_ - begin);
+  }
+
+  Record finish(const Record& record)
+  {
+    if (peek() != '\0')
+    {
+      fail("trailing characters");
+    }
+    return record;
+  }
+
+  void fail(const std::string& reason) const
+  {
+    throw std::invalid_argument("Invalid benchmark record (" + reason + " at position " + std::to_string(pos_) +
+                                "): " + line_);
+  }
+
+private:
+  const std::string& line_;
+  std::size_t pos_{ 0 };
+};
+
+std::string field(const Record& record, const std::string& name)
+{
+  const auto it{ record.find(name) };
+  return it != record.end() ? it->second : std::string();
+}
+
+double toNumber(const std::string& value, const std::string& description)
+{
+  try
+  {
+    std::size_t parsed{ 0 };
+    const double number{ std::stod(value, &parsed) };
+    if (parsed == value.size())
+    {
+      return number;
+    }
+  }
+  catch (const std::logic_error&)
+  {
+  }
+  throw std::invalid_argument(description + " is no number: \"" + value + "\"");
+}
+
+//! @returns the benchmark and the key of the record, which identify it within the results.
+std::string recordId(const Record& record, const Rules& rules)
+{
+  const std::string benchmark{ field(record, "benchmark") };
+  const auto key{ rules.keys.find(benchmark) };
+  if (key == rules.keys.end())
+  {
+    return benchmark;
+  }
+  return benchmark + " " + key->second + "=" + field(record, key->second);
+}
+}  // namespace
+
+Record parseRecord(const std::string& line)
+{
+  return RecordParser(line).parse();
+}
+
+std::vector<Record> readRecords(std::istream& is)
+{
+  std::vector<Record> records;
+  std::string line;
+  while (std::getline(is, line))
+  {
+    const auto begin{ line.find_first_not_of(" \t\r") };
+    if (begin != std::string::npos && line[begin] == '{')
+    {
+      records.push_back(parseRecord(line));
+    }
+  }
+  return records;
+}
+
+double Tolerance::limit(const double& baseline) const
+{
+  const double slack{ relative * std::abs(baseline) + absolute };
+  return direction == Direction::lower_is_better ? baseline + slack : baseline - slack;
+}
+
+bool Tolerance::isRegression(const double& baseline, const double& current) const
+{
+  return direction == Direction::lower_is_better ? current > limit(baseline) : current < limit(baseline);
+}
+
+Rules parseRules(const std::vector<Record>& records)
+{
+  Rules rules;
+  for (const auto& record : records)
+  {
+    const std::string benchmark{ field(record, "benchmark") };
+    if (benchmark.empty())
+    {
+      throw std::invalid_argument("Rule without benchmark");
+    }
+    if (record.count("key"))
+    {
+      rules.keys[benchmark] = field(record, "key");
+      continue;
+    }
+
+    Tolerance tolerance;
+    tolerance.benchmark = benchmark;
+    tolerance.metric = field(record, "metric");
+    if (tolerance.metric.empty())
+    {
+      throw std::invalid_argument("Rule of benchmark " + benchmark + " has neither key nor metric");
+    }
+    const std::string better{ field(record, "better") };
+    if (better == "lower")
+    {
+      tolerance.direction = Direction::lower_is_better;
+    }
+    else if (better == "higher")
+    {
+      tolerance.direction = Direction::higher_is_better;
+    }
+    else
+    {
+      throw std::invalid_argument("Rule of " + benchmark + " " + tolerance.metric +
+                                  " needs \"better\": \"lower\" or \"higher\"");
+    }
+    const std::string description{ "Tolerance of " + benchmark + " " + tolerance.metric };
+    if (record.count("relative"))
+    {
+      tolerance.relative = toNumber(field(record, "relative"), description);
+    }
+    if (record.count("absolute"))
+    {
+      tolerance.absolute = toNumber(field(record, "absolute"), description);
+    }
+    if (tolerance.relative < 0. || tolerance.absolute < 0.)
+    {
+      throw std::invalid_argument(description + " must not be negative");
+    }
+    rules.tolerances.push_back(tolerance);
+  }
+  return rules;
+}
+
+Environment environment(const std::vector<Record>& records)
+{
+  for (const auto& record : records)
+  {
+    if (field(record, "benchmark") != "environment")
+    {
+      continue;
+    }
+    Environment environment;
+    environment.build_type = field(record, "build_type");
+    environment.host = field(record, "host");
+    if (environment.build_type.empty())
+    {
+      throw std::invalid_argument("Environment without build type, set e.g. CMAKE_BUILD_TYPE=Release");
+    }
+    return environment;
+  }
+  throw std::invalid_argument("No environment record");
+}
+
+bool CheckResult::passed() const
+{
+  if (!missing.empty())
+  {
+    return false;
+  }
+  for (const auto& comparison : comparisons)
+  {
+    if (comparison.regression)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+CheckResult check(const std::vector<Record>& baseline, const std::vector<Record>& current, const Rules& rules)
+{
+  std::map<std::string, const Record*> current_by_id;
+  for (const auto& record : current)
+  {
+    current_by_id[recordId(record, rules)] = &record;
+  }
+
+  CheckResult result;
+  for (const auto& baseline_record : baseline)
+  {
+    const std::string id{ recordId(baseline_record, rules) };
+    const auto current_record{ current_by_id.find(id) };
+    for (const auto& tolerance : rules.tolerances)
+    {
+      if (tolerance.benchmark != field(baseline_record, "benchmark") || !baseline_record.count(tolerance.metric))
+      {
+        continue;
+      }
+      if (current_record == current_by_id.end() || !current_record->second->count(tolerance.metric))
+      {
+        result.missing.push_back(id + " " + tolerance.metric);
+        continue;
+      }
+      Comparison comparison;
+      comparison.record = id;
+      comparison.metric = tolerance.metric;
+      comparison.baseline =
+          toNumber(field(baseline_record, tolerance.metric), "Baseline of " + id + " " + tolerance.metric);
+      comparison.current =
+          toNumber(field(*current_record->second, tolerance.metric), "Result of " + id + " " + tolerance.metric);
+      comparison.limit = tolerance.limit(comparison.baseline);
+      comparison.regression = tolerance.isRegression(comparison.baseline, comparison.current);
+      result.comparisons.push_back(comparison);
+    }
+  }
+  return result;
+}
+
+}  // namespace benchmark_regression
+}  // namespace psen_scan_v2_standalone_test
@@ -0,0 +1,261 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/capture_converter.h"
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/laserscan_conversions.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_deserialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
+#include "psen_scan_v2_standalone/util/tenth_of_degree.h"
+
+using namespace psen_scan_v2_standalone;
+using communication_layer::RecordedDatagram;
+using data_conversion_layer::monitoring_frame::Message;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr std::size_t FRAMES_PER_ROUND{ 6 };
+static constexpr int16_t MEASUREMENTS_PER_FRAME{ 10 };
+static constexpr uint32_t NUMBER_OF_ROUNDS{ 50 };
+
+static Message createFrame(const uint32_t& scan_counter, const std::size_t& fragment)
+{
+  std::vector<double> measurements;
+  for (int16_t i = 0; i < MEASUREMENTS_PER_FRAME; ++i)
+  {
+    measurements.push_back(static_cast<double>(scan_counter * 100 + fragment * 10 + i) / 1000.);
+  }
+  return Message(util::TenthOfDegree(static_cast<int16_t>(fragment * MEASUREMENTS_PER_FRAME)),
+                 util::TenthOfDegree(1),
+                 scan_counter,
+                 measurements);
+}
+
+static RecordedDatagram createDatagram(const Message& frame, const int64_t& timestamp)
+{
+  RecordedDatagram datagram;
+  datagram.timestamp = std::chrono::nanoseconds(timestamp);
+  datagram.data = data_conversion_layer::monitoring_frame::serialize(frame);
+  return datagram;
+}
+
+static std::vector<RecordedDatagram> createDatagrams()
+{
+  std::vector<RecordedDatagram> datagrams;
+  for (uint32_t scan_counter = 1; scan_counter <= NUMBER_OF_ROUNDS; ++scan_counter)
+  {
+    for (std::size_t fragment = 0; fragment < FRAMES_PER_ROUND; ++fragment)
+    {
+      datagrams.push_back(createDatagram(createFrame(scan_counter, fragment), datagrams.size()));
+    }
+  }
+  return datagrams;
+}
+
+//! @returns the scan the driver would create from the given datagrams.
+//! @returns the datagrams with incomplete rounds and outdated frames spread over the whole capture.
+static std::vector<RecordedDatagram> createDisorderedDatagrams()
+{
+  auto datagrams{ createDatagrams() };
+  // Works backwards, so that the positions of the earlier rounds stay valid.
+  for (std::size_t round = NUMBER_OF_ROUNDS; round-- > 0;)
+  {
+    const auto begin{ datagrams.begin() + static_cast<std::ptrdiff_t>(round * FRAMES_PER_ROUND) };
+    if (round % 7 == 3)
+    {
+      // Repeats a frame of the previous round after the first frame of this round.
+      const auto outdated_frame{ createFrame(static_cast<uint32_t>(round), 1) };
+      datagrams.insert(begin + 1, createDatagram(outdated_frame, begin->timestamp.count()));
+    }
+    if (round % 3 == 0)
+    {
+      datagrams.erase(begin + FRAMES_PER_ROUND - 1);
+    }
+    else if (round % 3 == 1)
+    {
+      datagrams.erase(begin);
+    }
+  }
+  return datagrams;
+}
+
+static LaserScan expectedScan(const std::vector<RecordedDatagram>& datagrams)
+{
+  std::vector<Message> frames;
+  for (const auto& datagram : datagrams)
+  {
+    frames.push_back(data_conversion_layer::monitoring_frame::deserialize(datagram.data, datagram.data.size()));
+  }
+  return data_conversion_layer::LaserScanConverter::toLaserScan(frames);
+}
+
+static uint32_t scanCounterOf(const RecordedDatagram& datagram)
+{
+  return data_conversion_layer::monitoring_frame::deserialize(datagram.data, datagram.data.size()).scanCounter();
+}
+
+TEST(CaptureConverterTest, shouldConvertEachScanRound)
+{
+  const auto datagrams{ createDatagrams() };
+  std::vector<CapturedScan> scans;
+  const CaptureConversionStatistics statistics{ CaptureConverter(false, 3).convert(
+      datagrams, [&scans](const CapturedScan& scan) { scans.push_back(scan); }) };
+
+  ASSERT_EQ(NUMBER_OF_ROUNDS, scans.size());
+  for (std::size_t round = 0; round < NUMBER_OF_ROUNDS; ++round)
+  {
+    const auto begin{ datagrams.begin() + static_cast<std::ptrdiff_t>(round * FRAMES_PER_ROUND) };
+    EXPECT_EQ(expectedScan({ begin, begin + FRAMES_PER_ROUND }), scans[round].scan);
+    EXPECT_EQ((begin + FRAMES_PER_ROUND - 1)->timestamp, scans[round].timestamp);
+  }
+  EXPECT_EQ(datagrams.size(), statistics.datagrams);
+  EXPECT_EQ(NUMBER_OF_ROUNDS, statistics.scans);
+  EXPECT_EQ(0u, statistics.decode_errors);
+  EXPECT_EQ(0u, statistics.dropped_rounds);
+}
+
+TEST(CaptureConverterTest, shouldProduceSameScansWithAnyNumberOfThreads)
+{
+  const auto datagrams{ createDatagrams() };
+  const auto expected_scans{ CaptureConverter(false, 1).convert(datagrams) };
+  for (const std::size_t threads : { 2, 4, 7 })
+  {
+    const auto scans{ CaptureConverter(false, threads).convert(datagrams) };
+    ASSERT_EQ(expected_scans.size(), scans.size());
+    for (std::size_t i = 0; i < scans.size(); ++i)
+    {
+      EXPECT_EQ(expected_scans[i].scan, scans[i].scan);
+      EXPECT_EQ(expected_scans[i].timestamp, scans[i].timestamp);
+    }
+  }
+}
+
+TEST(CaptureConverterTest, shouldProduceSameResultWithAnyNumberOfThreadsIfRoundsAreIncomplete)
+{
+  const auto datagrams{ createDisorderedDatagrams() };
+  std::vector<CapturedScan> expected_scans;
+  const CaptureConversionStatistics expected_statistics{ CaptureConverter(false, 1).convert(
+      datagrams, [&expected_scans](const CapturedScan& scan) { expected_scans.push_back(scan); }) };
+  ASSERT_GT(expected_statistics.dropped_rounds, 0u);
+  ASSERT_GT(expected_statistics.outdated_frames, 0u);
+
+  for (const std::size_t threads : { 2, 3, 4, 5, 7, 8 })
+  {
+    std::vector<CapturedScan> scans;
+    const CaptureConversionStatistics statistics{ CaptureConverter(false, threads).convert(
+        datagrams, [&scans](const CapturedScan& scan) { scans.push_back(scan); }) };
+    EXPECT_EQ(expected_statistics.datagrams, statistics.datagrams) << threads << " threads";
+    EXPECT_EQ(expected_statistics.scans, statistics.scans) << threads << " threads";
+    EXPECT_EQ(expected_statistics.decode_errors, statistics.decode_errors) << threads << " threads";
+    EXPECT_EQ(expected_statistics.dropped_rounds, statistics.dropped_rounds) << threads << " threads";
+    EXPECT_EQ(expected_statistics.outdated_frames, statistics.outdated_frames) << threads << " threads";
+    ASSERT_EQ(expected_scans.size(), scans.size()) << threads << " threads";
+    for (std::size_t i = 0; i < scans.size(); ++i)
+    {
+      EXPECT_EQ(expected_scans[i].scan, scans[i].scan);
+      EXPECT_EQ(expected_scans[i].timestamp, scans[i].timestamp);
+    }
+  }
+}
+
+TEST(CaptureConverterTest, shouldStartChunksAtScanRounds)
+{
+  const auto datagrams{ createDatagrams() };
+  const auto chunks{ CaptureConverter::findChunks(datagrams, 7) };
+  ASSERT_EQ(7u, chunks.size());
+  EXPECT_EQ(0u, chunks[0]);
+  for (std::size_t i = 1; i < chunks.size(); ++i)
+  {
+    EXPECT_GT(chunks[i], chunks[i - 1]);
+    EXPECT_LT(scanCounterOf(datagrams[chunks[i] - 1]), scanCounterOf(datagrams[chunks[i]]));
+  }
+}
+
+TEST(CaptureConverterTest, shouldNotStartChunksAtOutdatedFrames)
+{
+  const auto datagrams{ createDisorderedDatagrams() };
+  const auto chunks{ CaptureConverter::findChunks(datagrams, 16) };
+  for (std::size_t i = 1; i < chunks.size(); ++i)
+  {
+    for (std::size_t j = 0; j < chunks[i]; ++j)
+    {
+      EXPECT_LT(scanCounterOf(datagrams[j]), scanCounterOf(datagrams[chunks[i]]));
+    }
+  }
+}
+
+TEST(CaptureConverterTest, shouldReturnFewerChunksThanRequestedForShortCaptures)
+{
+  auto datagrams{ createDatagrams() };
+  datagrams.resize(2 * FRAMES_PER_ROUND);
+  EXPECT_EQ((std::vector<std::size_t>{ 0, FRAMES_PER_ROUND }), CaptureConverter::findChunks(datagrams, 100));
+  EXPECT_TRUE(CaptureConverter::findChunks({}, 4).empty());
+}
+
+TEST(CaptureConverterTest, shouldSkipInvalidDatagrams)
+{
+  auto datagrams{ createDatagrams() };
+  RecordedDatagram invalid_datagram;
+  invalid_datagram.data = data_conversion_layer::RawData(20, 'x');
+  datagrams.insert(datagrams.begin() + 3, invalid_datagram);
+
+  const CaptureConversionStatistics statistics{ CaptureConverter(false, 2).convert(datagrams,
+                                                                                   [](const CapturedScan&) {}) };
+  EXPECT_EQ(1u, statistics.decode_errors);
+  EXPECT_EQ(NUMBER_OF_ROUNDS, statistics.scans);
+}
+
+TEST(CaptureConverterTest, shouldDropIncompleteRounds)
+{
+  auto datagrams{ createDatagrams() };
+  // Removes a frame of the second round.
+  datagrams.erase(datagrams.begin() + FRAMES_PER_ROUND + 2);
+
+  const auto scans{ CaptureConverter(false, 1).convert(datagrams) };
+  ASSERT_EQ(NUMBER_OF_ROUNDS - 1, scans.size());
+  EXPECT_EQ(1u, scans[0].scan.getScanCounter());
+  EXPECT_EQ(3u, scans[1].scan.getScanCounter());
+}
+
+TEST(CaptureConverterTest, shouldConvertEachFrameIfFragmentedScansAreEnabled)
+{
+  const auto datagrams{ createDatagrams() };
+  const auto scans{ CaptureConverter(true, 2).convert(datagrams) };
+  ASSERT_EQ(datagrams.size(), scans.size());
+  for (std::size_t i = 0; i < datagrams.size(); ++i)
+  {
+    EXPECT_EQ(expectedScan({ datagrams[i] }), scans[i].scan);
+  }
+}
+
+TEST(CaptureConverterTest, shouldThrowWithoutThreads)
+{
+  EXPECT_THROW(CaptureConverter(false, 0), std::invalid_argument);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -54,6 +54,25 @@ TEST(LaserScanTest, testGetScanResolution)
   EXPECT_EQ(expected_resolution, laser_scan->getScanResolution());
 }
 
+TEST(LaserScanTest, testSetScanCounter)
+{
+  LaserScan laser_scan(DEFAULT_RESOLUTION, DEFAULT_START_ANGLE, DEFAULT_END_ANGLE);
+  EXPECT_EQ(0u, laser_scan.getScanCounter());
+
+  laser_scan.setScanCounter(42u);
+  EXPECT_EQ(42u, laser_scan.getScanCounter());
+}
+
+TEST(LaserScanTest, testScansOfDifferentRoundsAreNotEqual)
+{
+  LaserScan laser_scan(DEFAULT_RESOLUTION, DEFAULT_START_ANGLE, DEFAULT_END_ANGLE);
+  LaserScan next_round{ laser_scan };
+  EXPECT_EQ(laser_scan, next_round);
+
+  next_round.setScanCounter(1u);
+  EXPECT_FALSE(laser_scan == next_round);
+}
+
 TEST(LaserScanTest, testGetMinScanAngle)
 {
   const auto expected_min_scan_angle{ DEFAULT_START_ANGLE };
@@ -0,0 +1,126 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/communication_layer/replay_source.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/replay_scanner.h"
+#include "psen_scan_v2_standalone/scanner_config_builder.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr std::size_t FRAMES_PER_ROUND{ 6 };
+static constexpr int16_t FRAME_WIDTH{ 100 };
+static const util::TenthOfDegree RESOLUTION{ 1 };
+
+static ScannerConfiguration createConfig(const bool& fragmented)
+{
+  return ScannerConfigurationBuilder()
+      .scannerIp("192.168.0.10")
+      .scanRange(ScanRange{ util::TenthOfDegree(0), util::TenthOfDegree(FRAMES_PER_ROUND * FRAME_WIDTH) })
+      .scanResolution(RESOLUTION)
+      .enableFragmentedScans(fragmented)
+      .build();
+}
+
+static std::vector<communication_layer::RecordedDatagram> createRecording(const uint32_t& number_of_rounds)
+{
+  std::vector<communication_layer::RecordedDatagram> datagrams;
+  for (uint32_t scan_counter = 1; scan_counter <= number_of_rounds; ++scan_counter)
+  {
+    for (std::size_t frame = 0; frame < FRAMES_PER_ROUND; ++frame)
+    {
+      const data_conversion_layer::monitoring_frame::Message msg(
+          util::TenthOfDegree(static_cast<int16_t>(frame * FRAME_WIDTH)),
+          RESOLUTION,
+          scan_counter,
+          std::vector<double>(FRAME_WIDTH, 1.));
+      datagrams.push_back(communication_layer::RecordedDatagram{
+          std::chrono::milliseconds(datagrams.size()), data_conversion_layer::monitoring_frame::serialize(msg) });
+    }
+  }
+  return datagrams;
+}
+
+TEST(ReplayScannerTest, shouldConvertRecordedRoundsToLaserScans)
+{
+  std::vector<std::size_t> scan_sizes;
+  ReplayScanner scanner(createConfig(false),
+                        [&scan_sizes](const LaserScan& scan) { scan_sizes.push_back(scan.getMeasurements().size()); },
+                        createRecording(3),
+                        communication_layer::ReplaySource::AS_FAST_AS_POSSIBLE);
+  scanner.run();
+
+  EXPECT_EQ(std::vector<std::size_t>(3, FRAMES_PER_ROUND * FRAME_WIDTH), scan_sizes);
+  const ScannerStatistics statistics{ scanner.getStatistics() };
+  EXPECT_EQ(3 * FRAMES_PER_ROUND, statistics.protocol.datagrams_received);
+  EXPECT_EQ(3 * FRAMES_PER_ROUND, statistics.protocol.frames_received);
+  EXPECT_EQ(3u, statistics.protocol.scans_completed);
+  EXPECT_EQ(0u, statistics.protocol.decode_errors);
+}
+
+TEST(ReplayScannerTest, shouldPassEachFrameInFragmentedMode)
+{
+  std::size_t number_of_scans{ 0 };
+  ReplayScanner scanner(createConfig(true),
+                        [&number_of_scans](const LaserScan&) { ++number_of_scans; },
+                        createRecording(2),
+                        communication_layer::ReplaySource::AS_FAST_AS_POSSIBLE);
+  scanner.run();
+
+  EXPECT_EQ(2 * FRAMES_PER_ROUND, number_of_scans);
+}
+
+TEST(ReplayScannerTest, shouldStopProcessingAfterInvalidDatagramLikeTheDriver)
+{
+  auto recording{ createRecording(2) };
+  recording.insert(recording.begin() + FRAMES_PER_ROUND,
+                   communication_layer::RecordedDatagram{ std::chrono::milliseconds(0),
+                                                          data_conversion_layer::RawData(10, '\0') });
+  std::size_t number_of_scans{ 0 };
+  ReplayScanner scanner(createConfig(false),
+                        [&number_of_scans](const LaserScan&) { ++number_of_scans; },
+                        recording,
+                        communication_layer::ReplaySource::AS_FAST_AS_POSSIBLE);
+  ASSERT_NO_THROW(scanner.run());
+
+  EXPECT_EQ(1u, number_of_scans);
+  EXPECT_EQ(FRAMES_PER_ROUND + 1, scanner.getStatistics().protocol.datagrams_received);
+}
+
+TEST(ReplayScannerTest, shouldThrowIfRunTwice)
+{
+  ReplayScanner scanner(createConfig(false), [](const LaserScan&) {}, createRecording(1), 0.);
+  scanner.run();
+  EXPECT_THROW(scanner.run(), std::logic_error);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
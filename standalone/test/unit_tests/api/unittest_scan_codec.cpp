@@ -0,0 +1,261 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scan_codec.h"
+#include "psen_scan_v2_standalone/util/tenth_of_degree.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr std::size_t NUMBER_OF_MEASUREMENTS{ 275 };
+
+static LaserScan createScan(const uint32_t& scan_counter,
+                            const std::size_t& number_of_measurements = NUMBER_OF_MEASUREMENTS,
+                            const bool& with_intensities = true)
+{
+  LaserScan scan(util::TenthOfDegree(10),
+                 util::TenthOfDegree(0),
+                 util::TenthOfDegree(static_cast<int16_t>(10 * number_of_measurements)));
+  scan.setScanCounter(scan_counter);
+  LaserScan::MeasurementData measurements;
+  LaserScan::IntensityData intensities;
+  for (std::size_t i = 0; i < number_of_measurements; ++i)
+  {
+    // A static scene with a few millimeters of noise and an object moving through it.
+    const double noise{ static_cast<double>((i * 7 + scan_counter * 13) % 5) };
+    const bool object{ (i + scan_counter) % 100 < 10 };
+    measurements.push_back(((object ? 500. : 3000. + 10. * static_cast<double>(i % 50)) + noise) / 1000.);
+    intensities.push_back(static_cast<double>((i * 31 + scan_counter) % 16384));
+  }
+  scan.setMeasurements(measurements);
+  if (with_intensities)
+  {
+    scan.setIntensities(intensities);
+  }
+  return scan;
+}
+
+//! @returns all combinations of varints/bit packing and scalar/SSE2 implementation.
+static std::vector<ScanCodecOptions> allOptions(const std::size_t& key_frame_interval = 33)
+{
+  std::vector<ScanCodecOptions> options;
+  for (const bool bit_packing : { false, true })
+  {
+    for (const bool simd : { false, true })
+    {
+      ScanCodecOptions option;
+      option.key_frame_interval = key_frame_interval;
+      option.bit_packing = bit_packing;
+      option.simd = simd;
+      options.push_back(option);
+    }
+  }
+  return options;
+}
+
+TEST(ScanCodecTest, shouldDecodeEncodedScans)
+{
+  for (const auto& options : allOptions())
+  {
+    ScanEncoder encoder(options);
+    ScanDecoder decoder(options.simd);
+    for (uint32_t scan_counter = 1; scan_counter <= 100; ++scan_counter)
+    {
+      EXPECT_EQ(createScan(scan_counter), decoder.decode(encoder.encode(createScan(scan_counter))))
+          << "bit_packing: " << options.bit_packing << " simd: " << options.simd;
+    }
+  }
+}
+
+TEST(ScanCodecTest, shouldDecodeKeyFramesOnly)
+{
+  for (const auto& options : allOptions(1))
+  {
+    ScanEncoder encoder(options);
+    ScanDecoder decoder(options.simd);
+    for (uint32_t scan_counter = 1; scan_counter <= 3; ++scan_counter)
+    {
+      EXPECT_EQ(createScan(scan_counter), decoder.decode(encoder.encode(createScan(scan_counter))));
+    }
+  }
+}
+
+TEST(ScanCodecTest, shouldDecodeExtremeDifferences)
+{
+  LaserScan near(util::TenthOfDegree(10), util::TenthOfDegree(0), util::TenthOfDegree(200));
+  LaserScan far(near);
+  LaserScan::MeasurementData near_measurements, far_measurements;
+  for (std::size_t i = 0; i < 20; ++i)
+  {
+    near_measurements.push_back(i % 2 == 0 ? 0. : 65.535);
+    far_measurements.push_back(i % 2 == 0 ? 65.535 : 0.);
+  }
+  near.setMeasurements(near_measurements);
+  far.setMeasurements(far_measurements);
+
+  for (const auto& options : allOptions())
+  {
+    ScanEncoder encoder(options);
+    ScanDecoder decoder(options.simd);
+    EXPECT_EQ(near, decoder.decode(encoder.encode(near)));
+    EXPECT_EQ(far, decoder.decode(encoder.encode(far)));
+    EXPECT_EQ(near, decoder.decode(encoder.encode(near)));
+  }
+}
+
+TEST(ScanCodecTest, shouldProduceSameFramesWithAndWithoutSimd)
+{
+  for (const bool bit_packing : { false, true })
+  {
+    ScanCodecOptions scalar_options;
+    scalar_options.bit_packing = bit_packing;
+    scalar_options.simd = false;
+    ScanCodecOptions simd_options{ scalar_options };
+    simd_options.simd = true;
+
+    ScanEncoder scalar_encoder(scalar_options);
+    ScanEncoder simd_encoder(simd_options);
+    for (uint32_t scan_counter = 1; scan_counter <= 10; ++scan_counter)
+    {
+      EXPECT_EQ(scalar_encoder.encode(createScan(scan_counter)), simd_encoder.encode(createScan(scan_counter)));
+    }
+  }
+}
+
+TEST(ScanCodecTest, shouldCompressConsecutiveScansBetterThanKeyFrames)
+{
+  const std::size_t raw_size{ NUMBER_OF_MEASUREMENTS * 2 * sizeof(uint16_t) };
+  for (const auto& options : allOptions())
+  {
+    ScanEncoder encoder(options);
+    const auto key_frame{ encoder.encode(createScan(1)) };
+    const auto delta_frame{ encoder.encode(createScan(2)) };
+    EXPECT_LT(key_frame.size(), raw_size);
+    EXPECT_LT(delta_frame.size(), key_frame.size());
+  }
+}
+
+TEST(ScanCodecTest, shouldDecodeScanWithoutIntensities)
+{
+  ScanEncoder encoder;
+  ScanDecoder decoder;
+  EXPECT_EQ(createScan(1, 10, false), decoder.decode(encoder.encode(createScan(1, 10, false))));
+  EXPECT_EQ(createScan(2, 10, false), decoder.decode(encoder.encode(createScan(2, 10, false))));
+}
+
+TEST(ScanCodecTest, shouldEncodeKeyFrameIfScanChanges)
+{
+  ScanEncoder encoder;
+  ScanDecoder decoder;
+  EXPECT_EQ(createScan(1, 100), decoder.decode(encoder.encode(createScan(1, 100))));
+  EXPECT_EQ(createScan(2, 50), decoder.decode(encoder.encode(createScan(2, 50))));
+  EXPECT_EQ(createScan(3, 50, false), decoder.decode(encoder.encode(createScan(3, 50, false))));
+}
+
+TEST(ScanCodecTest, shouldEncodeNotRepresentableMeasurementsAsMaximum)
+{
+  LaserScan scan(util::TenthOfDegree(10), util::TenthOfDegree(0), util::TenthOfDegree(30));
+  scan.setMeasurements({ std::numeric_limits<double>::infinity(), std::nan(""), -1. });
+
+  ScanEncoder encoder;
+  ScanDecoder decoder;
+  const auto measurements{ decoder.decode(encoder.encode(scan)).getMeasurements() };
+  EXPECT_EQ((LaserScan::MeasurementData{ 65.535, 65.535, 0. }), measurements);
+}
+
+TEST(ScanCodecTest, shouldWriteUncompressedValuesAsUint16)
+{
+  ScanCodecOptions options;
+  options.compression = false;
+  ScanEncoder encoder(options);
+  const auto frame{ encoder.encode(createScan(1)) };
+  ASSERT_EQ(28u + 2 * 2 * NUMBER_OF_MEASUREMENTS, frame.size());
+
+  uint16_t first_measurement;
+  std::memcpy(&first_measurement, frame.data() + 28, sizeof(first_measurement));
+  EXPECT_EQ(std::lround(createScan(1).getMeasurements()[0] * 1000.), first_measurement);
+
+  // Each uncompressed frame is a key frame, so frames can be lost without affecting the following ones.
+  encoder.encode(createScan(2));
+  ScanDecoder decoder;
+  EXPECT_EQ(createScan(3), decoder.decode(encoder.encode(createScan(3))));
+  EXPECT_EQ(0u, decoder.numberOfErrors());
+}
+
+TEST(ScanCodecTest, shouldThrowOnLostFrameAndRecoverWithKeyFrame)
+{
+  ScanCodecOptions options;
+  options.key_frame_interval = 3;
+  ScanEncoder encoder(options);
+  ScanDecoder decoder;
+
+  EXPECT_NO_THROW(decoder.decode(encoder.encode(createScan(1))));
+  encoder.encode(createScan(2));
+  EXPECT_THROW(decoder.decode(encoder.encode(createScan(3))), ScanCodecError);
+  EXPECT_EQ(createScan(4), decoder.decode(encoder.encode(createScan(4))));
+  EXPECT_EQ(createScan(5), decoder.decode(encoder.encode(createScan(5))));
+  EXPECT_EQ(1u, decoder.numberOfErrors());
+}
+
+TEST(ScanCodecTest, shouldDecodeForcedKeyFrameWithoutPreviousFrames)
+{
+  ScanEncoder encoder;
+  encoder.encode(createScan(1));
+  encoder.forceKeyFrame();
+
+  ScanDecoder decoder;
+  EXPECT_EQ(createScan(2), decoder.decode(encoder.encode(createScan(2))));
+}
+
+TEST(ScanCodecTest, shouldThrowOnInvalidFrame)
+{
+  for (const auto& options : allOptions())
+  {
+    ScanEncoder encoder(options);
+    const auto frame{ encoder.encode(createScan(1)) };
+
+    ScanDecoder decoder(options.simd);
+    EXPECT_THROW(decoder.decode(frame.data(), 10), ScanCodecError);
+    EXPECT_THROW(decoder.decode(frame.data(), frame.size() - 1), ScanCodecError);
+    auto with_trailing_byte{ frame };
+    with_trailing_byte.push_back(0);
+    EXPECT_THROW(decoder.decode(with_trailing_byte), ScanCodecError);
+    auto with_invalid_version{ frame };
+    with_invalid_version[0] = 42;
+    EXPECT_THROW(decoder.decode(with_invalid_version), ScanCodecError);
+    auto with_invalid_resolution{ frame };
+    with_invalid_resolution[12] = 0;
+    EXPECT_THROW(decoder.decode(with_invalid_resolution), ScanCodecError);
+    EXPECT_EQ(createScan(1), decoder.decode(frame));
+  }
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
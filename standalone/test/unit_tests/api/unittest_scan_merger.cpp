@@ -0,0 +1,307 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scan_merger.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr double EPSILON{ 1e-9 };
+static constexpr double PI{ boost::math::double_constants::pi };
+static constexpr std::chrono::milliseconds SYNC_WINDOW{ 10 };
+
+static LaserScan createScan(const std::vector<double>& measurements,
+                            const uint32_t scan_counter = 1,
+                            const util::TenthOfDegree& min_angle = util::TenthOfDegree(0),
+                            const util::TenthOfDegree& resolution = util::TenthOfDegree(100))
+{
+  LaserScan scan(resolution, min_angle, min_angle + resolution * static_cast<int>(measurements.size()));
+  scan.setMeasurements(measurements);
+  scan.setScanCounter(scan_counter);
+  return scan;
+}
+
+static ScanMergerInput createInput(const double& x, const double& y, const double& yaw)
+{
+  ScanMergerInput input;
+  input.mounting_pose = MountingPose{ x, y, yaw };
+  input.x_axis_rotation = 0.;
+  return input;
+}
+
+class ScanMergerTest : public ::testing::Test
+{
+protected:
+  ScanMerger::CompositeScanCallback storeCompositeScan()
+  {
+    return [this](const CompositeScan& composite_scan) {
+      composite_scans_.push_back(composite_scan);
+    };
+  }
+
+protected:
+  std::vector<CompositeScan> composite_scans_;
+  const ScanMerger::Clock::time_point start_{ ScanMerger::Clock::now() };
+};
+
+TEST_F(ScanMergerTest, shouldThrowOnMissingInputs)
+{
+  EXPECT_THROW(ScanMerger({}, SYNC_WINDOW, storeCompositeScan()), std::invalid_argument);
+}
+
+TEST_F(ScanMergerTest, shouldThrowOnMissingCallback)
+{
+  EXPECT_THROW(ScanMerger({ ScanMergerInput() }, SYNC_WINDOW, nullptr), std::invalid_argument);
+}
+
+TEST_F(ScanMergerTest, shouldThrowOnInvalidInputIndex)
+{
+  ScanMerger merger({ ScanMergerInput() }, SYNC_WINDOW, storeCompositeScan());
+  EXPECT_THROW(merger.addScan(1, createScan({ 1. })), std::out_of_range);
+  EXPECT_THROW(merger.laserScanCallback(1), std::out_of_range);
+}
+
+TEST_F(ScanMergerTest, shouldTransformMeasurementsIntoTargetFrame)
+{
+  ScanMerger merger({ createInput(1., 2., PI / 2.) }, SYNC_WINDOW, storeCompositeScan());
+  CompositeScan composite_scan;
+  merger.merge({ createScan({ 1. }) }, composite_scan);
+
+  ASSERT_EQ(1u, composite_scan.size());
+  EXPECT_NEAR(1., composite_scan.x[0], EPSILON);
+  EXPECT_NEAR(3., composite_scan.y[0], EPSILON);
+  EXPECT_NEAR(std::sqrt(10.), composite_scan.ranges[0], EPSILON);
+  EXPECT_NEAR(std::atan2(3., 1.), composite_scan.angles[0], EPSILON);
+}
+
+TEST_F(ScanMergerTest, shouldSubtractXAxisRotationFromScanAngles)
+{
+  ScanMergerInput input;
+  input.x_axis_rotation = PI / 2.;
+  ScanMerger merger({ input }, SYNC_WINDOW, storeCompositeScan());
+  CompositeScan composite_scan;
+  merger.merge({ createScan({ 2. }) }, composite_scan);
+
+  ASSERT_EQ(1u, composite_scan.size());
+  EXPECT_NEAR(-PI / 2., composite_scan.angles[0], EPSILON);
+  EXPECT_NEAR(0., composite_scan.x[0], EPSILON);
+  EXPECT_NEAR(-2., composite_scan.y[0], EPSILON);
+}
+
+TEST_F(ScanMergerTest, shouldMergeScansSortedByAngle)
+{
+  // Both scanners measure in steps of 10 degrees, the second one is rotated by 5 degrees.
+  const double yaw_of_second_scanner{ PI / 36. };
+  ScanMerger merger(
+      { createInput(0., 0., 0.), createInput(0., 0., yaw_of_second_scanner) }, SYNC_WINDOW, storeCompositeScan());
+  CompositeScan composite_scan;
+  merger.merge({ createScan({ 1., 2., 3. }, 5), createScan({ 4., 5., 6. }, 7) }, composite_scan);
+
+  ASSERT_EQ(6u, composite_scan.size());
+  EXPECT_TRUE(std::is_sorted(composite_scan.angles.begin(), composite_scan.angles.end()));
+  const std::vector<std::size_t> expected_sources{ 0, 1, 0, 1, 0, 1 };
+  const std::vector<double> expected_ranges{ 1., 4., 2., 5., 3., 6. };
+  EXPECT_EQ(expected_sources, composite_scan.sources);
+  for (std::size_t i = 0; i < expected_ranges.size(); ++i)
+  {
+    EXPECT_NEAR(expected_ranges[i], composite_scan.ranges[i], EPSILON);
+  }
+  EXPECT_EQ((std::vector<uint32_t>{ 5, 7 }), composite_scan.scan_counters);
+}
+
+TEST_F(ScanMergerTest, shouldSortAnglesCrossingPi)
+{
+  ScanMerger merger({ createInput(0.5, 0.2, PI - 0.3) }, SYNC_WINDOW, storeCompositeScan());
+  CompositeScan composite_scan;
+  merger.merge({ createScan({ 1., 2., 1., 3., 1., 2., 1., 3. }) }, composite_scan);
+
+  ASSERT_EQ(8u, composite_scan.size());
+  EXPECT_TRUE(std::is_sorted(composite_scan.angles.begin(), composite_scan.angles.end()));
+  EXPECT_TRUE(std::all_of(composite_scan.angles.begin(), composite_scan.angles.end(), [](const double& angle) {
+    return angle >= -PI && angle <= PI;
+  }));
+}
+
+TEST_F(ScanMergerTest, shouldIgnoreInvalidMeasurements)
+{
+  ScanMerger merger({ ScanMergerInput() }, SYNC_WINDOW, storeCompositeScan());
+  CompositeScan composite_scan;
+  merger.merge({ createScan({ 1., std::numeric_limits<double>::infinity(), 2. }) }, composite_scan);
+
+  EXPECT_EQ(2u, composite_scan.size());
+}
+
+TEST_F(ScanMergerTest, shouldUseNaNForMissingIntensities)
+{
+  ScanMerger merger({ ScanMergerInput(), ScanMergerInput() }, SYNC_WINDOW, storeCompositeScan());
+  LaserScan scan_with_intensities{ createScan({ 1. }) };
+  scan_with_intensities.setIntensities({ 42. });
+  CompositeScan composite_scan;
+  merger.merge({ scan_with_intensities, createScan({ 1. }) }, composite_scan);
+
+  ASSERT_EQ(2u, composite_scan.size());
+  const auto source_with_intensities{ composite_scan.sources[0] == 0 ? 0u : 1u };
+  EXPECT_DOUBLE_EQ(42., composite_scan.intensities[source_with_intensities]);
+  EXPECT_TRUE(std::isnan(composite_scan.intensities[1u - source_with_intensities]));
+}
+
+TEST_F(ScanMergerTest, shouldCallCallbackAfterScanOfEachInput)
+{
+  ScanMerger merger({ createInput(0., 0., 0.), createInput(0., 0., PI) }, SYNC_WINDOW, storeCompositeScan());
+
+  merger.addScan(0, createScan({ 1. }, 3), start_);
+  EXPECT_TRUE(composite_scans_.empty());
+  merger.addScan(1, createScan({ 1. }, 8), start_ + SYNC_WINDOW);
+
+  ASSERT_EQ(1u, composite_scans_.size());
+  EXPECT_EQ(2u, composite_scans_[0].size());
+  EXPECT_EQ((std::vector<uint32_t>{ 3, 8 }), composite_scans_[0].scan_counters);
+  EXPECT_EQ(0u, merger.numberOfDroppedScans());
+}
+
+TEST_F(ScanMergerTest, shouldDropScansOutsideOfSyncWindow)
+{
+  ScanMerger merger({ createInput(0., 0., 0.), createInput(0., 0., PI) }, SYNC_WINDOW, storeCompositeScan());
+
+  merger.addScan(0, createScan({ 1. }, 3), start_);
+  merger.addScan(1, createScan({ 1. }, 8), start_ + SYNC_WINDOW + std::chrono::milliseconds(1));
+  EXPECT_TRUE(composite_scans_.empty());
+  EXPECT_EQ(1u, merger.numberOfDroppedScans());
+
+  merger.addScan(0, createScan({ 1. }, 4), start_ + SYNC_WINDOW + std::chrono::milliseconds(2));
+  ASSERT_EQ(1u, composite_scans_.size());
+  EXPECT_EQ((std::vector<uint32_t>{ 4, 8 }), composite_scans_[0].scan_counters);
+}
+
+TEST_F(ScanMergerTest, shouldReplacePendingScanByNewerScanOfSameInput)
+{
+  ScanMerger merger({ createInput(0., 0., 0.), createInput(0., 0., PI) }, SYNC_WINDOW, storeCompositeScan());
+
+  merger.addScan(0, createScan({ 1. }, 3), start_);
+  merger.addScan(0, createScan({ 1. }, 4), start_);
+  merger.addScan(1, createScan({ 1. }, 8), start_);
+
+  ASSERT_EQ(1u, composite_scans_.size());
+  EXPECT_EQ((std::vector<uint32_t>{ 4, 8 }), composite_scans_[0].scan_counters);
+  EXPECT_EQ(1u, merger.numberOfDroppedScans());
+}
+
+TEST_F(ScanMergerTest, shouldDropScansWhichAreNotNewerThanTheLastMergedScan)
+{
+  ScanMerger merger({ ScanMergerInput() }, SYNC_WINDOW, storeCompositeScan());
+
+  merger.addScan(0, createScan({ 1. }, 3), start_);
+  merger.addScan(0, createScan({ 1. }, 3), start_);
+  merger.addScan(0, createScan({ 1. }, 2), start_);
+
+  EXPECT_EQ(1u, composite_scans_.size());
+  EXPECT_EQ(2u, merger.numberOfDroppedScans());
+}
+
+TEST_F(ScanMergerTest, shouldMergeScansAfterWrapAroundOfScanCounter)
+{
+  ScanMerger merger({ ScanMergerInput() }, SYNC_WINDOW, storeCompositeScan());
+
+  merger.addScan(0, createScan({ 1. }, std::numeric_limits<uint32_t>::max()), start_);
+  merger.addScan(0, createScan({ 1. }, 0), start_);
+  merger.addScan(0, createScan({ 1. }, std::numeric_limits<uint32_t>::max()), start_);
+
+  ASSERT_EQ(2u, composite_scans_.size());
+  EXPECT_EQ(0u, composite_scans_[1].scan_counters[0]);
+  EXPECT_EQ(1u, merger.numberOfDroppedScans());
+}
+
+TEST_F(ScanMergerTest, shouldMergeScansAfterRestartOfScanner)
+{
+  ScanMerger merger({ createInput(0., 0., 0.), createInput(0., 0., PI) }, SYNC_WINDOW, storeCompositeScan());
+
+  merger.addScan(0, createScan({ 1. }, 1000), start_);
+  merger.addScan(1, createScan({ 1. }, 2000), start_);
+  merger.addScan(0, createScan({ 1. }, 1), start_);
+  merger.addScan(1, createScan({ 1. }, 2001), start_);
+  merger.addScan(0, createScan({ 1. }, 2), start_);
+  merger.addScan(1, createScan({ 1. }, 2002), start_);
+
+  ASSERT_EQ(3u, composite_scans_.size());
+  EXPECT_EQ((std::vector<uint32_t>{ 1, 2001 }), composite_scans_[1].scan_counters);
+  EXPECT_EQ((std::vector<uint32_t>{ 2, 2002 }), composite_scans_[2].scan_counters);
+  EXPECT_EQ(0u, merger.numberOfDroppedScans());
+}
+
+TEST_F(ScanMergerTest, shouldDropLateScansWithinMaxScanCounterDelay)
+{
+  ScanMerger merger({ ScanMergerInput() }, SYNC_WINDOW, storeCompositeScan());
+
+  merger.addScan(0, createScan({ 1. }, 1000), start_);
+  merger.addScan(0, createScan({ 1. }, 1000 - ScanMerger::MAX_SCAN_COUNTER_DELAY), start_);
+  merger.addScan(0, createScan({ 1. }, 1000 - ScanMerger::MAX_SCAN_COUNTER_DELAY - 1), start_);
+
+  ASSERT_EQ(2u, composite_scans_.size());
+  EXPECT_EQ(1000u - ScanMerger::MAX_SCAN_COUNTER_DELAY - 1, composite_scans_[1].scan_counters[0]);
+  EXPECT_EQ(1u, merger.numberOfDroppedScans());
+}
+
+TEST_F(ScanMergerTest, shouldThrowOnFragmentOfMergedScan)
+{
+  ScanMerger merger({ ScanMergerInput() }, SYNC_WINDOW, storeCompositeScan());
+
+  merger.addScan(0, createScan({ 1., 2. }, 3, util::TenthOfDegree(0)), start_);
+  EXPECT_THROW(merger.addScan(0, createScan({ 3., 4. }, 3, util::TenthOfDegree(200)), start_), std::invalid_argument);
+  EXPECT_EQ(1u, composite_scans_.size());
+}
+
+TEST_F(ScanMergerTest, shouldThrowOnFragmentOfPendingScan)
+{
+  ScanMerger merger({ createInput(0., 0., 0.), createInput(0., 0., PI) }, SYNC_WINDOW, storeCompositeScan());
+
+  merger.addScan(0, createScan({ 1., 2. }, 3, util::TenthOfDegree(0)), start_);
+  EXPECT_THROW(merger.addScan(0, createScan({ 3., 4. }, 3, util::TenthOfDegree(200)), start_), std::invalid_argument);
+
+  merger.addScan(1, createScan({ 1., 2. }, 8), start_);
+  ASSERT_EQ(1u, composite_scans_.size());
+  EXPECT_EQ(4u, composite_scans_[0].size());
+}
+
+TEST_F(ScanMergerTest, shouldAddScansViaLaserScanCallback)
+{
+  ScanMerger merger({ ScanMergerInput() }, SYNC_WINDOW, storeCompositeScan());
+  const auto laser_scan_callback{ merger.laserScanCallback(0) };
+
+  laser_scan_callback(createScan({ 1., 2. }));
+
+  ASSERT_EQ(1u, composite_scans_.size());
+  EXPECT_EQ(2u, composite_scans_[0].size());
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
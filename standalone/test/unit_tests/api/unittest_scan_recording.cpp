@@ -0,0 +1,285 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/laserscan.h"
+#include "psen_scan_v2_standalone/scan_recording.h"
+#include "psen_scan_v2_standalone/util/tenth_of_degree.h"
+#include "psen_scan_v2_standalone/util/temporary_files.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr std::size_t NUMBER_OF_SCANS{ 100 };
+static constexpr std::size_t NUMBER_OF_MEASUREMENTS{ 27 };
+
+class ScanRecordingTest : public TemporaryFilesTest
+{
+protected:
+  static LaserScan createScan(const uint32_t& scan_counter, const bool& with_intensities = true)
+  {
+    LaserScan scan(util::TenthOfDegree(10), util::TenthOfDegree(-100), util::TenthOfDegree(160));
+    scan.setScanCounter(scan_counter);
+    LaserScan::MeasurementData measurements;
+    LaserScan::IntensityData intensities;
+    for (std::size_t i = 0; i < NUMBER_OF_MEASUREMENTS; ++i)
+    {
+      measurements.push_back(static_cast<double>(scan_counter + i) / 1000.);
+      intensities.push_back(static_cast<double>(i * 100));
+    }
+    scan.setMeasurements(measurements);
+    if (with_intensities)
+    {
+      scan.setIntensities(intensities);
+    }
+    return scan;
+  }
+
+  static std::chrono::nanoseconds timestampOf(const uint32_t& scan_counter)
+  {
+    return std::chrono::milliseconds(30 * scan_counter);
+  }
+
+  static void writeScans(ScanRecordingWriter& writer)
+  {
+    for (uint32_t scan_counter = 1; scan_counter <= NUMBER_OF_SCANS; ++scan_counter)
+    {
+      writer.write(createScan(scan_counter), timestampOf(scan_counter));
+    }
+  }
+};
+
+TEST_F(ScanRecordingTest, shouldReadWrittenScans)
+{
+  const auto name{ filename(".scans") };
+  {
+    ScanRecordingWriter writer(name);
+    writeScans(writer);
+    EXPECT_EQ(NUMBER_OF_SCANS, writer.numberOfScans());
+  }
+
+  ScanRecordingReader reader(name);
+  EXPECT_TRUE(reader.isComplete());
+  ASSERT_EQ(NUMBER_OF_SCANS, reader.size());
+  for (uint32_t scan_counter = 1; scan_counter <= NUMBER_OF_SCANS; ++scan_counter)
+  {
+    const auto view{ reader[scan_counter - 1] };
+    EXPECT_EQ(timestampOf(scan_counter), view.timestamp());
+    EXPECT_EQ(createScan(scan_counter), view.toLaserScan());
+  }
+}
+
+TEST_F(ScanRecordingTest, shouldProvideRangesAndIntensitiesWithoutCopy)
+{
+  const auto name{ filename(".scans") };
+  {
+    ScanRecordingWriter writer(name);
+    writer.write(createScan(42), timestampOf(42));
+  }
+
+  ScanRecordingReader reader(name);
+  const auto view{ reader.at(0) };
+  EXPECT_EQ(42u, view.scanCounter());
+  EXPECT_EQ(util::TenthOfDegree(10), view.scanResolution());
+  EXPECT_EQ(util::TenthOfDegree(-100), view.minScanAngle());
+  EXPECT_EQ(util::TenthOfDegree(160), view.maxScanAngle());
+  ASSERT_EQ(NUMBER_OF_MEASUREMENTS, view.size());
+  ASSERT_EQ(NUMBER_OF_MEASUREMENTS, view.numberOfIntensities());
+  for (std::size_t i = 0; i < NUMBER_OF_MEASUREMENTS; ++i)
+  {
+    EXPECT_EQ(42u + i, view.ranges()[i]);
+    EXPECT_EQ(i * 100, view.intensities()[i]);
+  }
+}
+
+TEST_F(ScanRecordingTest, shouldReadScanWithoutIntensities)
+{
+  const auto name{ filename(".scans") };
+  {
+    ScanRecordingWriter writer(name);
+    writer.write(createScan(1, false), timestampOf(1));
+  }
+
+  ScanRecordingReader reader(name);
+  ASSERT_EQ(1u, reader.size());
+  EXPECT_EQ(0u, reader[0].numberOfIntensities());
+  EXPECT_EQ(createScan(1, false), reader[0].toLaserScan());
+}
+
+TEST_F(ScanRecordingTest, shouldStoreNotRepresentableMeasurementsAsMaximum)
+{
+  const auto name{ filename(".scans") };
+  LaserScan scan(util::TenthOfDegree(10), util::TenthOfDegree(0), util::TenthOfDegree(20));
+  scan.setMeasurements({ std::numeric_limits<double>::infinity(), std::nan(""), -1., 100. });
+  {
+    ScanRecordingWriter writer(name);
+    writer.write(scan, timestampOf(1));
+  }
+
+  ScanRecordingReader reader(name);
+  ASSERT_EQ(4u, reader[0].size());
+  EXPECT_EQ(std::numeric_limits<uint16_t>::max(), reader[0].ranges()[0]);
+  EXPECT_EQ(std::numeric_limits<uint16_t>::max(), reader[0].ranges()[1]);
+  EXPECT_EQ(0u, reader[0].ranges()[2]);
+  EXPECT_EQ(std::numeric_limits<uint16_t>::max(), reader[0].ranges()[3]);
+}
+
+TEST_F(ScanRecordingTest, shouldFindScansByTime)
+{
+  const auto name{ filename(".scans") };
+  {
+    ScanRecordingWriter writer(name);
+    writeScans(writer);
+  }
+
+  ScanRecordingReader reader(name);
+  EXPECT_EQ(0u, reader.findByTime(std::chrono::nanoseconds(0)));
+  EXPECT_EQ(9u, reader.findByTime(timestampOf(10)));
+  EXPECT_EQ(10u, reader.findByTime(timestampOf(10) + std::chrono::nanoseconds(1)));
+  EXPECT_EQ(reader.size(), reader.findByTime(timestampOf(NUMBER_OF_SCANS + 1)));
+}
+
+TEST_F(ScanRecordingTest, shouldFindScansByScanCounter)
+{
+  const auto name{ filename(".scans") };
+  {
+    ScanRecordingWriter writer(name);
+    writeScans(writer);
+  }
+
+  ScanRecordingReader reader(name);
+  EXPECT_EQ(0u, reader.findByScanCounter(0));
+  EXPECT_EQ(49u, reader.findByScanCounter(50));
+  EXPECT_EQ(50u, reader[reader.findByScanCounter(50)].scanCounter());
+  EXPECT_EQ(reader.size(), reader.findByScanCounter(NUMBER_OF_SCANS + 1));
+}
+
+TEST_F(ScanRecordingTest, shouldRebuildIndexOfRecordingWhichWasNotClosed)
+{
+  const auto name{ filename(".scans") };
+  const auto copy{ filename(".copy") };
+  {
+    ScanRecordingWriter writer(name);
+    writeScans(writer);
+    writer.write(createScan(NUMBER_OF_SCANS + 1), timestampOf(NUMBER_OF_SCANS + 1));
+    writer.flush();
+
+    // Copies the recording before the index is written and cuts the last scan, like a crash while writing.
+    std::ifstream is(name, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    std::ofstream(copy, std::ios::binary) << content.substr(0, content.size() - 10);
+  }
+
+  ScanRecordingReader reader(copy);
+  EXPECT_FALSE(reader.isComplete());
+  ASSERT_EQ(NUMBER_OF_SCANS, reader.size());
+  EXPECT_EQ(createScan(NUMBER_OF_SCANS), reader[NUMBER_OF_SCANS - 1].toLaserScan());
+  EXPECT_EQ(49u, reader.findByScanCounter(50));
+}
+
+TEST_F(ScanRecordingTest, shouldWriteScansPassedToCallback)
+{
+  const auto name{ filename(".scans") };
+  {
+    ScanRecordingWriter writer(name);
+    const auto callback{ writer.laserScanCallback() };
+    callback(createScan(1));
+    callback(createScan(2));
+  }
+
+  ScanRecordingReader reader(name);
+  ASSERT_EQ(2u, reader.size());
+  EXPECT_EQ(createScan(2), reader[1].toLaserScan());
+  EXPECT_LE(reader[0].timestamp(), reader[1].timestamp());
+}
+
+TEST_F(ScanRecordingTest, shouldThrowOnWriteAfterClose)
+{
+  ScanRecordingWriter writer(filename(".scans"));
+  writer.close();
+  EXPECT_THROW(writer.write(createScan(1)), ScanRecordingError);
+}
+
+TEST_F(ScanRecordingTest, shouldThrowOnPositionOutOfRange)
+{
+  const auto name{ filename(".scans") };
+  ScanRecordingWriter(name).write(createScan(1), timestampOf(1));
+
+  ScanRecordingReader reader(name);
+  EXPECT_NO_THROW(reader.at(0));
+  EXPECT_THROW(reader.at(1), std::out_of_range);
+}
+
+TEST_F(ScanRecordingTest, shouldThrowOnInvalidFile)
+{
+  const auto name{ filename(".scans") };
+  std::ofstream(name, std::ios::binary) << std::string(100, 'x');
+  EXPECT_THROW(ScanRecordingReader{ name }, ScanRecordingError);
+  EXPECT_THROW(ScanRecordingReader{ filename(".missing") }, ScanRecordingError);
+}
+
+TEST_F(ScanRecordingTest, shouldThrowOnInvalidIndex)
+{
+  const auto name{ filename(".scans") };
+  {
+    ScanRecordingWriter writer(name);
+    writeScans(writer);
+  }
+  // Claims more scans than the index contains.
+  std::fstream file(name, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(16);
+  const uint64_t scan_count{ 1000000 };
+  file.write(reinterpret_cast<const char*>(&scan_count), sizeof(scan_count));
+  file.close();
+
+  EXPECT_THROW(ScanRecordingReader{ name }, ScanRecordingError);
+}
+
+TEST_F(ScanRecordingTest, shouldThrowOnCorruptRecordHeader)
+{
+  const auto name{ filename(".scans") };
+  {
+    ScanRecordingWriter writer(name);
+    writeScans(writer);
+  }
+
+  // The measurement count in the header of the first record claims more measurements than the record contains.
+  std::fstream file(name, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(64 + 24);
+  const uint32_t measurement_count{ 1000 };
+  file.write(reinterpret_cast<const char*>(&measurement_count), sizeof(measurement_count));
+  file.close();
+
+  EXPECT_THROW(ScanRecordingReader{ name }, ScanRecordingError);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
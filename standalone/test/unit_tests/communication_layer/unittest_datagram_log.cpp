@@ -0,0 +1,314 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace psen_scan_v2_standalone::communication_layer;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr uint16_t SCANNER_PORT{ 2000 };
+static constexpr uint16_t HOST_PORT{ 55115 };
+static constexpr uint16_t OTHER_PORT{ 4711 };
+
+static constexpr uint32_t LINKTYPE_ETHERNET{ 1 };
+static constexpr uint32_t LINKTYPE_RAW{ 101 };
+static constexpr uint32_t LINKTYPE_LINUX_SLL{ 113 };
+
+static void appendBigEndian(std::string& bytes, const uint64_t& value, const std::size_t& size)
+{
+  for (std::size_t i = size; i > 0; --i)
+  {
+    bytes.push_back(static_cast<char>((value >> (8 * (i - 1))) & 0xff));
+  }
+}
+
+static void appendLittleEndian(std::string& bytes, const uint64_t& value, const std::size_t& size)
+{
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+static std::string toString(const data_conversion_layer::RawData& data)
+{
+  return std::string(data.begin(), data.end());
+}
+
+static std::string udpPacket(const std::string& payload, const uint16_t& source_port, const uint16_t& destination_port)
+{
+  std::string packet;
+  appendBigEndian(packet, source_port, 2);
+  appendBigEndian(packet, destination_port, 2);
+  appendBigEndian(packet, payload.size() + 8, 2);
+  appendBigEndian(packet, 0, 2);
+  return packet + payload;
+}
+
+static std::string ipv4Packet(const std::string& payload,
+                              const uint16_t& id = 1,
+                              const std::size_t& fragment_offset = 0,
+                              const bool& more_fragments = false)
+{
+  std::string packet;
+  packet.push_back(0x45);
+  packet.push_back(0);
+  appendBigEndian(packet, payload.size() + 20, 2);
+  appendBigEndian(packet, id, 2);
+  appendBigEndian(packet, (more_fragments ? 0x2000 : 0) | (fragment_offset / 8), 2);
+  packet.push_back(64);
+  packet.push_back(17);
+  appendBigEndian(packet, 0, 2);
+  appendBigEndian(packet, 0xc0a8000a, 4);
+  appendBigEndian(packet, 0xc0a80064, 4);
+  return packet + payload;
+}
+
+static std::string ethernetFrame(const std::string& ip_packet, const bool& vlan_tagged = false)
+{
+  std::string frame(12, '\x01');
+  if (vlan_tagged)
+  {
+    appendBigEndian(frame, 0x8100, 2);
+    appendBigEndian(frame, 42, 2);
+  }
+  appendBigEndian(frame, 0x0800, 2);
+  return frame + ip_packet;
+}
+
+static std::string linuxCookedFrame(const std::string& ip_packet)
+{
+  std::string frame(14, '\0');
+  appendBigEndian(frame, 0x0800, 2);
+  return frame + ip_packet;
+}
+
+class PcapBuilder
+{
+public:
+  explicit PcapBuilder(const uint32_t& link_type, const bool& big_endian = false) : big_endian_(big_endian)
+  {
+    append32(0xa1b2c3d4);
+    append16(2);
+    append16(4);
+    append32(0);
+    append32(0);
+    append32(65535);
+    append32(link_type);
+  }
+
+  PcapBuilder& addPacket(const std::string& frame, const uint32_t& seconds, const uint32_t& microseconds)
+  {
+    append32(seconds);
+    append32(microseconds);
+    append32(static_cast<uint32_t>(frame.size()));
+    append32(static_cast<uint32_t>(frame.size()));
+    bytes_ += frame;
+    return *this;
+  }
+
+  std::string bytes() const
+  {
+    return bytes_;
+  }
+
+private:
+  void append16(const uint16_t& value)
+  {
+    big_endian_ ? appendBigEndian(bytes_, value, 2) : appendLittleEndian(bytes_, value, 2);
+  }
+
+  void append32(const uint32_t& value)
+  {
+    big_endian_ ? appendBigEndian(bytes_, value, 4) : appendLittleEndian(bytes_, value, 4);
+  }
+
+  const bool big_endian_;
+  std::string bytes_;
+};
+
+TEST(DatagramLogTest, shouldReadWrittenDatagrams)
+{
+  std::stringstream log;
+  writeDatagramLogHeader(log);
+  const std::string first{ "first datagram" };
+  const std::string second{ "second" };
+  writeDatagramLogRecord(log, std::chrono::nanoseconds(1000), first.data(), first.size());
+  writeDatagramLogRecord(log, std::chrono::nanoseconds(2500), second.data(), second.size());
+
+  const auto datagrams{ readDatagramLog(log) };
+  ASSERT_EQ(2u, datagrams.size());
+  EXPECT_EQ(std::chrono::nanoseconds(1000), datagrams[0].timestamp);
+  EXPECT_EQ(first, toString(datagrams[0].data));
+  EXPECT_EQ(std::chrono::nanoseconds(2500), datagrams[1].timestamp);
+  EXPECT_EQ(second, toString(datagrams[1].data));
+}
+
+TEST(DatagramLogTest, shouldIgnoreTruncatedLastRecord)
+{
+  std::stringstream log;
+  writeDatagramLogHeader(log);
+  const std::string datagram{ "datagram" };
+  writeDatagramLogRecord(log, std::chrono::nanoseconds(1), datagram.data(), datagram.size());
+  writeDatagramLogRecord(log, std::chrono::nanoseconds(2), datagram.data(), datagram.size());
+  std::string bytes{ log.str() };
+  bytes.resize(bytes.size() - 3);
+
+  std::istringstream truncated_log(bytes);
+  EXPECT_EQ(1u, readDatagramLog(truncated_log).size());
+}
+
+TEST(DatagramLogTest, shouldThrowOnInvalidHeader)
+{
+  std::istringstream log("NOTALOG!\x01\0\0\0");
+  EXPECT_THROW(readDatagramLog(log), DatagramLogError);
+}
+
+TEST(DatagramLogTest, shouldThrowOnCorruptRecordLength)
+{
+  std::stringstream log;
+  writeDatagramLogHeader(log);
+  std::string record;
+  appendLittleEndian(record, 1, 8);
+  appendLittleEndian(record, 0xffffffff, 4);
+  log << record;
+  EXPECT_THROW(readDatagramLog(log), DatagramLogError);
+}
+
+TEST(PcapTest, shouldReadUdpPayloadOfEthernetFrames)
+{
+  std::istringstream pcap(
+      PcapBuilder(LINKTYPE_ETHERNET)
+          .addPacket(ethernetFrame(ipv4Packet(udpPacket("frame 1", SCANNER_PORT, HOST_PORT))), 10, 5)
+          .addPacket(ethernetFrame(ipv4Packet(udpPacket("frame 2", SCANNER_PORT, HOST_PORT))), 11, 7)
+          .bytes());
+
+  const auto datagrams{ readPcap(pcap) };
+  ASSERT_EQ(2u, datagrams.size());
+  EXPECT_EQ("frame 1", toString(datagrams[0].data));
+  EXPECT_EQ(std::chrono::seconds(10) + std::chrono::microseconds(5), datagrams[0].timestamp);
+  EXPECT_EQ("frame 2", toString(datagrams[1].data));
+  EXPECT_EQ(std::chrono::seconds(11) + std::chrono::microseconds(7), datagrams[1].timestamp);
+}
+
+TEST(PcapTest, shouldReadBigEndianPcap)
+{
+  std::istringstream pcap(
+      PcapBuilder(LINKTYPE_ETHERNET, true)
+          .addPacket(ethernetFrame(ipv4Packet(udpPacket("frame", SCANNER_PORT, HOST_PORT))), 3, 4)
+          .bytes());
+
+  const auto datagrams{ readPcap(pcap) };
+  ASSERT_EQ(1u, datagrams.size());
+  EXPECT_EQ("frame", toString(datagrams[0].data));
+  EXPECT_EQ(std::chrono::seconds(3) + std::chrono::microseconds(4), datagrams[0].timestamp);
+}
+
+TEST(PcapTest, shouldReadVlanTaggedLinuxCookedAndRawFrames)
+{
+  const std::string ip_packet{ ipv4Packet(udpPacket("frame", SCANNER_PORT, HOST_PORT)) };
+  std::istringstream vlan(PcapBuilder(LINKTYPE_ETHERNET).addPacket(ethernetFrame(ip_packet, true), 0, 0).bytes());
+  std::istringstream cooked(PcapBuilder(LINKTYPE_LINUX_SLL).addPacket(linuxCookedFrame(ip_packet), 0, 0).bytes());
+  std::istringstream raw(PcapBuilder(LINKTYPE_RAW).addPacket(ip_packet, 0, 0).bytes());
+
+  for (std::istringstream* pcap : { &vlan, &cooked, &raw })
+  {
+    const auto datagrams{ readPcap(*pcap) };
+    ASSERT_EQ(1u, datagrams.size());
+    EXPECT_EQ("frame", toString(datagrams[0].data));
+  }
+}
+
+TEST(PcapTest, shouldReassembleFragmentedDatagrams)
+{
+  const std::string udp_packet{ udpPacket(std::string(3000, 'x') + "end", SCANNER_PORT, HOST_PORT) };
+  // The fragments are captured in reverse order, which can happen on some interfaces.
+  std::istringstream pcap(
+      PcapBuilder(LINKTYPE_ETHERNET)
+          .addPacket(ethernetFrame(ipv4Packet(udp_packet.substr(1480), 7, 1480, false)), 0, 2)
+          .addPacket(ethernetFrame(ipv4Packet(udp_packet.substr(0, 1480), 7, 0, true)), 0, 1)
+          .bytes());
+
+  const auto datagrams{ readPcap(pcap) };
+  ASSERT_EQ(1u, datagrams.size());
+  EXPECT_EQ(std::string(3000, 'x') + "end", toString(datagrams[0].data));
+}
+
+TEST(PcapTest, shouldOnlyReadDatagramsOfGivenPort)
+{
+  std::istringstream pcap(
+      PcapBuilder(LINKTYPE_ETHERNET)
+          .addPacket(ethernetFrame(ipv4Packet(udpPacket("from scanner", SCANNER_PORT, HOST_PORT))), 0, 0)
+          .addPacket(ethernetFrame(ipv4Packet(udpPacket("other", OTHER_PORT, OTHER_PORT))), 0, 0)
+          .addPacket(ethernetFrame(ipv4Packet(udpPacket("to scanner", HOST_PORT, SCANNER_PORT))), 0, 0)
+          .bytes());
+
+  const auto datagrams{ readPcap(pcap, SCANNER_PORT) };
+  ASSERT_EQ(2u, datagrams.size());
+  EXPECT_EQ("from scanner", toString(datagrams[0].data));
+  EXPECT_EQ("to scanner", toString(datagrams[1].data));
+}
+
+TEST(PcapTest, shouldSkipPacketsWhichAreNoUdp)
+{
+  std::string tcp_packet{ ipv4Packet("tcp segment") };
+  tcp_packet[9] = 6;
+  std::istringstream pcap(PcapBuilder(LINKTYPE_ETHERNET)
+                              .addPacket(ethernetFrame(tcp_packet), 0, 0)
+                              .addPacket(ethernetFrame(ipv4Packet(udpPacket("udp", SCANNER_PORT, HOST_PORT))), 0, 0)
+                              .bytes());
+
+  const auto datagrams{ readPcap(pcap) };
+  ASSERT_EQ(1u, datagrams.size());
+  EXPECT_EQ("udp", toString(datagrams[0].data));
+}
+
+TEST(PcapTest, shouldThrowOnPcapng)
+{
+  std::string pcapng;
+  appendLittleEndian(pcapng, 0x0a0d0d0a, 4);
+  pcapng += std::string(20, '\0');
+  std::istringstream pcap(pcapng);
+  EXPECT_THROW(readPcap(pcap), DatagramLogError);
+}
+
+TEST(PcapTest, shouldThrowOnUnsupportedLinkType)
+{
+  std::istringstream pcap(PcapBuilder(147).bytes());
+  EXPECT_THROW(readPcap(pcap), DatagramLogError);
+}
+
+TEST(RecordingTest, shouldThrowIfFileDoesNotExist)
+{
+  EXPECT_THROW(readRecording("/nonexistent/recording.pcap"), DatagramLogError);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/communication_layer/datagram_recorder.h"
+#include "psen_scan_v2_standalone/util/temporary_files.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace psen_scan_v2_standalone::communication_layer;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr uint16_t SCANNER_PORT{ 2000 };
+static constexpr uint16_t HOST_PORT{ 55115 };
+
+class DatagramRecorderTest : public TemporaryFilesTest
+{
+protected:
+  static void tap(DatagramRecorder& recorder, const std::chrono::nanoseconds& timestamp, const std::string& data)
+  {
+    recorder.tap(timestamp, data.data(), data.size());
+  }
+
+  static std::string toString(const data_conversion_layer::RawData& data)
+  {
+    return std::string(data.begin(), data.end());
+  }
+};
+
+TEST_F(DatagramRecorderTest, shouldWriteRawDatagramLog)
+{
+  const std::string file{ filename(".log") };
+  {
+    DatagramRecorder recorder(file);
+    tap(recorder, std::chrono::nanoseconds(1000), "first");
+    tap(recorder, std::chrono::nanoseconds(2000), "second");
+  }
+
+  std::ifstream log(file, std::ios::binary);
+  const auto datagrams{ readDatagramLog(log) };
+  ASSERT_EQ(2u, datagrams.size());
+  EXPECT_EQ(std::chrono::nanoseconds(1000), datagrams[0].timestamp);
+  EXPECT_EQ("first", toString(datagrams[0].data));
+  EXPECT_EQ(std::chrono::nanoseconds(2000), datagrams[1].timestamp);
+  EXPECT_EQ("second", toString(datagrams[1].data));
+}
+
+TEST_F(DatagramRecorderTest, shouldWritePcapWithUdpHeaders)
+{
+  const std::string file{ filename(".pcap") };
+  const std::chrono::nanoseconds timestamp{ std::chrono::seconds(1600000000) + std::chrono::nanoseconds(123456789) };
+  {
+    UdpEndpoints endpoints;
+    endpoints.source_ip = 0xc0a8000a;
+    endpoints.source_port = SCANNER_PORT;
+    endpoints.destination_ip = 0xc0a80064;
+    endpoints.destination_port = HOST_PORT;
+    DatagramRecorder recorder(file, endpoints);
+    tap(recorder, timestamp, std::string(3000, 'x'));
+  }
+
+  std::ifstream pcap(file, std::ios::binary);
+  const auto datagrams{ readPcap(pcap, SCANNER_PORT) };
+  ASSERT_EQ(1u, datagrams.size());
+  EXPECT_EQ(timestamp, datagrams[0].timestamp);
+  EXPECT_EQ(std::string(3000, 'x'), toString(datagrams[0].data));
+}
+
+TEST_F(DatagramRecorderTest, shouldWriteBatchesLargerThanOneBlock)
+{
+  const std::string file{ filename(".log") };
+  constexpr std::size_t NUMBER_OF_DATAGRAMS{ 2000 };
+  {
+    DatagramRecorder recorder(file, UdpEndpoints(), NUMBER_OF_DATAGRAMS);
+    for (std::size_t i = 0; i < NUMBER_OF_DATAGRAMS; ++i)
+    {
+      tap(recorder, std::chrono::nanoseconds(i), std::string(1000, static_cast<char>('a' + i % 26)));
+    }
+    EXPECT_EQ(0u, recorder.numberOfDroppedDatagrams());
+  }
+
+  std::ifstream log(file, std::ios::binary);
+  const auto datagrams{ readDatagramLog(log) };
+  ASSERT_EQ(NUMBER_OF_DATAGRAMS, datagrams.size());
+  for (std::size_t i = 0; i < NUMBER_OF_DATAGRAMS; ++i)
+  {
+    ASSERT_EQ(std::chrono::nanoseconds(i), datagrams[i].timestamp);
+    ASSERT_EQ(std::string(1000, static_cast<char>('a' + i % 26)), toString(datagrams[i].data));
+  }
+}
+
+TEST_F(DatagramRecorderTest, shouldDropDatagramsInsteadOfBlockingIfQueueIsFull)
+{
+  const std::string file{ filename(".log") };
+  constexpr std::size_t NUMBER_OF_DATAGRAMS{ 10000 };
+  uint64_t recorded{ 0 };
+  uint64_t dropped{ 0 };
+  {
+    DatagramRecorder recorder(file, UdpEndpoints(), 1);
+    for (std::size_t i = 0; i < NUMBER_OF_DATAGRAMS; ++i)
+    {
+      tap(recorder, std::chrono::nanoseconds(i), "datagram");
+    }
+    dropped = recorder.numberOfDroppedDatagrams();
+    recorded = NUMBER_OF_DATAGRAMS - dropped;
+  }
+
+  EXPECT_GT(dropped, 0u);
+  std::ifstream log(file, std::ios::binary);
+  EXPECT_EQ(recorded, readDatagramLog(log).size());
+}
+
+TEST_F(DatagramRecorderTest, shouldThrowIfFileCannotBeOpened)
+{
+  EXPECT_THROW(DatagramRecorder("/nonexistent/recording.log"), std::runtime_error);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,262 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/communication_layer/datagram_log.h"
+#include "psen_scan_v2_standalone/communication_layer/flight_recorder.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_msg.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/monitoring_frame_serialization.h"
+#include "psen_scan_v2_standalone/util/temporary_files.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace psen_scan_v2_standalone::communication_layer;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr std::size_t RING_CAPACITY{ 1024 };
+static constexpr std::chrono::seconds WAIT_TIMEOUT{ 3 };
+
+class FlightRecorderTest : public TemporaryFilesTest
+{
+protected:
+  static void tap(FlightRecorder& recorder, const uint64_t& index, const std::size_t& length = 100)
+  {
+    const std::string data(length, static_cast<char>('a' + index % 26));
+    recorder.tap(std::chrono::nanoseconds(index), data.data(), data.size());
+  }
+
+  static void expectDatagram(const RecordedDatagram& datagram, const uint64_t& index, const std::size_t& length = 100)
+  {
+    EXPECT_EQ(std::chrono::nanoseconds(index), datagram.timestamp);
+    EXPECT_EQ(std::string(length, static_cast<char>('a' + index % 26)),
+              std::string(datagram.data.begin(), datagram.data.end()));
+  }
+};
+
+TEST_F(FlightRecorderTest, shouldReturnTappedDatagramsInSnapshot)
+{
+  FlightRecorder recorder(filename(".ring"), RING_CAPACITY);
+  tap(recorder, 1);
+  tap(recorder, 2);
+
+  const auto datagrams{ recorder.snapshot() };
+  ASSERT_EQ(2u, datagrams.size());
+  expectDatagram(datagrams[0], 1);
+  expectDatagram(datagrams[1], 2);
+  EXPECT_EQ(2u, recorder.numberOfRecordedDatagrams());
+}
+
+TEST_F(FlightRecorderTest, shouldKeepOnlyLatestDatagramsWhenRingIsFull)
+{
+  FlightRecorder recorder(filename(".ring"), RING_CAPACITY);
+  // Each record takes 120 bytes, so the records wrap around the end of the ring at different offsets.
+  constexpr uint64_t NUMBER_OF_DATAGRAMS{ 50 };
+  for (uint64_t i = 0; i < NUMBER_OF_DATAGRAMS; ++i)
+  {
+    tap(recorder, i);
+  }
+
+  const auto datagrams{ recorder.snapshot() };
+  ASSERT_EQ(RING_CAPACITY / 120, datagrams.size());
+  for (std::size_t i = 0; i < datagrams.size(); ++i)
+  {
+    expectDatagram(datagrams[i], NUMBER_OF_DATAGRAMS - datagrams.size() + i);
+  }
+}
+
+TEST_F(FlightRecorderTest, shouldKeepDatagramsInFileAfterDestruction)
+{
+  const std::string file{ filename(".ring") };
+  {
+    FlightRecorder recorder(file, RING_CAPACITY);
+    for (uint64_t i = 0; i < 20; ++i)
+    {
+      tap(recorder, i, i * 7);
+    }
+  }
+
+  const auto datagrams{ readRecording(file) };
+  ASSERT_FALSE(datagrams.empty());
+  const uint64_t first{ 20 - datagrams.size() };
+  for (std::size_t i = 0; i < datagrams.size(); ++i)
+  {
+    expectDatagram(datagrams[i], first + i, (first + i) * 7);
+  }
+}
+
+TEST_F(FlightRecorderTest, shouldWriteSnapshotAsRawDatagramLog)
+{
+  FlightRecorder recorder(filename(".ring"), RING_CAPACITY);
+  tap(recorder, 1);
+  tap(recorder, 2);
+
+  const std::string snapshot{ filename(".log") };
+  recorder.writeSnapshot(snapshot);
+  std::ifstream log(snapshot, std::ios::binary);
+  const auto datagrams{ readDatagramLog(log) };
+  ASSERT_EQ(2u, datagrams.size());
+  expectDatagram(datagrams[0], 1);
+  expectDatagram(datagrams[1], 2);
+}
+
+TEST_F(FlightRecorderTest, shouldDropDatagramsLargerThanRing)
+{
+  FlightRecorder recorder(filename(".ring"), RING_CAPACITY);
+  tap(recorder, 1);
+  tap(recorder, 2, RING_CAPACITY);
+
+  const auto datagrams{ recorder.snapshot() };
+  ASSERT_EQ(1u, datagrams.size());
+  expectDatagram(datagrams[0], 1);
+  EXPECT_EQ(1u, recorder.numberOfDroppedDatagrams());
+}
+
+TEST_F(FlightRecorderTest, shouldReturnConsistentSnapshotsWhileTapping)
+{
+  FlightRecorder recorder(filename(".ring"), RING_CAPACITY);
+  constexpr uint64_t NUMBER_OF_DATAGRAMS{ 100000 };
+  std::thread writer([&recorder]() {
+    for (uint64_t i = 0; i < NUMBER_OF_DATAGRAMS; ++i)
+    {
+      tap(recorder, i, i % 200);
+    }
+  });
+
+  for (std::size_t snapshot = 0; snapshot < 1000; ++snapshot)
+  {
+    const auto datagrams{ recorder.snapshot() };
+    for (std::size_t i = 0; i < datagrams.size(); ++i)
+    {
+      const auto index{ static_cast<uint64_t>(datagrams[i].timestamp.count()) };
+      ASSERT_EQ(std::string(index % 200, static_cast<char>('a' + index % 26)),
+                std::string(datagrams[i].data.begin(), datagrams[i].data.end()));
+      if (i > 0)
+      {
+        ASSERT_EQ(datagrams[i - 1].timestamp.count() + 1, datagrams[i].timestamp.count());
+      }
+    }
+  }
+  writer.join();
+}
+
+TEST_F(FlightRecorderTest, shouldWriteSnapshotOnSignal)
+{
+  FlightRecorder recorder(filename(".ring"), RING_CAPACITY);
+  const std::string directory{ testing::TempDir() };
+  const std::string snapshot{ temporaryFilename("_snapshot") };
+  const std::string prefix{ snapshot.substr(directory.size()) };
+  recorder.snapshotOnSignal(SIGUSR1, snapshot);
+  tap(recorder, 1);
+  std::raise(SIGUSR1);
+
+  // The snapshot is written by the thread of the recorder, so it may not be complete right away.
+  std::vector<RecordedDatagram> datagrams;
+  const auto deadline{ std::chrono::steady_clock::now() + WAIT_TIMEOUT };
+  while (datagrams.empty() && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    DIR* dir{ ::opendir(directory.c_str()) };
+    while (const dirent* entry = ::readdir(dir))
+    {
+      if (std::string(entry->d_name).compare(0, prefix.size(), prefix) == 0)
+      {
+        const std::string name{ directory + entry->d_name };
+        removeAfterTest(name);
+        std::ifstream log(name, std::ios::binary);
+        try
+        {
+          datagrams = readDatagramLog(log);
+        }
+        catch (const DatagramLogError&)
+        {
+        }
+      }
+    }
+    ::closedir(dir);
+  }
+  ASSERT_EQ(1u, datagrams.size()) << "No snapshot written";
+  expectDatagram(datagrams[0], 1);
+}
+
+TEST_F(FlightRecorderTest, shouldThrowOnSecondCallOfSnapshotOnSignal)
+{
+  FlightRecorder recorder(filename(".ring"), RING_CAPACITY);
+  recorder.snapshotOnSignal(SIGUSR2, filename("_snapshot"));
+  EXPECT_THROW(recorder.snapshotOnSignal(SIGUSR2, filename("_snapshot")), std::logic_error);
+}
+
+TEST_F(FlightRecorderTest, shouldThrowIfFileCannotBeOpened)
+{
+  EXPECT_THROW(FlightRecorder("/nonexistent/flight.ring", RING_CAPACITY), std::runtime_error);
+}
+
+TEST_F(FlightRecorderTest, shouldRoundCapacityUpToRecordAlignment)
+{
+  FlightRecorder recorder(filename(".ring"), RING_CAPACITY + 1);
+  EXPECT_EQ(RING_CAPACITY + FLIGHT_RECORD_ALIGNMENT, recorder.capacity());
+}
+
+TEST_F(FlightRecorderTest, shouldComputeCapacityOfDuration)
+{
+  EXPECT_EQ(30u * 200u * (FLIGHT_RECORD_HEADER_SIZE + FLIGHT_RECORD_ALIGNMENT) + 30u * 100000u,
+            FlightRecorder::capacityFor(std::chrono::seconds(30), 200., 100000.));
+}
+
+TEST_F(FlightRecorderTest, shouldThrowOnCorruptFlightRecording)
+{
+  const std::string file{ filename(".ring") };
+  {
+    FlightRecorder recorder(file, RING_CAPACITY);
+    tap(recorder, 1);
+  }
+  std::fstream ring(file, std::ios::binary | std::ios::in | std::ios::out);
+  ring.seekp(FLIGHT_RECORDING_HEADER_SIZE + 8);
+  ring.put(static_cast<char>(0xff));
+  ring.close();
+
+  EXPECT_THROW(readRecording(file), DatagramLogError);
+}
+
+TEST_F(FlightRecorderTest, shouldDecodeMonitoringFramesAndSkipInvalidDatagrams)
+{
+  const data_conversion_layer::monitoring_frame::Message frame(
+      util::TenthOfDegree(100), util::TenthOfDegree(10), 7, { 1., 2., 3. });
+  std::vector<RecordedDatagram> datagrams(2);
+  datagrams[0].data = data_conversion_layer::monitoring_frame::serialize(frame);
+  datagrams[1].data = { 'n', 'o', ' ', 'f', 'r', 'a', 'm', 'e' };
+
+  const auto frames{ decodeMonitoringFrames(datagrams) };
+  ASSERT_EQ(1u, frames.size());
+  EXPECT_EQ(frame, frames[0]);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,152 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/communication_layer/replay_source.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace psen_scan_v2_standalone::communication_layer;
+using namespace std::chrono_literals;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr std::chrono::seconds WAIT_TIMEOUT{ 3 };
+
+static std::vector<RecordedDatagram> createDatagrams(const std::vector<std::chrono::milliseconds>& timestamps)
+{
+  std::vector<RecordedDatagram> datagrams;
+  for (std::size_t i = 0; i < timestamps.size(); ++i)
+  {
+    const std::string payload{ "datagram " + std::to_string(i) };
+    datagrams.push_back(
+        RecordedDatagram{ timestamps[i], data_conversion_layer::RawData(payload.begin(), payload.end()) });
+  }
+  return datagrams;
+}
+
+class DatagramRecorder
+{
+public:
+  NewDataHandler handler()
+  {
+    return [this](const data_conversion_layer::RawData& data, const std::size_t& num_bytes) {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      datagrams_.emplace_back(data.begin(), data.begin() + num_bytes);
+      times_.push_back(std::chrono::steady_clock::now());
+    };
+  }
+
+  std::vector<std::string> datagrams()
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return datagrams_;
+  }
+
+  std::vector<std::chrono::steady_clock::time_point> times()
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return times_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<std::string> datagrams_;
+  std::vector<std::chrono::steady_clock::time_point> times_;
+};
+
+TEST(ReplaySourceTest, shouldThrowOnNegativeSpeed)
+{
+  DatagramRecorder recorder;
+  EXPECT_THROW(ReplaySource(recorder.handler(), {}, -1.), std::invalid_argument);
+}
+
+TEST(ReplaySourceTest, shouldThrowOnInvalidDataHandler)
+{
+  EXPECT_THROW(ReplaySource(nullptr, {}), std::invalid_argument);
+}
+
+TEST(ReplaySourceTest, shouldPassAllDatagramsInOrderWhenReceiving)
+{
+  DatagramRecorder recorder;
+  ReplaySource source(recorder.handler(), createDatagrams({ 0ms, 1ms, 2ms }), ReplaySource::AS_FAST_AS_POSSIBLE);
+  source.startAsyncReceiving();
+  ASSERT_EQ(std::future_status::ready, source.play().wait_for(WAIT_TIMEOUT));
+
+  EXPECT_EQ((std::vector<std::string>{ "datagram 0", "datagram 1", "datagram 2" }), recorder.datagrams());
+  EXPECT_EQ(3u, source.numberOfReceivedDatagrams());
+  EXPECT_EQ(30u, source.numberOfReceivedBytes());
+}
+
+TEST(ReplaySourceTest, shouldDropDatagramsWhenNotReceiving)
+{
+  DatagramRecorder recorder;
+  ReplaySource source(recorder.handler(), createDatagrams({ 0ms, 1ms }), ReplaySource::AS_FAST_AS_POSSIBLE);
+  ASSERT_EQ(std::future_status::ready, source.play().wait_for(WAIT_TIMEOUT));
+
+  EXPECT_TRUE(recorder.datagrams().empty());
+  EXPECT_EQ(0u, source.numberOfReceivedDatagrams());
+}
+
+TEST(ReplaySourceTest, shouldPassOnlyOneDatagramInSingleMode)
+{
+  DatagramRecorder recorder;
+  ReplaySource source(recorder.handler(), createDatagrams({ 0ms, 1ms }), ReplaySource::AS_FAST_AS_POSSIBLE);
+  source.startAsyncReceiving(ReceiveMode::single);
+  ASSERT_EQ(std::future_status::ready, source.play().wait_for(WAIT_TIMEOUT));
+
+  EXPECT_EQ(std::vector<std::string>{ "datagram 0" }, recorder.datagrams());
+}
+
+TEST(ReplaySourceTest, shouldReproduceScaledTiming)
+{
+  DatagramRecorder recorder;
+  ReplaySource source(recorder.handler(), createDatagrams({ 1000ms, 1100ms, 1300ms }), 2.);
+  source.startAsyncReceiving();
+  ASSERT_EQ(std::future_status::ready, source.play().wait_for(WAIT_TIMEOUT));
+
+  const auto times{ recorder.times() };
+  ASSERT_EQ(3u, times.size());
+  EXPECT_GE(times[1] - times[0], 40ms);
+  EXPECT_GE(times[2] - times[0], 140ms);
+}
+
+TEST(ReplaySourceTest, shouldStopPlaybackOnDestruction)
+{
+  DatagramRecorder recorder;
+  const auto start{ std::chrono::steady_clock::now() };
+  {
+    ReplaySource source(recorder.handler(), createDatagrams({ 0ms, 1h }));
+    source.startAsyncReceiving();
+    source.play();
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, WAIT_TIMEOUT);
+  EXPECT_LE(recorder.datagrams().size(), 1u);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -13,6 +13,9 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+#include <chrono>
+#include <csignal>
+#include <functional>
 #include <stdexcept>
 #include <string>
 #include <limits>
@@ -330,6 +333,209 @@ TEST_F(ScannerConfigurationTest, shouldThrowInvalidArgumentWithResolutionViolati
   EXPECT_THROW(sb.scanResolution(util::TenthOfDegree{ 101u }), std::invalid_argument);
 }
 
+TEST_F(ScannerConfigurationTest, shouldReturnDefaultPipelinedProcessing)
+{
+  const ScannerConfiguration sc{ createValidDefaultConfig() };
+  EXPECT_EQ(configuration::PIPELINED_PROCESSING, sc.pipelinedProcessingEnabled());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnSetPipelinedProcessing)
+{
+  const ScannerConfiguration sc{
+    ScannerConfigurationBuilder().scannerIp(VALID_IP).scanRange(SCAN_RANGE).enablePipelinedProcessing(true).build()
+  };
+  EXPECT_TRUE(sc.pipelinedProcessingEnabled());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnPerfCountersDisabledByDefault)
+{
+  const ScannerConfiguration sc{ createValidDefaultConfig() };
+  EXPECT_FALSE(sc.perfCountersEnabled());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnSetPerfCounters)
+{
+  const ScannerConfiguration sc{
+    ScannerConfigurationBuilder().scannerIp(VALID_IP).scanRange(SCAN_RANGE).enablePerfCounters(true).build()
+  };
+  EXPECT_TRUE(sc.perfCountersEnabled());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnFastStartDisabledByDefault)
+{
+  const ScannerConfiguration sc{ createValidDefaultConfig() };
+  EXPECT_FALSE(sc.fastStartEnabled());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnSetFastStart)
+{
+  const ScannerConfiguration sc{
+    ScannerConfigurationBuilder().scannerIp(VALID_IP).scanRange(SCAN_RANGE).enableFastStart(true).build()
+  };
+  EXPECT_TRUE(sc.fastStartEnabled());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnIoUringDisabledByDefault)
+{
+  const ScannerConfiguration sc{ createValidDefaultConfig() };
+  EXPECT_FALSE(sc.ioUringEnabled());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnSetIoUring)
+{
+  const ScannerConfiguration sc{
+    ScannerConfigurationBuilder().scannerIp(VALID_IP).scanRange(SCAN_RANGE).enableIoUring(true).build()
+  };
+  EXPECT_TRUE(sc.ioUringEnabled());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnEmptyCallbackExecutorByDefault)
+{
+  const ScannerConfiguration sc{ createValidDefaultConfig() };
+  EXPECT_FALSE(sc.callbackExecutor());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnSetCallbackExecutor)
+{
+  int num_executed_tasks{ 0 };
+  const ScannerConfiguration sc{ ScannerConfigurationBuilder()
+                                     .scannerIp(VALID_IP)
+                                     .scanRange(SCAN_RANGE)
+                                     .callbackExecutor([&num_executed_tasks](std::function<void()> task) {
+                                       ++num_executed_tasks;
+                                       task();
+                                     })
+                                     .build() };
+  ASSERT_TRUE(sc.callbackExecutor());
+
+  bool task_called{ false };
+  sc.callbackExecutor()([&task_called]() { task_called = true; });
+  EXPECT_TRUE(task_called);
+  EXPECT_EQ(1, num_executed_tasks);
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnNoTraceFileByDefault)
+{
+  const ScannerConfiguration sc{ createValidDefaultConfig() };
+  EXPECT_FALSE(sc.traceFile());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnSetTraceFile)
+{
+  const ScannerConfiguration sc{
+    ScannerConfigurationBuilder().scannerIp(VALID_IP).scanRange(SCAN_RANGE).traceFile("/tmp/trace.json").build()
+  };
+  ASSERT_TRUE(sc.traceFile());
+  EXPECT_EQ("/tmp/trace.json", sc.traceFile().value());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnNoDatagramRecordingFileByDefault)
+{
+  const ScannerConfiguration sc{ createValidDefaultConfig() };
+  EXPECT_FALSE(sc.datagramRecordingFile());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnSetDatagramRecordingFile)
+{
+  const ScannerConfiguration sc{
+    ScannerConfigurationBuilder().scannerIp(VALID_IP).scanRange(SCAN_RANGE).recordDatagrams("/tmp/scan.pcap").build()
+  };
+  ASSERT_TRUE(sc.datagramRecordingFile());
+  EXPECT_EQ("/tmp/scan.pcap", sc.datagramRecordingFile().value());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnNoFlightRecorderByDefault)
+{
+  const ScannerConfiguration sc{ createValidDefaultConfig() };
+  EXPECT_FALSE(sc.flightRecorderFile());
+  EXPECT_EQ(configuration::FLIGHT_RECORDER_DURATION, sc.flightRecorderDuration());
+  EXPECT_FALSE(sc.flightRecorderSnapshotSignal());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnSetFlightRecorder)
+{
+  const ScannerConfiguration sc{ ScannerConfigurationBuilder()
+                                     .scannerIp(VALID_IP)
+                                     .scanRange(SCAN_RANGE)
+                                     .flightRecorder("/dev/shm/flight.ring", std::chrono::seconds(10))
+                                     .snapshotFlightRecorderOnSignal(SIGINT)
+                                     .build() };
+  ASSERT_TRUE(sc.flightRecorderFile());
+  EXPECT_EQ("/dev/shm/flight.ring", sc.flightRecorderFile().value());
+  EXPECT_EQ(std::chrono::seconds(10), sc.flightRecorderDuration());
+  ASSERT_TRUE(sc.flightRecorderSnapshotSignal());
+  EXPECT_EQ(SIGINT, sc.flightRecorderSnapshotSignal().value());
+}
+
+TEST_F(ScannerConfigurationTest, shouldThrowOnSnapshotSignalWithoutFlightRecorder)
+{
+  EXPECT_THROW(ScannerConfigurationBuilder()
+                   .scannerIp(VALID_IP)
+                   .scanRange(SCAN_RANGE)
+                   .snapshotFlightRecorderOnSignal(SIGINT)
+                   .build(),
+               std::invalid_argument);
+}
+
+TEST_F(ScannerConfigurationTest, shouldThrowOnNonPositiveFlightRecorderDuration)
+{
+  EXPECT_THROW(ScannerConfigurationBuilder()
+                   .scannerIp(VALID_IP)
+                   .scanRange(SCAN_RANGE)
+                   .flightRecorder("/dev/shm/flight.ring", std::chrono::seconds(0))
+                   .build(),
+               std::invalid_argument);
+}
+
+TEST_F(ScannerConfigurationTest, shouldHaveDistinctThreadNamesByDefault)
+{
+  const ScannerConfiguration sc{ createValidDefaultConfig() };
+  EXPECT_EQ(configuration::IO_THREAD_NAME, sc.threadSettings(util::ThreadRole::io).name);
+  EXPECT_EQ(configuration::WATCHDOG_THREAD_NAME, sc.threadSettings(util::ThreadRole::watchdog).name);
+  EXPECT_EQ(configuration::DISPATCHER_THREAD_NAME, sc.threadSettings(util::ThreadRole::dispatcher).name);
+  EXPECT_FALSE(sc.threadSettings(util::ThreadRole::io).fifo_priority);
+  EXPECT_EQ(configuration::MEMORY_LOCKING, sc.memoryLockingEnabled());
+}
+
+TEST_F(ScannerConfigurationTest, shouldReturnSetThreadSettings)
+{
+  util::ThreadSettings settings;
+  settings.name = "front_io";
+  settings.fifo_priority = 80;
+  settings.cpu_affinity_mask = 0x4;
+
+  const ScannerConfiguration sc{ ScannerConfigurationBuilder()
+                                     .scannerIp(VALID_IP)
+                                     .scanRange(SCAN_RANGE)
+                                     .threadSettings(util::ThreadRole::io, settings)
+                                     .enableMemoryLocking(true)
+                                     .build() };
+
+  EXPECT_EQ(settings.name, sc.threadSettings(util::ThreadRole::io).name);
+  EXPECT_EQ(settings.fifo_priority, sc.threadSettings(util::ThreadRole::io).fifo_priority);
+  EXPECT_EQ(settings.cpu_affinity_mask, sc.threadSettings(util::ThreadRole::io).cpu_affinity_mask);
+  EXPECT_EQ(configuration::WATCHDOG_THREAD_NAME, sc.threadSettings(util::ThreadRole::watchdog).name);
+  EXPECT_TRUE(sc.memoryLockingEnabled());
+}
+
+TEST_F(ScannerConfigurationTest, shouldThrowInvalidArgumentWithTooLongThreadName)
+{
+  util::ThreadSettings settings;
+  settings.name = "name_with_16_chr";
+  EXPECT_THROW(ScannerConfigurationBuilder().threadSettings(util::ThreadRole::io, settings), std::invalid_argument);
+}
+
+TEST_F(ScannerConfigurationTest, shouldThrowInvalidArgumentWithFifoPriorityOutOfRange)
+{
+  util::ThreadSettings settings;
+  settings.fifo_priority = util::MAX_FIFO_PRIORITY + 1;
+  EXPECT_THROW(ScannerConfigurationBuilder().threadSettings(util::ThreadRole::watchdog, settings),
+               std::invalid_argument);
+  settings.fifo_priority = util::MIN_FIFO_PRIORITY - 1;
+  EXPECT_THROW(ScannerConfigurationBuilder().threadSettings(util::ThreadRole::watchdog, settings),
+               std::invalid_argument);
+}
+
 }  // namespace psen_scan_v2_standalone_test
 
 int main(int argc, char* argv[])
@@ -121,6 +121,16 @@ TEST(LaserScanConversionsTest, laserScanShouldContainCorrectIntensitiesAfterConv
       << " in LaserScan is: " << *(mismatch_pair.first) << ", but expected: " << *(mismatch_pair.second);
 }
 
+TEST(LaserScanConversionsTest, laserScanShouldContainScanCounterAfterConversion)
+{
+  const data_conversion_layer::monitoring_frame::Message frame{ createMsg() };
+
+  std::unique_ptr<LaserScan> scan_ptr;
+  ASSERT_NO_THROW(scan_ptr.reset(new LaserScan{ data_conversion_layer::LaserScanConverter::toLaserScan({ frame }) }););
+
+  EXPECT_EQ(frame.scanCounter(), scan_ptr->getScanCounter());
+}
+
 TEST(LaserScanConversionsTest, shouldThrowProtocolErrorOnMismatchingResolutions)
 {
   auto msgs = createMsgs(6);
@@ -111,6 +111,25 @@ TEST(MonitoringFrameSerializationTest, shouldFailOnSerializeAndDeserializeFrameW
   EXPECT_EQ(deserialized_msg.intensities().at(0), 0b0011111111111111 & 70045);
 }
 
+TEST(MonitoringFrameSerializationTest, shouldComputeSizeOfSerializedFrame)
+{
+  using data_conversion_layer::monitoring_frame::maxSize;
+  const std::vector<double> measurements(275, 1.);
+  const std::vector<double> intensities(275, 10.);
+
+  const data_conversion_layer::monitoring_frame::Message frame(
+      util::TenthOfDegree(25), util::TenthOfDegree(1), 1, measurements);
+  EXPECT_EQ(serialize(frame).size(), maxSize(measurements.size(), false, false));
+
+  const data_conversion_layer::monitoring_frame::Message frame_with_intensities_and_diagnostics(
+      util::TenthOfDegree(25), util::TenthOfDegree(1), 1, measurements, intensities, {});
+  EXPECT_EQ(serialize(frame_with_intensities_and_diagnostics).size(), maxSize(measurements.size(), true, true));
+
+  const data_conversion_layer::monitoring_frame::Message empty_frame(
+      util::TenthOfDegree(25), util::TenthOfDegree(1), 1, {}, {}, {});
+  EXPECT_EQ(serialize(empty_frame).size(), maxSize(0, false, true));
+}
+
 TEST(MonitoringFrameSerializationDiagnosticMessagesTest, shouldSetCorrectBitInSerializedDiagnosticData)
 {
   std::vector<data_conversion_layer::monitoring_frame::diagnostic::Message> diagnostic_data{
@@ -0,0 +1,140 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/data_conversion_layer/start_request.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/start_request_serialization.h"
+#include "psen_scan_v2_standalone/data_conversion_layer/stop_request_serialization.h"
+#include "psen_scan_v2_standalone/scanner_config_builder.h"
+#include "psen_scan_v2_standalone/simulation/scanner_simulator.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static const std::string HOST_IP{ "192.168.0.50" };
+static constexpr int HOST_DATA_PORT{ 50505 };
+static const ScanRange SCAN_RANGE{ util::TenthOfDegree(100), util::TenthOfDegree(2000) };
+static const util::TenthOfDegree RESOLUTION{ 2 };
+
+static data_conversion_layer::RawData serializeStartRequest(const bool& intensities, const bool& diagnostics)
+{
+  const ScannerConfiguration config{ ScannerConfigurationBuilder()
+                                         .hostIP(HOST_IP)
+                                         .hostDataPort(HOST_DATA_PORT)
+                                         .scannerIp("192.168.0.10")
+                                         .scanRange(SCAN_RANGE)
+                                         .scanResolution(RESOLUTION)
+                                         .enableIntensities(intensities)
+                                         .enableDiagnostics(diagnostics)
+                                         .build() };
+  return data_conversion_layer::start_request::serialize(data_conversion_layer::start_request::Message(config));
+}
+
+TEST(ScannerSimulatorTest, shouldParseSettingsOfStartRequest)
+{
+  const simulation::StartRequestSettings settings{ simulation::parseStartRequest(serializeStartRequest(true, false)) };
+  EXPECT_EQ(HOST_IP, settings.host_ip);
+  EXPECT_EQ(HOST_DATA_PORT, settings.host_data_port);
+  EXPECT_EQ(SCAN_RANGE.getStart(), settings.scan_range.getStart());
+  EXPECT_EQ(SCAN_RANGE.getEnd(), settings.scan_range.getEnd());
+  EXPECT_EQ(RESOLUTION, settings.resolution);
+  EXPECT_TRUE(settings.intensities_enabled);
+  EXPECT_FALSE(settings.diagnostics_enabled);
+}
+
+TEST(ScannerSimulatorTest, shouldParseEnabledDiagnostics)
+{
+  const simulation::StartRequestSettings settings{ simulation::parseStartRequest(serializeStartRequest(false, true)) };
+  EXPECT_FALSE(settings.intensities_enabled);
+  EXPECT_TRUE(settings.diagnostics_enabled);
+}
+
+TEST(ScannerSimulatorTest, shouldThrowOnParsingStopRequest)
+{
+  EXPECT_THROW(simulation::parseStartRequest(data_conversion_layer::stop_request::serialize()),
+               simulation::ControlMessageFailure);
+}
+
+static void expectContiguousFrames(const std::vector<simulation::FrameLayout>& layout,
+                                   const ScanRange& scan_range,
+                                   const util::TenthOfDegree& resolution)
+{
+  ASSERT_EQ(simulation::FRAMES_PER_SCAN_ROUND, layout.size());
+  util::TenthOfDegree next_angle{ scan_range.getStart() };
+  std::size_t number_of_measurements{ 0 };
+  for (const auto& frame : layout)
+  {
+    if (frame.number_of_measurements > 0)
+    {
+      EXPECT_EQ(next_angle, frame.from_theta);
+      next_angle = frame.from_theta + resolution * static_cast<int>(frame.number_of_measurements);
+      number_of_measurements += frame.number_of_measurements;
+    }
+  }
+  const int range_width{ scan_range.getEnd().value() - scan_range.getStart().value() };
+  EXPECT_EQ(static_cast<std::size_t>(range_width / resolution.value()), number_of_measurements);
+}
+
+TEST(ScannerSimulatorTest, shouldSplitFullScanRangeIntoSixFilledFrames)
+{
+  const ScanRange full_range{ util::TenthOfDegree(0), util::TenthOfDegree(2750) };
+  const std::vector<simulation::FrameLayout> layout{ simulation::computeFrameLayout(full_range,
+                                                                                    util::TenthOfDegree(1)) };
+
+  expectContiguousFrames(layout, full_range, util::TenthOfDegree(1));
+  for (const auto& frame : layout)
+  {
+    EXPECT_GT(frame.number_of_measurements, 0u);
+  }
+}
+
+TEST(ScannerSimulatorTest, shouldSplitScanRangeAccordingToResolution)
+{
+  const std::vector<simulation::FrameLayout> layout{ simulation::computeFrameLayout(SCAN_RANGE, RESOLUTION) };
+
+  expectContiguousFrames(layout, SCAN_RANGE, RESOLUTION);
+  EXPECT_EQ(SCAN_RANGE.getStart(), layout.front().from_theta);
+  EXPECT_EQ(179u, layout.front().number_of_measurements);
+  EXPECT_EQ(0u, layout.back().number_of_measurements);
+}
+
+TEST(ScannerSimulatorTest, shouldSendFramesWithoutMeasurementsOutsideOfSmallScanRange)
+{
+  const ScanRange small_range{ util::TenthOfDegree(1370), util::TenthOfDegree(1380) };
+  const std::vector<simulation::FrameLayout> layout{ simulation::computeFrameLayout(small_range,
+                                                                                    util::TenthOfDegree(1)) };
+
+  expectContiguousFrames(layout, small_range, util::TenthOfDegree(1));
+  EXPECT_EQ(0u, layout.at(0).number_of_measurements);
+  EXPECT_EQ(0u, layout.at(1).number_of_measurements);
+  EXPECT_EQ(5u, layout.at(2).number_of_measurements);
+  EXPECT_EQ(5u, layout.at(3).number_of_measurements);
+  EXPECT_EQ(0u, layout.at(4).number_of_measurements);
+  EXPECT_EQ(0u, layout.at(5).number_of_measurements);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/util/allocation_tags.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+TEST(AllocationTagsTest, shouldBeOtherByDefault)
+{
+  EXPECT_EQ(util::AllocationTag::other, util::currentAllocationTag());
+}
+
+TEST(AllocationTagsTest, shouldSetTagDuringLifetimeOfScope)
+{
+  {
+    const util::AllocationTagScope scope(util::AllocationTag::decode);
+    EXPECT_EQ(util::AllocationTag::decode, util::currentAllocationTag());
+  }
+  EXPECT_EQ(util::AllocationTag::other, util::currentAllocationTag());
+}
+
+TEST(AllocationTagsTest, shouldRestorePreviousTagOfNestedScope)
+{
+  const util::AllocationTagScope outer_scope(util::AllocationTag::udp);
+  {
+    const util::AllocationTagScope inner_scope(util::AllocationTag::conversion);
+    EXPECT_EQ(util::AllocationTag::conversion, util::currentAllocationTag());
+  }
+  EXPECT_EQ(util::AllocationTag::udp, util::currentAllocationTag());
+}
+
+TEST(AllocationTagsTest, shouldKeepTagsOfThreadsApart)
+{
+  const util::AllocationTagScope scope(util::AllocationTag::buffer);
+  util::AllocationTag tag_of_other_thread{ util::AllocationTag::callback };
+  std::thread other_thread([&tag_of_other_thread]() { tag_of_other_thread = util::currentAllocationTag(); });
+  other_thread.join();
+  EXPECT_EQ(util::AllocationTag::other, tag_of_other_thread);
+  EXPECT_EQ(util::AllocationTag::buffer, util::currentAllocationTag());
+}
+
+TEST(AllocationTagsTest, shouldNameAllTags)
+{
+  EXPECT_EQ(std::string("other"), util::allocationTagName(util::AllocationTag::other));
+  EXPECT_EQ(std::string("udp"), util::allocationTagName(util::AllocationTag::udp));
+  EXPECT_EQ(std::string("decode"), util::allocationTagName(util::AllocationTag::decode));
+  EXPECT_EQ(std::string("buffer"), util::allocationTagName(util::AllocationTag::buffer));
+  EXPECT_EQ(std::string("conversion"), util::allocationTagName(util::AllocationTag::conversion));
+  EXPECT_EQ(std::string("callback"), util::allocationTagName(util::AllocationTag::callback));
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
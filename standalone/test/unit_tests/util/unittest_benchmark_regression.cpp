@@ -0,0 +1,213 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/util/benchmark_regression.h"
+
+namespace psen_scan_v2_standalone_test
+{
+using namespace benchmark_regression;
+
+static std::vector<Record> records(const std::string& lines)
+{
+  std::istringstream is(lines);
+  return readRecords(is);
+}
+
+static const Rules LOOPBACK_RULES{ parseRules(records(
+    "{\"benchmark\": \"loopback\", \"key\": \"rate_multiplier\"}\n"
+    "{\"benchmark\": \"loopback\", \"metric\": \"latency_us\", \"better\": \"lower\", \"relative\": 0.5}\n"
+    "{\"benchmark\": \"loopback\", \"metric\": \"frames_per_s\", \"better\": \"higher\", \"absolute\": 10}\n")) };
+
+TEST(BenchmarkRegressionTest, shouldParseFlatRecord)
+{
+  const Record record{ parseRecord("{\"benchmark\": \"loopback\", \"rate\": 5, \"p99\": 1.5e3, \"ok\": true}") };
+  EXPECT_EQ(4u, record.size());
+  EXPECT_EQ("loopback", record.at("benchmark"));
+  EXPECT_EQ("5", record.at("rate"));
+  EXPECT_EQ("1.5e3", record.at("p99"));
+  EXPECT_EQ("true", record.at("ok"));
+}
+
+TEST(BenchmarkRegressionTest, shouldParseEscapedQuotes)
+{
+  EXPECT_EQ("a \"b\"", parseRecord("{\"name\": \"a \\\"b\\\"\"}").at("name"));
+}
+
+TEST(BenchmarkRegressionTest, shouldParseEmptyRecord)
+{
+  EXPECT_TRUE(parseRecord(" { } ").empty());
+}
+
+TEST(BenchmarkRegressionTest, shouldThrowOnInvalidRecords)
+{
+  EXPECT_THROW(parseRecord("benchmark"), std::invalid_argument);
+  EXPECT_THROW(parseRecord("{\"benchmark\": \"loopback\""), std::invalid_argument);
+  EXPECT_THROW(parseRecord("{\"benchmark\": }"), std::invalid_argument);
+  EXPECT_THROW(parseRecord("{\"values\": [1, 2]}"), std::invalid_argument);
+  EXPECT_THROW(parseRecord("{\"rate\": 1} trailing"), std::invalid_argument);
+}
+
+TEST(BenchmarkRegressionTest, shouldSkipLinesWhichAreNoRecords)
+{
+  const auto result{ records("Scanner started\n{\"benchmark\": \"a\"}\n\n  {\"benchmark\": \"b\"}\n") };
+  ASSERT_EQ(2u, result.size());
+  EXPECT_EQ("a", result[0].at("benchmark"));
+  EXPECT_EQ("b", result[1].at("benchmark"));
+}
+
+TEST(BenchmarkRegressionTest, shouldParseRules)
+{
+  EXPECT_EQ("rate_multiplier", LOOPBACK_RULES.keys.at("loopback"));
+  ASSERT_EQ(2u, LOOPBACK_RULES.tolerances.size());
+  EXPECT_EQ("latency_us", LOOPBACK_RULES.tolerances[0].metric);
+  EXPECT_EQ(Direction::lower_is_better, LOOPBACK_RULES.tolerances[0].direction);
+  EXPECT_DOUBLE_EQ(0.5, LOOPBACK_RULES.tolerances[0].relative);
+  EXPECT_DOUBLE_EQ(0., LOOPBACK_RULES.tolerances[0].absolute);
+  EXPECT_EQ(Direction::higher_is_better, LOOPBACK_RULES.tolerances[1].direction);
+  EXPECT_DOUBLE_EQ(10., LOOPBACK_RULES.tolerances[1].absolute);
+}
+
+TEST(BenchmarkRegressionTest, shouldThrowOnInvalidRules)
+{
+  EXPECT_THROW(parseRules(records("{\"metric\": \"latency_us\", \"better\": \"lower\"}")), std::invalid_argument);
+  EXPECT_THROW(parseRules(records("{\"benchmark\": \"loopback\"}")), std::invalid_argument);
+  EXPECT_THROW(parseRules(records("{\"benchmark\": \"loopback\", \"metric\": \"latency_us\"}")),
+               std::invalid_argument);
+  EXPECT_THROW(
+      parseRules(records("{\"benchmark\": \"loopback\", \"metric\": \"latency_us\", \"better\": \"lower\", "
+                         "\"relative\": \"much\"}")),
+      std::invalid_argument);
+  EXPECT_THROW(
+      parseRules(records("{\"benchmark\": \"loopback\", \"metric\": \"latency_us\", \"better\": \"lower\", "
+                         "\"absolute\": -1}")),
+      std::invalid_argument);
+}
+
+TEST(BenchmarkRegressionTest, shouldAddRelativeAndAbsoluteTolerance)
+{
+  Tolerance tolerance;
+  tolerance.relative = 0.5;
+  tolerance.absolute = 10.;
+  EXPECT_DOUBLE_EQ(160., tolerance.limit(100.));
+  EXPECT_FALSE(tolerance.isRegression(100., 160.));
+  EXPECT_TRUE(tolerance.isRegression(100., 160.1));
+
+  tolerance.direction = Direction::higher_is_better;
+  EXPECT_DOUBLE_EQ(40., tolerance.limit(100.));
+  EXPECT_FALSE(tolerance.isRegression(100., 40.));
+  EXPECT_TRUE(tolerance.isRegression(100., 39.9));
+}
+
+TEST(BenchmarkRegressionTest, shouldPassWithinTolerances)
+{
+  const auto baseline{ records("{\"benchmark\": \"loopback\", \"rate_multiplier\": 1, \"latency_us\": 100, "
+                               "\"frames_per_s\": 200}\n"
+                               "{\"benchmark\": \"loopback\", \"rate_multiplier\": 5, \"latency_us\": 200, "
+                               "\"frames_per_s\": 1000}") };
+  // Records are matched by their key, not by their order.
+  const auto current{ records("{\"benchmark\": \"loopback\", \"rate_multiplier\": 5, \"latency_us\": 300, "
+                              "\"frames_per_s\": 990}\n"
+                              "{\"benchmark\": \"loopback\", \"rate_multiplier\": 1, \"latency_us\": 50, "
+                              "\"frames_per_s\": 500}") };
+
+  const CheckResult result{ check(baseline, current, LOOPBACK_RULES) };
+  EXPECT_TRUE(result.passed());
+  ASSERT_EQ(4u, result.comparisons.size());
+  EXPECT_EQ("loopback rate_multiplier=1", result.comparisons[0].record);
+  EXPECT_EQ("latency_us", result.comparisons[0].metric);
+  EXPECT_DOUBLE_EQ(100., result.comparisons[0].baseline);
+  EXPECT_DOUBLE_EQ(50., result.comparisons[0].current);
+  EXPECT_DOUBLE_EQ(150., result.comparisons[0].limit);
+  EXPECT_EQ("loopback rate_multiplier=5", result.comparisons[2].record);
+  EXPECT_DOUBLE_EQ(300., result.comparisons[2].current);
+}
+
+TEST(BenchmarkRegressionTest, shouldDetectRegression)
+{
+  const auto baseline{ records("{\"benchmark\": \"loopback\", \"rate_multiplier\": 1, \"latency_us\": 100, "
+                               "\"frames_per_s\": 200}") };
+  const auto current{ records("{\"benchmark\": \"loopback\", \"rate_multiplier\": 1, \"latency_us\": 100, "
+                              "\"frames_per_s\": 189}") };
+
+  const CheckResult result{ check(baseline, current, LOOPBACK_RULES) };
+  EXPECT_FALSE(result.passed());
+  ASSERT_EQ(2u, result.comparisons.size());
+  EXPECT_FALSE(result.comparisons[0].regression);
+  EXPECT_TRUE(result.comparisons[1].regression);
+  EXPECT_EQ("frames_per_s", result.comparisons[1].metric);
+}
+
+TEST(BenchmarkRegressionTest, shouldFailOnMissingRecordsAndMetrics)
+{
+  const auto baseline{ records("{\"benchmark\": \"loopback\", \"rate_multiplier\": 1, \"latency_us\": 100, "
+                               "\"frames_per_s\": 200}\n"
+                               "{\"benchmark\": \"loopback\", \"rate_multiplier\": 5, \"latency_us\": 100}") };
+  const auto current{ records("{\"benchmark\": \"loopback\", \"rate_multiplier\": 1, \"latency_us\": 100}") };
+
+  const CheckResult result{ check(baseline, current, LOOPBACK_RULES) };
+  EXPECT_FALSE(result.passed());
+  const std::vector<std::string> expected_missing{ "loopback rate_multiplier=1 frames_per_s",
+                                                   "loopback rate_multiplier=5 latency_us" };
+  EXPECT_EQ(expected_missing, result.missing);
+}
+
+TEST(BenchmarkRegressionTest, shouldIgnoreNewRecordsAndMetricsWithoutTolerance)
+{
+  const auto baseline{ records("{\"benchmark\": \"conversion\", \"time_us\": 10}") };
+  const auto current{ records("{\"benchmark\": \"conversion\", \"time_us\": 1000}\n"
+                              "{\"benchmark\": \"loopback\", \"rate_multiplier\": 1, \"latency_us\": 100}") };
+
+  const CheckResult result{ check(baseline, current, LOOPBACK_RULES) };
+  EXPECT_TRUE(result.passed());
+  EXPECT_TRUE(result.comparisons.empty());
+}
+
+TEST(BenchmarkRegressionTest, shouldThrowIfComparedValueIsNoNumber)
+{
+  const auto baseline{ records("{\"benchmark\": \"loopback\", \"rate_multiplier\": 1, \"latency_us\": \"fast\"}") };
+  const auto current{ records("{\"benchmark\": \"loopback\", \"rate_multiplier\": 1, \"latency_us\": 100}") };
+  EXPECT_THROW(check(baseline, current, LOOPBACK_RULES), std::invalid_argument);
+}
+
+TEST(BenchmarkRegressionTest, shouldReadEnvironment)
+{
+  const Environment environment_of_records{ environment(
+      records("{\"benchmark\": \"loopback\", \"rate_multiplier\": 1}\n"
+              "{\"benchmark\": \"environment\", \"build_type\": \"Release\", \"host\": \"ci-1\"}\n")) };
+  EXPECT_EQ("Release", environment_of_records.build_type);
+  EXPECT_EQ("ci-1", environment_of_records.host);
+}
+
+TEST(BenchmarkRegressionTest, shouldThrowOnMissingEnvironmentOrBuildType)
+{
+  EXPECT_THROW(environment(records("{\"benchmark\": \"loopback\", \"rate_multiplier\": 1}")), std::invalid_argument);
+  EXPECT_THROW(environment(records("{\"benchmark\": \"environment\", \"build_type\": \"\", \"host\": \"ci-1\"}")),
+               std::invalid_argument);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,160 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/util/bits.h"
+#include "psen_scan_v2_standalone/util/latency_histogram.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace std::chrono_literals;
+
+namespace psen_scan_v2_standalone_test
+{
+//! Relative error of the reported percentiles.
+static constexpr double MAX_RELATIVE_ERROR{ 1. / util::LatencyHistogram::SUB_BUCKET_COUNT };
+
+static void expectNearRelative(const std::chrono::nanoseconds& expected, const std::chrono::nanoseconds& actual)
+{
+  EXPECT_GE(actual, expected);
+  EXPECT_LE(static_cast<double>(actual.count()), static_cast<double>(expected.count()) * (1. + MAX_RELATIVE_ERROR));
+}
+
+TEST(BitsTest, shouldReturnIndexOfMostSignificantBit)
+{
+  EXPECT_EQ(0u, util::mostSignificantBit(1u));
+  EXPECT_EQ(5u, util::mostSignificantBit(0x3Fu));
+  EXPECT_EQ(32u, util::mostSignificantBit(uint64_t{ 1 } << 32));
+  EXPECT_EQ(63u, util::mostSignificantBit(UINT64_MAX));
+}
+
+TEST(LatencyHistogramTest, shouldReturnZeroSnapshotIfEmpty)
+{
+  const util::LatencySnapshot snapshot{ util::LatencyHistogram().snapshot() };
+  EXPECT_EQ(0u, snapshot.count);
+  EXPECT_EQ(0ns, snapshot.p50);
+  EXPECT_EQ(0ns, snapshot.p99);
+  EXPECT_EQ(0ns, snapshot.p999);
+  EXPECT_EQ(0ns, snapshot.max);
+}
+
+TEST(LatencyHistogramTest, shouldReturnExactValuesForSmallLatencies)
+{
+  util::LatencyHistogram histogram;
+  for (int64_t i = 1; i <= 10; ++i)
+  {
+    histogram.record(std::chrono::nanoseconds(i));
+  }
+  const util::LatencySnapshot snapshot{ histogram.snapshot() };
+  EXPECT_EQ(10u, snapshot.count);
+  EXPECT_EQ(5ns, snapshot.p50);
+  EXPECT_EQ(10ns, snapshot.p99);
+  EXPECT_EQ(10ns, snapshot.max);
+}
+
+TEST(LatencyHistogramTest, shouldReturnPercentilesWithinResolution)
+{
+  util::LatencyHistogram histogram;
+  for (int64_t i = 1; i <= 10000; ++i)
+  {
+    histogram.record(std::chrono::microseconds(i));
+  }
+  const util::LatencySnapshot snapshot{ histogram.snapshot() };
+  EXPECT_EQ(10000u, snapshot.count);
+  expectNearRelative(5000us, snapshot.p50);
+  expectNearRelative(9900us, snapshot.p99);
+  expectNearRelative(9990us, snapshot.p999);
+  EXPECT_EQ(10000us, snapshot.max);
+}
+
+TEST(LatencyHistogramTest, shouldReportOutlierOnlyInHighPercentiles)
+{
+  util::LatencyHistogram histogram;
+  for (int i = 0; i < 999; ++i)
+  {
+    histogram.record(100us);
+  }
+  histogram.record(1s);
+  const util::LatencySnapshot snapshot{ histogram.snapshot() };
+  expectNearRelative(100us, snapshot.p50);
+  expectNearRelative(100us, snapshot.p99);
+  expectNearRelative(100us, snapshot.p999);
+  EXPECT_EQ(1s, snapshot.max);
+}
+
+TEST(LatencyHistogramTest, shouldClampNegativeLatenciesToZero)
+{
+  util::LatencyHistogram histogram;
+  histogram.record(-5ns);
+  const util::LatencySnapshot snapshot{ histogram.snapshot() };
+  EXPECT_EQ(1u, snapshot.count);
+  EXPECT_EQ(0ns, snapshot.max);
+}
+
+TEST(LatencyHistogramTest, shouldCountLatenciesAboveTrackableRange)
+{
+  util::LatencyHistogram histogram;
+  const std::chrono::nanoseconds max_trackable_latency(util::LatencyHistogram::MAX_TRACKABLE_VALUE);
+  histogram.record(max_trackable_latency * 4);
+  const util::LatencySnapshot snapshot{ histogram.snapshot() };
+  EXPECT_EQ(1u, snapshot.count);
+  EXPECT_EQ(max_trackable_latency * 4, snapshot.max);
+  EXPECT_GE(snapshot.p50, max_trackable_latency / 2);
+}
+
+TEST(LatencyHistogramTest, shouldRecordDurationBetweenTimePoints)
+{
+  util::LatencyHistogram histogram;
+  const util::LatencyClock::time_point start{ util::LatencyClock::now() };
+  histogram.record(start, start + 2ms);
+  EXPECT_EQ(2ms, histogram.snapshot().max);
+}
+
+TEST(LatencyHistogramTest, shouldCountAllRecordsOfConcurrentThreads)
+{
+  static constexpr std::size_t NUM_THREADS{ 4 };
+  static constexpr std::size_t NUM_RECORDS_PER_THREAD{ 10000 };
+  util::LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < NUM_THREADS; ++t)
+  {
+    threads.emplace_back([&histogram, t]() {
+      for (std::size_t i = 0; i < NUM_RECORDS_PER_THREAD; ++i)
+      {
+        histogram.record(std::chrono::nanoseconds(static_cast<int64_t>(t * NUM_RECORDS_PER_THREAD + i)));
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  const util::LatencySnapshot snapshot{ histogram.snapshot() };
+  EXPECT_EQ(NUM_THREADS * NUM_RECORDS_PER_THREAD, snapshot.count);
+  EXPECT_EQ(std::chrono::nanoseconds(NUM_THREADS * NUM_RECORDS_PER_THREAD - 1), snapshot.max);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
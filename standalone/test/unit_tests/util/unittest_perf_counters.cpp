@@ -0,0 +1,135 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/util/perf_counters.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr uint64_t NUMBER_OF_SAMPLES{ 10 };
+
+static uint64_t doSomeWork()
+{
+  std::vector<uint64_t> values(1000);
+  std::iota(values.begin(), values.end(), 0);
+  return std::accumulate(values.cbegin(), values.cend(), uint64_t{ 0 });
+}
+
+TEST(PerfCountersTest, shouldBeDisabledByDefault)
+{
+  EXPECT_FALSE(util::PerfCounters().isEnabled());
+}
+
+TEST(PerfCountersTest, shouldNotRecordIfDisabled)
+{
+  util::PerfCounters counters;
+  {
+    const util::PerfCounterScope scope(counters);
+    doSomeWork();
+  }
+  const util::PerfCounterSnapshot snapshot{ counters.snapshot() };
+  EXPECT_EQ(0u, snapshot.samples);
+  EXPECT_EQ(0u, snapshot.unavailable);
+}
+
+TEST(PerfCountersTest, shouldMeasureEachScopeOrCountItAsUnavailable)
+{
+  util::PerfCounters counters(true);
+  for (uint64_t i = 0; i < NUMBER_OF_SAMPLES; ++i)
+  {
+    const util::PerfCounterScope scope(counters);
+    doSomeWork();
+  }
+
+  const util::PerfCounterSnapshot snapshot{ counters.snapshot() };
+  if (util::PerfCounterGroup::ofCurrentThread().isOpen())
+  {
+    EXPECT_EQ(NUMBER_OF_SAMPLES, snapshot.samples);
+    EXPECT_EQ(0u, snapshot.unavailable);
+    EXPECT_GT(snapshot.totals.instructions, 0u);
+  }
+  else
+  {
+    EXPECT_EQ(0u, snapshot.samples);
+    EXPECT_EQ(NUMBER_OF_SAMPLES, snapshot.unavailable);
+    EXPECT_EQ(0u, snapshot.totals.instructions);
+  }
+}
+
+TEST(PerfCountersTest, shouldNotReadClosedGroup)
+{
+  const util::PerfCounterGroup& group{ util::PerfCounterGroup::ofCurrentThread() };
+  util::PerfCounterValues values;
+  EXPECT_EQ(group.isOpen(), group.read(values));
+}
+
+TEST(PerfCountersTest, shouldSumUpDifferencesOfAllSamples)
+{
+  util::PerfCounters counters(true);
+  counters.add({ 100, 200, 3, 4 }, { 150, 300, 5, 5 });
+  counters.add({ 0, 0, 0, 0 }, { 50, 100, 1, 2 });
+
+  const util::PerfCounterSnapshot snapshot{ counters.snapshot() };
+  EXPECT_EQ(2u, snapshot.samples);
+  EXPECT_EQ(100u, snapshot.totals.cycles);
+  EXPECT_EQ(200u, snapshot.totals.instructions);
+  EXPECT_EQ(3u, snapshot.totals.cache_misses);
+  EXPECT_EQ(3u, snapshot.totals.branch_misses);
+  EXPECT_DOUBLE_EQ(2., snapshot.instructionsPerCycle());
+}
+
+TEST(PerfCountersTest, shouldReturnZeroInstructionsPerCycleWithoutCycles)
+{
+  EXPECT_DOUBLE_EQ(0., util::PerfCounterSnapshot().instructionsPerCycle());
+}
+
+TEST(PerfCountersTest, shouldCountScopesOfConcurrentThreads)
+{
+  static constexpr std::size_t NUM_THREADS{ 4 };
+  util::PerfCounters counters(true);
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < NUM_THREADS; ++t)
+  {
+    threads.emplace_back([&counters]() {
+      for (uint64_t i = 0; i < NUMBER_OF_SAMPLES; ++i)
+      {
+        const util::PerfCounterScope scope(counters);
+        doSomeWork();
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  const util::PerfCounterSnapshot snapshot{ counters.snapshot() };
+  EXPECT_EQ(NUM_THREADS * NUMBER_OF_SAMPLES, snapshot.samples + snapshot.unavailable);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
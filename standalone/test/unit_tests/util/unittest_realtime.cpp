@@ -0,0 +1,238 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/util/realtime.h"
+#include "psen_scan_v2_standalone/util/watchdog.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static const std::string THREAD_NAME{ "psen_test_rt" };
+static constexpr std::chrono::seconds WATCHDOG_TIMEOUT{ 10 };
+
+/**
+ * @brief Thread which publishes its kernel thread id and keeps running until the test finishes.
+ */
+class TestThread
+{
+public:
+  TestThread()
+    : thread_([this]() {
+      tid_promise_.set_value(static_cast<pid_t>(syscall(SYS_gettid)));
+      finish_future_.wait();
+    })
+  {
+    tid_ = tid_future_.get();
+  }
+
+  ~TestThread()
+  {
+    finish_promise_.set_value();
+    thread_.join();
+  }
+
+  std::thread& thread()
+  {
+    return thread_;
+  }
+
+  pid_t tid() const
+  {
+    return tid_;
+  }
+
+private:
+  std::promise<pid_t> tid_promise_;
+  std::future<pid_t> tid_future_{ tid_promise_.get_future() };
+  std::promise<void> finish_promise_;
+  std::shared_future<void> finish_future_{ finish_promise_.get_future().share() };
+  std::thread thread_;
+  pid_t tid_{ 0 };
+};
+
+static std::string readProcFile(const pid_t& tid, const std::string& file)
+{
+  std::ifstream in("/proc/self/task/" + std::to_string(tid) + "/" + file);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static std::string threadName(const pid_t& tid)
+{
+  std::string name{ readProcFile(tid, "comm") };
+  if (!name.empty() && name.back() == '\n')
+  {
+    name.pop_back();
+  }
+  return name;
+}
+
+static std::string statusEntry(const pid_t& tid, const std::string& key)
+{
+  std::istringstream status{ readProcFile(tid, "status") };
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (line.compare(0, key.size() + 1, key + ":") == 0)
+    {
+      const auto value_start{ line.find_first_not_of(" \t", key.size() + 1) };
+      return line.substr(value_start);
+    }
+  }
+  return "";
+}
+
+//! @returns the fields of /proc/self/task/<tid>/stat following the command name.
+static std::vector<std::string> statFields(const pid_t& tid)
+{
+  const std::string stat{ readProcFile(tid, "stat") };
+  std::istringstream fields{ stat.substr(stat.rfind(')') + 2) };
+  return std::vector<std::string>(std::istream_iterator<std::string>(fields), std::istream_iterator<std::string>());
+}
+
+//! @returns the id of the first thread of the process with the specified name or 0 if there is no such thread.
+static pid_t findThread(const std::string& name)
+{
+  pid_t result{ 0 };
+  DIR* dir{ opendir("/proc/self/task") };
+  while (dir != nullptr && result == 0)
+  {
+    const dirent* entry{ readdir(dir) };
+    if (entry == nullptr)
+    {
+      break;
+    }
+    if (entry->d_name[0] != '.' && threadName(std::stoi(entry->d_name)) == name)
+    {
+      result = std::stoi(entry->d_name);
+    }
+  }
+  if (dir != nullptr)
+  {
+    closedir(dir);
+  }
+  return result;
+}
+
+static bool isCpuAvailable(const unsigned int& cpu)
+{
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  return sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0 && CPU_ISSET(cpu, &cpu_set);
+}
+
+TEST(RealtimeTest, shouldSetThreadName)
+{
+  TestThread thread;
+  util::ThreadSettings settings;
+  settings.name = THREAD_NAME;
+
+  EXPECT_TRUE(util::applyThreadSettings(thread.thread(), settings));
+  EXPECT_EQ(THREAD_NAME, threadName(thread.tid()));
+}
+
+TEST(RealtimeTest, shouldNotChangeThreadNameIfNoNameIsSpecified)
+{
+  TestThread thread;
+  const std::string name_before{ threadName(thread.tid()) };
+
+  EXPECT_TRUE(util::applyThreadSettings(thread.thread(), util::ThreadSettings()));
+  EXPECT_EQ(name_before, threadName(thread.tid()));
+}
+
+TEST(RealtimeTest, shouldSetCpuAffinity)
+{
+  TestThread thread;
+  const unsigned int cpu{ isCpuAvailable(1) ? 1u : 0u };
+  util::ThreadSettings settings;
+  settings.cpu_affinity_mask = 1u << cpu;
+
+  EXPECT_TRUE(util::applyThreadSettings(thread.thread(), settings));
+  EXPECT_EQ(std::to_string(cpu), statusEntry(thread.tid(), "Cpus_allowed_list"));
+}
+
+TEST(RealtimeTest, shouldSetFifoPriorityIfPermitted)
+{
+  TestThread thread;
+  util::ThreadSettings settings;
+  settings.fifo_priority = 10;
+
+  if (!util::applyThreadSettings(thread.thread(), settings))
+  {
+    GTEST_SKIP() << "Missing privileges for real-time scheduling.";
+  }
+
+  const auto fields{ statFields(thread.tid()) };
+  // Fields 40 and 41 of the stat file (rt_priority and policy) are located at index 37 and 38
+  // because pid and comm are not part of the fields.
+  ASSERT_GT(fields.size(), 38u);
+  EXPECT_EQ("10", fields.at(37));
+  EXPECT_EQ(std::to_string(SCHED_FIFO), fields.at(38));
+}
+
+TEST(RealtimeTest, shouldAppendNameSuffix)
+{
+  util::ThreadSettings settings;
+  settings.name = "psen_io";
+  EXPECT_EQ("psen_io_ctrl", settings.withNameSuffix("_ctrl").name);
+}
+
+TEST(RealtimeTest, shouldCutOffNameSuffixAtMaximalThreadNameLength)
+{
+  util::ThreadSettings settings;
+  settings.name = "scanner_front";
+  EXPECT_EQ("scanner_front_c", settings.withNameSuffix("_ctrl").name);
+}
+
+TEST(RealtimeTest, shouldNotAppendNameSuffixToEmptyName)
+{
+  EXPECT_EQ("", util::ThreadSettings().withNameSuffix("_ctrl").name);
+}
+
+TEST(RealtimeTest, shouldApplyThreadSettingsToWatchdogThread)
+{
+  util::ThreadSettings settings;
+  settings.name = THREAD_NAME;
+  settings.cpu_affinity_mask = 1u;
+
+  util::Watchdog watchdog(WATCHDOG_TIMEOUT, []() {}, settings);
+
+  const pid_t tid{ findThread(THREAD_NAME) };
+  ASSERT_NE(0, tid) << "No thread with name " << THREAD_NAME << " found.";
+  EXPECT_EQ("0", statusEntry(tid, "Cpus_allowed_list"));
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
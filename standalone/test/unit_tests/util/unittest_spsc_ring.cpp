@@ -0,0 +1,234 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/util/async_barrier.h"
+#include "psen_scan_v2_standalone/util/pipeline_stage.h"
+#include "psen_scan_v2_standalone/util/realtime.h"
+#include "psen_scan_v2_standalone/util/spsc_ring.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr std::chrono::seconds DEFAULT_TIMEOUT{ 3 };
+static constexpr int NUM_ELEMENTS{ 10000 };
+
+TEST(SpscRingTest, shouldThrowOnZeroCapacity)
+{
+  EXPECT_THROW(util::SpscRing<int>(0), std::invalid_argument);
+}
+
+TEST(SpscRingTest, shouldRoundCapacityUpToPowerOfTwo)
+{
+  EXPECT_EQ(1u, util::SpscRing<int>(1).capacity());
+  EXPECT_EQ(8u, util::SpscRing<int>(5).capacity());
+  EXPECT_EQ(64u, util::SpscRing<int>(64).capacity());
+}
+
+TEST(SpscRingTest, shouldReturnNullptrIfEmpty)
+{
+  util::SpscRing<int> ring(4);
+  EXPECT_EQ(nullptr, ring.front());
+  EXPECT_EQ(0u, ring.size());
+}
+
+TEST(SpscRingTest, shouldReturnNullptrIfFull)
+{
+  util::SpscRing<int> ring(2);
+  for (int i = 0; i < 2; ++i)
+  {
+    int* slot{ ring.beginPush() };
+    ASSERT_NE(nullptr, slot);
+    *slot = i;
+    ring.commitPush();
+  }
+  EXPECT_EQ(nullptr, ring.beginPush());
+  EXPECT_EQ(2u, ring.size());
+
+  ring.pop();
+  EXPECT_NE(nullptr, ring.beginPush());
+}
+
+TEST(SpscRingTest, shouldReturnElementsInOrderOfPush)
+{
+  util::SpscRing<int> ring(4);
+  for (int round = 0; round < 3; ++round)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      *ring.beginPush() = round * 10 + i;
+      ring.commitPush();
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+      ASSERT_NE(nullptr, ring.front());
+      EXPECT_EQ(round * 10 + i, *ring.front());
+      ring.pop();
+    }
+  }
+  EXPECT_EQ(nullptr, ring.front());
+}
+
+TEST(SpscRingTest, shouldTransferAllElementsBetweenTwoThreads)
+{
+  util::SpscRing<int> ring(16);
+  std::thread producer([&ring]() {
+    for (int i = 0; i < NUM_ELEMENTS; ++i)
+    {
+      int* slot{ nullptr };
+      while ((slot = ring.beginPush()) == nullptr)
+      {
+        std::this_thread::yield();
+      }
+      *slot = i;
+      ring.commitPush();
+    }
+  });
+
+  std::vector<int> received;
+  while (received.size() < static_cast<std::size_t>(NUM_ELEMENTS))
+  {
+    const int* element{ ring.front() };
+    if (element == nullptr)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    received.push_back(*element);
+    ring.pop();
+  }
+  producer.join();
+
+  for (int i = 0; i < NUM_ELEMENTS; ++i)
+  {
+    ASSERT_EQ(i, received[static_cast<std::size_t>(i)]);
+  }
+}
+
+TEST(PipelineStageTest, shouldProcessAllElementsInOrder)
+{
+  std::vector<int> processed;
+  util::Barrier all_processed_barrier;
+  util::PipelineStage<int> stage(
+      8,
+      [&](int& element) {
+        processed.push_back(element);
+        if (processed.size() == static_cast<std::size_t>(NUM_ELEMENTS))
+        {
+          all_processed_barrier.release();
+        }
+      },
+      util::ThreadSettings());
+
+  for (int i = 0; i < NUM_ELEMENTS; ++i)
+  {
+    while (!stage.tryPush([i](int& slot) { slot = i; }))
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  ASSERT_TRUE(all_processed_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Not all elements processed";
+  stage.stop();
+  for (int i = 0; i < NUM_ELEMENTS; ++i)
+  {
+    ASSERT_EQ(i, processed[static_cast<std::size_t>(i)]);
+  }
+  EXPECT_EQ(static_cast<uint64_t>(NUM_ELEMENTS), stage.statistics().processed);
+}
+
+TEST(PipelineStageTest, shouldCountDroppedElementsIfQueueIsFull)
+{
+  std::mutex block_mutex;
+  std::unique_lock<std::mutex> block_lock(block_mutex);
+  util::Barrier first_element_barrier;
+  util::PipelineStage<int> stage(
+      2,
+      [&](int&) {
+        first_element_barrier.release();
+        const std::lock_guard<std::mutex> lock(block_mutex);
+      },
+      util::ThreadSettings());
+
+  // The first element blocks the stage, so that the queue runs full.
+  ASSERT_TRUE(stage.tryPush([](int& slot) { slot = 0; }));
+  ASSERT_TRUE(first_element_barrier.waitTillRelease(DEFAULT_TIMEOUT));
+  EXPECT_TRUE(stage.tryPush([](int& slot) { slot = 1; }));
+  EXPECT_FALSE(stage.tryPush([](int& slot) { slot = 2; }));
+
+  const util::StageStatistics statistics{ stage.statistics() };
+  EXPECT_EQ(2u, statistics.queue_depth);
+  EXPECT_EQ(2u, statistics.max_queue_depth);
+  EXPECT_EQ(1u, statistics.dropped);
+  EXPECT_EQ(0u, statistics.processed);
+
+  block_lock.unlock();
+  stage.stop();
+}
+
+TEST(PipelineStageTest, shouldStopProcessingAfterExceptionInHandler)
+{
+  std::mutex block_mutex;
+  std::unique_lock<std::mutex> block_lock(block_mutex);
+  util::Barrier first_element_barrier;
+  std::atomic_bool second_element_processed{ false };
+  util::PipelineStage<int> stage(
+      4,
+      [&](int& element) {
+        if (element == 0)
+        {
+          first_element_barrier.release();
+          const std::lock_guard<std::mutex> lock(block_mutex);
+          throw std::runtime_error("Invalid element");
+        }
+        second_element_processed = true;
+      },
+      util::ThreadSettings());
+
+  // The second element is queued before the first one fails.
+  ASSERT_TRUE(stage.tryPush([](int& slot) { slot = 0; }));
+  ASSERT_TRUE(first_element_barrier.waitTillRelease(DEFAULT_TIMEOUT));
+  ASSERT_TRUE(stage.tryPush([](int& slot) { slot = 1; }));
+  block_lock.unlock();
+
+  stage.stop();
+  EXPECT_FALSE(second_element_processed) << "Second element processed despite the failure of the first one";
+  EXPECT_EQ(1u, stage.statistics().processed);
+  EXPECT_EQ(1u, stage.statistics().queue_depth);
+}
+
+TEST(PipelineStageTest, shouldStopWithoutElements)
+{
+  util::PipelineStage<int> stage(4, [](int&) {}, util::ThreadSettings());
+  stage.stop();
+  EXPECT_EQ(0u, stage.statistics().processed);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,239 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/io_service.hpp>
+
+#include "psen_scan_v2_standalone/util/async_barrier.h"
+#include "psen_scan_v2_standalone/util/executor.h"
+#include "psen_scan_v2_standalone/util/thread_pool.h"
+
+using namespace psen_scan_v2_standalone;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr std::chrono::seconds DEFAULT_TIMEOUT{ 3 };
+static constexpr std::size_t NUM_TASKS{ 1000 };
+
+TEST(ThreadPoolTest, shouldThrowIfNoThreadIsRequested)
+{
+  EXPECT_THROW(util::ThreadPool(0), std::invalid_argument);
+}
+
+TEST(ThreadPoolTest, shouldReturnNumberOfThreads)
+{
+  util::ThreadPool pool(3);
+  EXPECT_EQ(3u, pool.numberOfThreads());
+}
+
+TEST(ThreadPoolTest, shouldProcessAllTasksBeforeDestruction)
+{
+  std::atomic<std::size_t> num_processed{ 0 };
+  {
+    util::ThreadPool pool(4);
+    for (std::size_t i = 0; i < NUM_TASKS; ++i)
+    {
+      pool.post([&num_processed]() { ++num_processed; });
+    }
+  }
+  EXPECT_EQ(NUM_TASKS, num_processed);
+}
+
+TEST(ThreadPoolTest, shouldProcessTasksPostedByWorkers)
+{
+  util::ThreadPool pool(2);
+  util::Barrier nested_task_barrier;
+  pool.post([&pool, &nested_task_barrier]() { pool.post([&nested_task_barrier]() { nested_task_barrier.release(); }); });
+  EXPECT_TRUE(nested_task_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Nested task not processed";
+}
+
+TEST(ThreadPoolTest, shouldStealTasksOfBlockedWorker)
+{
+  util::ThreadPool pool(2);
+  std::promise<void> unblock;
+  std::shared_future<void> unblock_future{ unblock.get_future().share() };
+  util::Barrier stolen_task_barrier;
+
+  // The tasks posted by the blocked worker are queued at the blocked worker. They can only be processed by stealing.
+  pool.post([&pool, unblock_future, &stolen_task_barrier]() {
+    pool.post([&stolen_task_barrier]() { stolen_task_barrier.release(); });
+    unblock_future.wait();
+  });
+
+  EXPECT_TRUE(stolen_task_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Task of blocked worker not stolen";
+  unblock.set_value();
+}
+
+TEST(StrandTest, shouldThrowIfExecutorIsInvalid)
+{
+  EXPECT_THROW(util::Strand(nullptr), std::invalid_argument);
+}
+
+TEST(StrandTest, shouldProcessTasksInOrderAndNeverConcurrently)
+{
+  util::ThreadPool pool(4);
+  std::vector<std::size_t> processed;
+  std::atomic_bool running{ false };
+  std::atomic_bool concurrent{ false };
+  util::Barrier all_done_barrier;
+  {
+    util::Strand strand(pool.executor());
+    for (std::size_t i = 0; i < NUM_TASKS; ++i)
+    {
+      strand.post([&, i]() {
+        if (running.exchange(true))
+        {
+          concurrent = true;
+        }
+        processed.push_back(i);
+        running = false;
+        if (i == NUM_TASKS - 1)
+        {
+          all_done_barrier.release();
+        }
+      });
+    }
+    ASSERT_TRUE(all_done_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Tasks not processed";
+  }
+
+  EXPECT_FALSE(concurrent);
+  ASSERT_EQ(NUM_TASKS, processed.size());
+  for (std::size_t i = 0; i < NUM_TASKS; ++i)
+  {
+    EXPECT_EQ(i, processed[i]);
+  }
+}
+
+TEST(StrandTest, shouldDropTasksPostedAfterShutdown)
+{
+  std::vector<std::function<void()>> scheduled;
+  util::Strand strand([&scheduled](std::function<void()> task) { scheduled.push_back(task); });
+
+  strand.shutdown();
+  strand.post([]() {});
+
+  EXPECT_TRUE(scheduled.empty()) << "Strand scheduled a run after the shutdown";
+}
+
+TEST(StrandTest, shouldWaitForRunningTaskOnShutdown)
+{
+  util::ThreadPool pool(1);
+  util::Strand strand(pool.executor());
+  util::Barrier task_started_barrier;
+  std::atomic_bool task_finished{ false };
+
+  strand.post([&task_started_barrier, &task_finished]() {
+    task_started_barrier.release();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    task_finished = true;
+  });
+  ASSERT_TRUE(task_started_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Task not started";
+
+  strand.shutdown();
+  EXPECT_TRUE(task_finished);
+}
+
+TEST(StrandTest, shouldRunTasksDirectlyWithInlineExecutor)
+{
+  util::Strand strand(util::inlineExecutor());
+  std::size_t num_processed{ 0 };
+  strand.post([&num_processed]() { ++num_processed; });
+  strand.post([&num_processed]() { ++num_processed; });
+  EXPECT_EQ(2u, num_processed);
+}
+
+TEST(SerialExecutorTest, shouldThrowIfExecutorIsInvalid)
+{
+  EXPECT_THROW(util::serialExecutor(nullptr), std::invalid_argument);
+}
+
+TEST(SerialExecutorTest, shouldProcessTasksInOrderAndNeverConcurrently)
+{
+  util::ThreadPool pool(4);
+  const util::Executor serial_executor{ util::serialExecutor(pool.executor()) };
+  std::vector<std::size_t> processed;
+  std::atomic_bool running{ false };
+  std::atomic_bool concurrent{ false };
+  util::Barrier all_done_barrier;
+  for (std::size_t i = 0; i < NUM_TASKS; ++i)
+  {
+    serial_executor([&, i]() {
+      if (running.exchange(true))
+      {
+        concurrent = true;
+      }
+      processed.push_back(i);
+      running = false;
+      if (i == NUM_TASKS - 1)
+      {
+        all_done_barrier.release();
+      }
+    });
+  }
+  ASSERT_TRUE(all_done_barrier.waitTillRelease(DEFAULT_TIMEOUT)) << "Tasks not processed";
+
+  EXPECT_FALSE(concurrent);
+  ASSERT_EQ(NUM_TASKS, processed.size());
+  for (std::size_t i = 0; i < NUM_TASKS; ++i)
+  {
+    EXPECT_EQ(i, processed[i]);
+  }
+}
+
+TEST(SerialExecutorTest, shouldRunPendingTasksAfterDestruction)
+{
+  std::vector<std::function<void()>> scheduled;
+  std::size_t num_processed{ 0 };
+  {
+    const util::Executor serial_executor{ util::serialExecutor(
+        [&scheduled](std::function<void()> task) { scheduled.push_back(task); }) };
+    serial_executor([&num_processed]() { ++num_processed; });
+    serial_executor([&num_processed]() { ++num_processed; });
+  }
+  ASSERT_EQ(1u, scheduled.size()) << "Only one run should be scheduled for pending tasks";
+
+  scheduled.front()();
+  EXPECT_EQ(2u, num_processed);
+}
+
+TEST(ExecutorTest, shouldRunTasksOfIoServiceExecutorInThreadOfIoService)
+{
+  boost::asio::io_service io_service;
+  const util::Executor executor{ util::ioServiceExecutor(io_service) };
+  std::size_t num_processed{ 0 };
+  executor([&num_processed]() { ++num_processed; });
+  executor([&num_processed]() { ++num_processed; });
+  EXPECT_EQ(0u, num_processed);
+
+  io_service.run();
+  EXPECT_EQ(2u, num_processed);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
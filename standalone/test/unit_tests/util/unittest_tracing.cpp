@@ -0,0 +1,210 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/util/tracing.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace std::chrono_literals;
+
+namespace psen_scan_v2_standalone_test
+{
+static std::size_t countOccurrences(const std::string& str, const std::string& substr)
+{
+  std::size_t count{ 0 };
+  for (auto pos = str.find(substr); pos != std::string::npos; pos = str.find(substr, pos + substr.size()))
+  {
+    ++count;
+  }
+  return count;
+}
+
+static std::string chromeTrace()
+{
+  std::ostringstream os;
+  util::Tracer::instance().writeChromeTrace(os);
+  return os.str();
+}
+
+class TracerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    util::Tracer::instance().disable();
+    util::Tracer::instance().clear();
+  }
+
+  void TearDown() override
+  {
+    util::Tracer::instance().disable();
+  }
+};
+
+TEST_F(TracerTest, shouldBeDisabledByDefault)
+{
+  EXPECT_FALSE(util::Tracer::instance().isEnabled());
+}
+
+TEST_F(TracerTest, shouldNotRecordSpansWhileDisabled)
+{
+  {
+    const util::TraceSpan span("disabled_span");
+  }
+  EXPECT_EQ(0u, countOccurrences(chromeTrace(), "disabled_span"));
+}
+
+TEST_F(TracerTest, shouldRecordSpanAsCompleteEvent)
+{
+  util::Tracer::instance().enable();
+  {
+    const util::TraceSpan span("enabled_span");
+    std::this_thread::sleep_for(1ms);
+  }
+  const std::string trace{ chromeTrace() };
+  EXPECT_EQ(1u, countOccurrences(trace, R"({"name":"enabled_span","cat":"psen_scan_v2","ph":"X")"));
+  EXPECT_EQ(0u, countOccurrences(trace, R"("dur":0.000)"));
+}
+
+TEST_F(TracerTest, shouldRecordSpanEnabledAtConstruction)
+{
+  util::Tracer::instance().enable();
+  {
+    const util::TraceSpan span("span_outliving_disable");
+    util::Tracer::instance().disable();
+  }
+  EXPECT_EQ(1u, countOccurrences(chromeTrace(), "span_outliving_disable"));
+}
+
+TEST_F(TracerTest, shouldStayEnabledTillEachUserDisabledIt)
+{
+  util::Tracer::instance().enable();
+  util::Tracer::instance().enable();
+  EXPECT_FALSE(util::Tracer::instance().disable());
+  EXPECT_TRUE(util::Tracer::instance().isEnabled());
+  EXPECT_TRUE(util::Tracer::instance().disable());
+  EXPECT_FALSE(util::Tracer::instance().isEnabled());
+}
+
+TEST_F(TracerTest, shouldIgnoreDisableWithoutEnable)
+{
+  EXPECT_TRUE(util::Tracer::instance().disable());
+  util::Tracer::instance().enable();
+  EXPECT_TRUE(util::Tracer::instance().isEnabled());
+}
+
+TEST_F(TracerTest, shouldWriteValidTraceIfNothingWasRecorded)
+{
+  const std::string trace{ chromeTrace() };
+  EXPECT_EQ(0u, trace.find(R"({"traceEvents":[)"));
+  EXPECT_NE(std::string::npos, trace.find(R"(],"displayTimeUnit":"ns"})"));
+}
+
+TEST_F(TracerTest, shouldKeepOnlyMostRecentSpansOfThread)
+{
+  const std::size_t buffer_capacity{ util::Tracer::BUFFER_CAPACITY };
+  util::Tracer::instance().enable();
+  const auto now{ util::LatencyClock::now() };
+  util::Tracer::instance().record("oldest_span", now, now);
+  for (std::size_t i = 0; i < buffer_capacity; ++i)
+  {
+    util::Tracer::instance().record("recent_span", now, now);
+  }
+  const std::string trace{ chromeTrace() };
+  EXPECT_EQ(0u, countOccurrences(trace, "oldest_span"));
+  EXPECT_EQ(buffer_capacity, countOccurrences(trace, "recent_span"));
+}
+
+TEST_F(TracerTest, shouldRecordSpansOfEachThreadWithItsName)
+{
+  util::Tracer::instance().enable();
+  std::thread thread([]() {
+#ifdef __linux__
+    pthread_setname_np(pthread_self(), "traced_thread");
+#endif
+    const util::TraceSpan span("thread_span");
+  });
+  thread.join();
+  {
+    const util::TraceSpan span("main_span");
+  }
+
+  const std::string trace{ chromeTrace() };
+  EXPECT_EQ(1u, countOccurrences(trace, "thread_span"));
+  EXPECT_EQ(1u, countOccurrences(trace, "main_span"));
+  EXPECT_EQ(2u, countOccurrences(trace, R"("name":"thread_name","ph":"M")"));
+#ifdef __linux__
+  EXPECT_EQ(1u, countOccurrences(trace, R"("args":{"name":"traced_thread"})"));
+#endif
+}
+
+TEST_F(TracerTest, shouldDropSpansAndBuffersOfFinishedThreadsOnClear)
+{
+  util::Tracer::instance().enable();
+  {
+    const util::TraceSpan span("running_thread_span");
+  }
+  std::thread thread([]() { const util::TraceSpan span("finished_thread_span"); });
+  thread.join();
+  EXPECT_EQ(1u, countOccurrences(chromeTrace(), "finished_thread_span"));
+
+  util::Tracer::instance().clear();
+  const std::string trace{ chromeTrace() };
+  EXPECT_EQ(0u, countOccurrences(trace, "running_thread_span"));
+  EXPECT_EQ(0u, countOccurrences(trace, "finished_thread_span"));
+  EXPECT_EQ(1u, countOccurrences(trace, R"("ph":"M")")) << "Only the buffer of the running thread should be kept";
+}
+
+TEST_F(TracerTest, shouldWriteTraceFile)
+{
+  util::Tracer::instance().enable();
+  {
+    const util::TraceSpan span("file_span");
+  }
+  const std::string file_name{ "unittest_tracing_trace.json" };
+  util::Tracer::instance().writeChromeTrace(file_name);
+
+  std::ifstream file(file_name);
+  const std::string content{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+  EXPECT_EQ(chromeTrace(), content);
+  EXPECT_EQ(1u, countOccurrences(content, "file_span"));
+}
+
+TEST_F(TracerTest, shouldThrowIfTraceFileCannotBeOpened)
+{
+  EXPECT_THROW(util::Tracer::instance().writeChromeTrace("/non_existing_directory/trace.json"), std::runtime_error);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
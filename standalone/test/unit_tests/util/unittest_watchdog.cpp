@@ -0,0 +1,103 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "psen_scan_v2_standalone/util/watchdog.h"
+
+using namespace psen_scan_v2_standalone;
+using namespace std::chrono_literals;
+
+namespace psen_scan_v2_standalone_test
+{
+static constexpr std::chrono::seconds WAIT_TIMEOUT{ 3 };
+
+class TimeoutRecorder
+{
+public:
+  void record()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    timeouts_.push_back(std::chrono::steady_clock::now());
+    cv_.notify_all();
+  }
+
+  std::vector<std::chrono::steady_clock::time_point> waitForTimeouts(const std::size_t& number)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, WAIT_TIMEOUT, [this, &number]() { return timeouts_.size() >= number; });
+    return timeouts_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::chrono::steady_clock::time_point> timeouts_;
+};
+
+TEST(WatchdogTest, shouldCallHandlerRepeatedly)
+{
+  TimeoutRecorder recorder;
+  const auto start{ std::chrono::steady_clock::now() };
+  util::Watchdog watchdog(10ms, [&recorder]() { recorder.record(); });
+
+  const auto timeouts{ recorder.waitForTimeouts(3) };
+  ASSERT_GE(timeouts.size(), 3u);
+  EXPECT_GE(timeouts[2] - start, 30ms);
+}
+
+TEST(WatchdogTest, shouldFollowScheduleAndRepeatLastTimeout)
+{
+  TimeoutRecorder recorder;
+  const auto start{ std::chrono::steady_clock::now() };
+  util::Watchdog watchdog(util::Watchdog::Schedule{ 10ms, 20ms, 40ms }, [&recorder]() { recorder.record(); });
+
+  const auto timeouts{ recorder.waitForTimeouts(4) };
+  ASSERT_GE(timeouts.size(), 4u);
+  EXPECT_GE(timeouts[0] - start, 10ms);
+  EXPECT_GE(timeouts[1] - timeouts[0], 20ms);
+  EXPECT_GE(timeouts[2] - timeouts[1], 40ms);
+  EXPECT_GE(timeouts[3] - timeouts[2], 40ms);
+}
+
+TEST(WatchdogTest, shouldStartWithFirstTimeoutOfSchedule)
+{
+  TimeoutRecorder recorder;
+  const auto start{ std::chrono::steady_clock::now() };
+  util::Watchdog watchdog(util::Watchdog::Schedule{ 10ms, 10s }, [&recorder]() { recorder.record(); });
+
+  const auto timeouts{ recorder.waitForTimeouts(1) };
+  ASSERT_EQ(1u, timeouts.size());
+  EXPECT_LT(timeouts[0] - start, WAIT_TIMEOUT);
+}
+
+TEST(WatchdogTest, shouldThrowOnEmptySchedule)
+{
+  EXPECT_THROW(util::Watchdog(util::Watchdog::Schedule{}, []() {}), std::invalid_argument);
+}
+
+}  // namespace psen_scan_v2_standalone_test
+
+int main(int argc, char* argv[])
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
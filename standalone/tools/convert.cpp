@@ -0,0 +1,262 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Converts recordings of the data connection of a scanner into laser scans, using all cores.
+ *
+ * The recording can be a pcap file, a raw datagram log or a flight recording (see communication_layer::readRecording).
+ * The scans are written as CSV or as scan recording (see ScanRecordingWriter, only on Linux). Each scan is stamped
+ * with the receive time of its last datagram.
+ *
+ * CSV columns: timestamp_ns, scan_counter, resolution, min_angle, max_angle (in tenth of degree), the measurements
+ * (in meters) and the intensities, both separated by spaces.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <fmt/format.h>
+
+#include <psen_scan_v2_standalone/capture_converter.h>
+#include <psen_scan_v2_standalone/configuration/default_parameters.h>
+#include <psen_scan_v2_standalone/communication_layer/datagram_log.h>
+#include <psen_scan_v2_standalone/scan_recording.h>
+#include <psen_scan_v2_standalone/util/logging.h>
+#include <psen_scan_v2_standalone/util/thread_pool.h>
+
+using namespace psen_scan_v2_standalone;
+
+class ScanSink
+{
+public:
+  virtual ~ScanSink() = default;
+  virtual void write(const CapturedScan& scan) = 0;
+  virtual void close() = 0;
+};
+
+class CsvSink : public ScanSink
+{
+public:
+  CsvSink(const std::string& filename) : file_(filename)
+  {
+    if (!file_)
+    {
+      throw std::runtime_error(fmt::format("Could not open {}", filename));
+    }
+    file_ << "timestamp_ns,scan_counter,resolution,min_angle,max_angle,measurements,intensities\n";
+  }
+
+  void write(const CapturedScan& scan) override
+  {
+    line_.clear();
+    auto out{ std::back_inserter(line_) };
+    fmt::format_to(out,
+                   "{},{},{},{},{},",
+                   scan.timestamp.count(),
+                   scan.scan.getScanCounter(),
+                   scan.scan.getScanResolution().value(),
+                   scan.scan.getMinScanAngle().value(),
+                   scan.scan.getMaxScanAngle().value());
+    appendValues(scan.scan.getMeasurements());
+    line_.push_back(',');
+    appendValues(scan.scan.getIntensities());
+    line_.push_back('\n');
+    file_.write(line_.data(), static_cast<std::streamsize>(line_.size()));
+  }
+
+  void close() override
+  {
+    file_.close();
+    if (!file_)
+    {
+      throw std::runtime_error("Could not write the CSV file");
+    }
+  }
+
+private:
+  void appendValues(const std::vector<double>& values)
+  {
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+      fmt::format_to(std::back_inserter(line_), i == 0 ? "{}" : " {}", values[i]);
+    }
+  }
+
+private:
+  std::ofstream file_;
+  fmt::memory_buffer line_;
+};
+
+#ifdef __linux__
+class ScanRecordingSink : public ScanSink
+{
+public:
+  ScanRecordingSink(const std::string& filename) : writer_(filename)
+  {
+  }
+
+  void write(const CapturedScan& scan) override
+  {
+    writer_.write(scan.scan, scan.timestamp);
+  }
+
+  void close() override
+  {
+    writer_.close();
+  }
+
+private:
+  ScanRecordingWriter writer_;
+};
+#endif
+
+static void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [options] <recording> <output>\n"
+            << "  --format <format>        csv"
+#ifdef __linux__
+            << " or scans"
+#endif
+            << " (default: csv)\n"
+            << "  --jobs <n>               number of threads (default: number of cores)\n"
+            << "  --port <port>            udp port of the datagrams in a pcap file (default: "
+            << configuration::DATA_PORT_OF_SCANNER_DEVICE << ", 0 for all)\n"
+            << "  --fragmented             convert each monitoring frame into a scan of its own\n"
+      ;
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_WARN);
+
+  std::vector<std::string> files;
+  std::string format{ "csv" };
+  std::size_t jobs{ util::ThreadPool::defaultNumberOfThreads() };
+  unsigned short port{ configuration::DATA_PORT_OF_SCANNER_DEVICE };
+  bool fragmented{ false };
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string option{ argv[i] };
+    if (option == "--help")
+    {
+      printUsage(argv[0]);
+      return EXIT_SUCCESS;
+    }
+    if (option == "--fragmented")
+    {
+      fragmented = true;
+      continue;
+    }
+    if (option.compare(0, 2, "--") != 0)
+    {
+      files.push_back(option);
+      continue;
+    }
+    if (i + 1 >= argc)
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    const std::string value{ argv[++i] };
+    try
+    {
+      if (option == "--format")
+      {
+        format = value;
+      }
+      else if (option == "--jobs")
+      {
+        jobs = std::stoul(value);
+      }
+      else if (option == "--port")
+      {
+        port = static_cast<unsigned short>(std::stoul(value));
+      }
+      else
+      {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    catch (const std::logic_error&)
+    {
+      std::cerr << "Invalid value for " << option << ": " << value << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (files.size() != 2 || jobs == 0)
+  {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  try
+  {
+    std::unique_ptr<ScanSink> sink;
+    if (format == "csv")
+    {
+      sink.reset(new CsvSink(files[1]));
+    }
+#ifdef __linux__
+    else if (format == "scans")
+    {
+      sink.reset(new ScanRecordingSink(files[1]));
+    }
+#endif
+    else
+    {
+      std::cerr << "Unknown format " << format << "\n";
+      return EXIT_FAILURE;
+    }
+
+    const auto read_start{ std::chrono::steady_clock::now() };
+    const std::vector<communication_layer::RecordedDatagram> datagrams{ communication_layer::readRecording(
+        files[0], port == 0 ? boost::none : boost::optional<unsigned short>(port)) };
+    const auto conversion_start{ std::chrono::steady_clock::now() };
+    const CaptureConversionStatistics statistics{ CaptureConverter(fragmented, jobs).convert(
+        datagrams, [&sink](const CapturedScan& scan) { sink->write(scan); }) };
+    sink->close();
+    const auto conversion_end{ std::chrono::steady_clock::now() };
+
+    const std::chrono::duration<double> read_duration{ conversion_start - read_start };
+    const std::chrono::duration<double> conversion_duration{ conversion_end - conversion_start };
+    const double rate{ conversion_duration.count() > 0. ? statistics.datagrams / conversion_duration.count() : 0. };
+    std::cout << fmt::format("{} datagrams, {} scans, {} decode errors, {} dropped rounds, {} outdated frames; "
+                             "read in {:.3f} s, converted with {} threads in {:.3f} s ({:.0f} datagrams/s)\n",
+                             statistics.datagrams,
+                             statistics.scans,
+                             statistics.decode_errors,
+                             statistics.dropped_rounds,
+                             statistics.outdated_frames,
+                             read_duration.count(),
+                             jobs,
+                             conversion_duration.count(),
+                             rate);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,192 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Replays a recording of the data connection of a scanner through the protocol implementation of the driver.
+ *
+ * The recording can be a pcap file (e.g. "tcpdump -i eth0 -w scanner.pcap udp port 2000") or a raw datagram log. The
+ * scan range, resolution and fragmentation have to match the configuration of the recorded scanner. With --max-speed
+ * the datagrams are processed without any pause, so the reported frame rate is the throughput of the processing on
+ * this machine.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <fmt/format.h>
+
+#include <psen_scan_v2_standalone/configuration/default_parameters.h>
+#include <psen_scan_v2_standalone/communication_layer/datagram_log.h>
+#include <psen_scan_v2_standalone/communication_layer/replay_source.h>
+#include <psen_scan_v2_standalone/laserscan.h>
+#include <psen_scan_v2_standalone/replay_scanner.h>
+#include <psen_scan_v2_standalone/scanner_config_builder.h>
+#include <psen_scan_v2_standalone/util/format_range.h>
+#include <psen_scan_v2_standalone/util/logging.h>
+
+using namespace psen_scan_v2_standalone;
+
+static void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [options] <recording>\n"
+            << "  --speed <factor>         multiple of the recorded speed (default: 1)\n"
+            << "  --max-speed              process the datagrams as fast as possible\n"
+            << "  --port <port>            udp port of the datagrams in a pcap file (default: "
+            << configuration::DATA_PORT_OF_SCANNER_DEVICE << ", 0 for all)\n"
+            << "  --start <angle>          start of the scan range in tenth of degree (default: 0)\n"
+            << "  --end <angle>            end of the scan range in tenth of degree (default: 2750)\n"
+            << "  --resolution <angle>     scan resolution in tenth of degree (default: "
+            << configuration::SCAN_ANGLE_RESOLUTION << ")\n"
+            << "  --fragmented             the scanner was configured for fragmented scans\n"
+            << "  --print-scans            print the ranges of each laser scan\n";
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_WARN);
+
+  std::string recording;
+  double speed{ 1. };
+  unsigned short port{ configuration::DATA_PORT_OF_SCANNER_DEVICE };
+  int16_t start{ 0 };
+  int16_t end{ 2750 };
+  int16_t resolution{ configuration::SCAN_ANGLE_RESOLUTION };
+  bool fragmented{ false };
+  bool print_scans{ false };
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string option{ argv[i] };
+    if (option == "--help")
+    {
+      printUsage(argv[0]);
+      return EXIT_SUCCESS;
+    }
+    if (option == "--max-speed")
+    {
+      speed = communication_layer::ReplaySource::AS_FAST_AS_POSSIBLE;
+      continue;
+    }
+    if (option == "--fragmented")
+    {
+      fragmented = true;
+      continue;
+    }
+    if (option == "--print-scans")
+    {
+      print_scans = true;
+      continue;
+    }
+    if (option.compare(0, 2, "--") != 0)
+    {
+      recording = option;
+      continue;
+    }
+    if (i + 1 >= argc)
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    const std::string value{ argv[++i] };
+    try
+    {
+      if (option == "--speed")
+      {
+        speed = std::stod(value);
+      }
+      else if (option == "--port")
+      {
+        port = static_cast<unsigned short>(std::stoul(value));
+      }
+      else if (option == "--start")
+      {
+        start = static_cast<int16_t>(std::stoi(value));
+      }
+      else if (option == "--end")
+      {
+        end = static_cast<int16_t>(std::stoi(value));
+      }
+      else if (option == "--resolution")
+      {
+        resolution = static_cast<int16_t>(std::stoi(value));
+      }
+      else
+      {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    catch (const std::logic_error&)
+    {
+      std::cerr << "Invalid value for " << option << ": " << value << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (recording.empty() || speed < 0.)
+  {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  try
+  {
+    const ScannerConfiguration config{ ScannerConfigurationBuilder()
+                                           .hostIP("127.0.0.1")
+                                           .scannerIp("127.0.0.1")
+                                           .scanRange(ScanRange{ util::TenthOfDegree(start), util::TenthOfDegree(end) })
+                                           .scanResolution(util::TenthOfDegree(resolution))
+                                           .enableFragmentedScans(fragmented)
+                                           .build() };
+    std::vector<communication_layer::RecordedDatagram> datagrams{ communication_layer::readRecording(
+        recording, port == 0 ? boost::none : boost::optional<unsigned short>(port)) };
+    const std::size_t number_of_datagrams{ datagrams.size() };
+
+    ReplayScanner scanner(
+        config,
+        [print_scans](const LaserScan& scan) {
+          if (print_scans)
+          {
+            std::cout << util::formatRange(scan.getMeasurements()) << "\n";
+          }
+        },
+        std::move(datagrams),
+        speed);
+    const auto replay_start{ std::chrono::steady_clock::now() };
+    scanner.run();
+    const std::chrono::duration<double> duration{ std::chrono::steady_clock::now() - replay_start };
+
+    const ScannerStatistics statistics{ scanner.getStatistics() };
+    std::cout << fmt::format("{} datagrams, {} frames, {} scans, {} decode errors, {} dropped rounds, "
+                             "{} scan counter gaps in {:.3f} s ({:.0f} frames/s)\n",
+                             number_of_datagrams,
+                             statistics.protocol.frames_received,
+                             statistics.protocol.scans_completed,
+                             statistics.protocol.decode_errors,
+                             statistics.protocol.dropped_rounds,
+                             statistics.protocol.scan_counter_gaps,
+                             duration.count(),
+                             duration.count() > 0. ? statistics.protocol.frames_received / duration.count() : 0.);
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
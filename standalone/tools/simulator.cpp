@@ -0,0 +1,191 @@
+// Copyright (c) 2020-2021 Pilz GmbH & Co. KG
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/*
+ * Simulates one or more scanners, e.g. to load-test the driver without hardware.
+ *
+ * Scanner i listens on <ip>:<control-port + i> and sends its monitoring frames from <ip>:<data-port + i>. Configure
+ * the driver with the corresponding scannerIp, scannerControlPort and scannerDataPort. The simulated scanners follow
+ * the scan range, resolution, intensities and diagnostics of the start requests.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <psen_scan_v2_standalone/configuration/default_parameters.h>
+#include <psen_scan_v2_standalone/simulation/scanner_simulator.h>
+#include <psen_scan_v2_standalone/util/logging.h>
+
+using namespace psen_scan_v2_standalone;
+
+static std::atomic<bool> terminate_requested{ false };
+
+static void handleSignal(int /*signal*/)
+{
+  terminate_requested = true;
+}
+
+static void printUsage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [options]\n"
+            << "  --scanners <n>           number of simulated scanners (default: 1)\n"
+            << "  --ip <address>           ip address of the scanners (default: 127.0.0.1)\n"
+            << "  --control-port <port>    control port of the first scanner (default: "
+            << configuration::CONTROL_PORT_OF_SCANNER_DEVICE << ")\n"
+            << "  --data-port <port>       data port of the first scanner (default: "
+            << configuration::DATA_PORT_OF_SCANNER_DEVICE << ")\n"
+            << "  --rate <factor>          multiple of the scan rate of the scanner ("
+            << simulation::DEFAULT_SCAN_RATE_HZ << " Hz, default: 1)\n"
+            << "  --jitter-us <us>         maximal random delay of each frame (default: 0)\n"
+            << "  --loss <probability>     probability of a frame being dropped (default: 0)\n"
+            << "  --reorder <probability>  probability of a frame being sent after its successor (default: 0)\n"
+            << "  --diagnostic-errors      report a diagnostic error in each frame, if diagnostics are enabled\n"
+            << "  --seed <n>               seed of jitter, loss and reordering (default: 0)\n"
+            << "  --duration <s>           stop after the given time instead of waiting for SIGINT\n";
+}
+
+int main(int argc, char* argv[])
+{
+  setLogLevel(CONSOLE_BRIDGE_LOG_INFO);
+
+  std::size_t number_of_scanners{ 1 };
+  std::string ip{ "127.0.0.1" };
+  unsigned short control_port{ configuration::CONTROL_PORT_OF_SCANNER_DEVICE };
+  unsigned short data_port{ configuration::DATA_PORT_OF_SCANNER_DEVICE };
+  double duration_s{ 0. };
+  simulation::SimulationParameters parameters;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string option{ argv[i] };
+    if (option == "--help")
+    {
+      printUsage(argv[0]);
+      return EXIT_SUCCESS;
+    }
+    if (option == "--diagnostic-errors")
+    {
+      parameters.diagnostic_errors = true;
+      continue;
+    }
+    if (i + 1 >= argc)
+    {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    const std::string value{ argv[++i] };
+    try
+    {
+      if (option == "--scanners")
+      {
+        number_of_scanners = std::stoul(value);
+      }
+      else if (option == "--ip")
+      {
+        ip = value;
+      }
+      else if (option == "--control-port")
+      {
+        control_port = static_cast<unsigned short>(std::stoul(value));
+      }
+      else if (option == "--data-port")
+      {
+        data_port = static_cast<unsigned short>(std::stoul(value));
+      }
+      else if (option == "--rate")
+      {
+        parameters.scan_rate_hz = simulation::DEFAULT_SCAN_RATE_HZ * std::stod(value);
+      }
+      else if (option == "--jitter-us")
+      {
+        parameters.jitter = std::chrono::microseconds(std::stol(value));
+      }
+      else if (option == "--loss")
+      {
+        parameters.loss_probability = std::stod(value);
+      }
+      else if (option == "--reorder")
+      {
+        parameters.reorder_probability = std::stod(value);
+      }
+      else if (option == "--seed")
+      {
+        parameters.seed = static_cast<unsigned int>(std::stoul(value));
+      }
+      else if (option == "--duration")
+      {
+        duration_s = std::stod(value);
+      }
+      else
+      {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    }
+    catch (const std::logic_error&)
+    {
+      std::cerr << "Invalid value for " << option << ": " << value << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (parameters.scan_rate_hz <= 0.)
+  {
+    std::cerr << "The rate must be positive.\n";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::unique_ptr<simulation::ScannerSimulator>> scanners;
+  for (std::size_t i = 0; i < number_of_scanners; ++i)
+  {
+    simulation::SimulationParameters scanner_parameters{ parameters };
+    scanner_parameters.seed = parameters.seed + static_cast<unsigned int>(i);
+    scanners.emplace_back(new simulation::ScannerSimulator(ip,
+                                                           static_cast<unsigned short>(control_port + i),
+                                                           static_cast<unsigned short>(data_port + i),
+                                                           scanner_parameters));
+  }
+
+  std::signal(SIGINT, handleSignal);
+  std::signal(SIGTERM, handleSignal);
+  const auto start{ std::chrono::steady_clock::now() };
+  while (!terminate_requested &&
+         (duration_s <= 0. || std::chrono::steady_clock::now() - start < std::chrono::duration<double>(duration_s)))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  for (std::size_t i = 0; i < scanners.size(); ++i)
+  {
+    const simulation::SimulatorStatistics statistics{ scanners[i]->statistics() };
+    PSENSCAN_INFO("Simulator",
+                  "Scanner {}: {} start requests, {} stop requests, {} scan rounds, {} frames sent, {} frames lost, "
+                  "{} frames reordered",
+                  i,
+                  statistics.start_requests,
+                  statistics.stop_requests,
+                  statistics.scan_rounds,
+                  statistics.sent_frames,
+                  statistics.lost_frames,
+                  statistics.reordered_frames);
+  }
+  return EXIT_SUCCESS;
+}